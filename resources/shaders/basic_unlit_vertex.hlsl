@@ -1,7 +1,13 @@
-
 struct SVertInput
 {
-    [[vk::location(0)]] uint idx : SV_VertexID;
+    [[vk::location(0)]] float3 position : POSITION;
+    [[vk::location(1)]] float4 colour : COLOR0;
+    // Per instance, one matrix column per location
+    [[vk::location(2)]] float4 transform_0 : TRANSFORM0;
+    [[vk::location(3)]] float4 transform_1 : TRANSFORM1;
+    [[vk::location(4)]] float4 transform_2 : TRANSFORM2;
+    [[vk::location(5)]] float4 transform_3 : TRANSFORM3;
+    [[vk::location(6)]] float4 tint : TINT;
 };
 
 struct SVertexOutput
@@ -10,24 +16,24 @@ struct SVertexOutput
     [[vk::location(1)]] float4 vDiffuse : COLOR;
 };
 
-static const float4 _verts[] = {
-    float4(0.0, -0.5, 0.0, 1.0),
-    float4(0.5, 0.5, 0.0, 1.0),
-    float4(-0.5, 0.5, 0.0, 1.0)
+struct SPushConstants
+{
+    float4x4 view_projection;
 };
 
-static const float4 colors[] = {
-    float4(1.0, 0.0, 0.0, 1.0),
-    float4(0.0, 1.0, 0.0, 1.0),
-    float4(0.0, 0.0, 1.0, 1.0)
-};
+[[vk::push_constant]] SPushConstants constants;
 
 SVertexOutput main(in const SVertInput v)
 {
     SVertexOutput output;
-    output.vPos = _verts[v.idx];
 
-    output.vDiffuse = colors[v.idx];
+    // Built from the columns as rows, so multiplying the row vector on the left applies it the
+    // same way glm does on the CPU
+    float4x4 const transform = float4x4(v.transform_0, v.transform_1, v.transform_2, v.transform_3);
+    float4 const world = mul(float4(v.position, 1.0), transform);
+    output.vPos = mul(constants.view_projection, world);
+
+    output.vDiffuse = v.colour * v.tint;
 
     return output;
-}
\ No newline at end of file
+}
@@ -0,0 +1,68 @@
+// One thread per object, every object whose bounds touch the frustum appends an indexed draw.
+// The draw count is cleared by the host before dispatch and read back by the indirect draw.
+
+struct SCullObject
+{
+    float4 centre;
+    float4 extents;
+    uint index_count;
+    uint first_index;
+    int vertex_offset;
+    uint padding;
+};
+
+// Matches VkDrawIndexedIndirectCommand
+struct SDrawCommand
+{
+    uint index_count;
+    uint instance_count;
+    uint first_index;
+    int vertex_offset;
+    uint first_instance;
+};
+
+struct SCullConstants
+{
+    float4 planes[6];
+    uint object_count;
+};
+
+[[vk::binding(0)]] StructuredBuffer<SCullObject> objects;
+[[vk::binding(1)]] RWStructuredBuffer<SDrawCommand> draws;
+[[vk::binding(2)]] RWStructuredBuffer<uint> draw_count;
+
+[[vk::push_constant]] SCullConstants constants;
+
+[numthreads(64, 1, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+    uint const index = id.x;
+    if (index >= constants.object_count)
+    {
+        return;
+    }
+
+    SCullObject const object = objects[index];
+    for (uint p = 0; p < 6; ++p)
+    {
+        float4 const plane = constants.planes[p];
+        float const distance = dot(plane.xyz, object.centre.xyz) + plane.w;
+        float const radius = dot(abs(plane.xyz), object.extents.xyz);
+        if (distance + radius < 0.0)
+        {
+            return;
+        }
+    }
+
+    uint slot = 0;
+    InterlockedAdd(draw_count[0], 1, slot);
+
+    SDrawCommand draw;
+    draw.index_count = object.index_count;
+    draw.instance_count = 1;
+    draw.first_index = object.first_index;
+    draw.vertex_offset = object.vertex_offset;
+    // Lets the vertex shader find the object's own data again
+    draw.first_instance = index;
+    draws[slot] = draw;
+}
@@ -0,0 +1,24 @@
+struct SFragInput
+{
+    [[vk::location(0)]] float4 vPos : SV_Position;
+    [[vk::location(1)]] float4 vColour : COLOR;
+    [[vk::location(2)]] float2 vCorner : TEXCOORD0;
+};
+
+struct SFragOutput
+{
+    [[vk::location(0)]] float4 colour : SV_Target;
+};
+
+SFragOutput main(const SFragInput input)
+{
+    float const falloff = 1.0 - dot(input.vCorner, input.vCorner);
+    if (falloff <= 0.0)
+    {
+        discard;
+    }
+
+    SFragOutput output;
+    output.colour = float4(input.vColour.rgb, input.vColour.a * falloff);
+    return output;
+}
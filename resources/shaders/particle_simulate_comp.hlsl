@@ -0,0 +1,80 @@
+// One thread per particle. The pool is always full, a particle that reaches the end of its life
+// is respawned in place at the emitter, so there's nothing to compact on the GPU.
+
+struct SParticle
+{
+    // xyz position, w life from 0 at spawn to 1 at death
+    float4 position_life;
+    // xyz velocity, w one over the lifetime
+    float4 velocity_rate;
+};
+
+struct SParticleConstants
+{
+    float4 origin_dt;
+    // Gravity already scaled by dt, w the velocity damping for the step
+    float4 gravity_damping;
+    float4 extents_min_lifetime;
+    float4 min_velocity_max_lifetime;
+    float4 max_velocity;
+    uint particle_count;
+    uint seed;
+};
+
+[[vk::binding(0)]] RWStructuredBuffer<SParticle> particles;
+
+[[vk::push_constant]] SParticleConstants constants;
+
+uint pcg_hash(uint value)
+{
+    uint const state = value * 747796405u + 2891336453u;
+    uint const word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+float random(inout uint state)
+{
+    state = pcg_hash(state);
+    return float(state >> 8) * (1.0 / 16777216.0);
+}
+
+float3 random_range(inout uint state, float3 low, float3 high)
+{
+    float3 t;
+    t.x = random(state);
+    t.y = random(state);
+    t.z = random(state);
+    return lerp(low, high, t);
+}
+
+[numthreads(64, 1, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+    uint const index = id.x;
+    if (index >= constants.particle_count)
+    {
+        return;
+    }
+
+    SParticle particle = particles[index];
+    float const dt = constants.origin_dt.w;
+
+    float3 const velocity = (particle.velocity_rate.xyz + constants.gravity_damping.xyz) * constants.gravity_damping.w;
+    particle.position_life.xyz += velocity * dt;
+    particle.position_life.w += particle.velocity_rate.w * dt;
+    particle.velocity_rate.xyz = velocity;
+
+    if (particle.position_life.w >= 1.0)
+    {
+        uint state = pcg_hash(index ^ pcg_hash(constants.seed));
+        float3 const extents = constants.extents_min_lifetime.xyz;
+        particle.position_life.xyz = constants.origin_dt.xyz + random_range(state, -extents, extents);
+        particle.position_life.w = 0.0;
+        particle.velocity_rate.xyz = random_range(state, constants.min_velocity_max_lifetime.xyz, constants.max_velocity.xyz);
+
+        float const lifetime = lerp(constants.extents_min_lifetime.w, constants.min_velocity_max_lifetime.w, random(state));
+        particle.velocity_rate.w = lifetime > 0.0 ? 1.0 / lifetime : 1.0e30;
+    }
+
+    particles[index] = particle;
+}
@@ -0,0 +1,41 @@
+struct SVertInput
+{
+    [[vk::location(0)]] float2 corner : CORNER;
+    // Per instance, each from its own stream
+    [[vk::location(1)]] float position_x : POSITION0;
+    [[vk::location(2)]] float position_y : POSITION1;
+    [[vk::location(3)]] float position_z : POSITION2;
+    [[vk::location(4)]] float life : LIFE;
+};
+
+struct SVertexOutput
+{
+    [[vk::location(0)]] float4 vPos : SV_Position;
+    [[vk::location(1)]] float4 vColour : COLOR;
+    [[vk::location(2)]] float2 vCorner : TEXCOORD0;
+};
+
+struct SPushConstants
+{
+    float4x4 view_projection;
+    float4 start_colour;
+    float4 end_colour;
+    // x the size at spawn, y at death
+    float4 size;
+};
+
+[[vk::push_constant]] SPushConstants constants;
+
+SVertexOutput main(in const SVertInput v)
+{
+    SVertexOutput output;
+
+    // Expanded after projection so every particle faces the camera
+    float4 const centre = mul(constants.view_projection, float4(v.position_x, v.position_y, v.position_z, 1.0));
+    float const size = lerp(constants.size.x, constants.size.y, v.life);
+    output.vPos = centre + float4(v.corner * size * centre.w, 0.0, 0.0);
+    output.vColour = lerp(constants.start_colour, constants.end_colour, v.life);
+    output.vCorner = v.corner;
+
+    return output;
+}
@@ -0,0 +1,27 @@
+struct SFragInput
+{
+    [[vk::location(0)]] float4 vPos : SV_Position;
+    [[vk::location(1)]] float2 vUV : TEXCOORD0;
+    [[vk::location(2)]] float4 vColour : COLOR;
+};
+
+struct SFragOutput
+{
+    [[vk::location(0)]] float4 colour : SV_Target;
+};
+
+[[vk::binding(0)]] Texture2D glyph_atlas;
+[[vk::binding(0)]] SamplerState glyph_sampler;
+
+SFragOutput main(const SFragInput input)
+{
+    // 0.5 is the glyph outline (SDF_ON_EDGE_VALUE), antialiased over about a screen pixel
+    // whatever size the text is drawn at
+    float distance = glyph_atlas.Sample(glyph_sampler, input.vUV).r;
+    float width = fwidth(distance) * 0.5;
+    float coverage = smoothstep(0.5 - width, 0.5 + width, distance);
+
+    SFragOutput output;
+    output.colour = float4(input.vColour.rgb, input.vColour.a * coverage);
+    return output;
+}
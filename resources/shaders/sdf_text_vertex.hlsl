@@ -0,0 +1,31 @@
+struct SVertInput
+{
+    [[vk::location(0)]] float2 vPos : POSITION;
+    [[vk::location(1)]] float2 vUV : TEXCOORD0;
+    [[vk::location(2)]] float4 vColour : COLOR;
+};
+
+struct SVertexOutput
+{
+    [[vk::location(0)]] float4 vPos : SV_Position;
+    [[vk::location(1)]] float2 vUV : TEXCOORD0;
+    [[vk::location(2)]] float4 vColour : COLOR;
+};
+
+struct SScreen
+{
+    float2 size;
+};
+
+[[vk::push_constant]] SScreen screen;
+
+// Text vertices are in screen pixels with y down
+SVertexOutput main(in const SVertInput v)
+{
+    SVertexOutput output;
+    output.vPos = float4(v.vPos / screen.size * 2.0 - 1.0, 0.0, 1.0);
+    output.vUV = v.vUV;
+    output.vColour = v.vColour;
+
+    return output;
+}
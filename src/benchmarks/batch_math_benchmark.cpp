@@ -0,0 +1,222 @@
+// Compares the batch maths kernels at every supported SIMD level against the equivalent
+// per-object glm code. Run from a release build: ./batch_math_benchmark [item_count]
+
+#include "math/batch_math.hpp"
+#include "renderer/bounds.hpp"
+#include "utility/cpu_features.hpp"
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cinttypes>
+#include <cstdlib>
+#include <functional>
+#include <initializer_list>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr int RUN_COUNT = 5;
+
+    // Best of several runs in milliseconds
+    double time_ms(std::function<void()> const & func)
+    {
+        double best = 1.0e30;
+        for (int run = 0; run < RUN_COUNT; ++run)
+        {
+            auto const start = std::chrono::high_resolution_clock::now();
+            func();
+            auto const finish = std::chrono::high_resolution_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(finish - start).count());
+        }
+        return best;
+    }
+
+    void print_result(std::string const & name, double const ms, double const baseline_ms)
+    {
+        std::cout << "  " << std::left << std::setw(12) << name
+                  << std::right << std::setw(10) << std::fixed << std::setprecision(3) << ms << " ms"
+                  << std::setw(8) << std::setprecision(2) << (baseline_ms / ms) << "x" << std::endl;
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    size_t const count = argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10)) : (1u << 20);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+
+    // glm baseline data, array of structures
+    std::vector<glm::vec3> points(count);
+    std::vector<glm::vec3> points_out(count);
+    std::vector<glm::vec3> translations(count);
+    std::vector<glm::quat> rotations(count);
+    std::vector<glm::vec3> scales(count);
+    std::vector<glm::mat4> matrices(count);
+    std::vector<Renderer::SAabb> aabbs(count);
+    std::vector<Renderer::SAabb> aabbs_out(count);
+
+    // Batch data, one array per component
+    std::vector<std::vector<float>> streams;
+    auto new_stream = [&]()
+    {
+        streams.emplace_back(count, 0.0f);
+        return streams.back().data();
+    };
+    streams.reserve(48);
+
+    BatchMath::SVec3Stream in_stream;
+    BatchMath::SVec3Stream out_stream;
+    BatchMath::SVec3Stream translation_stream;
+    BatchMath::SVec3Stream scale_stream;
+    BatchMath::SQuatStream rotation_stream;
+    BatchMath::SMat4Stream matrix_stream;
+    BatchMath::SAabbStream aabb_stream;
+    BatchMath::SAabbStream aabb_out_stream;
+
+    for (BatchMath::SVec3Stream * stream : { &in_stream, &out_stream, &translation_stream, &scale_stream })
+    {
+        stream->x = new_stream();
+        stream->y = new_stream();
+        stream->z = new_stream();
+    }
+    rotation_stream.x = new_stream();
+    rotation_stream.y = new_stream();
+    rotation_stream.z = new_stream();
+    rotation_stream.w = new_stream();
+    for (float *& element : matrix_stream.m)
+    {
+        element = new_stream();
+    }
+    for (BatchMath::SAabbStream * stream : { &aabb_stream, &aabb_out_stream })
+    {
+        stream->centre_x = new_stream();
+        stream->centre_y = new_stream();
+        stream->centre_z = new_stream();
+        stream->extent_x = new_stream();
+        stream->extent_y = new_stream();
+        stream->extent_z = new_stream();
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        points[i] = glm::vec3(dist(rng), dist(rng), dist(rng));
+        translations[i] = glm::vec3(dist(rng), dist(rng), dist(rng));
+        rotations[i] = glm::quat(dist(rng), dist(rng), dist(rng), dist(rng));
+        scales[i] = glm::vec3(dist(rng), dist(rng), dist(rng));
+        aabbs[i].min = glm::vec3(dist(rng), dist(rng), dist(rng));
+        aabbs[i].max = aabbs[i].min + glm::vec3(1.0f);
+
+        in_stream.x[i] = points[i].x;
+        in_stream.y[i] = points[i].y;
+        in_stream.z[i] = points[i].z;
+        translation_stream.x[i] = translations[i].x;
+        translation_stream.y[i] = translations[i].y;
+        translation_stream.z[i] = translations[i].z;
+        scale_stream.x[i] = scales[i].x;
+        scale_stream.y[i] = scales[i].y;
+        scale_stream.z[i] = scales[i].z;
+        rotation_stream.x[i] = rotations[i].x;
+        rotation_stream.y[i] = rotations[i].y;
+        rotation_stream.z[i] = rotations[i].z;
+        rotation_stream.w[i] = rotations[i].w;
+
+        glm::vec3 const centre = aabbs[i].Centre();
+        glm::vec3 const extents = aabbs[i].Extents();
+        aabb_stream.centre_x[i] = centre.x;
+        aabb_stream.centre_y[i] = centre.y;
+        aabb_stream.centre_z[i] = centre.z;
+        aabb_stream.extent_x[i] = extents.x;
+        aabb_stream.extent_y[i] = extents.y;
+        aabb_stream.extent_z[i] = extents.z;
+    }
+
+    Utility::ESimdLevel const levels[] = {
+        Utility::ESimdLevel::Scalar,
+        Utility::ESimdLevel::SSE41,
+        Utility::ESimdLevel::AVX2,
+        Utility::ESimdLevel::AVX512
+    };
+    Utility::ESimdLevel const supported = Utility::get_simd_level();
+
+    std::cout << "Batch maths benchmark, " << count << " items, best of " << RUN_COUNT << " runs" << std::endl;
+    std::cout << "CPU supports up to " << Utility::simd_level_name(supported) << std::endl;
+
+    auto run_levels = [&](char const * name, double const baseline_ms, std::function<void()> const & batch_func)
+    {
+        std::cout << name << std::endl;
+        print_result("glm", baseline_ms, baseline_ms);
+        for (Utility::ESimdLevel const level : levels)
+        {
+            if (level > supported)
+            {
+                break;
+            }
+            Utility::set_max_simd_level(level);
+            print_result(Utility::simd_level_name(level), time_ms(batch_func), baseline_ms);
+        }
+        Utility::set_max_simd_level(Utility::ESimdLevel::AVX512);
+    };
+
+    // normalise first so compose_trs gets valid rotations
+    double const normalise_glm_ms = time_ms([&]()
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            rotations[i] = glm::normalize(rotations[i]);
+        }
+    });
+    run_levels("normalise_quats", normalise_glm_ms, [&]() { BatchMath::normalise_quats(rotation_stream, 0, count); });
+
+    double const compose_glm_ms = time_ms([&]()
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            matrices[i] = glm::translate(glm::mat4(1.0f), translations[i])
+                        * glm::mat4_cast(rotations[i])
+                        * glm::scale(glm::mat4(1.0f), scales[i]);
+        }
+    });
+    run_levels("compose_trs", compose_glm_ms, [&]() { BatchMath::compose_trs(translation_stream, rotation_stream, scale_stream, matrix_stream, 0, count); });
+
+    double const points_glm_ms = time_ms([&]()
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            points_out[i] = glm::vec3(matrices[i] * glm::vec4(points[i], 1.0f));
+        }
+    });
+    run_levels("transform_points", points_glm_ms, [&]() { BatchMath::transform_points(matrix_stream, in_stream, out_stream, 0, count); });
+
+    double const aabbs_glm_ms = time_ms([&]()
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            aabbs_out[i] = Renderer::transform_aabb(aabbs[i], matrices[i]);
+        }
+    });
+    run_levels("transform_aabbs", aabbs_glm_ms, [&]() { BatchMath::transform_aabbs(matrix_stream, aabb_stream, aabb_out_stream, 0, count); });
+
+    // Sanity check the batch results against glm
+    float max_error = 0.0f;
+    for (size_t i = 0; i < count; ++i)
+    {
+        max_error = std::max(max_error, std::fabs(points_out[i].x - out_stream.x[i]));
+        max_error = std::max(max_error, std::fabs(points_out[i].y - out_stream.y[i]));
+        max_error = std::max(max_error, std::fabs(points_out[i].z - out_stream.z[i]));
+    }
+    std::cout << "Max transform_points difference from glm : " << max_error << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,139 @@
+// Renders a typical effect bus layout offline through the voice mixer at every supported SIMD
+// level and compares the cost of a block against the time that block lasts.
+// Run from a release build: ./dsp_graph_benchmark [voice_count] [seconds]
+
+#include "audio/dsp_effects.hpp"
+#include "audio/dsp_graph.hpp"
+#include "audio/sound_buffer.hpp"
+#include "audio/voice_mixer.hpp"
+#include "utility/cpu_features.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t SAMPLE_RATE = 44100;
+    constexpr uint32_t CHANNELS = 2;
+    // A common device buffer size, each one is a callback
+    constexpr size_t CALLBACK_FRAMES = 512;
+    constexpr uint32_t GROUP_BUS_COUNT = 8;
+
+    // Eight group buses with a filter and compressor each, half sent through a shared delay
+    // bus, and a reverb and limiter on the master
+    std::unique_ptr<Audio::CDspGraph> create_graph()
+    {
+        std::unique_ptr<Audio::CDspGraph> graph = std::make_unique<Audio::CDspGraph>();
+
+        uint32_t const delay_bus = graph->AddBus(Audio::MASTER_BUS);
+        graph->AddEffect(delay_bus, std::make_unique<Audio::CDelay>(375.0f, 0.45f, 0.35f));
+
+        for (uint32_t group = 0; group < GROUP_BUS_COUNT; ++group)
+        {
+            uint32_t const bus = graph->AddBus(group % 2 == 0 ? Audio::MASTER_BUS : delay_bus);
+            graph->AddEffect(bus, std::make_unique<Audio::CBiquadFilter>(Audio::EBiquadType::LowPass, 2000.0f + 1000.0f * static_cast<float>(group)));
+            graph->AddEffect(bus, std::make_unique<Audio::CCompressor>(-18.0f, 3.0f));
+        }
+
+        graph->AddEffect(Audio::MASTER_BUS, std::make_unique<Audio::CReverb>(0.6f, 0.2f));
+        graph->AddEffect(Audio::MASTER_BUS, std::make_unique<Audio::CCompressor>(-3.0f, 20.0f, 1.0f, 50.0f));
+
+        graph->Compile(SAMPLE_RATE);
+        return graph;
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    uint32_t const voice_count = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 128;
+    float const seconds = argc > 2 ? static_cast<float>(std::strtod(argv[2], nullptr)) : 10.0f;
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-0.25f, 0.25f);
+
+    // One second of stereo noise for every voice to loop
+    std::vector<float> noise(SAMPLE_RATE * CHANNELS);
+    for (float & sample : noise)
+    {
+        sample = dist(rng);
+    }
+    Audio::SSoundBuffer buffer;
+    Audio::create_sound_buffer(noise.data(), SAMPLE_RATE, CHANNELS, SAMPLE_RATE, buffer);
+
+    size_t const callback_count = static_cast<size_t>(seconds * SAMPLE_RATE) / CALLBACK_FRAMES;
+    double const callback_budget_ms = 1000.0 * static_cast<double>(CALLBACK_FRAMES) / SAMPLE_RATE;
+    std::vector<float> output(CALLBACK_FRAMES * CHANNELS);
+
+    Utility::ESimdLevel const levels[] = {
+        Utility::ESimdLevel::Scalar,
+        Utility::ESimdLevel::SSE41,
+        Utility::ESimdLevel::AVX2
+    };
+    Utility::ESimdLevel const supported = Utility::get_simd_level();
+
+    std::cout << "DSP graph benchmark, " << voice_count << " voices over " << GROUP_BUS_COUNT << " group buses, "
+              << seconds << "s rendered in " << CALLBACK_FRAMES << " frame callbacks" << std::endl;
+    std::cout << "CPU supports up to " << Utility::simd_level_name(supported) << std::endl;
+
+    for (Utility::ESimdLevel const level : levels)
+    {
+        if (level > supported)
+        {
+            break;
+        }
+        Utility::set_max_simd_level(level);
+
+        // Fresh state every run so each level renders the same thing
+        std::unique_ptr<Audio::CDspGraph> graph = create_graph();
+        std::unique_ptr<Audio::CVoiceMixer> mixer = std::make_unique<Audio::CVoiceMixer>();
+        mixer->SetGraph(graph.get());
+
+        for (uint32_t voice = 0; voice < std::min(voice_count, Audio::MAX_VOICES); ++voice)
+        {
+            Audio::SAudioCommand command;
+            command.type = Audio::EAudioCommand::Play;
+            command.voice = voice;
+            command.buffer = &buffer;
+            command.params.volume = 0.1f;
+            command.params.looping = true;
+            command.params.start_frame = (voice * 997) % SAMPLE_RATE;
+            command.params.bus = 2 + voice % GROUP_BUS_COUNT;
+            mixer->ApplyCommand(command);
+        }
+
+        double total_ms = 0.0;
+        double peak_ms = 0.0;
+        float peak_sample = 0.0f;
+        for (size_t callback = 0; callback < callback_count; ++callback)
+        {
+            auto const start = std::chrono::high_resolution_clock::now();
+            mixer->Mix(output.data(), CALLBACK_FRAMES, CHANNELS);
+            auto const finish = std::chrono::high_resolution_clock::now();
+
+            double const ms = std::chrono::duration<double, std::milli>(finish - start).count();
+            total_ms += ms;
+            peak_ms = std::max(peak_ms, ms);
+            for (float const sample : output)
+            {
+                peak_sample = std::max(peak_sample, std::fabs(sample));
+            }
+        }
+
+        double const average_ms = total_ms / static_cast<double>(std::max<size_t>(callback_count, 1));
+        std::cout << "  " << std::left << std::setw(8) << Utility::simd_level_name(level) << std::right << std::fixed
+                  << std::setprecision(4) << std::setw(9) << average_ms << " ms average"
+                  << std::setw(9) << peak_ms << " ms peak"
+                  << std::setprecision(2) << std::setw(8) << (100.0 * average_ms / callback_budget_ms) << "% of budget"
+                  << "  (peak sample " << std::setprecision(3) << peak_sample << ")" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,97 @@
+// Steps a particle system holding a steady population split over several emitters at every
+// supported SIMD level and compares the cost of an update against a 60 Hz frame.
+// Run from a release build: ./particle_benchmark [particle_count] [emitter_count]
+
+#include "renderer/particles/particle_system.hpp"
+#include "utility/cpu_features.hpp"
+#include "utility/parallel_for.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    constexpr float FRAME_TIME = 1.0f / 60.0f;
+    constexpr uint32_t WARM_UP_FRAMES = 180;
+    constexpr uint32_t MEASURED_FRAMES = 600;
+
+    constexpr float MIN_LIFETIME = 1.0f;
+    constexpr float MAX_LIFETIME = 3.0f;
+}
+
+int main(int argc, char ** argv)
+{
+    uint32_t const particle_count = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 1000000;
+    uint32_t const emitter_count = std::max(argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 8u, 1u);
+    uint32_t const per_emitter = particle_count / emitter_count;
+
+    Utility::ESimdLevel const levels[] = {
+        Utility::ESimdLevel::Scalar,
+        Utility::ESimdLevel::SSE41,
+        Utility::ESimdLevel::AVX2
+    };
+    Utility::ESimdLevel const supported = Utility::get_simd_level();
+
+    std::cout << "Particle benchmark, " << per_emitter * emitter_count << " particles over " << emitter_count << " emitters on "
+              << Utility::parallel_thread_count() << " threads" << std::endl;
+    std::cout << "CPU supports up to " << Utility::simd_level_name(supported) << std::endl;
+
+    for (Utility::ESimdLevel const level : levels)
+    {
+        if (level > supported)
+        {
+            break;
+        }
+        Utility::set_max_simd_level(level);
+
+        // The system picks its kernels when it's made, so each level gets a fresh one
+        Renderer::CParticleSystem particle_system;
+        for (uint32_t emitter = 0; emitter < emitter_count; ++emitter)
+        {
+            // Spawning at the rate particles die keeps the population around per_emitter, with
+            // some headroom for the random lifetimes
+            Renderer::SParticleEmitterSettings settings;
+            settings.max_particles = per_emitter + per_emitter / 4;
+            settings.spawn_rate = static_cast<float>(per_emitter) * 2.0f / (MIN_LIFETIME + MAX_LIFETIME);
+            settings.min_lifetime = MIN_LIFETIME;
+            settings.max_lifetime = MAX_LIFETIME;
+            settings.gravity = glm::vec3(0.0f, -9.81f, 0.0f);
+            settings.drag = 0.1f;
+            settings.seed = emitter + 1;
+            particle_system.CreateEmitter(settings)->Burst(per_emitter);
+        }
+
+        for (uint32_t frame = 0; frame < WARM_UP_FRAMES; ++frame)
+        {
+            particle_system.Update(FRAME_TIME);
+        }
+
+        double total_ms = 0.0;
+        double peak_ms = 0.0;
+        uint64_t total_particles = 0;
+        for (uint32_t frame = 0; frame < MEASURED_FRAMES; ++frame)
+        {
+            auto const start = std::chrono::high_resolution_clock::now();
+            particle_system.Update(FRAME_TIME);
+            auto const finish = std::chrono::high_resolution_clock::now();
+
+            double const ms = std::chrono::duration<double, std::milli>(finish - start).count();
+            total_ms += ms;
+            peak_ms = std::max(peak_ms, ms);
+            total_particles += particle_system.GetStats().particles;
+        }
+
+        double const average_ms = total_ms / MEASURED_FRAMES;
+        std::cout << "  " << std::left << std::setw(8) << Utility::simd_level_name(level) << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(9) << average_ms << " ms average"
+                  << std::setw(9) << peak_ms << " ms peak"
+                  << std::setprecision(2) << std::setw(8) << (100.0 * average_ms / (1000.0 * FRAME_TIME)) << "% of a frame"
+                  << "  (" << total_particles / MEASURED_FRAMES << " alive)" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
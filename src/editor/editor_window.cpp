@@ -3,12 +3,245 @@
 #include "imgui.h"
 
 #include "renderer/primitives/shape_2d.hpp"
+#include "scene/hierarchy_system.hpp"
+#include "utility/cpu_features.hpp"
+#include "utility/logging.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+#include <glm/geometric.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    constexpr char const * MEMORY_DUMP_FILENAME = "memory_stats.json";
+    constexpr size_t BYTES_PER_MB = 1024 * 1024;
+
+    constexpr char const * SCENE_FILENAME = "scene.gscn";
+    constexpr char const * SCENE_TEXT_FILENAME = "scene.gscn.txt";
+    constexpr char const * PROJECT_FILENAME = "project.gproj";
+    constexpr char const * PROJECT_NAME = "GOAT";
+
+    // Not part of the repo, any TrueType font will do, imgui's misc/fonts has a few
+    constexpr char const * TEST_FONT_FILENAME = "fonts/Roboto-Medium.ttf";
+
+    constexpr float TEST_TONE_HZ = 440.0f;
+    constexpr float TEST_TONE_VOLUME = 0.2f;
+
+    // One second of a sine wave, a whole number of cycles so it loops cleanly
+    void create_test_tone(uint32_t const sample_rate, Audio::SSoundBuffer & out_buffer)
+    {
+        std::vector<float> samples(sample_rate);
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            float const t = static_cast<float>(i) / static_cast<float>(sample_rate);
+            samples[i] = std::sin(2.0f * 3.14159265f * TEST_TONE_HZ * t);
+        }
+        Audio::create_sound_buffer(samples.data(), samples.size(), 1, sample_rate, out_buffer);
+    }
+
+    // The tint goes into the colours, scenes have nothing else to keep it in yet
+    void add_scene_mesh(Renderer::CMesh const & source, glm::vec4 const & tint, Scene::SSceneDesc & out_scene)
+    {
+        Scene::SSceneMeshDesc mesh;
+        mesh.positions.assign(source.GetPositions(), source.GetPositions() + source.GetVertexCount());
+        mesh.indices.assign(source.GetIndices(), source.GetIndices() + source.GetIndexCount());
+        for (uint32_t i = 0; i < source.GetVertexCount(); ++i)
+        {
+            mesh.colours.push_back(source.GetColours()[i] * tint);
+        }
+        out_scene.meshes.push_back(mesh);
+    }
+
+    // The binary file is the one that gets loaded, the text copy is only for reading and diffs
+    bool save_scene_files(Scene::SSceneDesc const & scene)
+    {
+        if (Scene::save_scene(scene, SCENE_FILENAME) == false)
+        {
+            return false;
+        }
+
+        // Exported from the saved file rather than the desc so it shows exactly what was written
+        Scene::CSceneFile scene_file;
+        if (scene_file.Open(SCENE_FILENAME) == false || Scene::export_scene_text(scene_file, SCENE_TEXT_FILENAME) == false)
+        {
+            return false;
+        }
+
+        DEBUG_LOG(std::string("Saved ") + SCENE_FILENAME);
+        return true;
+    }
+
+    bool save_project_files(Scene::SSceneDesc const & scene)
+    {
+        if (save_scene_files(scene) == false)
+        {
+            return false;
+        }
+
+        Scene::SProjectDesc project;
+        project.name = PROJECT_NAME;
+        project.scenes.push_back(SCENE_FILENAME);
+        if (Scene::save_project(project, PROJECT_FILENAME) == false)
+        {
+            return false;
+        }
+
+        DEBUG_LOG(std::string("Saved ") + PROJECT_FILENAME);
+        return true;
+    }
+
+    void draw_audio_stats(Audio::SAudioStats const & stats)
+    {
+        ImGui::Text("Voices     : %u", stats.active_voices);
+        ImGui::Text("Callback   : %.3f ms (avg %.3f, peak %.3f)", stats.callback_ms_last, stats.callback_ms_average, stats.callback_ms_peak);
+        ImGui::Text("Budget     : %.3f ms", stats.callback_budget_ms);
+        ImGui::Text("Callbacks  : %llu", static_cast<unsigned long long>(stats.callback_count));
+        ImGui::Text("Dropped    : %u commands", stats.dropped_commands);
+        ImGui::Text("Streams    : %u (%zu KB resident)", stats.open_streams, stats.stream_resident_bytes / 1024);
+        ImGui::Text("Underruns  : %u", stats.stream_underruns);
+
+        float const load = stats.callback_budget_ms > 0.0f ? stats.callback_ms_average / stats.callback_budget_ms : 0.0f;
+        ImGui::ProgressBar(load, ImVec2(-1.0f, 0.0f), "CPU load");
+    }
+
+    void format_bytes(char * buffer, size_t const buffer_size, size_t const bytes)
+    {
+        if (bytes >= BYTES_PER_MB)
+        {
+            std::snprintf(buffer, buffer_size, "%.2f MB", static_cast<double>(bytes) / BYTES_PER_MB);
+        }
+        else
+        {
+            std::snprintf(buffer, buffer_size, "%.2f KB", static_cast<double>(bytes) / 1024.0);
+        }
+    }
+
+    void draw_memory_stats(std::string & dump_status)
+    {
+        bool capture_callstacks = Memory::is_callstack_capture_enabled();
+        if (ImGui::Checkbox("Capture callstacks", &capture_callstacks))
+        {
+            Memory::set_callstack_capture(capture_callstacks);
+        }
+
+        ImGui::SameLine();
+        if (ImGui::Button("Dump JSON"))
+        {
+            dump_status = Memory::dump_memory_stats_json(MEMORY_DUMP_FILENAME) ? std::string("Wrote ") + MEMORY_DUMP_FILENAME
+                                                                                 : std::string("Failed to write ") + MEMORY_DUMP_FILENAME;
+        }
+        if (dump_status.empty() == false)
+        {
+            ImGui::SameLine();
+            ImGui::TextUnformatted(dump_status.c_str());
+        }
+
+        if (ImGui::BeginTable("memory_tags", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+        {
+            ImGui::TableSetupColumn("Tag");
+            ImGui::TableSetupColumn("Live");
+            ImGui::TableSetupColumn("Peak");
+            ImGui::TableSetupColumn("Allocations");
+            ImGui::TableSetupColumn("Total");
+            ImGui::TableSetupColumn("Budget (MB)");
+            ImGui::TableHeadersRow();
+
+            char buffer[32];
+            for (size_t i = 0; i < Memory::MEMORY_TAG_COUNT; ++i)
+            {
+                Memory::EMemoryTag const tag = static_cast<Memory::EMemoryTag>(i);
+                Memory::SMemoryTagStats const stats = Memory::get_memory_stats(tag);
+                bool const over_budget = stats.budget_bytes != 0 && stats.live_bytes > stats.budget_bytes;
+
+                ImGui::PushID(static_cast<int>(i));
+                ImGui::TableNextRow();
+
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(Memory::memory_tag_name(tag));
+
+                ImGui::TableNextColumn();
+                format_bytes(buffer, sizeof(buffer), stats.live_bytes);
+                if (over_budget == true)
+                {
+                    ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s", buffer);
+                }
+                else
+                {
+                    ImGui::TextUnformatted(buffer);
+                }
+
+                ImGui::TableNextColumn();
+                format_bytes(buffer, sizeof(buffer), stats.peak_bytes);
+                ImGui::TextUnformatted(buffer);
+
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(stats.live_allocations));
+
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(stats.total_allocations));
+
+                // Zero turns the budget off
+                ImGui::TableNextColumn();
+                int budget_mb = static_cast<int>(stats.budget_bytes / BYTES_PER_MB);
+                ImGui::SetNextItemWidth(-1.0f);
+                if (ImGui::InputInt("##budget", &budget_mb, 0, 0, ImGuiInputTextFlags_EnterReturnsTrue))
+                {
+                    Memory::set_memory_budget(tag, static_cast<size_t>(budget_mb > 0 ? budget_mb : 0) * BYTES_PER_MB);
+                }
+
+                ImGui::PopID();
+            }
+            ImGui::EndTable();
+        }
+    }
+}
 
 EditorWindow::EditorWindow()
 : m_should_close(false)
 , m_display_about(false)
 , m_display_imgui_demo(false)
+, m_display_render_stats(false)
+, m_display_memory_stats(false)
+, m_display_audio_stats(false)
+, m_last_cull_stats()
+, m_last_gpu_time()
+, m_last_resolution_scale(1.0f)
+, m_dynamic_resolution()
+, m_dynamic_resolution_changed(false)
+, m_memory_dump_status()
+, m_world()
+, m_hierarchy()
+, m_systems()
+, m_render_system(nullptr)
+, m_triangle_mesh(Renderer::INVALID_MESH)
+, m_test_entity(ECS::INVALID_ENTITY)
+, m_scene_nodes()
+, m_scene_node_ids()
+, m_scene_meshes()
+, m_scene_entities()
+, m_test_font()
+, m_test_text()
+, m_test_tone()
+, m_test_tone_voice(Audio::INVALID_VOICE)
+, m_audio_manager()
 {
+    // Transforms have to be up to date before the render system reads them
+    m_systems.AddSystem(std::make_unique<Scene::CHierarchySystem>(m_hierarchy));
+
+    std::unique_ptr<Renderer::CRenderSystem> render_system = std::make_unique<Renderer::CRenderSystem>();
+    m_render_system = render_system.get();
+    m_triangle_mesh = m_render_system->AddMesh(Renderer::get_triangle_mesh());
+    m_systems.AddSystem(std::move(render_system));
+
+    // Carry on without sound if there's no device
+    m_audio_manager.Init();
 }
 
 
@@ -18,6 +251,10 @@ EditorWindow::~EditorWindow()
 
 void EditorWindow::Input()
 {
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Editor);
+
+    m_audio_manager.Update();
+
     ImGui::BeginMainMenuBar();
 
     if (ImGui::BeginMenu("File"))
@@ -26,15 +263,24 @@ void EditorWindow::Input()
         {
             // TODO:
         }
+
+        if (ImGui::MenuItem("Open"))
+        {
+            OpenScene();
+        }
         
         if (ImGui::MenuItem("Save"))
         {
-            // TODO:
+            Scene::SSceneDesc scene;
+            BuildSceneDesc(scene);
+            save_scene_files(scene);
         }
         
         if (ImGui::MenuItem("Save Project"))
         {
-            // TODO:
+            Scene::SSceneDesc scene;
+            BuildSceneDesc(scene);
+            save_project_files(scene);
         }
 
         ImGui::Separator();
@@ -48,19 +294,65 @@ void EditorWindow::Input()
     }
     if (ImGui::BeginMenu("Testing"))
     {
-        bool test_triangle_enabled = m_test_renderable != nullptr;
+        bool test_triangle_enabled = m_world.IsAlive(m_test_entity);
 
         if (ImGui::MenuItem("Draw Triangle", "", &test_triangle_enabled))
         {
-            if (m_test_renderable != nullptr)
+            if (m_world.IsAlive(m_test_entity) == true)
             {
-                m_test_renderable = nullptr;
+                m_world.DestroyEntity(m_test_entity);
+                m_test_entity = ECS::INVALID_ENTITY;
             }
             else
             {
-                m_test_renderable = std::make_unique<Renderer::CTriangle2d>();
+                Renderer::SMeshComponent mesh;
+                mesh.mesh = m_triangle_mesh;
+                m_test_entity = m_world.CreateEntity(Renderer::STransformComponent(), mesh);
             }
         }
+
+        bool test_text_enabled = m_test_text != nullptr;
+
+        if (ImGui::MenuItem("Draw Text", "", &test_text_enabled))
+        {
+            if (m_test_text != nullptr)
+            {
+                // The atlas texture is let go in Render, where there's a context to do it
+                m_test_text = nullptr;
+            }
+            else if (m_test_font != nullptr || LoadTestFont() == true)
+            {
+                m_test_text = std::make_unique<Renderer::CTextRenderer>(*m_test_font);
+            }
+        }
+
+        bool test_tone_playing = m_audio_manager.IsPlaying(m_test_tone_voice);
+
+        if (ImGui::MenuItem("Play Test Tone", "", &test_tone_playing, m_audio_manager.IsInitialised()))
+        {
+            if (m_audio_manager.IsPlaying(m_test_tone_voice) == true)
+            {
+                m_audio_manager.Stop(m_test_tone_voice);
+            }
+            else
+            {
+                if (m_test_tone.sample_rate != m_audio_manager.GetSampleRate())
+                {
+                    create_test_tone(m_audio_manager.GetSampleRate(), m_test_tone);
+                }
+
+                Audio::SPlayParams params;
+                params.volume = TEST_TONE_VOLUME;
+                params.looping = true;
+                m_test_tone_voice = m_audio_manager.Play(m_test_tone, params);
+            }
+        }
+
+        ImGui::Separator();
+
+        ImGui::MenuItem("Renderer Stats", "", &m_display_render_stats);
+        ImGui::MenuItem("Memory Stats", "", &m_display_memory_stats);
+        ImGui::MenuItem("Audio Stats", "", &m_display_audio_stats);
         ImGui::EndMenu();
     }
     if (ImGui::BeginMenu("Help"))
@@ -100,17 +392,271 @@ void EditorWindow::Input()
     {
         ImGui::ShowDemoWindow();
     }
+
+    if (m_display_render_stats == true)
+    {
+        if (ImGui::Begin("Renderer Stats", &m_display_render_stats))
+        {
+            ImGui::Text("SIMD level : %s", Utility::simd_level_name(Utility::get_simd_level()));
+            ImGui::Text("Visible    : %u", m_last_cull_stats.visible);
+            ImGui::Text("Culled     : %u", m_last_cull_stats.culled);
+            if (m_last_gpu_time.valid == true)
+            {
+                ImGui::Text("GPU        : %.3f ms", m_last_gpu_time.milliseconds);
+            }
+            else
+            {
+                ImGui::Text("GPU        : not timed");
+            }
+            ImGui::Text("Resolution : %.0f%%", m_last_resolution_scale * 100.0f);
+
+            // Only moves when redrawing on demand, it's the stretch that ended with this frame
+            Window::SIdleStats const idle_stats = Window::get_idle_stats();
+            if (idle_stats.last_idle_seconds > 0.0)
+            {
+                ImGui::Text("Idle CPU   : %.2f%% over %.1f s", idle_stats.last_idle_cpu_seconds * 100.0 / idle_stats.last_idle_seconds, idle_stats.last_idle_seconds);
+            }
+            else
+            {
+                ImGui::Text("Idle CPU   : never idle");
+            }
+            ImGui::Text("Frames     : %llu drawn, %llu idle wakeups", static_cast<unsigned long long>(idle_stats.frames_drawn), static_cast<unsigned long long>(idle_stats.idle_wakeups));
+
+            m_dynamic_resolution_changed |= ImGui::Checkbox("Dynamic resolution", &m_dynamic_resolution.enabled);
+            m_dynamic_resolution_changed |= ImGui::SliderFloat("GPU budget (ms)", &m_dynamic_resolution.target_milliseconds, 1.0f, 33.0f);
+            m_dynamic_resolution_changed |= ImGui::SliderFloat("Min scale", &m_dynamic_resolution.min_scale, 0.25f, 1.0f);
+        }
+        ImGui::End();
+    }
+
+    if (m_display_memory_stats == true)
+    {
+        if (ImGui::Begin("Memory Stats", &m_display_memory_stats))
+        {
+            draw_memory_stats(m_memory_dump_status);
+        }
+        ImGui::End();
+    }
+
+    if (m_display_audio_stats == true)
+    {
+        if (ImGui::Begin("Audio Stats", &m_display_audio_stats))
+        {
+            draw_audio_stats(m_audio_manager.GetStats());
+        }
+        ImGui::End();
+    }
 }
 
 void EditorWindow::Render(Renderer::IRenderContext * render_context)
 {
-    if (m_test_renderable != nullptr)
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Editor);
+
+    // Stats are from the last frame that went through RenderFrame
+    m_last_cull_stats = render_context->GetCullStats();
+    m_last_gpu_time = render_context->GetGpuFrameTime();
+    m_last_resolution_scale = render_context->GetResolutionScale();
+
+    if (m_dynamic_resolution_changed == true)
     {
-        render_context->SubmitRenderable(m_test_renderable.get());
+        render_context->SetDynamicResolution(m_dynamic_resolution);
+        m_dynamic_resolution_changed = false;
     }
+
+    // Two units tall around the origin and as wide as the window's aspect, so the scene keeps
+    // its shape however the window is sized
+    ImVec2 const display_size = ImGui::GetIO().DisplaySize;
+    float const aspect = display_size.y > 0.0f ? display_size.x / display_size.y : 1.0f;
+    render_context->SetViewProjection(glm::ortho(-aspect, aspect, -1.0f, 1.0f));
+
+    // The editor has nothing animating yet so there's no time to step
+    m_systems.Update(m_world, 0.0f);
+    m_render_system->Submit(*render_context);
+
+    Renderer::ITextureBackend * texture_backend = render_context->GetTextureBackend();
+    if (texture_backend == nullptr || m_test_font == nullptr)
+    {
+        return;
+    }
+
+    if (m_test_text == nullptr)
+    {
+        m_test_font->ReleaseGpuTexture(*texture_backend);
+        return;
+    }
+
+    char gpu_time[64];
+    std::snprintf(gpu_time, sizeof(gpu_time), "GPU %.2f ms", m_last_gpu_time.milliseconds);
+
+    Renderer::STextStyle style;
+    style.size = 24.0f;
+    m_test_text->BeginFrame();
+    m_test_text->DrawText("GOAT", glm::vec2(16.0f, 32.0f), style);
+    style.size = 16.0f;
+    style.colour = glm::vec4(0.8f, 0.8f, 0.8f, 1.0f);
+    m_test_text->DrawText(gpu_time, glm::vec2(16.0f, 60.0f), style);
+    m_test_text->EndFrame(*texture_backend);
+    render_context->SubmitText(m_test_text.get());
 }
 
 bool EditorWindow::WindowShouldClose()
 {
     return m_should_close;
 }
+
+bool EditorWindow::NeedsRedraw()
+{
+    // The text cursor blinks while an input box has focus
+    if (ImGui::GetIO().WantTextInput == true)
+    {
+        return true;
+    }
+
+    // Callback timings change with every buffer the device asks for
+    return m_display_audio_stats == true && m_audio_manager.GetStats().active_voices > 0;
+}
+
+void EditorWindow::BuildSceneDesc(Scene::SSceneDesc & out_scene)
+{
+    // The opened scene goes back out as it came in, with each node's transform as it is now
+    out_scene.nodes.assign(m_scene_nodes.begin(), m_scene_nodes.end());
+    for (size_t i = 0; i < m_scene_nodes.size(); ++i)
+    {
+        Scene::NodeId const node = m_scene_node_ids[i];
+        out_scene.nodes[i].position = m_hierarchy.GetLocalPosition(node);
+        out_scene.nodes[i].rotation = m_hierarchy.GetLocalRotation(node);
+        out_scene.nodes[i].scale = m_hierarchy.GetLocalScale(node);
+    }
+    for (uint32_t const mesh : m_scene_meshes)
+    {
+        add_scene_mesh(*m_render_system->GetMesh(mesh), glm::vec4(1.0f), out_scene);
+    }
+
+    if (out_scene.nodes.empty() == true)
+    {
+        Scene::SSceneNodeDesc root;
+        root.name = "Root";
+        out_scene.nodes.push_back(root);
+    }
+
+    // The test triangle goes under the first node
+    Renderer::STransformComponent const * transform_component = m_world.GetComponent<Renderer::STransformComponent>(m_test_entity);
+    Renderer::SMeshComponent const * mesh_component = m_world.GetComponent<Renderer::SMeshComponent>(m_test_entity);
+    if (transform_component == nullptr || mesh_component == nullptr)
+    {
+        return;
+    }
+
+    Renderer::CMesh const * source = m_render_system->GetMesh(mesh_component->mesh);
+    if (source == nullptr)
+    {
+        return;
+    }
+
+    Scene::SSceneNodeDesc node;
+    node.name = "Triangle";
+    node.parent = 0;
+    node.mesh = static_cast<uint32_t>(out_scene.meshes.size());
+    add_scene_mesh(*source, mesh_component->tint, out_scene);
+
+    // Back to position, rotation and scale, assuming there's no shear
+    glm::mat4 const & transform = transform_component->transform;
+    node.position = glm::vec3(transform[3]);
+    node.scale = glm::vec3(glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2])));
+
+    glm::mat3 rotation;
+    for (int column = 0; column < 3; ++column)
+    {
+        rotation[column] = node.scale[column] > 0.0f ? glm::vec3(transform[column]) / node.scale[column] : glm::vec3(0.0f);
+    }
+    node.rotation = glm::quat_cast(rotation);
+    out_scene.nodes.push_back(node);
+}
+
+bool EditorWindow::LoadTestFont()
+{
+    m_test_font = std::make_unique<Renderer::CSdfFont>();
+    if (m_test_font->Load(TEST_FONT_FILENAME) == false)
+    {
+        m_test_font = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool EditorWindow::OpenScene()
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Assets);
+
+    Scene::CSceneFile scene_file;
+    if (scene_file.Open(SCENE_FILENAME) == false)
+    {
+        return false;
+    }
+
+    CloseScene();
+
+    Scene::SSceneMeshDesc mesh;
+    for (uint32_t i = 0; i < scene_file.GetMeshCount(); ++i)
+    {
+        Scene::load_scene_mesh(scene_file, i, mesh);
+        m_scene_meshes.push_back(m_render_system->AddMesh(Renderer::CMesh::Create(mesh.positions, mesh.colours, mesh.indices)));
+    }
+
+    // The hierarchy works out each node's world matrix, the hierarchy system copies it into the
+    // node's entity every frame
+    std::vector<Scene::NodeId> node_ids;
+    Scene::load_transform_hierarchy(scene_file, m_hierarchy, node_ids);
+    m_scene_node_ids.assign(node_ids.begin(), node_ids.end());
+
+    for (uint32_t i = 0; i < scene_file.GetNodeCount(); ++i)
+    {
+        Scene::SFileNode const & file_node = scene_file.GetNodes()[i];
+
+        Scene::SSceneNodeDesc node;
+        node.name = scene_file.GetName(file_node);
+        node.parent = file_node.parent;
+        node.mesh = file_node.mesh;
+        m_scene_nodes.push_back(node);
+
+        if (file_node.mesh == Scene::INVALID_FILE_INDEX)
+        {
+            continue;
+        }
+
+        Scene::SNodeComponent node_component;
+        node_component.node = m_scene_node_ids[i];
+        Renderer::SMeshComponent mesh_component;
+        mesh_component.mesh = m_scene_meshes[file_node.mesh];
+        m_scene_entities.push_back(m_world.CreateEntity(Renderer::STransformComponent(), mesh_component, node_component));
+    }
+
+    DEBUG_LOG(std::string("Opened ") + SCENE_FILENAME);
+    return true;
+}
+
+void EditorWindow::CloseScene()
+{
+    for (ECS::SEntity const entity : m_scene_entities)
+    {
+        m_world.DestroyEntity(entity);
+    }
+    m_scene_entities.clear();
+
+    // Destroying a node takes its children with it, so some of these will already be gone
+    for (Scene::NodeId const node : m_scene_node_ids)
+    {
+        if (m_hierarchy.IsValid(node) == true)
+        {
+            m_hierarchy.DestroyNode(node);
+        }
+    }
+    m_scene_node_ids.clear();
+    m_scene_nodes.clear();
+
+    for (uint32_t const mesh : m_scene_meshes)
+    {
+        m_render_system->RemoveMesh(mesh);
+    }
+    m_scene_meshes.clear();
+}
@@ -1,10 +1,26 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "window/window.hpp"
 
-#include "renderer/renderable.hpp"
+#include "audio/audio_manager.hpp"
+#include "audio/sound_buffer.hpp"
+
+#include "ecs/system_scheduler.hpp"
+#include "ecs/world.hpp"
+
+#include "renderer/render_system.hpp"
+#include "renderer/text/sdf_font.hpp"
+#include "renderer/text/text_renderer.hpp"
+#include "renderer/culling/frustum_culler.hpp"
+
+#include "scene/scene_file.hpp"
+#include "scene/transform_hierarchy.hpp"
+
+#include "utility/memory/memory_tracker.hpp"
 
 class EditorWindow : public Window::IWindowFunctions
 {
@@ -17,11 +33,57 @@ public:
     virtual void Render(Renderer::IRenderContext * render_context) override;
 
     virtual bool WindowShouldClose() override;
+    virtual bool NeedsRedraw() override;
 
 private:
+    // Everything open plus the test triangle, ready to save
+    void BuildSceneDesc(Scene::SSceneDesc & out_scene);
+
+    // Replaces whatever scene was open with the saved one, each node with a mesh becoming an
+    // entity placed by the hierarchy
+    bool OpenScene();
+    void CloseScene();
+
+    bool LoadTestFont();
+
     bool m_should_close;
     bool m_display_about;
     bool m_display_imgui_demo;
+    bool m_display_render_stats;
+    bool m_display_memory_stats;
+    bool m_display_audio_stats;
+
+    Renderer::SCullStats m_last_cull_stats;
+    Renderer::SGpuFrameTime m_last_gpu_time;
+    float m_last_resolution_scale;
+
+    // Edited in the stats window, handed to the renderer on the next Render when changed
+    Renderer::SDynamicResolutionSettings m_dynamic_resolution;
+    bool m_dynamic_resolution_changed;
+
+    std::string m_memory_dump_status;
+
+    // The test triangle and the opened scene are entities, drawn by the render system the
+    // scheduler owns. The hierarchy is declared first since the scheduler's systems refer to it.
+    ECS::CWorld m_world;
+    Scene::CTransformHierarchy m_hierarchy;
+    ECS::CSystemScheduler m_systems;
+    Renderer::CRenderSystem * m_render_system;
+    uint32_t m_triangle_mesh;
+    ECS::SEntity m_test_entity;
+
+    // The opened scene's nodes, minus their transforms which live in the hierarchy
+    Memory::tagged_vector<Scene::SSceneNodeDesc, Memory::EMemoryTag::Editor> m_scene_nodes;
+    Memory::tagged_vector<Scene::NodeId, Memory::EMemoryTag::Editor> m_scene_node_ids;
+    Memory::tagged_vector<uint32_t, Memory::EMemoryTag::Editor> m_scene_meshes;
+    Memory::tagged_vector<ECS::SEntity, Memory::EMemoryTag::Editor> m_scene_entities;
+
+    // Loaded the first time the test text is turned on, the text renderer draws from it
+    std::unique_ptr<Renderer::CSdfFont> m_test_font;
+    std::unique_ptr<Renderer::CTextRenderer> m_test_text;
 
-    std::unique_ptr<Renderer::IRenderable> m_test_renderable = nullptr;
+    // Declared before the manager so the device is shut down before the tone it may be playing is freed
+    Audio::SSoundBuffer m_test_tone;
+    Audio::SVoiceHandle m_test_tone_voice;
+    Audio::CAudioManager m_audio_manager;
 };
@@ -1,17 +1,36 @@
 #include "editor_window.hpp"
 #include "window/window.hpp"
+#include "utility/memory/memory_tracker.hpp"
 
 #include <memory>
+#include <string>
 #include <utility>
 
-int main ()
+int main (int argc, char ** argv)
 {
+    // --continuous draws every frame like the game does instead of only when something changed,
+    // to compare what the editor costs sitting idle
+    Window::SRedrawOnDemandSettings redraw_on_demand;
+    redraw_on_demand.enabled = true;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--continuous")
+        {
+            redraw_on_demand.enabled = false;
+        }
+    }
+
+    // Rough budgets for now, warnings only, tune them from the Memory Stats window
+    Memory::set_memory_budget(Memory::EMemoryTag::Renderer, 256 * 1024 * 1024);
+    Memory::set_memory_budget(Memory::EMemoryTag::Editor, 64 * 1024 * 1024);
+
     EditorWindow * editor_window_funcs =  new EditorWindow();
 
     Window::WindowInstance * window_ptr = Window::create_window("OGAT - GOAT Editor",
                                                                 1440,
                                                                 900,
                                                                 std::move(editor_window_funcs));
+    window_ptr->SetRedrawOnDemand(redraw_on_demand);
     int exit_code = window_ptr->Run();
 
     Window::destroy_window(window_ptr);
@@ -1,9 +1,67 @@
 #include "window/window.hpp"
 
-int main ()
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstdlib>
+#include <string>
+
+int main (int argc, char ** argv)
 {
-    Window::WindowInstance * window_ptr = Window::create_window("OGAT - GOAT", 800, 600, nullptr);
-    int exit_code = window_ptr->Run();
+    // --headless renders without a display for --frames frames, --capture <directory> saves
+    // every --capture-interval'th of them (as --raw pixels instead of png if asked). --trace
+    // <file> records everything rendered for goat_replay. --dynamic-resolution <ms> scales the
+    // scene's resolution to keep the GPU time of a frame under the given budget.
+    bool headless = false;
+    std::string render_trace_filename;
+    Renderer::SDynamicResolutionSettings dynamic_resolution;
+    Window::SHeadlessSettings headless_settings;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const argument = argv[i];
+        bool const has_value = i + 1 < argc;
+        if (argument == "--headless")
+        {
+            headless = true;
+        }
+        else if (argument == "--frames" && has_value == true)
+        {
+            headless_settings.frame_count = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (argument == "--capture" && has_value == true)
+        {
+            headless_settings.capture_directory = argv[++i];
+        }
+        else if (argument == "--capture-interval" && has_value == true)
+        {
+            headless_settings.capture_interval = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (argument == "--raw")
+        {
+            headless_settings.capture_format = Renderer::ECaptureFileFormat::Raw;
+        }
+        else if (argument == "--trace" && has_value == true)
+        {
+            render_trace_filename = argv[++i];
+        }
+        else if (argument == "--dynamic-resolution" && has_value == true)
+        {
+            dynamic_resolution.enabled = true;
+            dynamic_resolution.target_milliseconds = std::strtof(argv[++i], nullptr);
+        }
+    }
+
+    int const width = 800;
+    int const height = 600;
+    Window::WindowInstance * window_ptr = Window::create_window("OGAT - GOAT", width, height, nullptr);
+    if (render_trace_filename.empty() == false)
+    {
+        window_ptr->RecordRenderTrace(render_trace_filename);
+    }
+    window_ptr->SetDynamicResolution(dynamic_resolution);
+    // Two units tall around the origin and as wide as the window's aspect
+    float const aspect = static_cast<float>(width) / static_cast<float>(height);
+    window_ptr->SetViewProjection(glm::ortho(-aspect, aspect, -1.0f, 1.0f));
+    int exit_code = headless == true ? window_ptr->RunHeadless(headless_settings) : window_ptr->Run();
 
     Window::destroy_window(window_ptr);
     return exit_code;
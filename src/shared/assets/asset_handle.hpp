@@ -1,2 +1,24 @@
 #pragma once
 
+#include <cinttypes>
+#include <string>
+
+namespace Assets
+{
+    // Identifies an asset wherever it's referenced without needing a registry to hand ids out
+    using AssetId = uint64_t;
+
+    constexpr AssetId INVALID_ASSET_ID = 0;
+
+    // FNV-1a of the path, so the same file always gets the same id
+    inline AssetId make_asset_id(std::string const & path)
+    {
+        AssetId hash = 14695981039346656037ull;
+        for (char const c : path)
+        {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash == INVALID_ASSET_ID ? 1 : hash;
+    }
+}
@@ -0,0 +1,84 @@
+#include "audio_decoder.hpp"
+
+#include "audio/wav_decoder.hpp"
+#include "utility/logging.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+namespace
+{
+    constexpr size_t DECODE_CHUNK_FRAMES = 16384;
+}
+
+Audio::IAudioDecoder::~IAudioDecoder()
+{
+    // This page is intentionally left blank
+}
+
+std::unique_ptr<Audio::IAudioDecoder> Audio::open_audio_decoder(std::string const & filename)
+{
+    std::unique_ptr<std::ifstream> file = std::make_unique<std::ifstream>(filename, std::ios::binary);
+    if (file->is_open() == false)
+    {
+        ERROR_LOG("Failed to open file: " + filename);
+        return nullptr;
+    }
+    return open_audio_decoder(std::move(file), filename);
+}
+
+std::unique_ptr<Audio::IAudioDecoder> Audio::open_audio_decoder(std::unique_ptr<std::istream> stream, std::string const & name)
+{
+    // Each format is recognised from its header, a new decoder gets its own check here
+    if (CWavDecoder::IsWav(*stream) == true)
+    {
+        std::unique_ptr<CWavDecoder> decoder = std::make_unique<CWavDecoder>();
+        if (decoder->Open(std::move(stream)) == false)
+        {
+            ERROR_LOG("Failed to read WAVE file: " + name);
+            return nullptr;
+        }
+        return std::unique_ptr<IAudioDecoder>(std::move(decoder));
+    }
+
+    ERROR_LOG("Unrecognised audio format: " + name);
+    return nullptr;
+}
+
+bool Audio::decode_audio(IAudioDecoder & decoder, SSoundBuffer & out_buffer)
+{
+    if (decoder.GetChannels() == 0 || decoder.GetChannels() > MAX_SOURCE_CHANNELS || decoder.Rewind() == false)
+    {
+        return false;
+    }
+
+    out_buffer.sample_rate = decoder.GetSampleRate();
+    out_buffer.channels = decoder.GetChannels();
+    out_buffer.frame_count = decoder.GetFrameCount();
+    out_buffer.samples.assign(out_buffer.frame_count * out_buffer.channels, 0.0f);
+
+    size_t done = 0;
+    while (done < out_buffer.frame_count)
+    {
+        float * channels[MAX_SOURCE_CHANNELS] = {};
+        for (uint32_t channel = 0; channel < out_buffer.channels; ++channel)
+        {
+            channels[channel] = out_buffer.Channel(channel) + done;
+        }
+
+        size_t const read = decoder.Read(channels, std::min(DECODE_CHUNK_FRAMES, out_buffer.frame_count - done));
+        if (read == 0)
+        {
+            break;
+        }
+        done += read;
+    }
+
+    // A truncated file still plays what it has
+    if (done < out_buffer.frame_count)
+    {
+        DEBUG_LOG("Audio ended early, decoded " + std::to_string(done) + " of " + std::to_string(out_buffer.frame_count) + " frames");
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "audio/sound_buffer.hpp"
+
+#include <cinttypes>
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <string>
+
+namespace Audio
+{
+    // Pulls float PCM out of an encoded source a chunk at a time, so a file never has to be
+    // fully decoded (or even fully read) to be played
+    class IAudioDecoder
+    {
+    public:
+        virtual ~IAudioDecoder();
+
+        virtual uint32_t GetSampleRate() const = 0;
+        virtual uint32_t GetChannels() const = 0;
+        virtual size_t GetFrameCount() const = 0;
+
+        // Decodes up to frame_count frames into one planar pointer per channel, returns how
+        // many were written, zero once the end has been reached
+        virtual size_t Read(float * const * channels, size_t const frame_count) = 0;
+
+        virtual bool Rewind() = 0;
+    };
+
+    // Picks a decoder from the file's header, returns nullptr (after logging) if nothing can read it
+    std::unique_ptr<IAudioDecoder> open_audio_decoder(std::string const & filename);
+    std::unique_ptr<IAudioDecoder> open_audio_decoder(std::unique_ptr<std::istream> stream, std::string const & name);
+
+    // Runs a decoder to the end, for sounds short enough to keep fully in memory
+    bool decode_audio(IAudioDecoder & decoder, SSoundBuffer & out_buffer);
+}
@@ -0,0 +1,80 @@
+#include "audio_kernels.hpp"
+
+#include "utility/cpu_features.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    void mix_ramp_scalar(float * dst, float const * src, size_t const count, float const gain, float const gain_step)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            dst[i] += src[i] * (gain + gain_step * static_cast<float>(i));
+        }
+    }
+
+    void scale_ramp_scalar(float * dst, size_t const count, float const gain, float const gain_step)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            dst[i] *= gain + gain_step * static_cast<float>(i);
+        }
+    }
+
+    float peak_scalar(float const * src, size_t const count)
+    {
+        float peak = 0.0f;
+        for (size_t i = 0; i < count; ++i)
+        {
+            peak = std::max(peak, std::fabs(src[i]));
+        }
+        return peak;
+    }
+
+    void comb_scalar(float * out, float * line_write, float const * in, float const * line_read, size_t const count, float const feedback)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            float const delayed = line_read[i];
+            out[i] += delayed;
+            line_write[i] = in[i] + delayed * feedback;
+        }
+    }
+
+    void allpass_scalar(float * io, float * line_write, float const * line_read, size_t const count, float const feedback)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            float const delayed = line_read[i];
+            float const input = io[i];
+            line_write[i] = input + delayed * feedback;
+            io[i] = delayed - input;
+        }
+    }
+}
+
+Audio::SAudioKernels const & Audio::get_scalar_audio_kernels()
+{
+    static SAudioKernels const table = {
+        &mix_ramp_scalar,
+        &scale_ramp_scalar,
+        &peak_scalar,
+        &comb_scalar,
+        &allpass_scalar
+    };
+    return table;
+}
+
+Audio::SAudioKernels const & Audio::get_audio_kernels()
+{
+    switch (Utility::get_simd_level())
+    {
+        case Utility::ESimdLevel::AVX512:
+        case Utility::ESimdLevel::AVX2: return get_avx2_audio_kernels();
+        case Utility::ESimdLevel::SSE41: return get_sse41_audio_kernels();
+        case Utility::ESimdLevel::Scalar: break;
+    }
+    return get_scalar_audio_kernels();
+}
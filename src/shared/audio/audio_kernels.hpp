@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Audio
+{
+    // Inner loops of the mixer, all over planar float channels
+    struct SAudioKernels
+    {
+        // dst[i] += src[i] * (gain + gain_step * i), the ramp avoids zipper noise on gain changes
+        void (*mix_ramp)(float * dst, float const * src, size_t count, float gain, float gain_step);
+
+        // dst[i] *= gain + gain_step * i
+        void (*scale_ramp)(float * dst, size_t count, float gain, float gain_step);
+
+        // Largest absolute sample
+        float (*peak)(float const * src, size_t count);
+
+        // Feedback comb over a delay line: out[i] += line_read[i], line_write[i] = in[i] + line_read[i] * feedback.
+        // The read and write spans must not overlap, i.e. the delay is at least count frames.
+        void (*comb)(float * out, float * line_write, float const * in, float const * line_read, size_t count, float feedback);
+
+        // Schroeder allpass over a delay line, in place: line_write[i] = io[i] + line_read[i] * feedback,
+        // io[i] = line_read[i] - io[i]. Same overlap rule as comb.
+        void (*allpass)(float * io, float * line_write, float const * line_read, size_t count, float feedback);
+    };
+
+    // Each lives in its own translation unit built with the matching instruction set flags,
+    // on other architectures they hand back the scalar table
+    SAudioKernels const & get_sse41_audio_kernels();
+    SAudioKernels const & get_avx2_audio_kernels();
+    SAudioKernels const & get_scalar_audio_kernels();
+
+    // Picked from Utility::get_simd_level()
+    SAudioKernels const & get_audio_kernels();
+}
@@ -0,0 +1,169 @@
+// Included into an anonymous namespace by each instruction set's translation unit after it has
+// defined its ops struct, see batch_math_simd.inl for the same pattern
+
+// Nothing from the standard library here, its functions are shared weak symbols and the linker
+// may keep this translation unit's copy, built for wider instructions than the CPU might have
+inline float scalar_max(float const a, float const b)
+{
+    return a > b ? a : b;
+}
+
+inline float scalar_abs(float const a)
+{
+    return a < 0.0f ? -a : a;
+}
+
+template <typename Ops>
+void mix_ramp_simd(float * dst, float const * src, size_t const count, float const gain, float const gain_step)
+{
+    using Reg = typename Ops::Reg;
+    constexpr size_t WIDTH = Ops::WIDTH;
+
+    size_t i = 0;
+    if (count >= WIDTH)
+    {
+        float ramp[WIDTH];
+        for (size_t lane = 0; lane < WIDTH; ++lane)
+        {
+            ramp[lane] = gain + gain_step * static_cast<float>(lane);
+        }
+
+        Reg gains = Ops::Load(ramp);
+        Reg const step = Ops::Set1(gain_step * static_cast<float>(WIDTH));
+
+        for (; i + WIDTH <= count; i += WIDTH)
+        {
+            Ops::Store(dst + i, Ops::MulAdd(Ops::Load(src + i), gains, Ops::Load(dst + i)));
+            gains = Ops::Add(gains, step);
+        }
+    }
+
+    for (; i < count; ++i)
+    {
+        dst[i] += src[i] * (gain + gain_step * static_cast<float>(i));
+    }
+}
+
+template <typename Ops>
+void scale_ramp_simd(float * dst, size_t const count, float const gain, float const gain_step)
+{
+    using Reg = typename Ops::Reg;
+    constexpr size_t WIDTH = Ops::WIDTH;
+
+    size_t i = 0;
+    if (count >= WIDTH)
+    {
+        float ramp[WIDTH];
+        for (size_t lane = 0; lane < WIDTH; ++lane)
+        {
+            ramp[lane] = gain + gain_step * static_cast<float>(lane);
+        }
+
+        Reg gains = Ops::Load(ramp);
+        Reg const step = Ops::Set1(gain_step * static_cast<float>(WIDTH));
+
+        for (; i + WIDTH <= count; i += WIDTH)
+        {
+            Ops::Store(dst + i, Ops::Mul(Ops::Load(dst + i), gains));
+            gains = Ops::Add(gains, step);
+        }
+    }
+
+    for (; i < count; ++i)
+    {
+        dst[i] *= gain + gain_step * static_cast<float>(i);
+    }
+}
+
+template <typename Ops>
+float peak_simd(float const * src, size_t const count)
+{
+    using Reg = typename Ops::Reg;
+    constexpr size_t WIDTH = Ops::WIDTH;
+
+    float peak = 0.0f;
+    size_t i = 0;
+    if (count >= WIDTH)
+    {
+        Reg peaks = Ops::Set1(0.0f);
+        for (; i + WIDTH <= count; i += WIDTH)
+        {
+            peaks = Ops::Max(peaks, Ops::Abs(Ops::Load(src + i)));
+        }
+
+        float lanes[WIDTH];
+        Ops::Store(lanes, peaks);
+        for (size_t lane = 0; lane < WIDTH; ++lane)
+        {
+            peak = scalar_max(peak, lanes[lane]);
+        }
+    }
+
+    for (; i < count; ++i)
+    {
+        peak = scalar_max(peak, scalar_abs(src[i]));
+    }
+    return peak;
+}
+
+template <typename Ops>
+void comb_simd(float * out, float * line_write, float const * in, float const * line_read, size_t const count, float const feedback)
+{
+    using Reg = typename Ops::Reg;
+    constexpr size_t WIDTH = Ops::WIDTH;
+
+    Reg const feedbacks = Ops::Set1(feedback);
+
+    size_t i = 0;
+    for (; i + WIDTH <= count; i += WIDTH)
+    {
+        Reg const delayed = Ops::Load(line_read + i);
+        Ops::Store(out + i, Ops::Add(Ops::Load(out + i), delayed));
+        Ops::Store(line_write + i, Ops::MulAdd(delayed, feedbacks, Ops::Load(in + i)));
+    }
+
+    for (; i < count; ++i)
+    {
+        float const delayed = line_read[i];
+        out[i] += delayed;
+        line_write[i] = in[i] + delayed * feedback;
+    }
+}
+
+template <typename Ops>
+void allpass_simd(float * io, float * line_write, float const * line_read, size_t const count, float const feedback)
+{
+    using Reg = typename Ops::Reg;
+    constexpr size_t WIDTH = Ops::WIDTH;
+
+    Reg const feedbacks = Ops::Set1(feedback);
+
+    size_t i = 0;
+    for (; i + WIDTH <= count; i += WIDTH)
+    {
+        Reg const delayed = Ops::Load(line_read + i);
+        Reg const input = Ops::Load(io + i);
+        Ops::Store(line_write + i, Ops::MulAdd(delayed, feedbacks, input));
+        Ops::Store(io + i, Ops::Sub(delayed, input));
+    }
+
+    for (; i < count; ++i)
+    {
+        float const delayed = line_read[i];
+        float const input = io[i];
+        line_write[i] = input + delayed * feedback;
+        io[i] = delayed - input;
+    }
+}
+
+template <typename Ops>
+Audio::SAudioKernels make_audio_kernel_table()
+{
+    Audio::SAudioKernels table;
+    table.mix_ramp = &mix_ramp_simd<Ops>;
+    table.scale_ramp = &scale_ramp_simd<Ops>;
+    table.peak = &peak_simd<Ops>;
+    table.comb = &comb_simd<Ops>;
+    table.allpass = &allpass_simd<Ops>;
+    return table;
+}
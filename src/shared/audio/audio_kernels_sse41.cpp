@@ -0,0 +1,43 @@
+#include "audio/audio_kernels.hpp"
+
+#include "utility/cpu_features.hpp"
+
+#if GOAT_ARCH_X86
+
+#include <smmintrin.h>
+
+namespace
+{
+    struct SSse41Ops
+    {
+        using Reg = __m128;
+        static constexpr size_t WIDTH = 4;
+
+        static Reg Load(float const * ptr) { return _mm_loadu_ps(ptr); }
+        static void Store(float * ptr, Reg const v) { _mm_storeu_ps(ptr, v); }
+        static Reg Set1(float const v) { return _mm_set1_ps(v); }
+        static Reg Add(Reg const a, Reg const b) { return _mm_add_ps(a, b); }
+        static Reg Sub(Reg const a, Reg const b) { return _mm_sub_ps(a, b); }
+        static Reg Mul(Reg const a, Reg const b) { return _mm_mul_ps(a, b); }
+        static Reg MulAdd(Reg const a, Reg const b, Reg const c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+        static Reg Abs(Reg const a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+        static Reg Max(Reg const a, Reg const b) { return _mm_max_ps(a, b); }
+    };
+
+#include "audio/audio_kernels_simd.inl"
+}
+
+Audio::SAudioKernels const & Audio::get_sse41_audio_kernels()
+{
+    static SAudioKernels const table = make_audio_kernel_table<SSse41Ops>();
+    return table;
+}
+
+#else
+
+Audio::SAudioKernels const & Audio::get_sse41_audio_kernels()
+{
+    return get_scalar_audio_kernels();
+}
+
+#endif
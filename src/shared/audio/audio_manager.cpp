@@ -1,4 +1,475 @@
 #include "audio_manager.hpp"
 
+#include "utility/logging.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
 #define SOKOL_AUDIO_IMPL
 #include <sokol_audio.h>
+
+namespace
+{
+    // Weight of the newest callback in the running average
+    constexpr float AVERAGE_WEIGHT = 0.05f;
+}
+
+Audio::CAudioManager::CAudioManager()
+: m_initialised(false)
+, m_sample_rate(0)
+, m_voice_generations(MAX_VOICES, 0)
+, m_voice_in_use(MAX_VOICES, false)
+, m_free_voices()
+, m_dropped_commands(0)
+, m_streams()
+, m_streamer()
+, m_dsp_graphs()
+, m_mixer()
+, m_commands()
+, m_finished_voices()
+, m_callback_ms_last(0.0f)
+, m_callback_ms_average(0.0f)
+, m_callback_ms_peak(0.0f)
+, m_callback_frames(0)
+, m_callback_count(0)
+, m_active_voices(0)
+{
+    // Reversed so the lowest slots get handed out first
+    m_free_voices.reserve(MAX_VOICES);
+    for (uint32_t i = MAX_VOICES; i > 0; --i)
+    {
+        m_free_voices.push_back(i - 1);
+    }
+}
+
+Audio::CAudioManager::~CAudioManager()
+{
+    Shutdown();
+}
+
+bool Audio::CAudioManager::Init(SAudioConfig const & config)
+{
+    if (m_initialised == true)
+    {
+        return true;
+    }
+
+    // sokol only has the one device
+    if (saudio_isvalid() == true)
+    {
+        ERROR_LOG("Audio device already in use by another audio manager");
+        return false;
+    }
+
+    saudio_desc desc = {};
+    desc.sample_rate = static_cast<int>(config.sample_rate);
+    desc.num_channels = static_cast<int>(config.channels);
+    desc.buffer_frames = static_cast<int>(config.buffer_frames);
+    desc.stream_userdata_cb = &CAudioManager::stream_callback;
+    desc.user_data = this;
+    saudio_setup(&desc);
+
+    if (saudio_isvalid() == false)
+    {
+        ERROR_LOG("Failed to initialise the audio device");
+        saudio_shutdown();
+        return false;
+    }
+
+    m_sample_rate = static_cast<uint32_t>(saudio_sample_rate());
+    m_initialised = true;
+
+    m_streamer.Start();
+
+    DEBUG_LOG("Audio device started at " + std::to_string(m_sample_rate) + "Hz, " +
+              std::to_string(saudio_channels()) + " channels, " +
+              std::to_string(saudio_buffer_frames()) + " frames");
+    return true;
+}
+
+void Audio::CAudioManager::Shutdown()
+{
+    if (m_initialised == false)
+    {
+        return;
+    }
+
+    // Stops the callback, nothing touches the mixer after this returns
+    saudio_shutdown();
+    m_streamer.Stop();
+    m_initialised = false;
+
+    // Nothing is consuming the queues now so the game thread can empty them itself
+    SAudioCommand command;
+    while (m_commands.TryPop(command) == true)
+    {
+    }
+    uint32_t voice = 0;
+    while (m_finished_voices.TryPop(voice) == true)
+    {
+    }
+    m_mixer.Reset();
+
+    m_streams.clear();
+    m_dsp_graphs.clear();
+
+    m_free_voices.clear();
+    for (uint32_t i = MAX_VOICES; i > 0; --i)
+    {
+        if (m_voice_in_use[i - 1] == true)
+        {
+            m_voice_in_use[i - 1] = false;
+            ++m_voice_generations[i - 1];
+        }
+        m_free_voices.push_back(i - 1);
+    }
+}
+
+void Audio::CAudioManager::Update()
+{
+    uint32_t voice = 0;
+    while (m_finished_voices.TryPop(voice) == true)
+    {
+        if (m_voice_in_use[voice] == false)
+        {
+            continue;
+        }
+
+        for (auto entry = m_streams.begin(); entry != m_streams.end(); ++entry)
+        {
+            if (entry->voice.index == voice)
+            {
+                entry->voice = INVALID_VOICE;
+                if (entry->closing == true)
+                {
+                    DestroyStream(entry);
+                }
+                break;
+            }
+        }
+
+        m_voice_in_use[voice] = false;
+        ++m_voice_generations[voice];
+        m_free_voices.push_back(voice);
+    }
+}
+
+Audio::SVoiceHandle Audio::CAudioManager::Play(SSoundBuffer const & buffer, SPlayParams const & params)
+{
+    if (m_initialised == false)
+    {
+        return INVALID_VOICE;
+    }
+
+    if (buffer.sample_rate != m_sample_rate)
+    {
+        ERROR_LOG("Sound is " + std::to_string(buffer.sample_rate) + "Hz but the device runs at " +
+                  std::to_string(m_sample_rate) + "Hz");
+        return INVALID_VOICE;
+    }
+
+    if (buffer.channels == 0 || buffer.channels > MAX_SOURCE_CHANNELS)
+    {
+        ERROR_LOG("Unsupported channel count: " + std::to_string(buffer.channels));
+        return INVALID_VOICE;
+    }
+
+    SAudioCommand command;
+    command.type = EAudioCommand::Play;
+    command.buffer = &buffer;
+    command.params = params;
+    return StartVoice(command);
+}
+
+void Audio::CAudioManager::Stop(SVoiceHandle const voice)
+{
+    if (IsPlaying(voice) == true)
+    {
+        SAudioCommand command;
+        command.type = EAudioCommand::Stop;
+        command.voice = voice.index;
+        PushCommand(command);
+    }
+}
+
+bool Audio::CAudioManager::IsPlaying(SVoiceHandle const voice) const
+{
+    return voice.index < MAX_VOICES &&
+           m_voice_in_use[voice.index] == true &&
+           m_voice_generations[voice.index] == voice.generation;
+}
+
+void Audio::CAudioManager::SetVolume(SVoiceHandle const voice, float const volume)
+{
+    if (IsPlaying(voice) == true)
+    {
+        SAudioCommand command;
+        command.type = EAudioCommand::SetVolume;
+        command.voice = voice.index;
+        command.value = volume;
+        PushCommand(command);
+    }
+}
+
+void Audio::CAudioManager::SetPan(SVoiceHandle const voice, float const pan)
+{
+    if (IsPlaying(voice) == true)
+    {
+        SAudioCommand command;
+        command.type = EAudioCommand::SetPan;
+        command.voice = voice.index;
+        command.value = pan;
+        PushCommand(command);
+    }
+}
+
+void Audio::CAudioManager::SetMasterVolume(float const volume)
+{
+    SAudioCommand command;
+    command.type = EAudioCommand::SetMasterVolume;
+    command.value = volume;
+    PushCommand(command);
+}
+
+bool Audio::CAudioManager::SetDspGraph(std::unique_ptr<CDspGraph> graph)
+{
+    if (m_initialised == false)
+    {
+        return false;
+    }
+
+    if (graph != nullptr && graph->Compile(m_sample_rate) == false)
+    {
+        return false;
+    }
+
+    SAudioCommand command;
+    command.type = EAudioCommand::SetGraph;
+    command.graph = graph.get();
+    if (PushCommand(command) == false)
+    {
+        return false;
+    }
+
+    if (graph != nullptr)
+    {
+        m_dsp_graphs.push_back(std::move(graph));
+    }
+    return true;
+}
+
+void Audio::CAudioManager::SetBusGain(uint32_t const bus, float const gain)
+{
+    SAudioCommand command;
+    command.type = EAudioCommand::SetBusGain;
+    command.bus = bus;
+    command.value = gain;
+    PushCommand(command);
+}
+
+void Audio::CAudioManager::SetEffectParameter(uint32_t const bus, uint32_t const effect, uint32_t const parameter, float const value)
+{
+    SAudioCommand command;
+    command.type = EAudioCommand::SetEffectParameter;
+    command.bus = bus;
+    command.effect = effect;
+    command.parameter = parameter;
+    command.value = value;
+    PushCommand(command);
+}
+
+Audio::CAudioStream * Audio::CAudioManager::OpenStream(std::string const & filename, bool const looping)
+{
+    if (m_initialised == false)
+    {
+        return nullptr;
+    }
+
+    std::unique_ptr<IAudioDecoder> decoder = open_audio_decoder(filename);
+    if (decoder == nullptr)
+    {
+        return nullptr;
+    }
+
+    if (decoder->GetSampleRate() != m_sample_rate)
+    {
+        ERROR_LOG(filename + " is " + std::to_string(decoder->GetSampleRate()) + "Hz but the device runs at " +
+                  std::to_string(m_sample_rate) + "Hz");
+        return nullptr;
+    }
+
+    SStreamEntry entry;
+    entry.stream = std::make_unique<CAudioStream>(std::move(decoder), looping);
+
+    // Filled here first so playback doesn't start with an underrun
+    entry.stream->Fill();
+
+    CAudioStream * stream = entry.stream.get();
+    m_streams.push_back(std::move(entry));
+    m_streamer.AddStream(stream);
+    return stream;
+}
+
+Audio::SVoiceHandle Audio::CAudioManager::PlayStream(CAudioStream * stream, SPlayParams const & params)
+{
+    auto entry = FindStream(stream);
+    if (entry == m_streams.end() || entry->closing == true)
+    {
+        ERROR_LOG("Playing a stream that isn't open");
+        return INVALID_VOICE;
+    }
+
+    if (entry->played == true)
+    {
+        ERROR_LOG("Streams can only be played once, open it again instead");
+        return INVALID_VOICE;
+    }
+
+    SAudioCommand command;
+    command.type = EAudioCommand::Play;
+    command.stream = stream;
+    command.params = params;
+
+    SVoiceHandle const voice = StartVoice(command);
+    if (voice != INVALID_VOICE)
+    {
+        entry->voice = voice;
+        entry->played = true;
+    }
+    return voice;
+}
+
+void Audio::CAudioManager::CloseStream(CAudioStream * stream)
+{
+    auto entry = FindStream(stream);
+    if (entry == m_streams.end())
+    {
+        return;
+    }
+
+    if (IsPlaying(entry->voice) == true)
+    {
+        // Freed in Update once the mixer reports the voice finished
+        Stop(entry->voice);
+        entry->closing = true;
+        return;
+    }
+
+    DestroyStream(entry);
+}
+
+Audio::SAudioStats Audio::CAudioManager::GetStats() const
+{
+    SAudioStats stats;
+    stats.callback_ms_last = m_callback_ms_last.load(std::memory_order_relaxed);
+    stats.callback_ms_average = m_callback_ms_average.load(std::memory_order_relaxed);
+    stats.callback_ms_peak = m_callback_ms_peak.load(std::memory_order_relaxed);
+    if (m_sample_rate > 0)
+    {
+        stats.callback_budget_ms = static_cast<float>(m_callback_frames.load(std::memory_order_relaxed)) * 1000.0f / static_cast<float>(m_sample_rate);
+    }
+    stats.callback_count = m_callback_count.load(std::memory_order_relaxed);
+    stats.active_voices = m_active_voices.load(std::memory_order_relaxed);
+    stats.dropped_commands = m_dropped_commands;
+
+    stats.open_streams = static_cast<uint32_t>(m_streams.size());
+    for (SStreamEntry const & entry : m_streams)
+    {
+        stats.stream_underruns += entry.stream->GetUnderrunCount();
+        stats.stream_resident_bytes += entry.stream->GetResidentBytes();
+    }
+    return stats;
+}
+
+void Audio::CAudioManager::ResetPeakStats()
+{
+    m_callback_ms_peak.store(0.0f, std::memory_order_relaxed);
+}
+
+void Audio::CAudioManager::stream_callback(float * buffer, int num_frames, int num_channels, void * user_data)
+{
+    static_cast<CAudioManager *>(user_data)->MixCallback(buffer, static_cast<size_t>(num_frames), static_cast<uint32_t>(num_channels));
+}
+
+void Audio::CAudioManager::MixCallback(float * buffer, size_t const frames, uint32_t const channels)
+{
+    auto const start = std::chrono::steady_clock::now();
+
+    SAudioCommand command;
+    while (m_commands.TryPop(command) == true)
+    {
+        m_mixer.ApplyCommand(command);
+    }
+
+    m_mixer.Mix(buffer, frames, channels);
+
+    // A slot is only reused after the game thread has seen it here, so this can never fill up
+    uint32_t const * finished = m_mixer.GetFinishedVoices();
+    for (uint32_t i = 0; i < m_mixer.GetFinishedVoiceCount(); ++i)
+    {
+        m_finished_voices.TryPush(finished[i]);
+    }
+    m_mixer.ClearFinishedVoices();
+
+    auto const end = std::chrono::steady_clock::now();
+    float const elapsed_ms = std::chrono::duration<float, std::milli>(end - start).count();
+
+    uint64_t const count = m_callback_count.fetch_add(1, std::memory_order_relaxed);
+    float const average = m_callback_ms_average.load(std::memory_order_relaxed);
+
+    m_callback_ms_last.store(elapsed_ms, std::memory_order_relaxed);
+    m_callback_ms_average.store(count == 0 ? elapsed_ms : average + (elapsed_ms - average) * AVERAGE_WEIGHT, std::memory_order_relaxed);
+    m_callback_ms_peak.store(std::max(m_callback_ms_peak.load(std::memory_order_relaxed), elapsed_ms), std::memory_order_relaxed);
+    m_callback_frames.store(static_cast<uint32_t>(frames), std::memory_order_relaxed);
+    m_active_voices.store(m_mixer.GetActiveVoiceCount(), std::memory_order_relaxed);
+}
+
+Audio::SVoiceHandle Audio::CAudioManager::StartVoice(SAudioCommand & command)
+{
+    if (m_free_voices.empty() == true)
+    {
+        ERROR_LOG("Out of voices");
+        return INVALID_VOICE;
+    }
+
+    uint32_t const index = m_free_voices.back();
+
+    command.voice = index;
+    if (PushCommand(command) == false)
+    {
+        return INVALID_VOICE;
+    }
+
+    m_free_voices.pop_back();
+    m_voice_in_use[index] = true;
+
+    SVoiceHandle handle;
+    handle.index = index;
+    handle.generation = m_voice_generations[index];
+    return handle;
+}
+
+std::vector<Audio::CAudioManager::SStreamEntry>::iterator Audio::CAudioManager::FindStream(CAudioStream const * stream)
+{
+    return std::find_if(m_streams.begin(), m_streams.end(), [stream](SStreamEntry const & entry)
+    {
+        return entry.stream.get() == stream;
+    });
+}
+
+void Audio::CAudioManager::DestroyStream(std::vector<SStreamEntry>::iterator entry)
+{
+    m_streamer.RemoveStream(entry->stream.get());
+    m_streams.erase(entry);
+}
+
+bool Audio::CAudioManager::PushCommand(SAudioCommand const & command)
+{
+    if (m_commands.TryPush(command) == false)
+    {
+        ++m_dropped_commands;
+        return false;
+    }
+    return true;
+}
@@ -1,5 +1,147 @@
 #pragma once
 
+#include "audio/audio_stream.hpp"
+#include "audio/dsp_graph.hpp"
+#include "audio/sound_buffer.hpp"
+#include "audio/voice_mixer.hpp"
+#include "utility/spsc_queue.hpp"
+
+#include <atomic>
+#include <cinttypes>
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace Audio
 {
+    struct SVoiceHandle
+    {
+        uint32_t index = UINT32_MAX;
+        uint32_t generation = 0;
+
+        bool operator==(SVoiceHandle const & rhs) const { return index == rhs.index && generation == rhs.generation; }
+        bool operator!=(SVoiceHandle const & rhs) const { return !(*this == rhs); }
+    };
+
+    constexpr SVoiceHandle INVALID_VOICE = SVoiceHandle();
+
+    struct SAudioConfig
+    {
+        uint32_t sample_rate = 44100;
+        uint32_t channels = 2;
+        // Zero lets sokol pick
+        uint32_t buffer_frames = 0;
+    };
+
+    struct SAudioStats
+    {
+        // Time spent inside the device callback, against the time the callback's buffer lasts
+        float callback_ms_last = 0.0f;
+        float callback_ms_average = 0.0f;
+        float callback_ms_peak = 0.0f;
+        float callback_budget_ms = 0.0f;
+        uint64_t callback_count = 0;
+
+        uint32_t active_voices = 0;
+        uint32_t dropped_commands = 0;
+
+        uint32_t open_streams = 0;
+        uint32_t stream_underruns = 0;
+        size_t stream_resident_bytes = 0;
+    };
+
+    // Owns the sokol audio device. The game thread calls everything public, the mixing happens
+    // in the device callback, and the only link between the two is a pair of wait-free queues
+    // (commands in, finished voices out) so the callback never locks or allocates.
+    class CAudioManager
+    {
+    public:
+        CAudioManager();
+        ~CAudioManager();
+
+        CAudioManager(CAudioManager const &) = delete;
+        CAudioManager & operator=(CAudioManager const &) = delete;
+
+        bool Init(SAudioConfig const & config = SAudioConfig());
+        void Shutdown();
+
+        bool IsInitialised() const { return m_initialised; }
+        uint32_t GetSampleRate() const { return m_sample_rate; }
+
+        // Call once per frame, reclaims the slots of voices that have finished
+        void Update();
+
+        // The buffer has to outlive the voice, i.e. until IsPlaying is false after an Update
+        SVoiceHandle Play(SSoundBuffer const & buffer, SPlayParams const & params = SPlayParams());
+        void Stop(SVoiceHandle const voice);
+        bool IsPlaying(SVoiceHandle const voice) const;
+
+        void SetVolume(SVoiceHandle const voice, float const volume);
+        void SetPan(SVoiceHandle const voice, float const pan);
+        void SetMasterVolume(float const volume);
+
+        // Long sounds are decoded a block at a time on the streaming thread while they play. The
+        // manager owns the stream, which can be played once and stays valid until it is closed.
+        // Looping is decided here rather than by the play params.
+        CAudioStream * OpenStream(std::string const & filename, bool const looping = false);
+        SVoiceHandle PlayStream(CAudioStream * stream, SPlayParams const & params = SPlayParams());
+        // Stops it if it's playing, the memory goes once the mixer has let go of it
+        void CloseStream(CAudioStream * stream);
+
+        // Routes the voices through a graph of effect buses, compiling it for the device's rate.
+        // A graph that gets replaced is kept until Shutdown as the audio thread may still be in it.
+        bool SetDspGraph(std::unique_ptr<CDspGraph> graph);
+        void SetBusGain(uint32_t const bus, float const gain);
+        void SetEffectParameter(uint32_t const bus, uint32_t const effect, uint32_t const parameter, float const value);
+
+        uint32_t GetPlayingVoiceCount() const { return MAX_VOICES - static_cast<uint32_t>(m_free_voices.size()); }
+
+        SAudioStats GetStats() const;
+        void ResetPeakStats();
+
+    private:
+        static void stream_callback(float * buffer, int num_frames, int num_channels, void * user_data);
+        void MixCallback(float * buffer, size_t const frames, uint32_t const channels);
+
+        bool PushCommand(SAudioCommand const & command);
+        SVoiceHandle StartVoice(SAudioCommand & command);
+
+        struct SStreamEntry
+        {
+            std::unique_ptr<CAudioStream> stream;
+            SVoiceHandle voice;
+            bool played = false;
+            bool closing = false;
+        };
+
+        std::vector<SStreamEntry>::iterator FindStream(CAudioStream const * stream);
+        void DestroyStream(std::vector<SStreamEntry>::iterator entry);
+
+        bool m_initialised;
+        uint32_t m_sample_rate;
+
+        // Game thread side of the voice slots
+        std::vector<uint32_t> m_voice_generations;
+        std::vector<bool> m_voice_in_use;
+        std::vector<uint32_t> m_free_voices;
+        uint32_t m_dropped_commands;
+
+        std::vector<SStreamEntry> m_streams;
+        CAudioStreamer m_streamer;
+
+        std::vector<std::unique_ptr<CDspGraph>> m_dsp_graphs;
+
+        // Audio thread side
+        CVoiceMixer m_mixer;
+
+        Utility::CSpscQueue<SAudioCommand, 4096> m_commands;
+        Utility::CSpscQueue<uint32_t, MAX_VOICES> m_finished_voices;
+
+        std::atomic<float> m_callback_ms_last;
+        std::atomic<float> m_callback_ms_average;
+        std::atomic<float> m_callback_ms_peak;
+        std::atomic<uint32_t> m_callback_frames;
+        std::atomic<uint64_t> m_callback_count;
+        std::atomic<uint32_t> m_active_voices;
+    };
 }
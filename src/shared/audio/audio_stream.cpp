@@ -0,0 +1,201 @@
+#include "audio_stream.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+    // Well inside the length of a block so a refill is always ready long before it's needed
+    constexpr std::chrono::milliseconds STREAMER_POLL_INTERVAL(20);
+}
+
+Audio::CAudioStream::CAudioStream(std::unique_ptr<IAudioDecoder> decoder, bool const looping)
+: m_decoder(std::move(decoder))
+, m_sample_rate(m_decoder->GetSampleRate())
+, m_channels(m_decoder->GetChannels())
+, m_looping(looping)
+, m_blocks()
+, m_write_block(0)
+, m_decoder_finished(false)
+, m_read_block(0)
+, m_read_cursor(0)
+, m_finished(false)
+, m_underruns(0)
+{
+    for (SBlock & block : m_blocks)
+    {
+        block.state.store(BLOCK_FREE, std::memory_order_relaxed);
+        block.samples.resize(STREAM_BLOCK_FRAMES * m_channels);
+    }
+}
+
+size_t Audio::CAudioStream::GetResidentBytes() const
+{
+    return sizeof(*this) + (m_blocks[0].samples.size() + m_blocks[1].samples.size()) * sizeof(float);
+}
+
+void Audio::CAudioStream::Fill()
+{
+    while (m_decoder_finished == false)
+    {
+        SBlock & block = m_blocks[m_write_block];
+        if (block.state.load(std::memory_order_acquire) != BLOCK_FREE)
+        {
+            return;
+        }
+
+        size_t filled = 0;
+        bool just_rewound = false;
+        while (filled < STREAM_BLOCK_FRAMES)
+        {
+            float * channels[MAX_SOURCE_CHANNELS] = {};
+            for (uint32_t channel = 0; channel < m_channels; ++channel)
+            {
+                channels[channel] = block.samples.data() + channel * STREAM_BLOCK_FRAMES + filled;
+            }
+
+            size_t const read = m_decoder->Read(channels, STREAM_BLOCK_FRAMES - filled);
+            if (read > 0)
+            {
+                filled += read;
+                just_rewound = false;
+                continue;
+            }
+
+            // Nothing straight after a rewind means there's nothing to loop
+            if (m_looping == true && just_rewound == false && m_decoder->Rewind() == true)
+            {
+                just_rewound = true;
+                continue;
+            }
+
+            m_decoder_finished = true;
+            break;
+        }
+
+        block.frame_count = filled;
+        block.end_of_stream = m_decoder_finished;
+        block.state.store(BLOCK_READY, std::memory_order_release);
+
+        m_write_block ^= 1;
+    }
+}
+
+size_t Audio::CAudioStream::Acquire(float const ** channels, size_t const max_frames)
+{
+    while (m_finished == false)
+    {
+        SBlock const & block = m_blocks[m_read_block];
+        if (block.state.load(std::memory_order_acquire) != BLOCK_READY)
+        {
+            return 0;
+        }
+
+        if (m_read_cursor < block.frame_count)
+        {
+            for (uint32_t channel = 0; channel < m_channels; ++channel)
+            {
+                channels[channel] = block.samples.data() + channel * STREAM_BLOCK_FRAMES + m_read_cursor;
+            }
+            return std::min(max_frames, block.frame_count - m_read_cursor);
+        }
+
+        // Only an empty final block gets here
+        ReleaseBlock();
+    }
+    return 0;
+}
+
+void Audio::CAudioStream::Release(size_t const frames)
+{
+    m_read_cursor += frames;
+    if (m_read_cursor >= m_blocks[m_read_block].frame_count)
+    {
+        ReleaseBlock();
+    }
+}
+
+void Audio::CAudioStream::ReleaseBlock()
+{
+    SBlock & block = m_blocks[m_read_block];
+    bool const end_of_stream = block.end_of_stream;
+
+    block.state.store(BLOCK_FREE, std::memory_order_release);
+    m_read_block ^= 1;
+    m_read_cursor = 0;
+
+    if (end_of_stream == true)
+    {
+        m_finished = true;
+    }
+}
+
+Audio::CAudioStreamer::CAudioStreamer()
+: m_thread()
+, m_mutex()
+, m_wake()
+, m_streams()
+, m_running(false)
+{
+}
+
+Audio::CAudioStreamer::~CAudioStreamer()
+{
+    Stop();
+}
+
+void Audio::CAudioStreamer::Start()
+{
+    if (m_thread.joinable() == true)
+    {
+        return;
+    }
+
+    m_running = true;
+    m_thread = std::thread(&CAudioStreamer::ThreadMain, this);
+}
+
+void Audio::CAudioStreamer::Stop()
+{
+    if (m_thread.joinable() == false)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+void Audio::CAudioStreamer::AddStream(CAudioStream * stream)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_streams.push_back(stream);
+    }
+    m_wake.notify_one();
+}
+
+void Audio::CAudioStreamer::RemoveStream(CAudioStream * stream)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_streams.erase(std::remove(m_streams.begin(), m_streams.end(), stream), m_streams.end());
+}
+
+void Audio::CAudioStreamer::ThreadMain()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_running == true)
+    {
+        // Decoding happens under the lock so a stream can't be removed (and deleted) mid fill
+        for (CAudioStream * stream : m_streams)
+        {
+            stream->Fill();
+        }
+
+        m_wake.wait_for(lock, STREAMER_POLL_INTERVAL);
+    }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "audio/audio_decoder.hpp"
+
+#include <atomic>
+#include <cinttypes>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Audio
+{
+    // Roughly 0.19s at 44.1kHz, so a stereo stream keeps 128KB of PCM resident
+    constexpr size_t STREAM_BLOCK_FRAMES = 8192;
+
+    // A long sound decoded a block at a time on the streaming thread into two PCM blocks that
+    // the mixer plays from while the other one refills. Each block is handed between the two
+    // threads with an atomic state, so neither side ever waits on the other; if the mixer gets
+    // to a block before it's ready it plays silence and counts an underrun.
+    class CAudioStream
+    {
+    public:
+        CAudioStream(std::unique_ptr<IAudioDecoder> decoder, bool const looping);
+
+        CAudioStream(CAudioStream const &) = delete;
+        CAudioStream & operator=(CAudioStream const &) = delete;
+
+        uint32_t GetSampleRate() const { return m_sample_rate; }
+        uint32_t GetChannels() const { return m_channels; }
+        size_t GetResidentBytes() const;
+
+        // Streaming thread, decodes into every block the mixer has handed back
+        void Fill();
+
+        // Audio thread, points at the next readable frames (one pointer per channel) and returns
+        // how many there are up to max_frames, zero if starved or finished
+        size_t Acquire(float const ** channels, size_t const max_frames);
+        void Release(size_t const frames);
+
+        // Audio thread, true once every decoded frame has been played
+        bool IsFinished() const { return m_finished; }
+
+        void AddUnderrun() { m_underruns.fetch_add(1, std::memory_order_relaxed); }
+        uint32_t GetUnderrunCount() const { return m_underruns.load(std::memory_order_relaxed); }
+
+    private:
+        enum EBlockState : uint32_t
+        {
+            BLOCK_FREE,
+            BLOCK_READY
+        };
+
+        struct SBlock
+        {
+            std::atomic<uint32_t> state;
+            size_t frame_count = 0;
+            bool end_of_stream = false;
+            std::vector<float> samples;
+        };
+
+        void ReleaseBlock();
+
+        std::unique_ptr<IAudioDecoder> m_decoder;
+        uint32_t m_sample_rate;
+        uint32_t m_channels;
+        bool m_looping;
+
+        SBlock m_blocks[2];
+
+        // Streaming thread side
+        uint32_t m_write_block;
+        bool m_decoder_finished;
+
+        // Audio thread side
+        uint32_t m_read_block;
+        size_t m_read_cursor;
+        bool m_finished;
+
+        std::atomic<uint32_t> m_underruns;
+    };
+
+    // One background thread filling every open stream
+    class CAudioStreamer
+    {
+    public:
+        CAudioStreamer();
+        ~CAudioStreamer();
+
+        CAudioStreamer(CAudioStreamer const &) = delete;
+        CAudioStreamer & operator=(CAudioStreamer const &) = delete;
+
+        void Start();
+        void Stop();
+
+        // Game thread, a removed stream is never touched by the streaming thread again
+        void AddStream(CAudioStream * stream);
+        void RemoveStream(CAudioStream * stream);
+
+    private:
+        void ThreadMain();
+
+        std::thread m_thread;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::vector<CAudioStream *> m_streams;
+        bool m_running;
+    };
+}
@@ -0,0 +1,372 @@
+#include "dsp_effects.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    constexpr float TWO_PI = 6.28318530718f;
+
+    // Compressor level detection and gain changes happen this often, about 0.7ms at 44.1kHz
+    constexpr size_t COMPRESSOR_SUB_BLOCK_FRAMES = 32;
+
+    // Freeverb's tunings at 44.1kHz, scaled to the actual rate in Prepare
+    constexpr size_t REVERB_COMB_TUNINGS[Audio::CReverb::COMB_COUNT] = { 1116, 1188, 1277, 1356 };
+    constexpr size_t REVERB_ALLPASS_TUNINGS[Audio::CReverb::ALLPASS_COUNT] = { 556, 441 };
+    constexpr size_t REVERB_STEREO_SPREAD = 23;
+    constexpr float REVERB_INPUT_GAIN = 0.015f;
+    constexpr float REVERB_ALLPASS_FEEDBACK = 0.5f;
+
+    float db_to_gain(float const db)
+    {
+        return std::pow(10.0f, db * 0.05f);
+    }
+
+    float gain_to_db(float const gain)
+    {
+        return 20.0f * std::log10(std::max(gain, 1.0e-6f));
+    }
+
+    // One pole smoothing coefficient for a time constant, per step of frames
+    float time_coefficient(float const time_ms, float const sample_rate, size_t const frames)
+    {
+        float const time_frames = std::max(time_ms, 0.01f) * 0.001f * sample_rate;
+        return std::exp(-static_cast<float>(frames) / time_frames);
+    }
+}
+
+Audio::IDspEffect::~IDspEffect()
+{
+    // This page is intentionally left blank
+}
+
+Audio::CDelayLine::CDelayLine()
+: m_samples()
+, m_write(0)
+{
+}
+
+void Audio::CDelayLine::Resize(size_t const max_delay_frames)
+{
+    // Room for a whole block past the longest delay so the spans never overlap
+    m_samples.assign(std::max(max_delay_frames, MIX_BLOCK_FRAMES) + MIX_BLOCK_FRAMES, 0.0f);
+    m_write = 0;
+}
+
+Audio::CBiquadFilter::CBiquadFilter(EBiquadType const type, float const frequency, float const q, float const gain_db)
+: m_type(type)
+, m_frequency(frequency)
+, m_q(q)
+, m_gain_db(gain_db)
+, m_sample_rate(44100.0f)
+, m_b0(1.0f)
+, m_b1(0.0f)
+, m_b2(0.0f)
+, m_a1(0.0f)
+, m_a2(0.0f)
+, m_z1()
+, m_z2()
+{
+    UpdateCoefficients();
+}
+
+void Audio::CBiquadFilter::Prepare(uint32_t const sample_rate)
+{
+    m_sample_rate = static_cast<float>(sample_rate);
+    m_z1[0] = m_z1[1] = 0.0f;
+    m_z2[0] = m_z2[1] = 0.0f;
+    UpdateCoefficients();
+}
+
+void Audio::CBiquadFilter::Process(SAudioKernels const &, float * const * channels, size_t const frames)
+{
+    // Every output depends on the previous one so this can't go wide within a channel
+    for (uint32_t channel = 0; channel < 2; ++channel)
+    {
+        float * samples = channels[channel];
+        float z1 = m_z1[channel];
+        float z2 = m_z2[channel];
+
+        for (size_t i = 0; i < frames; ++i)
+        {
+            float const input = samples[i];
+            float const output = m_b0 * input + z1;
+            z1 = m_b1 * input - m_a1 * output + z2;
+            z2 = m_b2 * input - m_a2 * output;
+            samples[i] = output;
+        }
+
+        m_z1[channel] = z1;
+        m_z2[channel] = z2;
+    }
+}
+
+void Audio::CBiquadFilter::SetParameter(uint32_t const parameter, float const value)
+{
+    switch (static_cast<EParameter>(parameter))
+    {
+        case EParameter::Frequency: m_frequency = value; break;
+        case EParameter::Q: m_q = value; break;
+        case EParameter::GainDb: m_gain_db = value; break;
+    }
+    UpdateCoefficients();
+}
+
+void Audio::CBiquadFilter::UpdateCoefficients()
+{
+    float const frequency = std::min(std::max(m_frequency, 10.0f), m_sample_rate * 0.49f);
+    float const omega = TWO_PI * frequency / m_sample_rate;
+    float const cos_omega = std::cos(omega);
+    float const alpha = std::sin(omega) / (2.0f * std::max(m_q, 0.01f));
+
+    float b0 = 1.0f;
+    float b1 = 0.0f;
+    float b2 = 0.0f;
+    float a0 = 1.0f;
+    float a1 = 0.0f;
+    float a2 = 0.0f;
+
+    switch (m_type)
+    {
+        case EBiquadType::LowPass:
+            b0 = (1.0f - cos_omega) * 0.5f;
+            b1 = 1.0f - cos_omega;
+            b2 = b0;
+            a0 = 1.0f + alpha;
+            a1 = -2.0f * cos_omega;
+            a2 = 1.0f - alpha;
+            break;
+        case EBiquadType::HighPass:
+            b0 = (1.0f + cos_omega) * 0.5f;
+            b1 = -(1.0f + cos_omega);
+            b2 = b0;
+            a0 = 1.0f + alpha;
+            a1 = -2.0f * cos_omega;
+            a2 = 1.0f - alpha;
+            break;
+        case EBiquadType::BandPass:
+            b0 = alpha;
+            b1 = 0.0f;
+            b2 = -alpha;
+            a0 = 1.0f + alpha;
+            a1 = -2.0f * cos_omega;
+            a2 = 1.0f - alpha;
+            break;
+        case EBiquadType::Peak:
+        {
+            float const amplitude = std::pow(10.0f, m_gain_db / 40.0f);
+            b0 = 1.0f + alpha * amplitude;
+            b1 = -2.0f * cos_omega;
+            b2 = 1.0f - alpha * amplitude;
+            a0 = 1.0f + alpha / amplitude;
+            a1 = -2.0f * cos_omega;
+            a2 = 1.0f - alpha / amplitude;
+            break;
+        }
+    }
+
+    float const inv_a0 = 1.0f / a0;
+    m_b0 = b0 * inv_a0;
+    m_b1 = b1 * inv_a0;
+    m_b2 = b2 * inv_a0;
+    m_a1 = a1 * inv_a0;
+    m_a2 = a2 * inv_a0;
+}
+
+Audio::CCompressor::CCompressor(float const threshold_db, float const ratio, float const attack_ms, float const release_ms, float const makeup_db)
+: m_threshold_db(threshold_db)
+, m_ratio(ratio)
+, m_attack_ms(attack_ms)
+, m_release_ms(release_ms)
+, m_makeup_db(makeup_db)
+, m_sample_rate(44100.0f)
+, m_attack_coefficient(0.0f)
+, m_release_coefficient(0.0f)
+, m_envelope_db(-120.0f)
+, m_gain(1.0f)
+{
+    UpdateCoefficients();
+}
+
+void Audio::CCompressor::Prepare(uint32_t const sample_rate)
+{
+    m_sample_rate = static_cast<float>(sample_rate);
+    m_envelope_db = -120.0f;
+    m_gain = db_to_gain(m_makeup_db);
+    UpdateCoefficients();
+}
+
+void Audio::CCompressor::Process(SAudioKernels const & kernels, float * const * channels, size_t const frames)
+{
+    float const slope = 1.0f - 1.0f / std::max(m_ratio, 1.0f);
+
+    size_t done = 0;
+    while (done < frames)
+    {
+        size_t const count = std::min(frames - done, COMPRESSOR_SUB_BLOCK_FRAMES);
+
+        float const peak = std::max(kernels.peak(channels[0] + done, count), kernels.peak(channels[1] + done, count));
+        float const level_db = gain_to_db(peak);
+
+        float const coefficient = level_db > m_envelope_db ? m_attack_coefficient : m_release_coefficient;
+        m_envelope_db = level_db + (m_envelope_db - level_db) * coefficient;
+
+        float const over_db = std::max(m_envelope_db - m_threshold_db, 0.0f);
+        float const target_gain = db_to_gain(m_makeup_db - over_db * slope);
+        float const gain_step = (target_gain - m_gain) / static_cast<float>(count);
+
+        kernels.scale_ramp(channels[0] + done, count, m_gain, gain_step);
+        kernels.scale_ramp(channels[1] + done, count, m_gain, gain_step);
+
+        m_gain = target_gain;
+        done += count;
+    }
+}
+
+void Audio::CCompressor::SetParameter(uint32_t const parameter, float const value)
+{
+    switch (static_cast<EParameter>(parameter))
+    {
+        case EParameter::ThresholdDb: m_threshold_db = value; break;
+        case EParameter::Ratio: m_ratio = value; break;
+        case EParameter::AttackMs: m_attack_ms = value; break;
+        case EParameter::ReleaseMs: m_release_ms = value; break;
+        case EParameter::MakeupDb: m_makeup_db = value; break;
+    }
+    UpdateCoefficients();
+}
+
+void Audio::CCompressor::UpdateCoefficients()
+{
+    m_attack_coefficient = time_coefficient(m_attack_ms, m_sample_rate, COMPRESSOR_SUB_BLOCK_FRAMES);
+    m_release_coefficient = time_coefficient(m_release_ms, m_sample_rate, COMPRESSOR_SUB_BLOCK_FRAMES);
+}
+
+Audio::CDelay::CDelay(float const time_ms, float const feedback, float const mix, float const max_time_ms)
+: m_time_ms(time_ms)
+, m_feedback(feedback)
+, m_mix(mix)
+, m_max_time_ms(max_time_ms)
+, m_sample_rate(44100.0f)
+, m_lines()
+, m_wet()
+{
+}
+
+void Audio::CDelay::Prepare(uint32_t const sample_rate)
+{
+    m_sample_rate = static_cast<float>(sample_rate);
+
+    size_t const max_frames = static_cast<size_t>(m_max_time_ms * 0.001f * m_sample_rate);
+    m_lines[0].Resize(max_frames);
+    m_lines[1].Resize(max_frames);
+}
+
+void Audio::CDelay::Process(SAudioKernels const & kernels, float * const * channels, size_t const frames)
+{
+    size_t const max_frames = static_cast<size_t>(m_max_time_ms * 0.001f * m_sample_rate);
+    size_t const delay_frames = std::min(std::max(static_cast<size_t>(m_time_ms * 0.001f * m_sample_rate), MIX_BLOCK_FRAMES), std::max(max_frames, MIX_BLOCK_FRAMES));
+    float const feedback = std::min(std::max(m_feedback, 0.0f), 0.99f);
+    float const mix = std::min(std::max(m_mix, 0.0f), 1.0f);
+
+    for (uint32_t channel = 0; channel < 2; ++channel)
+    {
+        float * samples = channels[channel];
+        float * wet = m_wet[channel];
+        std::memset(wet, 0, frames * sizeof(float));
+
+        m_lines[channel].Process(delay_frames, frames, [&](size_t const offset, float * write, float const * read, size_t const count)
+        {
+            kernels.comb(wet + offset, write, samples + offset, read, count, feedback);
+        });
+
+        kernels.scale_ramp(samples, frames, 1.0f - mix, 0.0f);
+        kernels.mix_ramp(samples, wet, frames, mix, 0.0f);
+    }
+}
+
+void Audio::CDelay::SetParameter(uint32_t const parameter, float const value)
+{
+    switch (static_cast<EParameter>(parameter))
+    {
+        case EParameter::TimeMs: m_time_ms = value; break;
+        case EParameter::Feedback: m_feedback = value; break;
+        case EParameter::Mix: m_mix = value; break;
+    }
+}
+
+Audio::CReverb::CReverb(float const room_size, float const mix)
+: m_room_size(room_size)
+, m_mix(mix)
+, m_comb_delays()
+, m_allpass_delays()
+, m_combs()
+, m_allpasses()
+, m_input()
+, m_wet()
+{
+}
+
+void Audio::CReverb::Prepare(uint32_t const sample_rate)
+{
+    float const scale = static_cast<float>(sample_rate) / 44100.0f;
+
+    for (uint32_t channel = 0; channel < 2; ++channel)
+    {
+        size_t const spread = channel == 0 ? 0 : REVERB_STEREO_SPREAD;
+        for (size_t i = 0; i < COMB_COUNT; ++i)
+        {
+            m_comb_delays[channel][i] = std::max(static_cast<size_t>(static_cast<float>(REVERB_COMB_TUNINGS[i] + spread) * scale), MIX_BLOCK_FRAMES);
+            m_combs[channel][i].Resize(m_comb_delays[channel][i]);
+        }
+        for (size_t i = 0; i < ALLPASS_COUNT; ++i)
+        {
+            m_allpass_delays[channel][i] = std::max(static_cast<size_t>(static_cast<float>(REVERB_ALLPASS_TUNINGS[i] + spread) * scale), MIX_BLOCK_FRAMES);
+            m_allpasses[channel][i].Resize(m_allpass_delays[channel][i]);
+        }
+    }
+}
+
+void Audio::CReverb::Process(SAudioKernels const & kernels, float * const * channels, size_t const frames)
+{
+    float const feedback = 0.7f + std::min(std::max(m_room_size, 0.0f), 1.0f) * 0.28f;
+    float const mix = std::min(std::max(m_mix, 0.0f), 1.0f);
+
+    // Both sides are fed the same mono sum
+    std::memset(m_input, 0, frames * sizeof(float));
+    kernels.mix_ramp(m_input, channels[0], frames, REVERB_INPUT_GAIN, 0.0f);
+    kernels.mix_ramp(m_input, channels[1], frames, REVERB_INPUT_GAIN, 0.0f);
+
+    for (uint32_t channel = 0; channel < 2; ++channel)
+    {
+        std::memset(m_wet, 0, frames * sizeof(float));
+
+        for (size_t i = 0; i < COMB_COUNT; ++i)
+        {
+            m_combs[channel][i].Process(m_comb_delays[channel][i], frames, [&](size_t const offset, float * write, float const * read, size_t const count)
+            {
+                kernels.comb(m_wet + offset, write, m_input + offset, read, count, feedback);
+            });
+        }
+
+        for (size_t i = 0; i < ALLPASS_COUNT; ++i)
+        {
+            m_allpasses[channel][i].Process(m_allpass_delays[channel][i], frames, [&](size_t const offset, float * write, float const * read, size_t const count)
+            {
+                kernels.allpass(m_wet + offset, write, read, count, REVERB_ALLPASS_FEEDBACK);
+            });
+        }
+
+        kernels.scale_ramp(channels[channel], frames, 1.0f - mix, 0.0f);
+        kernels.mix_ramp(channels[channel], m_wet, frames, mix, 0.0f);
+    }
+}
+
+void Audio::CReverb::SetParameter(uint32_t const parameter, float const value)
+{
+    switch (static_cast<EParameter>(parameter))
+    {
+        case EParameter::RoomSize: m_room_size = value; break;
+        case EParameter::Mix: m_mix = value; break;
+    }
+}
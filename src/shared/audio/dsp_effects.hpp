@@ -0,0 +1,206 @@
+#pragma once
+
+#include "audio/audio_kernels.hpp"
+#include "audio/voice_mixer.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+
+namespace Audio
+{
+    // An insert effect on a bus of the DSP graph, processing a stereo block in place. Prepare
+    // happens on the game thread when the graph is compiled and is the only place allowed to
+    // allocate, Process and SetParameter run on the audio thread.
+    class IDspEffect
+    {
+    public:
+        virtual ~IDspEffect();
+
+        virtual void Prepare(uint32_t const sample_rate) = 0;
+        virtual void Process(SAudioKernels const & kernels, float * const * channels, size_t const frames) = 0;
+        // Parameter ids are each effect's EParameter
+        virtual void SetParameter(uint32_t const parameter, float const value) = 0;
+    };
+
+    // A circular buffer for delay based effects. Delays have to be at least MIX_BLOCK_FRAMES so
+    // a block reads and writes separate spans, which is what lets the kernels work a block at a
+    // time instead of a sample at a time.
+    class CDelayLine
+    {
+    public:
+        CDelayLine();
+
+        void Resize(size_t const max_delay_frames);
+
+        // Calls func(offset, write, read, count) for each contiguous span of the next frames,
+        // read being delay_frames behind write, then moves on by frames
+        template <typename Func>
+        void Process(size_t const delay_frames, size_t const frames, Func && func);
+
+    private:
+        std::vector<float> m_samples;
+        size_t m_write;
+    };
+
+    enum class EBiquadType : uint8_t
+    {
+        LowPass,
+        HighPass,
+        BandPass,
+        Peak
+    };
+
+    // Second order filter with the RBJ cookbook responses
+    class CBiquadFilter final : public IDspEffect
+    {
+    public:
+        enum class EParameter : uint32_t
+        {
+            Frequency,
+            Q,
+            // Peak only
+            GainDb
+        };
+
+        explicit CBiquadFilter(EBiquadType const type, float const frequency = 1000.0f, float const q = 0.7071f, float const gain_db = 0.0f);
+
+        void Prepare(uint32_t const sample_rate) override;
+        void Process(SAudioKernels const & kernels, float * const * channels, size_t const frames) override;
+        void SetParameter(uint32_t const parameter, float const value) override;
+
+    private:
+        void UpdateCoefficients();
+
+        EBiquadType m_type;
+        float m_frequency;
+        float m_q;
+        float m_gain_db;
+        float m_sample_rate;
+
+        float m_b0, m_b1, m_b2, m_a1, m_a2;
+        // Transposed direct form II state per channel
+        float m_z1[2];
+        float m_z2[2];
+    };
+
+    // Feed forward peak compressor. The level is measured and the gain worked out once per
+    // sub block, then ramped across it, so the per sample work is all SIMD kernels.
+    class CCompressor final : public IDspEffect
+    {
+    public:
+        enum class EParameter : uint32_t
+        {
+            ThresholdDb,
+            Ratio,
+            AttackMs,
+            ReleaseMs,
+            MakeupDb
+        };
+
+        CCompressor(float const threshold_db = -12.0f, float const ratio = 4.0f, float const attack_ms = 5.0f, float const release_ms = 100.0f, float const makeup_db = 0.0f);
+
+        void Prepare(uint32_t const sample_rate) override;
+        void Process(SAudioKernels const & kernels, float * const * channels, size_t const frames) override;
+        void SetParameter(uint32_t const parameter, float const value) override;
+
+    private:
+        void UpdateCoefficients();
+
+        float m_threshold_db;
+        float m_ratio;
+        float m_attack_ms;
+        float m_release_ms;
+        float m_makeup_db;
+        float m_sample_rate;
+
+        float m_attack_coefficient;
+        float m_release_coefficient;
+        float m_envelope_db;
+        float m_gain;
+    };
+
+    // Stereo feedback delay
+    class CDelay final : public IDspEffect
+    {
+    public:
+        enum class EParameter : uint32_t
+        {
+            TimeMs,
+            Feedback,
+            // 0 is all dry, 1 all wet
+            Mix
+        };
+
+        CDelay(float const time_ms = 250.0f, float const feedback = 0.4f, float const mix = 0.3f, float const max_time_ms = 2000.0f);
+
+        void Prepare(uint32_t const sample_rate) override;
+        void Process(SAudioKernels const & kernels, float * const * channels, size_t const frames) override;
+        void SetParameter(uint32_t const parameter, float const value) override;
+
+    private:
+        float m_time_ms;
+        float m_feedback;
+        float m_mix;
+        float m_max_time_ms;
+        float m_sample_rate;
+
+        CDelayLine m_lines[2];
+        float m_wet[2][MIX_BLOCK_FRAMES];
+    };
+
+    // Schroeder style reverb, parallel combs into series allpasses per channel with the right
+    // channel's delays spread a little for width. Freeverb's damping filter is left out, it is
+    // recursive per sample and would be the only part of the reverb that can't go through the
+    // block kernels.
+    class CReverb final : public IDspEffect
+    {
+    public:
+        enum class EParameter : uint32_t
+        {
+            // 0 to 1, scales the comb feedback
+            RoomSize,
+            Mix
+        };
+
+        static constexpr size_t COMB_COUNT = 4;
+        static constexpr size_t ALLPASS_COUNT = 2;
+
+        CReverb(float const room_size = 0.5f, float const mix = 0.25f);
+
+        void Prepare(uint32_t const sample_rate) override;
+        void Process(SAudioKernels const & kernels, float * const * channels, size_t const frames) override;
+        void SetParameter(uint32_t const parameter, float const value) override;
+
+    private:
+        float m_room_size;
+        float m_mix;
+
+        size_t m_comb_delays[2][COMB_COUNT];
+        size_t m_allpass_delays[2][ALLPASS_COUNT];
+        CDelayLine m_combs[2][COMB_COUNT];
+        CDelayLine m_allpasses[2][ALLPASS_COUNT];
+
+        float m_input[MIX_BLOCK_FRAMES];
+        float m_wet[MIX_BLOCK_FRAMES];
+    };
+
+    template <typename Func>
+    void CDelayLine::Process(size_t const delay_frames, size_t const frames, Func && func)
+    {
+        size_t const length = m_samples.size();
+        size_t read = (m_write + length - delay_frames) % length;
+
+        size_t done = 0;
+        while (done < frames)
+        {
+            size_t const count = std::min(frames - done, std::min(length - m_write, length - read));
+            func(done, m_samples.data() + m_write, m_samples.data() + read, count);
+
+            done += count;
+            m_write = (m_write + count) % length;
+            read = (read + count) % length;
+        }
+    }
+}
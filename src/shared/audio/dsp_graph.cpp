@@ -0,0 +1,179 @@
+#include "dsp_graph.hpp"
+
+#include "utility/logging.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+Audio::CDspGraph::CDspGraph()
+: m_buses(1)
+, m_order()
+, m_samples()
+, m_compiled(false)
+{
+}
+
+uint32_t Audio::CDspGraph::AddBus(uint32_t const output)
+{
+    if (m_compiled == true || output >= m_buses.size())
+    {
+        ERROR_LOG("Can't add a bus to a compiled DSP graph or with an unknown output");
+        return INVALID_BUS;
+    }
+
+    SBus bus;
+    bus.output = output;
+    m_buses.push_back(std::move(bus));
+    return static_cast<uint32_t>(m_buses.size() - 1);
+}
+
+bool Audio::CDspGraph::SetBusOutput(uint32_t const bus, uint32_t const output)
+{
+    if (m_compiled == true || bus == MASTER_BUS || bus >= m_buses.size() || output >= m_buses.size() || bus == output)
+    {
+        ERROR_LOG("Invalid DSP bus routing");
+        return false;
+    }
+
+    // Loops are caught by Compile
+    m_buses[bus].output = output;
+    return true;
+}
+
+uint32_t Audio::CDspGraph::AddEffect(uint32_t const bus, std::unique_ptr<IDspEffect> effect)
+{
+    if (m_compiled == true || bus >= m_buses.size() || effect == nullptr)
+    {
+        ERROR_LOG("Can't add an effect to a compiled DSP graph or an unknown bus");
+        return UINT32_MAX;
+    }
+
+    m_buses[bus].effects.push_back(std::move(effect));
+    return static_cast<uint32_t>(m_buses[bus].effects.size() - 1);
+}
+
+bool Audio::CDspGraph::Compile(uint32_t const sample_rate)
+{
+    if (m_compiled == true)
+    {
+        return true;
+    }
+
+    // Kahn's algorithm, a bus is ready once every bus feeding it has been processed
+    std::vector<uint32_t> pending_inputs(m_buses.size(), 0);
+    for (SBus const & bus : m_buses)
+    {
+        if (bus.output != INVALID_BUS)
+        {
+            ++pending_inputs[bus.output];
+        }
+    }
+
+    m_order.clear();
+    m_order.reserve(m_buses.size());
+    for (uint32_t i = 0; i < m_buses.size(); ++i)
+    {
+        if (pending_inputs[i] == 0)
+        {
+            m_order.push_back(i);
+        }
+    }
+
+    for (size_t next = 0; next < m_order.size(); ++next)
+    {
+        uint32_t const output = m_buses[m_order[next]].output;
+        if (output != INVALID_BUS && --pending_inputs[output] == 0)
+        {
+            m_order.push_back(output);
+        }
+    }
+
+    if (m_order.size() != m_buses.size())
+    {
+        ERROR_LOG("DSP graph has a loop in its bus routing");
+        m_order.clear();
+        return false;
+    }
+
+    for (SBus & bus : m_buses)
+    {
+        for (std::unique_ptr<IDspEffect> const & effect : bus.effects)
+        {
+            effect->Prepare(sample_rate);
+        }
+    }
+
+    m_samples.assign(m_buses.size() * 2 * MIX_BLOCK_FRAMES, 0.0f);
+    m_compiled = true;
+    return true;
+}
+
+void Audio::CDspGraph::SetBusGain(uint32_t const bus, float const gain)
+{
+    if (bus < m_buses.size())
+    {
+        m_buses[bus].target_gain = std::max(gain, 0.0f);
+    }
+}
+
+void Audio::CDspGraph::SetEffectParameter(uint32_t const bus, uint32_t const effect, uint32_t const parameter, float const value)
+{
+    if (bus < m_buses.size() && effect < m_buses[bus].effects.size())
+    {
+        m_buses[bus].effects[effect]->SetParameter(parameter, value);
+    }
+}
+
+void Audio::CDspGraph::BeginBlock(size_t const frames)
+{
+    for (uint32_t bus = 0; bus < m_buses.size(); ++bus)
+    {
+        std::memset(GetBusSamples(bus, 0), 0, frames * sizeof(float));
+        std::memset(GetBusSamples(bus, 1), 0, frames * sizeof(float));
+    }
+}
+
+float * Audio::CDspGraph::GetBusInput(uint32_t const bus, uint32_t const channel)
+{
+    return GetBusSamples(bus < m_buses.size() ? bus : MASTER_BUS, channel);
+}
+
+void Audio::CDspGraph::Process(SAudioKernels const & kernels, size_t const frames)
+{
+    for (uint32_t const bus_index : m_order)
+    {
+        SBus & bus = m_buses[bus_index];
+        float * const channels[2] = { GetBusSamples(bus_index, 0), GetBusSamples(bus_index, 1) };
+
+        for (std::unique_ptr<IDspEffect> const & effect : bus.effects)
+        {
+            effect->Process(kernels, channels, frames);
+        }
+
+        float const gain_step = (bus.target_gain - bus.gain) / static_cast<float>(frames);
+        if (bus.output == INVALID_BUS)
+        {
+            if (bus.gain != 1.0f || gain_step != 0.0f)
+            {
+                kernels.scale_ramp(channels[0], frames, bus.gain, gain_step);
+                kernels.scale_ramp(channels[1], frames, bus.gain, gain_step);
+            }
+        }
+        else
+        {
+            kernels.mix_ramp(GetBusSamples(bus.output, 0), channels[0], frames, bus.gain, gain_step);
+            kernels.mix_ramp(GetBusSamples(bus.output, 1), channels[1], frames, bus.gain, gain_step);
+        }
+        bus.gain = bus.target_gain;
+    }
+}
+
+float * Audio::CDspGraph::GetBusSamples(uint32_t const bus, uint32_t const channel)
+{
+    return m_samples.data() + (bus * 2 + channel) * MIX_BLOCK_FRAMES;
+}
+
+float const * Audio::CDspGraph::GetBusSamples(uint32_t const bus, uint32_t const channel) const
+{
+    return m_samples.data() + (bus * 2 + channel) * MIX_BLOCK_FRAMES;
+}
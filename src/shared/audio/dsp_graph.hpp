@@ -0,0 +1,72 @@
+#pragma once
+
+#include "audio/audio_kernels.hpp"
+#include "audio/dsp_effects.hpp"
+
+#include <cinttypes>
+#include <memory>
+#include <vector>
+
+namespace Audio
+{
+    // Always there, everything ends up in it
+    constexpr uint32_t MASTER_BUS = 0;
+    constexpr uint32_t INVALID_BUS = UINT32_MAX;
+
+    // A tree of stereo buses. Voices mix into any bus, each bus runs its chain of insert effects
+    // a block at a time and then mixes into its output bus, until it all lands in the master.
+    // The layout is built up on the game thread and then compiled, which sorts the buses so
+    // every one is processed before the bus it feeds and prepares the effects. After that only
+    // gains and effect parameters change, so processing is a flat walk over the compiled order
+    // with nothing to look up or allocate.
+    class CDspGraph
+    {
+    public:
+        CDspGraph();
+
+        CDspGraph(CDspGraph const &) = delete;
+        CDspGraph & operator=(CDspGraph const &) = delete;
+
+        // Layout, only before Compile
+        uint32_t AddBus(uint32_t const output = MASTER_BUS);
+        bool SetBusOutput(uint32_t const bus, uint32_t const output);
+        // Returns the effect's index in the bus's chain, or UINT32_MAX
+        uint32_t AddEffect(uint32_t const bus, std::unique_ptr<IDspEffect> effect);
+
+        // Fails if the buses loop back on themselves
+        bool Compile(uint32_t const sample_rate);
+        bool IsCompiled() const { return m_compiled; }
+
+        uint32_t GetBusCount() const { return static_cast<uint32_t>(m_buses.size()); }
+
+        // Audio thread once compiled
+        void SetBusGain(uint32_t const bus, float const gain);
+        void SetEffectParameter(uint32_t const bus, uint32_t const effect, uint32_t const parameter, float const value);
+
+        // Zeroes every bus ready for the voices to be mixed in
+        void BeginBlock(size_t const frames);
+        // Where a voice on the bus mixes to, unknown buses fall back to the master
+        float * GetBusInput(uint32_t const bus, uint32_t const channel);
+        // Runs every bus and leaves the result in the master
+        void Process(SAudioKernels const & kernels, size_t const frames);
+        float const * GetOutput(uint32_t const channel) const { return GetBusSamples(MASTER_BUS, channel); }
+
+    private:
+        struct SBus
+        {
+            uint32_t output = INVALID_BUS;
+            float gain = 1.0f;
+            float target_gain = 1.0f;
+            std::vector<std::unique_ptr<IDspEffect>> effects;
+        };
+
+        float * GetBusSamples(uint32_t const bus, uint32_t const channel);
+        float const * GetBusSamples(uint32_t const bus, uint32_t const channel) const;
+
+        std::vector<SBus> m_buses;
+        std::vector<uint32_t> m_order;
+        // Two planar channels of MIX_BLOCK_FRAMES per bus
+        std::vector<float> m_samples;
+        bool m_compiled;
+    };
+}
@@ -0,0 +1,225 @@
+#include "sample_cache.hpp"
+
+#include "audio/audio_decoder.hpp"
+#include "utility/file/file_helper.hpp"
+#include "utility/logging.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <sstream>
+
+namespace
+{
+    bool read_sample(std::string const & filename, Audio::SSoundBuffer & out_buffer)
+    {
+        // The file and the decoder are loading costs, the decoded samples are tagged Audio
+        // whatever the scope
+        Memory::CMemoryTagScope const memory_scope(Memory::EMemoryTag::Assets);
+
+        // Read in one go and decode from memory, the file is only touched the once
+        std::vector<char> const data = FileHelpers::read_file(filename);
+        if (data.empty() == true)
+        {
+            return false;
+        }
+
+        std::unique_ptr<Audio::IAudioDecoder> decoder = Audio::open_audio_decoder(std::make_unique<std::istringstream>(std::string(data.begin(), data.end())), filename);
+        if (decoder == nullptr || Audio::decode_audio(*decoder, out_buffer) == false)
+        {
+            ERROR_LOG("Failed to decode sample: " + filename);
+            return false;
+        }
+        return true;
+    }
+}
+
+Audio::CSampleCache::CSampleCache(size_t const budget_bytes)
+: m_entries()
+, m_lru()
+, m_voice_pins()
+, m_budget_bytes(budget_bytes)
+, m_resident_bytes(0)
+, m_hits(0)
+, m_misses(0)
+, m_evictions(0)
+, m_over_budget_loads(0)
+{
+}
+
+Audio::SSoundBuffer const * Audio::CSampleCache::Acquire(Assets::AssetId const id, std::string const & filename)
+{
+    SEntry * entry = Find(id, filename);
+    if (entry == nullptr)
+    {
+        return nullptr;
+    }
+
+    ++entry->pin_count;
+    return &entry->buffer;
+}
+
+void Audio::CSampleCache::Release(Assets::AssetId const id)
+{
+    auto const entry = m_entries.find(id);
+    if (entry != m_entries.end() && entry->second.pin_count > 0)
+    {
+        --entry->second.pin_count;
+    }
+}
+
+bool Audio::CSampleCache::Preload(Assets::AssetId const id, std::string const & filename)
+{
+    return Find(id, filename) != nullptr;
+}
+
+Audio::SVoiceHandle Audio::CSampleCache::Play(CAudioManager & audio_manager, Assets::AssetId const id, std::string const & filename, SPlayParams const & params)
+{
+    SSoundBuffer const * buffer = Acquire(id, filename);
+    if (buffer == nullptr)
+    {
+        return INVALID_VOICE;
+    }
+
+    SVoiceHandle const voice = audio_manager.Play(*buffer, params);
+    if (voice == INVALID_VOICE)
+    {
+        Release(id);
+        return INVALID_VOICE;
+    }
+
+    SVoicePin pin;
+    pin.voice = voice;
+    pin.id = id;
+    m_voice_pins.push_back(pin);
+    return voice;
+}
+
+void Audio::CSampleCache::Update(CAudioManager const & audio_manager)
+{
+    for (size_t i = m_voice_pins.size(); i > 0; --i)
+    {
+        SVoicePin const pin = m_voice_pins[i - 1];
+        if (audio_manager.IsPlaying(pin.voice) == false)
+        {
+            Release(pin.id);
+            m_voice_pins[i - 1] = m_voice_pins.back();
+            m_voice_pins.pop_back();
+        }
+    }
+}
+
+void Audio::CSampleCache::SetBudget(size_t const budget_bytes)
+{
+    m_budget_bytes = budget_bytes;
+    MakeRoom(0);
+}
+
+void Audio::CSampleCache::Purge()
+{
+    for (auto entry = m_entries.begin(); entry != m_entries.end();)
+    {
+        auto const next = std::next(entry);
+        if (entry->second.pin_count == 0)
+        {
+            Evict(entry);
+        }
+        entry = next;
+    }
+}
+
+Audio::SSampleCacheStats Audio::CSampleCache::GetStats() const
+{
+    SSampleCacheStats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.evictions = m_evictions;
+    stats.over_budget_loads = m_over_budget_loads;
+    stats.entries = static_cast<uint32_t>(m_entries.size());
+    stats.pinned_entries = static_cast<uint32_t>(std::count_if(m_entries.begin(), m_entries.end(), [](std::pair<Assets::AssetId const, SEntry> const & entry)
+    {
+        return entry.second.pin_count > 0;
+    }));
+    stats.resident_bytes = m_resident_bytes;
+    stats.budget_bytes = m_budget_bytes;
+    return stats;
+}
+
+void Audio::CSampleCache::ResetStats()
+{
+    m_hits = 0;
+    m_misses = 0;
+    m_evictions = 0;
+    m_over_budget_loads = 0;
+}
+
+Audio::CSampleCache::SEntry * Audio::CSampleCache::Find(Assets::AssetId const id, std::string const & filename)
+{
+    auto const entry = m_entries.find(id);
+    if (entry != m_entries.end())
+    {
+        ++m_hits;
+        m_lru.splice(m_lru.begin(), m_lru, entry->second.lru);
+        return &entry->second;
+    }
+
+    ++m_misses;
+    return Load(id, filename);
+}
+
+Audio::CSampleCache::SEntry * Audio::CSampleCache::Load(Assets::AssetId const id, std::string const & filename)
+{
+    Memory::CMemoryTagScope const memory_scope(Memory::EMemoryTag::Audio);
+
+    SSoundBuffer buffer;
+    if (read_sample(filename, buffer) == false)
+    {
+        return nullptr;
+    }
+
+    size_t const size = buffer.GetSizeInBytes();
+    MakeRoom(size);
+    if (m_resident_bytes + size > m_budget_bytes)
+    {
+        ++m_over_budget_loads;
+        DEBUG_LOG("Sample cache over budget loading " + filename + ", everything else is pinned");
+    }
+
+    SEntry & entry = m_entries[id];
+    entry.buffer = std::move(buffer);
+    entry.pin_count = 0;
+    m_lru.push_front(id);
+    entry.lru = m_lru.begin();
+
+    m_resident_bytes += size;
+    return &entry;
+}
+
+void Audio::CSampleCache::MakeRoom(size_t const bytes)
+{
+    // Oldest first, skipping anything pinned
+    auto candidate = m_lru.end();
+    while (m_resident_bytes + bytes > m_budget_bytes && candidate != m_lru.begin())
+    {
+        --candidate;
+
+        auto const entry = m_entries.find(*candidate);
+        if (entry->second.pin_count > 0)
+        {
+            continue;
+        }
+
+        // Evicting removes it from the list, the next one along stays valid
+        candidate = std::next(candidate);
+        Evict(entry);
+    }
+}
+
+void Audio::CSampleCache::Evict(std::unordered_map<Assets::AssetId, SEntry>::iterator entry)
+{
+    m_lru.erase(entry->second.lru);
+    m_resident_bytes -= entry->second.buffer.GetSizeInBytes();
+    m_entries.erase(entry);
+    ++m_evictions;
+}
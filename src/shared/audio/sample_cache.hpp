@@ -0,0 +1,99 @@
+#pragma once
+
+#include "assets/asset_handle.hpp"
+#include "audio/audio_manager.hpp"
+#include "audio/sound_buffer.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+#include <cinttypes>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Audio
+{
+    struct SSampleCacheStats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        // Loads that had to go over budget because everything else was pinned
+        uint64_t over_budget_loads = 0;
+
+        uint32_t entries = 0;
+        uint32_t pinned_entries = 0;
+        size_t resident_bytes = 0;
+        size_t budget_bytes = 0;
+    };
+
+    // Decoded sound effects kept around by asset id so playing the same one again doesn't read
+    // or decode anything. The pool is bounded by a byte budget and the least recently used
+    // samples are evicted to make room, except those that are pinned: every Acquire pins until
+    // the matching Release, and samples played through the cache stay pinned until their voice
+    // has finished. Game thread only.
+    class CSampleCache
+    {
+    public:
+        explicit CSampleCache(size_t const budget_bytes);
+
+        CSampleCache(CSampleCache const &) = delete;
+        CSampleCache & operator=(CSampleCache const &) = delete;
+
+        // Loads on a miss, nullptr if the file can't be decoded. The buffer stays valid until
+        // the pin is released and the sample is evicted.
+        SSoundBuffer const * Acquire(Assets::AssetId const id, std::string const & filename);
+        void Release(Assets::AssetId const id);
+
+        // Warms the cache without pinning anything
+        bool Preload(Assets::AssetId const id, std::string const & filename);
+
+        // Acquires the sample for as long as the voice plays
+        SVoiceHandle Play(CAudioManager & audio_manager, Assets::AssetId const id, std::string const & filename, SPlayParams const & params = SPlayParams());
+
+        // Once per frame after CAudioManager::Update, unpins the samples of finished voices
+        void Update(CAudioManager const & audio_manager);
+
+        void SetBudget(size_t const budget_bytes);
+        // Drops everything not pinned
+        void Purge();
+
+        bool Contains(Assets::AssetId const id) const { return m_entries.find(id) != m_entries.end(); }
+
+        SSampleCacheStats GetStats() const;
+        void ResetStats();
+
+    private:
+        struct SEntry
+        {
+            SSoundBuffer buffer;
+            uint32_t pin_count = 0;
+            // Position in m_lru, most recent at the front
+            std::list<Assets::AssetId>::iterator lru;
+        };
+
+        struct SVoicePin
+        {
+            SVoiceHandle voice;
+            Assets::AssetId id = Assets::INVALID_ASSET_ID;
+        };
+
+        SEntry * Find(Assets::AssetId const id, std::string const & filename);
+        SEntry * Load(Assets::AssetId const id, std::string const & filename);
+        // Evicts from the back of the list until bytes more would fit
+        void MakeRoom(size_t const bytes);
+        void Evict(std::unordered_map<Assets::AssetId, SEntry>::iterator entry);
+
+        std::unordered_map<Assets::AssetId, SEntry> m_entries;
+        std::list<Assets::AssetId> m_lru;
+        Memory::tagged_vector<SVoicePin, Memory::EMemoryTag::Audio> m_voice_pins;
+
+        size_t m_budget_bytes;
+        size_t m_resident_bytes;
+
+        uint64_t m_hits;
+        uint64_t m_misses;
+        uint64_t m_evictions;
+        uint64_t m_over_budget_loads;
+    };
+}
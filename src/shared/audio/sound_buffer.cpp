@@ -0,0 +1,33 @@
+#include "sound_buffer.hpp"
+
+#include "utility/logging.hpp"
+
+#include <string>
+
+bool Audio::create_sound_buffer(float const * interleaved,
+                                size_t const frame_count,
+                                uint32_t const channels,
+                                uint32_t const sample_rate,
+                                SSoundBuffer & out_buffer)
+{
+    if (channels == 0 || channels > MAX_SOURCE_CHANNELS)
+    {
+        ERROR_LOG("Unsupported channel count: " + std::to_string(channels));
+        return false;
+    }
+
+    out_buffer.sample_rate = sample_rate;
+    out_buffer.channels = channels;
+    out_buffer.frame_count = frame_count;
+    out_buffer.samples.resize(frame_count * channels);
+
+    for (uint32_t channel = 0; channel < channels; ++channel)
+    {
+        float * dst = out_buffer.Channel(channel);
+        for (size_t frame = 0; frame < frame_count; ++frame)
+        {
+            dst[frame] = interleaved[frame * channels + channel];
+        }
+    }
+    return true;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+
+#include "utility/memory/memory_tracker.hpp"
+
+namespace Audio
+{
+    // Fully decoded PCM ready for the mixer. Samples are float and planar (all of channel 0,
+    // then all of channel 1) so the mix kernels can run straight down a channel.
+    struct SSoundBuffer
+    {
+        uint32_t sample_rate = 0;
+        uint32_t channels = 0;
+        size_t frame_count = 0;
+        // Tagged Audio wherever the buffer is filled, decoding usually runs under Assets
+        Memory::tagged_vector<float, Memory::EMemoryTag::Audio> samples;
+
+        float const * Channel(uint32_t const channel) const { return samples.data() + channel * frame_count; }
+        float * Channel(uint32_t const channel) { return samples.data() + channel * frame_count; }
+
+        size_t GetSizeInBytes() const { return samples.size() * sizeof(float); }
+    };
+
+    // The mixer only handles mono and stereo sources
+    constexpr uint32_t MAX_SOURCE_CHANNELS = 2;
+
+    // Deinterleaves into a new buffer, returns false if the format can't be mixed
+    bool create_sound_buffer(float const * interleaved,
+                             size_t const frame_count,
+                             uint32_t const channels,
+                             uint32_t const sample_rate,
+                             SSoundBuffer & out_buffer);
+}
@@ -0,0 +1,357 @@
+#include "voice_mixer.hpp"
+
+#include "audio/dsp_graph.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    constexpr float QUARTER_PI = 0.78539816339f;
+}
+
+Audio::CVoiceMixer::CVoiceMixer()
+: m_voices()
+, m_active()
+, m_active_count(0)
+, m_finished()
+, m_finished_count(0)
+, m_master_gain(1.0f)
+, m_master_target_gain(1.0f)
+, m_graph(nullptr)
+, m_mix()
+{
+}
+
+void Audio::CVoiceMixer::ApplyCommand(SAudioCommand const & command)
+{
+    switch (command.type)
+    {
+        case EAudioCommand::SetMasterVolume:
+            m_master_target_gain = std::max(command.value, 0.0f);
+            return;
+        case EAudioCommand::SetGraph:
+            m_graph = command.graph;
+            return;
+        case EAudioCommand::SetBusGain:
+            if (m_graph != nullptr)
+            {
+                m_graph->SetBusGain(command.bus, command.value);
+            }
+            return;
+        case EAudioCommand::SetEffectParameter:
+            if (m_graph != nullptr)
+            {
+                m_graph->SetEffectParameter(command.bus, command.effect, command.parameter, command.value);
+            }
+            return;
+        case EAudioCommand::Play:
+        case EAudioCommand::Stop:
+        case EAudioCommand::SetVolume:
+        case EAudioCommand::SetPan:
+            break;
+    }
+
+    if (command.voice >= MAX_VOICES)
+    {
+        return;
+    }
+
+    SVoice & voice = m_voices[command.voice];
+    switch (command.type)
+    {
+        case EAudioCommand::Play:
+            StartVoice(command.voice, command);
+            break;
+        case EAudioCommand::Stop:
+            // Fades out over the next block rather than cutting off with a click
+            if (voice.active == true)
+            {
+                voice.stopping = true;
+                voice.target_gain[0] = 0.0f;
+                voice.target_gain[1] = 0.0f;
+            }
+            break;
+        case EAudioCommand::SetVolume:
+            voice.volume = std::max(command.value, 0.0f);
+            UpdateTargetGains(voice);
+            break;
+        case EAudioCommand::SetPan:
+            voice.pan = std::min(std::max(command.value, -1.0f), 1.0f);
+            UpdateTargetGains(voice);
+            break;
+        case EAudioCommand::SetMasterVolume:
+        case EAudioCommand::SetGraph:
+        case EAudioCommand::SetBusGain:
+        case EAudioCommand::SetEffectParameter:
+            break;
+    }
+}
+
+void Audio::CVoiceMixer::Reset()
+{
+    for (SVoice & voice : m_voices)
+    {
+        voice = SVoice();
+    }
+    m_active_count = 0;
+    m_finished_count = 0;
+    m_graph = nullptr;
+}
+
+void Audio::CVoiceMixer::Mix(float * output, size_t const frames, uint32_t const channels)
+{
+    SAudioKernels const & kernels = get_audio_kernels();
+
+    size_t done = 0;
+    while (done < frames)
+    {
+        size_t const block_frames = std::min(frames - done, MIX_BLOCK_FRAMES);
+
+        MixBlock(kernels, block_frames);
+
+        float const * const mix[2] = {
+            m_graph != nullptr ? m_graph->GetOutput(0) : m_mix[0],
+            m_graph != nullptr ? m_graph->GetOutput(1) : m_mix[1]
+        };
+        WriteOutput(mix, output + done * channels, block_frames, channels);
+
+        done += block_frames;
+    }
+}
+
+void Audio::CVoiceMixer::StartVoice(uint32_t const voice_index, SAudioCommand const & command)
+{
+    uint32_t const channels = command.buffer != nullptr ? command.buffer->channels
+                            : command.stream != nullptr ? command.stream->GetChannels()
+                            : 0;
+    if (channels == 0 || channels > MAX_SOURCE_CHANNELS)
+    {
+        // Still report it so the game thread gets the slot back
+        m_finished[m_finished_count++] = voice_index;
+        return;
+    }
+
+    SVoice & voice = m_voices[voice_index];
+    if (voice.active == false)
+    {
+        voice.active_index = m_active_count;
+        m_active[m_active_count++] = voice_index;
+    }
+
+    voice.buffer = command.buffer;
+    voice.stream = command.stream;
+    voice.cursor = 0;
+    voice.channels = channels;
+    voice.bus = command.params.bus;
+    voice.volume = std::max(command.params.volume, 0.0f);
+    voice.pan = std::min(std::max(command.params.pan, -1.0f), 1.0f);
+    // Streams loop in the decoder instead
+    voice.looping = command.params.looping && command.stream == nullptr;
+    voice.active = true;
+    voice.stopping = false;
+
+    if (command.buffer != nullptr && command.buffer->frame_count > 0 && command.params.start_frame > 0)
+    {
+        voice.cursor = voice.looping == true ? command.params.start_frame % command.buffer->frame_count
+                                             : std::min(command.params.start_frame, command.buffer->frame_count);
+    }
+
+    UpdateTargetGains(voice);
+    if (voice.cursor == 0)
+    {
+        // Starts at full gain so the attack of the sound isn't smeared by a ramp
+        voice.gain[0] = voice.target_gain[0];
+        voice.gain[1] = voice.target_gain[1];
+    }
+    else
+    {
+        // Part way through a sound ramps in over the first block rather than clicking
+        voice.gain[0] = 0.0f;
+        voice.gain[1] = 0.0f;
+    }
+}
+
+void Audio::CVoiceMixer::FinishVoice(uint32_t const voice_index)
+{
+    SVoice & voice = m_voices[voice_index];
+
+    uint32_t const last = m_active[--m_active_count];
+    m_active[voice.active_index] = last;
+    m_voices[last].active_index = voice.active_index;
+
+    voice.active = false;
+    voice.stopping = false;
+    voice.buffer = nullptr;
+    voice.stream = nullptr;
+
+    m_finished[m_finished_count++] = voice_index;
+}
+
+void Audio::CVoiceMixer::UpdateTargetGains(SVoice & voice)
+{
+    if (voice.stopping == true || voice.channels == 0)
+    {
+        return;
+    }
+
+    if (voice.channels == 1)
+    {
+        // Constant power so a mono source doesn't get louder as it pans to the centre
+        float const angle = (voice.pan + 1.0f) * QUARTER_PI;
+        voice.target_gain[0] = voice.volume * std::cos(angle);
+        voice.target_gain[1] = voice.volume * std::sin(angle);
+    }
+    else
+    {
+        // Stereo sources are already mixed, panning just balances them
+        voice.target_gain[0] = voice.volume * std::min(1.0f, 1.0f - voice.pan);
+        voice.target_gain[1] = voice.volume * std::min(1.0f, 1.0f + voice.pan);
+    }
+}
+
+void Audio::CVoiceMixer::MixBlock(SAudioKernels const & kernels, size_t const frames)
+{
+    if (m_graph != nullptr)
+    {
+        m_graph->BeginBlock(frames);
+    }
+    else
+    {
+        std::memset(m_mix, 0, sizeof(m_mix));
+    }
+
+    // Walk backwards so finishing a voice (a swap remove) doesn't skip the one swapped in
+    for (uint32_t i = m_active_count; i > 0; --i)
+    {
+        uint32_t const voice_index = m_active[i - 1];
+        SVoice & voice = m_voices[voice_index];
+
+        float * const output[2] = {
+            m_graph != nullptr ? m_graph->GetBusInput(voice.bus, 0) : m_mix[0],
+            m_graph != nullptr ? m_graph->GetBusInput(voice.bus, 1) : m_mix[1]
+        };
+        if (MixVoice(kernels, voice, output, frames) == false)
+        {
+            FinishVoice(voice_index);
+        }
+    }
+
+    if (m_graph != nullptr)
+    {
+        m_graph->Process(kernels, frames);
+    }
+}
+
+bool Audio::CVoiceMixer::MixVoice(SAudioKernels const & kernels, SVoice & voice, float * const * output, size_t const frames)
+{
+    float const inv_frames = 1.0f / static_cast<float>(frames);
+    float const step[2] = {
+        (voice.target_gain[0] - voice.gain[0]) * inv_frames,
+        (voice.target_gain[1] - voice.gain[1]) * inv_frames
+    };
+
+    if (voice.stream != nullptr)
+    {
+        return MixStreamVoice(kernels, voice, output, frames, step);
+    }
+
+    SSoundBuffer const & buffer = *voice.buffer;
+
+    bool playing = true;
+    size_t mixed = 0;
+    while (mixed < frames && buffer.frame_count > 0)
+    {
+        size_t const count = std::min(frames - mixed, buffer.frame_count - voice.cursor);
+
+        for (uint32_t channel = 0; channel < 2; ++channel)
+        {
+            // Mono sources feed both sides
+            float const * src = buffer.Channel(std::min(channel, buffer.channels - 1)) + voice.cursor;
+            float const gain = voice.gain[channel] + step[channel] * static_cast<float>(mixed);
+            kernels.mix_ramp(output[channel] + mixed, src, count, gain, step[channel]);
+        }
+
+        voice.cursor += count;
+        mixed += count;
+
+        if (voice.cursor == buffer.frame_count)
+        {
+            if (voice.looping == false)
+            {
+                playing = false;
+                break;
+            }
+            voice.cursor = 0;
+        }
+    }
+
+    voice.gain[0] = voice.target_gain[0];
+    voice.gain[1] = voice.target_gain[1];
+
+    return playing == true && voice.stopping == false && buffer.frame_count > 0;
+}
+
+bool Audio::CVoiceMixer::MixStreamVoice(SAudioKernels const & kernels, SVoice & voice, float * const * output, size_t const frames, float const * step)
+{
+    CAudioStream & stream = *voice.stream;
+
+    size_t mixed = 0;
+    while (mixed < frames)
+    {
+        float const * src[MAX_SOURCE_CHANNELS] = {};
+        size_t const count = stream.Acquire(src, frames - mixed);
+        if (count == 0)
+        {
+            // The rest of the block stays silent until the streaming thread catches up
+            if (stream.IsFinished() == false)
+            {
+                stream.AddUnderrun();
+            }
+            break;
+        }
+
+        for (uint32_t channel = 0; channel < 2; ++channel)
+        {
+            float const gain = voice.gain[channel] + step[channel] * static_cast<float>(mixed);
+            kernels.mix_ramp(output[channel] + mixed, src[std::min(channel, voice.channels - 1)], count, gain, step[channel]);
+        }
+
+        stream.Release(count);
+        mixed += count;
+    }
+
+    voice.gain[0] = voice.target_gain[0];
+    voice.gain[1] = voice.target_gain[1];
+
+    return stream.IsFinished() == false && voice.stopping == false;
+}
+
+void Audio::CVoiceMixer::WriteOutput(float const * const * mix, float * output, size_t const frames, uint32_t const channels)
+{
+    float const master_step = (m_master_target_gain - m_master_gain) / static_cast<float>(frames);
+
+    for (size_t frame = 0; frame < frames; ++frame)
+    {
+        float const master = m_master_gain + master_step * static_cast<float>(frame);
+        float const left = std::min(std::max(mix[0][frame] * master, -1.0f), 1.0f);
+        float const right = std::min(std::max(mix[1][frame] * master, -1.0f), 1.0f);
+
+        float * out = output + frame * channels;
+        if (channels == 1)
+        {
+            out[0] = (left + right) * 0.5f;
+            continue;
+        }
+
+        out[0] = left;
+        out[1] = right;
+        for (uint32_t channel = 2; channel < channels; ++channel)
+        {
+            out[channel] = 0.0f;
+        }
+    }
+
+    m_master_gain = m_master_target_gain;
+}
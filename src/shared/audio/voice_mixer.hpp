@@ -0,0 +1,136 @@
+#pragma once
+
+#include "audio/audio_kernels.hpp"
+#include "audio/audio_stream.hpp"
+#include "audio/sound_buffer.hpp"
+
+#include <cinttypes>
+#include <cstddef>
+
+namespace Audio
+{
+    class CDspGraph;
+
+    constexpr uint32_t MAX_VOICES = 512;
+
+    // The mixer always works in blocks of at most this many frames whatever size the device asks for
+    constexpr size_t MIX_BLOCK_FRAMES = 256;
+
+    struct SPlayParams
+    {
+        float volume = 1.0f;
+        // -1 is hard left, 1 is hard right
+        float pan = 0.0f;
+        bool looping = false;
+        // Buffers only, lets a sound pick up part way through (see CVoiceVirtualiser)
+        size_t start_frame = 0;
+        // DSP graph bus the voice mixes into, the master if there's no graph
+        uint32_t bus = 0;
+    };
+
+    enum class EAudioCommand : uint8_t
+    {
+        Play,
+        Stop,
+        SetVolume,
+        SetPan,
+        SetMasterVolume,
+        SetGraph,
+        SetBusGain,
+        SetEffectParameter
+    };
+
+    // Plain data so it can go through the lock free queue to the audio thread
+    struct SAudioCommand
+    {
+        EAudioCommand type = EAudioCommand::Stop;
+        uint32_t voice = 0;
+        // One or the other
+        SSoundBuffer const * buffer = nullptr;
+        CAudioStream * stream = nullptr;
+        SPlayParams params;
+        float value = 0.0f;
+        CDspGraph * graph = nullptr;
+        uint32_t bus = 0;
+        uint32_t effect = 0;
+        uint32_t parameter = 0;
+    };
+
+    // Mixes the active voices into the output. Everything here belongs to the audio thread, the
+    // game thread only talks to it through commands (see CAudioManager) so none of it locks, and
+    // nothing allocates after construction. It doesn't know about the device either, so it can
+    // also render offline into a plain buffer.
+    class CVoiceMixer
+    {
+    public:
+        CVoiceMixer();
+
+        CVoiceMixer(CVoiceMixer const &) = delete;
+        CVoiceMixer & operator=(CVoiceMixer const &) = delete;
+
+        void ApplyCommand(SAudioCommand const & command);
+
+        // A compiled graph the voices are routed through, or nullptr to mix straight to the
+        // output. The mixer doesn't own it. Normally set with a command, directly when offline.
+        void SetGraph(CDspGraph * graph) { m_graph = graph; }
+
+        // Drops every voice (without reporting them) and the graph, only while nothing is mixing
+        void Reset();
+
+        // Overwrites frames * channels interleaved samples
+        void Mix(float * output, size_t const frames, uint32_t const channels);
+
+        // Voices that finished or were stopped since the last clear, their slots can be reused
+        // once the game thread has been told
+        uint32_t const * GetFinishedVoices() const { return m_finished; }
+        uint32_t GetFinishedVoiceCount() const { return m_finished_count; }
+        void ClearFinishedVoices() { m_finished_count = 0; }
+
+        uint32_t GetActiveVoiceCount() const { return m_active_count; }
+
+    private:
+        struct SVoice
+        {
+            SSoundBuffer const * buffer = nullptr;
+            CAudioStream * stream = nullptr;
+            size_t cursor = 0;
+            uint32_t channels = 0;
+            uint32_t bus = 0;
+            float volume = 1.0f;
+            float pan = 0.0f;
+            float gain[MAX_SOURCE_CHANNELS] = {};
+            float target_gain[MAX_SOURCE_CHANNELS] = {};
+            uint32_t active_index = 0;
+            bool looping = false;
+            bool active = false;
+            bool stopping = false;
+        };
+
+        void StartVoice(uint32_t const voice, SAudioCommand const & command);
+        void FinishVoice(uint32_t const voice);
+        void UpdateTargetGains(SVoice & voice);
+
+        void MixBlock(SAudioKernels const & kernels, size_t const frames);
+        // Returns false once the voice has nothing more to play
+        bool MixVoice(SAudioKernels const & kernels, SVoice & voice, float * const * output, size_t const frames);
+        bool MixStreamVoice(SAudioKernels const & kernels, SVoice & voice, float * const * output, size_t const frames, float const * step);
+        void WriteOutput(float const * const * mix, float * output, size_t const frames, uint32_t const channels);
+
+        SVoice m_voices[MAX_VOICES];
+
+        // Dense list of the playing voices so mixing doesn't walk every slot
+        uint32_t m_active[MAX_VOICES];
+        uint32_t m_active_count;
+
+        uint32_t m_finished[MAX_VOICES];
+        uint32_t m_finished_count;
+
+        float m_master_gain;
+        float m_master_target_gain;
+
+        CDspGraph * m_graph;
+
+        // Stereo bus the voices are summed into without a graph, planar to match the sources
+        float m_mix[2][MIX_BLOCK_FRAMES];
+    };
+}
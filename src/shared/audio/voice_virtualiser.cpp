@@ -0,0 +1,347 @@
+#include "voice_virtualiser.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+    // Below this an emitter isn't worth a voice however few are playing
+    constexpr float AUDIBLE_THRESHOLD = 0.001f;
+
+    // Real voices score a little higher so two similar emitters don't keep swapping
+    constexpr float REAL_VOICE_BONUS = 1.1f;
+
+    // Smaller changes aren't sent to the mixer, it would just be queue traffic
+    constexpr float GAIN_EPSILON = 0.005f;
+    constexpr float PAN_EPSILON = 0.01f;
+}
+
+Audio::CVoiceVirtualiser::CVoiceVirtualiser(CAudioManager & audio_manager, uint32_t const max_real_voices)
+: m_audio_manager(audio_manager)
+, m_max_real_voices(std::min(max_real_voices, MAX_VOICES))
+, m_listener_position(0.0f)
+, m_listener_right(1.0f, 0.0f, 0.0f)
+, m_position_x()
+, m_position_y()
+, m_position_z()
+, m_volume()
+, m_priority()
+, m_min_distance()
+, m_max_distance()
+, m_cursor()
+, m_buffers()
+, m_looping()
+, m_alive()
+, m_generations()
+, m_voices()
+, m_sent_gain()
+, m_sent_pan()
+, m_gain()
+, m_pan()
+, m_score()
+, m_candidates()
+, m_selected()
+, m_free_slots()
+, m_alive_count(0)
+, m_stats()
+{
+}
+
+Audio::CVoiceVirtualiser::~CVoiceVirtualiser()
+{
+    for (SVoiceHandle const voice : m_voices)
+    {
+        m_audio_manager.Stop(voice);
+    }
+}
+
+Audio::SEmitterHandle Audio::CVoiceVirtualiser::Play(SSoundBuffer const & buffer, glm::vec3 const & position, SEmitterParams const & params)
+{
+    if (buffer.frame_count == 0)
+    {
+        return INVALID_EMITTER;
+    }
+
+    uint32_t const slot = AllocateSlot();
+
+    m_position_x[slot] = position.x;
+    m_position_y[slot] = position.y;
+    m_position_z[slot] = position.z;
+    m_volume[slot] = std::max(params.volume, 0.0f);
+    m_priority[slot] = std::max(params.priority, 0.0f);
+    m_min_distance[slot] = std::max(params.min_distance, 0.0001f);
+    m_max_distance[slot] = std::max(params.max_distance, m_min_distance[slot]);
+    m_cursor[slot] = 0.0;
+    m_buffers[slot] = &buffer;
+    m_looping[slot] = params.looping ? 1 : 0;
+    m_voices[slot] = INVALID_VOICE;
+
+    // Voices are handed out in Update so a burst of sounds in one frame still only gets the best few
+    SEmitterHandle handle;
+    handle.index = slot;
+    handle.generation = m_generations[slot];
+    return handle;
+}
+
+void Audio::CVoiceVirtualiser::Stop(SEmitterHandle const emitter)
+{
+    if (IsAlive(emitter) == true)
+    {
+        m_audio_manager.Stop(m_voices[emitter.index]);
+        ReleaseSlot(emitter.index);
+    }
+}
+
+bool Audio::CVoiceVirtualiser::IsAlive(SEmitterHandle const emitter) const
+{
+    return emitter.index < m_alive.size() &&
+           m_alive[emitter.index] != 0 &&
+           m_generations[emitter.index] == emitter.generation;
+}
+
+bool Audio::CVoiceVirtualiser::IsReal(SEmitterHandle const emitter) const
+{
+    return IsAlive(emitter) == true && m_voices[emitter.index] != INVALID_VOICE;
+}
+
+void Audio::CVoiceVirtualiser::SetPosition(SEmitterHandle const emitter, glm::vec3 const & position)
+{
+    if (IsAlive(emitter) == true)
+    {
+        m_position_x[emitter.index] = position.x;
+        m_position_y[emitter.index] = position.y;
+        m_position_z[emitter.index] = position.z;
+    }
+}
+
+void Audio::CVoiceVirtualiser::SetVolume(SEmitterHandle const emitter, float const volume)
+{
+    if (IsAlive(emitter) == true)
+    {
+        m_volume[emitter.index] = std::max(volume, 0.0f);
+    }
+}
+
+void Audio::CVoiceVirtualiser::SetListener(glm::vec3 const & position, glm::vec3 const & right)
+{
+    m_listener_position = position;
+    m_listener_right = right;
+}
+
+void Audio::CVoiceVirtualiser::SetMaxRealVoices(uint32_t const max_real_voices)
+{
+    m_max_real_voices = std::min(max_real_voices, MAX_VOICES);
+}
+
+void Audio::CVoiceVirtualiser::Update(float const delta_seconds)
+{
+    auto const start = std::chrono::steady_clock::now();
+
+    AdvancePlayback(delta_seconds);
+    ScoreEmitters();
+    AssignVoices();
+
+    auto const end = std::chrono::steady_clock::now();
+    m_stats.update_ms = std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+uint32_t Audio::CVoiceVirtualiser::AllocateSlot()
+{
+    uint32_t slot = 0;
+    if (m_free_slots.empty() == false)
+    {
+        slot = m_free_slots.back();
+        m_free_slots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<uint32_t>(m_alive.size());
+
+        size_t const size = slot + 1;
+        m_position_x.resize(size);
+        m_position_y.resize(size);
+        m_position_z.resize(size);
+        m_volume.resize(size);
+        m_priority.resize(size);
+        m_min_distance.resize(size);
+        m_max_distance.resize(size);
+        m_cursor.resize(size);
+        m_buffers.resize(size);
+        m_looping.resize(size);
+        m_alive.resize(size);
+        m_generations.resize(size, 0);
+        m_voices.resize(size);
+        m_sent_gain.resize(size);
+        m_sent_pan.resize(size);
+    }
+
+    m_alive[slot] = 1;
+    ++m_alive_count;
+    return slot;
+}
+
+void Audio::CVoiceVirtualiser::ReleaseSlot(uint32_t const slot)
+{
+    m_alive[slot] = 0;
+    m_buffers[slot] = nullptr;
+    m_voices[slot] = INVALID_VOICE;
+    ++m_generations[slot];
+    --m_alive_count;
+    m_free_slots.push_back(slot);
+}
+
+void Audio::CVoiceVirtualiser::AdvancePlayback(float const delta_seconds)
+{
+    double const frames = static_cast<double>(delta_seconds) * m_audio_manager.GetSampleRate();
+
+    for (uint32_t slot = 0; slot < m_alive.size(); ++slot)
+    {
+        if (m_alive[slot] == 0)
+        {
+            continue;
+        }
+
+        double const frame_count = static_cast<double>(m_buffers[slot]->frame_count);
+
+        m_cursor[slot] += frames;
+        if (m_cursor[slot] < frame_count)
+        {
+            continue;
+        }
+
+        if (m_looping[slot] != 0)
+        {
+            m_cursor[slot] = std::fmod(m_cursor[slot], frame_count);
+        }
+        else
+        {
+            // A real voice plays out the last few frames by itself
+            ReleaseSlot(slot);
+        }
+    }
+}
+
+void Audio::CVoiceVirtualiser::ScoreEmitters()
+{
+    size_t const count = m_alive.size();
+    m_gain.resize(count);
+    m_pan.resize(count);
+    m_score.resize(count);
+
+    float const listener_x = m_listener_position.x;
+    float const listener_y = m_listener_position.y;
+    float const listener_z = m_listener_position.z;
+    float const right_x = m_listener_right.x;
+    float const right_y = m_listener_right.y;
+    float const right_z = m_listener_right.z;
+
+    // Branch free so the compiler can vectorise it, dead slots just score zero
+    for (size_t i = 0; i < count; ++i)
+    {
+        float const dx = m_position_x[i] - listener_x;
+        float const dy = m_position_y[i] - listener_y;
+        float const dz = m_position_z[i] - listener_z;
+        float const distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+        float const attenuation = distance >= m_max_distance[i] ? 0.0f
+                                : m_min_distance[i] / std::max(distance, m_min_distance[i]);
+        float const gain = m_volume[i] * attenuation * static_cast<float>(m_alive[i]);
+
+        float const inv_distance = 1.0f / std::max(distance, 0.0001f);
+        float const pan = (dx * right_x + dy * right_y + dz * right_z) * inv_distance;
+
+        m_gain[i] = gain;
+        m_pan[i] = std::min(std::max(pan, -1.0f), 1.0f);
+        m_score[i] = gain * m_priority[i];
+    }
+}
+
+void Audio::CVoiceVirtualiser::AssignVoices()
+{
+    size_t const count = m_alive.size();
+
+    m_candidates.clear();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (m_gain[i] < AUDIBLE_THRESHOLD)
+        {
+            continue;
+        }
+
+        // A voice that has stopped on its own (e.g. the mixer ran out of sound first) gets a new one
+        if (m_voices[i] != INVALID_VOICE && m_audio_manager.IsPlaying(m_voices[i]) == true)
+        {
+            m_score[i] *= REAL_VOICE_BONUS;
+        }
+        m_candidates.push_back(i);
+    }
+
+    if (m_candidates.size() > m_max_real_voices)
+    {
+        std::nth_element(m_candidates.begin(), m_candidates.begin() + m_max_real_voices, m_candidates.end(),
+                         [this](uint32_t const lhs, uint32_t const rhs)
+        {
+            return m_score[lhs] > m_score[rhs];
+        });
+        m_candidates.resize(m_max_real_voices);
+    }
+
+    m_selected.assign(count, 0);
+    for (uint32_t const i : m_candidates)
+    {
+        m_selected[i] = 1;
+    }
+
+    uint32_t real_voices = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        bool const is_real = m_voices[i] != INVALID_VOICE && m_audio_manager.IsPlaying(m_voices[i]) == true;
+
+        if (m_selected[i] == 0)
+        {
+            // Virtualise, the cursor carries on from where it is
+            if (is_real == true)
+            {
+                m_audio_manager.Stop(m_voices[i]);
+            }
+            m_voices[i] = INVALID_VOICE;
+            continue;
+        }
+
+        if (is_real == false)
+        {
+            SPlayParams params;
+            params.volume = m_gain[i];
+            params.pan = m_pan[i];
+            params.looping = m_looping[i] != 0;
+            params.start_frame = static_cast<size_t>(m_cursor[i]);
+
+            m_voices[i] = m_audio_manager.Play(*m_buffers[i], params);
+            m_sent_gain[i] = m_gain[i];
+            m_sent_pan[i] = m_pan[i];
+        }
+        else
+        {
+            if (std::fabs(m_gain[i] - m_sent_gain[i]) > GAIN_EPSILON)
+            {
+                m_audio_manager.SetVolume(m_voices[i], m_gain[i]);
+                m_sent_gain[i] = m_gain[i];
+            }
+            if (std::fabs(m_pan[i] - m_sent_pan[i]) > PAN_EPSILON)
+            {
+                m_audio_manager.SetPan(m_voices[i], m_pan[i]);
+                m_sent_pan[i] = m_pan[i];
+            }
+        }
+
+        if (m_voices[i] != INVALID_VOICE)
+        {
+            ++real_voices;
+        }
+    }
+
+    m_stats.emitters = m_alive_count;
+    m_stats.real_voices = real_voices;
+    m_stats.virtual_voices = m_alive_count - real_voices;
+}
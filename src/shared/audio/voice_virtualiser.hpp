@@ -0,0 +1,119 @@
+#pragma once
+
+#include "audio/audio_manager.hpp"
+#include "audio/sound_buffer.hpp"
+
+#include <glm/vec3.hpp>
+
+#include <cinttypes>
+#include <vector>
+
+namespace Audio
+{
+    struct SEmitterHandle
+    {
+        uint32_t index = UINT32_MAX;
+        uint32_t generation = 0;
+
+        bool operator==(SEmitterHandle const & rhs) const { return index == rhs.index && generation == rhs.generation; }
+        bool operator!=(SEmitterHandle const & rhs) const { return !(*this == rhs); }
+    };
+
+    constexpr SEmitterHandle INVALID_EMITTER = SEmitterHandle();
+
+    struct SEmitterParams
+    {
+        float volume = 1.0f;
+        // Scales audibility when picking which emitters get a real voice
+        float priority = 1.0f;
+        // Full volume inside min_distance, inverse distance falloff out to silence at max_distance
+        float min_distance = 1.0f;
+        float max_distance = 50.0f;
+        bool looping = false;
+    };
+
+    struct SVirtualisationStats
+    {
+        uint32_t emitters = 0;
+        uint32_t real_voices = 0;
+        uint32_t virtual_voices = 0;
+        float update_ms = 0.0f;
+    };
+
+    // Positional sounds that don't all get mixed. Every emitter keeps its own playback position,
+    // advanced with game time, but only the most audible (volume * attenuation * priority) get a
+    // real voice on the mixer; the rest are virtual and cost a few floats of bookkeeping. When a
+    // virtual emitter becomes audible enough it starts a voice at its current position, so
+    // thousands of emitters cost about the same to mix as the real voice limit.
+    class CVoiceVirtualiser
+    {
+    public:
+        explicit CVoiceVirtualiser(CAudioManager & audio_manager, uint32_t const max_real_voices = 64);
+        ~CVoiceVirtualiser();
+
+        CVoiceVirtualiser(CVoiceVirtualiser const &) = delete;
+        CVoiceVirtualiser & operator=(CVoiceVirtualiser const &) = delete;
+
+        // As with CAudioManager::Play the buffer has to outlive the emitter
+        SEmitterHandle Play(SSoundBuffer const & buffer, glm::vec3 const & position, SEmitterParams const & params = SEmitterParams());
+        void Stop(SEmitterHandle const emitter);
+        bool IsAlive(SEmitterHandle const emitter) const;
+        bool IsReal(SEmitterHandle const emitter) const;
+
+        void SetPosition(SEmitterHandle const emitter, glm::vec3 const & position);
+        void SetVolume(SEmitterHandle const emitter, float const volume);
+
+        // Right is used for panning and should be normalised
+        void SetListener(glm::vec3 const & position, glm::vec3 const & right);
+
+        void SetMaxRealVoices(uint32_t const max_real_voices);
+
+        // Once per frame after CAudioManager::Update
+        void Update(float const delta_seconds);
+
+        SVirtualisationStats GetStats() const { return m_stats; }
+
+    private:
+        uint32_t AllocateSlot();
+        void ReleaseSlot(uint32_t const slot);
+
+        void AdvancePlayback(float const delta_seconds);
+        void ScoreEmitters();
+        void AssignVoices();
+
+        CAudioManager & m_audio_manager;
+        uint32_t m_max_real_voices;
+
+        glm::vec3 m_listener_position;
+        glm::vec3 m_listener_right;
+
+        // Per emitter slot, structure of arrays so scoring runs straight down each one
+        std::vector<float> m_position_x;
+        std::vector<float> m_position_y;
+        std::vector<float> m_position_z;
+        std::vector<float> m_volume;
+        std::vector<float> m_priority;
+        std::vector<float> m_min_distance;
+        std::vector<float> m_max_distance;
+        std::vector<double> m_cursor;
+        std::vector<SSoundBuffer const *> m_buffers;
+        std::vector<uint8_t> m_looping;
+        std::vector<uint8_t> m_alive;
+        std::vector<uint32_t> m_generations;
+        std::vector<SVoiceHandle> m_voices;
+        std::vector<float> m_sent_gain;
+        std::vector<float> m_sent_pan;
+
+        // Rebuilt every update
+        std::vector<float> m_gain;
+        std::vector<float> m_pan;
+        std::vector<float> m_score;
+        std::vector<uint32_t> m_candidates;
+        std::vector<uint8_t> m_selected;
+
+        std::vector<uint32_t> m_free_slots;
+        uint32_t m_alive_count;
+
+        SVirtualisationStats m_stats;
+    };
+}
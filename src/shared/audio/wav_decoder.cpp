@@ -0,0 +1,438 @@
+#include "wav_decoder.hpp"
+
+#include "utility/logging.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace
+{
+    constexpr uint16_t WAVE_FORMAT_PCM = 0x0001;
+    constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+    constexpr uint16_t WAVE_FORMAT_IMA_ADPCM = 0x0011;
+    constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+    // Plain PCM is converted this many frames at a time
+    constexpr size_t PCM_READ_FRAMES = 1024;
+
+    constexpr int32_t ADPCM_INDEX_TABLE[16] = {
+        -1, -1, -1, -1, 2, 4, 6, 8,
+        -1, -1, -1, -1, 2, 4, 6, 8
+    };
+
+    constexpr int32_t ADPCM_STEP_TABLE[89] = {
+        7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+        50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+        253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+        1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+        3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+        12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+    };
+
+    uint16_t read_u16(uint8_t const * bytes)
+    {
+        return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+    }
+
+    uint32_t read_u32(uint8_t const * bytes)
+    {
+        return static_cast<uint32_t>(bytes[0]) |
+               (static_cast<uint32_t>(bytes[1]) << 8) |
+               (static_cast<uint32_t>(bytes[2]) << 16) |
+               (static_cast<uint32_t>(bytes[3]) << 24);
+    }
+
+    bool read_bytes(std::istream & stream, uint8_t * bytes, size_t const count)
+    {
+        stream.read(reinterpret_cast<char *>(bytes), static_cast<std::streamsize>(count));
+        return static_cast<size_t>(stream.gcount()) == count;
+    }
+
+    float decode_pcm_sample(uint8_t const * bytes, uint32_t const bits_per_sample)
+    {
+        switch (bits_per_sample)
+        {
+            case 8:
+                return (static_cast<float>(bytes[0]) - 128.0f) * (1.0f / 128.0f);
+            case 16:
+                return static_cast<float>(static_cast<int16_t>(read_u16(bytes))) * (1.0f / 32768.0f);
+            case 24:
+            {
+                // Shift up into the top of an int32 so the sign comes along
+                int32_t const value = static_cast<int32_t>((static_cast<uint32_t>(bytes[0]) << 8) |
+                                                           (static_cast<uint32_t>(bytes[1]) << 16) |
+                                                           (static_cast<uint32_t>(bytes[2]) << 24));
+                return static_cast<float>(value) * (1.0f / 2147483648.0f);
+            }
+            case 32:
+                return static_cast<float>(static_cast<int32_t>(read_u32(bytes))) * (1.0f / 2147483648.0f);
+        }
+        return 0.0f;
+    }
+
+    struct SAdpcmChannelState
+    {
+        int32_t predictor;
+        int32_t step_index;
+    };
+
+    int16_t decode_adpcm_nibble(SAdpcmChannelState & state, uint8_t const nibble)
+    {
+        int32_t const step = ADPCM_STEP_TABLE[state.step_index];
+
+        int32_t diff = step >> 3;
+        if ((nibble & 1) != 0) { diff += step >> 2; }
+        if ((nibble & 2) != 0) { diff += step >> 1; }
+        if ((nibble & 4) != 0) { diff += step; }
+
+        state.predictor += (nibble & 8) != 0 ? -diff : diff;
+        state.predictor = std::min(std::max(state.predictor, -32768), 32767);
+        state.step_index = std::min(std::max(state.step_index + ADPCM_INDEX_TABLE[nibble], 0), 88);
+
+        return static_cast<int16_t>(state.predictor);
+    }
+}
+
+Audio::CWavDecoder::CWavDecoder()
+: m_stream()
+, m_encoding(EEncoding::Pcm)
+, m_sample_rate(0)
+, m_channels(0)
+, m_bits_per_sample(0)
+, m_block_align(0)
+, m_frames_per_block(0)
+, m_frame_count(0)
+, m_data_offset(0)
+, m_data_size(0)
+, m_data_read(0)
+, m_frames_read(0)
+, m_raw()
+, m_block()
+, m_block_frames(0)
+, m_block_cursor(0)
+{
+}
+
+Audio::CWavDecoder::~CWavDecoder()
+{
+}
+
+bool Audio::CWavDecoder::Open(std::unique_ptr<std::istream> stream)
+{
+    m_stream = std::move(stream);
+    if (m_stream == nullptr || ReadHeader() == false)
+    {
+        m_stream = nullptr;
+        return false;
+    }
+    return Rewind();
+}
+
+bool Audio::CWavDecoder::IsWav(std::istream & stream)
+{
+    std::streampos const position = stream.tellg();
+
+    uint8_t header[12] = {};
+    bool const is_wav = read_bytes(stream, header, sizeof(header)) &&
+                        std::memcmp(header, "RIFF", 4) == 0 &&
+                        std::memcmp(header + 8, "WAVE", 4) == 0;
+
+    stream.clear();
+    stream.seekg(position);
+    return is_wav;
+}
+
+bool Audio::CWavDecoder::ReadHeader()
+{
+    uint8_t header[12] = {};
+    if (read_bytes(*m_stream, header, sizeof(header)) == false ||
+        std::memcmp(header, "RIFF", 4) != 0 ||
+        std::memcmp(header + 8, "WAVE", 4) != 0)
+    {
+        ERROR_LOG("Not a RIFF WAVE file");
+        return false;
+    }
+
+    bool found_format = false;
+    uint16_t format_tag = 0;
+    uint32_t fact_frames = 0;
+
+    // Walk the chunks until the data, anything we don't know about gets skipped
+    uint8_t chunk_header[8] = {};
+    while (read_bytes(*m_stream, chunk_header, sizeof(chunk_header)) == true)
+    {
+        uint32_t const chunk_size = read_u32(chunk_header + 4);
+
+        if (std::memcmp(chunk_header, "fmt ", 4) == 0)
+        {
+            std::vector<uint8_t> format(std::max<uint32_t>(chunk_size, 16));
+            if (chunk_size < 16 || read_bytes(*m_stream, format.data(), chunk_size) == false)
+            {
+                ERROR_LOG("Truncated WAVE format chunk");
+                return false;
+            }
+
+            format_tag = read_u16(format.data());
+            m_channels = read_u16(format.data() + 2);
+            m_sample_rate = read_u32(format.data() + 4);
+            m_block_align = read_u16(format.data() + 12);
+            m_bits_per_sample = read_u16(format.data() + 14);
+
+            // The real format is the first two bytes of the sub format GUID
+            if (format_tag == WAVE_FORMAT_EXTENSIBLE && chunk_size >= 26)
+            {
+                format_tag = read_u16(format.data() + 24);
+            }
+
+            if (format_tag == WAVE_FORMAT_IMA_ADPCM && chunk_size >= 20)
+            {
+                m_frames_per_block = read_u16(format.data() + 18);
+            }
+            found_format = true;
+        }
+        else if (std::memcmp(chunk_header, "fact", 4) == 0 && chunk_size >= 4)
+        {
+            uint8_t fact[4] = {};
+            if (read_bytes(*m_stream, fact, sizeof(fact)) == false)
+            {
+                return false;
+            }
+            fact_frames = read_u32(fact);
+            m_stream->seekg(chunk_size - 4, std::ios::cur);
+        }
+        else if (std::memcmp(chunk_header, "data", 4) == 0)
+        {
+            m_data_offset = m_stream->tellg();
+            m_data_size = chunk_size;
+            break;
+        }
+        else
+        {
+            m_stream->seekg(chunk_size, std::ios::cur);
+        }
+
+        // Chunks are word aligned
+        if ((chunk_size & 1) != 0)
+        {
+            m_stream->seekg(1, std::ios::cur);
+        }
+    }
+
+    if (found_format == false || m_data_offset == 0)
+    {
+        ERROR_LOG("WAVE file is missing its format or data chunk");
+        return false;
+    }
+
+    if (m_channels == 0 || m_channels > MAX_SOURCE_CHANNELS)
+    {
+        ERROR_LOG("Unsupported WAVE channel count: " + std::to_string(m_channels));
+        return false;
+    }
+
+    if (format_tag == WAVE_FORMAT_PCM &&
+        (m_bits_per_sample == 8 || m_bits_per_sample == 16 || m_bits_per_sample == 24 || m_bits_per_sample == 32))
+    {
+        m_encoding = EEncoding::Pcm;
+    }
+    else if (format_tag == WAVE_FORMAT_IEEE_FLOAT && m_bits_per_sample == 32)
+    {
+        m_encoding = EEncoding::Float;
+    }
+    else if (format_tag == WAVE_FORMAT_IMA_ADPCM && m_bits_per_sample == 4 && m_block_align > 4 * m_channels)
+    {
+        m_encoding = EEncoding::ImaAdpcm;
+    }
+    else
+    {
+        ERROR_LOG("Unsupported WAVE encoding: format " + std::to_string(format_tag) + ", " +
+                  std::to_string(m_bits_per_sample) + " bits");
+        return false;
+    }
+
+    if (m_encoding == EEncoding::ImaAdpcm)
+    {
+        // Each channel has a 4 byte header holding the first sample, then two samples a byte
+        uint32_t const frames_in_block = (m_block_align - 4 * m_channels) * 2 / m_channels + 1;
+        if (m_frames_per_block == 0 || m_frames_per_block > frames_in_block)
+        {
+            m_frames_per_block = frames_in_block;
+        }
+
+        size_t const full_blocks = m_data_size / m_block_align;
+        size_t const tail_bytes = m_data_size % m_block_align;
+        m_frame_count = full_blocks * m_frames_per_block;
+        if (tail_bytes > 4 * m_channels)
+        {
+            m_frame_count += (tail_bytes - 4 * m_channels) * 2 / m_channels + 1;
+        }
+
+        // The fact chunk knows about any padding in the last block
+        if (fact_frames > 0)
+        {
+            m_frame_count = std::min<size_t>(m_frame_count, fact_frames);
+        }
+
+        m_raw.resize(m_block_align);
+        m_block.resize(static_cast<size_t>(m_frames_per_block) * m_channels);
+    }
+    else
+    {
+        m_block_align = m_channels * (m_bits_per_sample / 8);
+        m_frame_count = m_data_size / m_block_align;
+        m_raw.resize(PCM_READ_FRAMES * m_block_align);
+    }
+
+    return true;
+}
+
+size_t Audio::CWavDecoder::Read(float * const * channels, size_t const frame_count)
+{
+    if (m_stream == nullptr)
+    {
+        return 0;
+    }
+
+    size_t const frames = std::min(frame_count, m_frame_count - m_frames_read);
+    size_t const read = m_encoding == EEncoding::ImaAdpcm ? ReadAdpcm(channels, frames)
+                                                          : ReadPcm(channels, frames);
+    m_frames_read += read;
+    return read;
+}
+
+bool Audio::CWavDecoder::Rewind()
+{
+    if (m_stream == nullptr)
+    {
+        return false;
+    }
+
+    m_stream->clear();
+    m_stream->seekg(m_data_offset);
+    m_data_read = 0;
+    m_frames_read = 0;
+    m_block_frames = 0;
+    m_block_cursor = 0;
+    return m_stream->good();
+}
+
+size_t Audio::CWavDecoder::ReadPcm(float * const * channels, size_t const frame_count)
+{
+    size_t done = 0;
+    while (done < frame_count)
+    {
+        size_t const frames = std::min(frame_count - done, PCM_READ_FRAMES);
+        size_t const bytes = frames * m_block_align;
+
+        m_stream->read(reinterpret_cast<char *>(m_raw.data()), static_cast<std::streamsize>(bytes));
+        size_t const frames_read = static_cast<size_t>(m_stream->gcount()) / m_block_align;
+        m_data_read += frames_read * m_block_align;
+
+        uint32_t const sample_bytes = m_bits_per_sample / 8;
+        for (uint32_t channel = 0; channel < m_channels; ++channel)
+        {
+            float * dst = channels[channel] + done;
+            uint8_t const * src = m_raw.data() + channel * sample_bytes;
+
+            if (m_encoding == EEncoding::Float)
+            {
+                for (size_t frame = 0; frame < frames_read; ++frame)
+                {
+                    std::memcpy(&dst[frame], src + frame * m_block_align, sizeof(float));
+                }
+            }
+            else
+            {
+                for (size_t frame = 0; frame < frames_read; ++frame)
+                {
+                    dst[frame] = decode_pcm_sample(src + frame * m_block_align, m_bits_per_sample);
+                }
+            }
+        }
+
+        done += frames_read;
+        if (frames_read < frames)
+        {
+            break;
+        }
+    }
+    return done;
+}
+
+size_t Audio::CWavDecoder::ReadAdpcm(float * const * channels, size_t const frame_count)
+{
+    size_t done = 0;
+    while (done < frame_count)
+    {
+        if (m_block_cursor == m_block_frames && DecodeAdpcmBlock() == false)
+        {
+            break;
+        }
+
+        size_t const frames = std::min(frame_count - done, m_block_frames - m_block_cursor);
+        for (uint32_t channel = 0; channel < m_channels; ++channel)
+        {
+            float const * src = m_block.data() + channel * m_frames_per_block + m_block_cursor;
+            std::copy(src, src + frames, channels[channel] + done);
+        }
+
+        m_block_cursor += frames;
+        done += frames;
+    }
+    return done;
+}
+
+bool Audio::CWavDecoder::DecodeAdpcmBlock()
+{
+    size_t const bytes = std::min<size_t>(m_block_align, m_data_size - m_data_read);
+    if (bytes <= 4 * m_channels || read_bytes(*m_stream, m_raw.data(), bytes) == false)
+    {
+        return false;
+    }
+    m_data_read += bytes;
+
+    SAdpcmChannelState states[MAX_SOURCE_CHANNELS] = {};
+    for (uint32_t channel = 0; channel < m_channels; ++channel)
+    {
+        uint8_t const * header = m_raw.data() + channel * 4;
+        states[channel].predictor = static_cast<int16_t>(read_u16(header));
+        states[channel].step_index = std::min<int32_t>(header[2], 88);
+
+        m_block[channel * m_frames_per_block] = static_cast<float>(states[channel].predictor) * (1.0f / 32768.0f);
+    }
+
+    // After the headers the channels take turns with 4 bytes (8 samples) each
+    size_t const frames_in_block = std::min<size_t>((bytes - 4 * m_channels) * 2 / m_channels + 1, m_frames_per_block);
+    uint8_t const * data = m_raw.data() + 4 * m_channels;
+    size_t frame = 1;
+    while (frame < frames_in_block)
+    {
+        for (uint32_t channel = 0; channel < m_channels; ++channel)
+        {
+            float * dst = m_block.data() + channel * m_frames_per_block;
+            for (size_t byte = 0; byte < 4; ++byte)
+            {
+                uint8_t const packed = data[channel * 4 + byte];
+                size_t const index = frame + byte * 2;
+
+                int16_t const low = decode_adpcm_nibble(states[channel], packed & 0x0F);
+                int16_t const high = decode_adpcm_nibble(states[channel], packed >> 4);
+                if (index < frames_in_block)
+                {
+                    dst[index] = static_cast<float>(low) * (1.0f / 32768.0f);
+                }
+                if (index + 1 < frames_in_block)
+                {
+                    dst[index + 1] = static_cast<float>(high) * (1.0f / 32768.0f);
+                }
+            }
+        }
+        data += 4 * m_channels;
+        frame += 8;
+    }
+
+    m_block_frames = frames_in_block;
+    m_block_cursor = 0;
+    return true;
+}
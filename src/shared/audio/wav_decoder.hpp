@@ -0,0 +1,66 @@
+#pragma once
+
+#include "audio/audio_decoder.hpp"
+
+#include <cinttypes>
+#include <istream>
+#include <memory>
+#include <vector>
+
+namespace Audio
+{
+    // RIFF WAVE reader for integer PCM (8, 16, 24 and 32 bit), 32 bit float and IMA ADPCM, which
+    // gives 4:1 compression for music that would be too big as plain PCM
+    class CWavDecoder : public IAudioDecoder
+    {
+    public:
+        CWavDecoder();
+        virtual ~CWavDecoder();
+
+        bool Open(std::unique_ptr<std::istream> stream);
+
+        virtual uint32_t GetSampleRate() const override { return m_sample_rate; }
+        virtual uint32_t GetChannels() const override { return m_channels; }
+        virtual size_t GetFrameCount() const override { return m_frame_count; }
+
+        virtual size_t Read(float * const * channels, size_t const frame_count) override;
+        virtual bool Rewind() override;
+
+        // True if the stream starts with a RIFF WAVE header, doesn't move the read position
+        static bool IsWav(std::istream & stream);
+
+    private:
+        enum class EEncoding : uint8_t
+        {
+            Pcm,
+            Float,
+            ImaAdpcm
+        };
+
+        bool ReadHeader();
+        size_t ReadPcm(float * const * channels, size_t const frame_count);
+        size_t ReadAdpcm(float * const * channels, size_t const frame_count);
+        bool DecodeAdpcmBlock();
+
+        std::unique_ptr<std::istream> m_stream;
+
+        EEncoding m_encoding;
+        uint32_t m_sample_rate;
+        uint32_t m_channels;
+        uint32_t m_bits_per_sample;
+        uint32_t m_block_align;
+        uint32_t m_frames_per_block;
+        size_t m_frame_count;
+
+        std::streamoff m_data_offset;
+        size_t m_data_size;
+        size_t m_data_read;
+        size_t m_frames_read;
+
+        // Raw bytes for the current read, then for ADPCM the decoded block being served from
+        std::vector<uint8_t> m_raw;
+        std::vector<float> m_block;
+        size_t m_block_frames;
+        size_t m_block_cursor;
+    };
+}
@@ -0,0 +1,154 @@
+#include "archetype.hpp"
+
+#include "utility/logging.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+
+namespace
+{
+    size_t align_up(size_t const value, size_t const alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+constexpr uint32_t ECS::CArchetype::INVALID_COLUMN;
+
+ECS::CArchetype::CArchetype(ComponentMask const mask)
+: add_edges()
+, remove_edges()
+, m_mask(mask)
+, m_types()
+, m_column_sizes()
+, m_column_offsets()
+, m_chunk_capacity(0)
+, m_entity_count(0)
+, m_chunks()
+{
+    std::fill(std::begin(m_column_lookup), std::end(m_column_lookup), INVALID_COLUMN);
+
+    size_t bytes_per_entity = sizeof(SEntity);
+    for (ComponentTypeId type = 0; type < MAX_COMPONENT_TYPES; ++type)
+    {
+        if ((mask & component_bit(type)) != 0)
+        {
+            SComponentInfo const & info = get_component_info(type);
+            assert(info.alignment <= alignof(std::max_align_t));
+
+            m_column_lookup[type] = static_cast<uint32_t>(m_types.size());
+            m_types.push_back(type);
+            m_column_sizes.push_back(info.size);
+            bytes_per_entity += info.size;
+        }
+    }
+
+    // Start from the unpadded estimate and shrink until the aligned layout fits in a chunk
+    uint32_t capacity = static_cast<uint32_t>(CHUNK_SIZE / bytes_per_entity);
+    while (capacity > 0)
+    {
+        size_t offset = sizeof(SEntity) * capacity;
+        m_column_offsets.clear();
+        for (ComponentTypeId const type : m_types)
+        {
+            SComponentInfo const & info = get_component_info(type);
+            offset = align_up(offset, info.alignment);
+            m_column_offsets.push_back(static_cast<uint32_t>(offset));
+            offset += info.size * capacity;
+        }
+
+        if (offset <= CHUNK_SIZE)
+        {
+            break;
+        }
+        --capacity;
+    }
+
+    if (capacity == 0)
+    {
+        ERROR_LOG("Archetype components don't fit in a single chunk");
+        assert(false);
+    }
+    m_chunk_capacity = capacity;
+}
+
+void * ECS::CArchetype::GetComponent(uint32_t const chunk, uint32_t const row, uint32_t const column)
+{
+    return static_cast<uint8_t *>(GetColumnData(m_chunks[chunk], column)) + m_column_sizes[column] * row;
+}
+
+void ECS::CArchetype::Allocate(SEntity const entity, uint32_t & out_chunk, uint32_t & out_row)
+{
+    if (m_chunks.empty() == true || m_chunks.back().count == m_chunk_capacity)
+    {
+        SChunk chunk;
+        chunk.memory.reset(new std::max_align_t[CHUNK_SIZE / sizeof(std::max_align_t)]);
+        m_chunks.emplace_back(std::move(chunk));
+    }
+
+    SChunk & chunk = m_chunks.back();
+    uint32_t const row = chunk.count++;
+
+    GetEntities(chunk)[row] = entity;
+    for (uint32_t column = 0; column < m_types.size(); ++column)
+    {
+        std::memset(static_cast<uint8_t *>(GetColumnData(chunk, column)) + m_column_sizes[column] * row,
+                    0,
+                    m_column_sizes[column]);
+    }
+
+    ++m_entity_count;
+    out_chunk = static_cast<uint32_t>(m_chunks.size() - 1);
+    out_row = row;
+}
+
+ECS::SEntity ECS::CArchetype::Remove(uint32_t const chunk_index, uint32_t const row)
+{
+    assert(chunk_index < m_chunks.size() && row < m_chunks[chunk_index].count);
+
+    SChunk & last_chunk = m_chunks.back();
+    uint32_t const last_chunk_index = static_cast<uint32_t>(m_chunks.size() - 1);
+    uint32_t const last_row = last_chunk.count - 1;
+
+    SEntity moved = INVALID_ENTITY;
+    if (chunk_index != last_chunk_index || row != last_row)
+    {
+        SChunk & chunk = m_chunks[chunk_index];
+        moved = GetEntities(last_chunk)[last_row];
+        GetEntities(chunk)[row] = moved;
+
+        for (uint32_t column = 0; column < m_types.size(); ++column)
+        {
+            uint32_t const size = m_column_sizes[column];
+            std::memcpy(static_cast<uint8_t *>(GetColumnData(chunk, column)) + size * row,
+                        static_cast<uint8_t *>(GetColumnData(last_chunk, column)) + size * last_row,
+                        size);
+        }
+    }
+
+    --last_chunk.count;
+    --m_entity_count;
+
+    if (last_chunk.count == 0)
+    {
+        m_chunks.pop_back();
+    }
+    return moved;
+}
+
+void ECS::CArchetype::CopySharedComponents(CArchetype & src, uint32_t const src_chunk, uint32_t const src_row,
+                                           CArchetype & dst, uint32_t const dst_chunk, uint32_t const dst_row)
+{
+    for (uint32_t src_column = 0; src_column < src.m_types.size(); ++src_column)
+    {
+        uint32_t const dst_column = dst.GetColumn(src.m_types[src_column]);
+        if (dst_column != INVALID_COLUMN)
+        {
+            std::memcpy(dst.GetComponent(dst_chunk, dst_row, dst_column),
+                        src.GetComponent(src_chunk, src_row, src_column),
+                        src.m_column_sizes[src_column]);
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "ecs/ecs_types.hpp"
+
+namespace ECS
+{
+    struct SChunk
+    {
+        std::unique_ptr<std::max_align_t[]> memory;
+        uint32_t count = 0;
+
+        uint8_t * Data() { return reinterpret_cast<uint8_t *>(memory.get()); }
+        uint8_t const * Data() const { return reinterpret_cast<uint8_t const *>(memory.get()); }
+    };
+
+    // All entities with exactly the same set of components. Each chunk holds an entity array
+    // followed by one tightly packed array per component, and every chunk apart from the last is
+    // kept full so iterating an archetype touches nothing but dense component data.
+    class CArchetype
+    {
+    public:
+        static constexpr uint32_t INVALID_COLUMN = UINT32_MAX;
+
+        CArchetype(ComponentMask const mask);
+
+        ComponentMask GetMask() const { return m_mask; }
+        std::vector<ComponentTypeId> const & GetComponentTypes() const { return m_types; }
+
+        uint32_t GetChunkCapacity() const { return m_chunk_capacity; }
+        size_t GetChunkCount() const { return m_chunks.size(); }
+        size_t GetEntityCount() const { return m_entity_count; }
+
+        SChunk & GetChunk(size_t const chunk) { return m_chunks[chunk]; }
+        SChunk const & GetChunk(size_t const chunk) const { return m_chunks[chunk]; }
+
+        // Column of the component within this archetype or INVALID_COLUMN if it isn't present
+        uint32_t GetColumn(ComponentTypeId const type) const { return m_column_lookup[type]; }
+
+        SEntity * GetEntities(SChunk & chunk) const { return reinterpret_cast<SEntity *>(chunk.Data()); }
+        void * GetColumnData(SChunk & chunk, uint32_t const column) const { return chunk.Data() + m_column_offsets[column]; }
+        void * GetComponent(uint32_t const chunk, uint32_t const row, uint32_t const column);
+
+        // Appends an entity with zeroed components, returns its chunk and row
+        void Allocate(SEntity const entity, uint32_t & out_chunk, uint32_t & out_row);
+
+        // Swap removes the row with the last entity in the archetype. Returns the entity that was
+        // moved into the row so its record can be patched, or INVALID_ENTITY if nothing moved.
+        SEntity Remove(uint32_t const chunk, uint32_t const row);
+
+        // Copies every component both archetypes share from one row to another
+        static void CopySharedComponents(CArchetype & src, uint32_t const src_chunk, uint32_t const src_row,
+                                         CArchetype & dst, uint32_t const dst_chunk, uint32_t const dst_row);
+
+        // Cached transitions to the archetype with one component added or removed
+        std::unordered_map<ComponentTypeId, CArchetype *> add_edges;
+        std::unordered_map<ComponentTypeId, CArchetype *> remove_edges;
+
+    private:
+        ComponentMask m_mask;
+        std::vector<ComponentTypeId> m_types;
+        std::vector<uint32_t> m_column_sizes;
+        std::vector<uint32_t> m_column_offsets;
+        uint32_t m_column_lookup[MAX_COMPONENT_TYPES];
+
+        uint32_t m_chunk_capacity;
+        size_t m_entity_count;
+        std::vector<SChunk> m_chunks;
+    };
+}
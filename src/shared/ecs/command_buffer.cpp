@@ -0,0 +1,82 @@
+#include "command_buffer.hpp"
+
+#include "ecs/world.hpp"
+
+void ECS::CCommandBuffer::DestroyEntity(SEntity const entity)
+{
+    PushCommand(ECommandType::Destroy, entity, 0, m_payload.size());
+}
+
+void ECS::CCommandBuffer::Playback(CWorld & world)
+{
+    for (SCommand const & command : m_commands)
+    {
+        switch (command.type)
+        {
+            case ECommandType::Create:
+            {
+                SEntity const entity = world.CreateEntityRaw(command.mask);
+
+                uint32_t offset = command.payload_offset;
+                uint32_t const payload_end = command.payload_offset + command.payload_size;
+                while (offset < payload_end)
+                {
+                    SComponentHeader header;
+                    std::memcpy(&header, m_payload.data() + offset, sizeof(SComponentHeader));
+                    offset += sizeof(SComponentHeader);
+
+                    std::memcpy(world.GetComponentRaw(entity, header.type), m_payload.data() + offset, header.size);
+                    offset += header.size;
+                }
+                break;
+            }
+            case ECommandType::Destroy:
+            {
+                world.DestroyEntity(command.entity);
+                break;
+            }
+            case ECommandType::AddComponent:
+            {
+                SComponentHeader header;
+                std::memcpy(&header, m_payload.data() + command.payload_offset, sizeof(SComponentHeader));
+
+                void * data = world.AddComponentRaw(command.entity, header.type);
+                if (data != nullptr)
+                {
+                    std::memcpy(data, m_payload.data() + command.payload_offset + sizeof(SComponentHeader), header.size);
+                }
+                break;
+            }
+            case ECommandType::RemoveComponent:
+            {
+                for (ComponentTypeId type = 0; type < MAX_COMPONENT_TYPES; ++type)
+                {
+                    if ((command.mask & component_bit(type)) != 0)
+                    {
+                        world.RemoveComponentRaw(command.entity, type);
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    Clear();
+}
+
+void ECS::CCommandBuffer::Clear()
+{
+    m_commands.clear();
+    m_payload.clear();
+}
+
+void ECS::CCommandBuffer::PushCommand(ECommandType const type, SEntity const entity, ComponentMask const mask, size_t const payload_begin)
+{
+    SCommand command;
+    command.type = type;
+    command.entity = entity;
+    command.mask = mask;
+    command.payload_offset = static_cast<uint32_t>(payload_begin);
+    command.payload_size = static_cast<uint32_t>(m_payload.size() - payload_begin);
+    m_commands.push_back(command);
+}
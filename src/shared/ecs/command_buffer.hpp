@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstring>
+#include <vector>
+
+#include "ecs/ecs_types.hpp"
+
+namespace ECS
+{
+    class CWorld;
+
+    // Records structural changes so they can be made while iterating queries or from inside
+    // parallel systems, then applied in recorded order by Playback. Component values are copied
+    // into a flat byte buffer so recording never allocates per command once the buffers have grown.
+    class CCommandBuffer
+    {
+    public:
+        template <typename... Ts>
+        void CreateEntity(Ts const & ... components);
+
+        void DestroyEntity(SEntity const entity);
+
+        template <typename T>
+        void AddComponent(SEntity const entity, T const & component);
+
+        template <typename T>
+        void RemoveComponent(SEntity const entity);
+
+        void Playback(CWorld & world);
+
+        bool IsEmpty() const { return m_commands.empty(); }
+        void Clear();
+
+    private:
+        enum class ECommandType : uint8_t
+        {
+            Create,
+            Destroy,
+            AddComponent,
+            RemoveComponent
+        };
+
+        struct SCommand
+        {
+            ECommandType type;
+            SEntity entity;
+            ComponentMask mask;
+            uint32_t payload_offset;
+            uint32_t payload_size;
+        };
+
+        // Payload of one component, create commands hold several of these back to back
+        struct SComponentHeader
+        {
+            ComponentTypeId type;
+            uint32_t size;
+        };
+
+        template <typename T>
+        void WritePayload(T const & component)
+        {
+            SComponentHeader header;
+            header.type = component_type_id<T>();
+            header.size = static_cast<uint32_t>(sizeof(T));
+
+            size_t const offset = m_payload.size();
+            m_payload.resize(offset + sizeof(SComponentHeader) + sizeof(T));
+            std::memcpy(m_payload.data() + offset, &header, sizeof(SComponentHeader));
+            std::memcpy(m_payload.data() + offset + sizeof(SComponentHeader), &component, sizeof(T));
+        }
+
+        void PushCommand(ECommandType const type, SEntity const entity, ComponentMask const mask, size_t const payload_begin);
+
+        std::vector<SCommand> m_commands;
+        std::vector<uint8_t> m_payload;
+    };
+
+    template <typename... Ts>
+    void CCommandBuffer::CreateEntity(Ts const & ... components)
+    {
+        size_t const payload_begin = m_payload.size();
+
+        using expand = int[];
+        (void)expand{ 0, (WritePayload(components), 0)... };
+
+        PushCommand(ECommandType::Create, INVALID_ENTITY, component_mask<Ts...>(), payload_begin);
+    }
+
+    template <typename T>
+    void CCommandBuffer::AddComponent(SEntity const entity, T const & component)
+    {
+        size_t const payload_begin = m_payload.size();
+        WritePayload(component);
+        PushCommand(ECommandType::AddComponent, entity, component_mask<T>(), payload_begin);
+    }
+
+    template <typename T>
+    void CCommandBuffer::RemoveComponent(SEntity const entity)
+    {
+        PushCommand(ECommandType::RemoveComponent, entity, component_mask<T>(), m_payload.size());
+    }
+}
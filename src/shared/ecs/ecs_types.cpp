@@ -0,0 +1,38 @@
+#include "ecs_types.hpp"
+
+#include "utility/logging.hpp"
+
+#include <cassert>
+#include <mutex>
+
+namespace
+{
+    std::mutex registry_mutex;
+    ECS::SComponentInfo component_infos[ECS::MAX_COMPONENT_TYPES];
+    uint32_t component_type_count = 0;
+}
+
+ECS::ComponentTypeId ECS::register_component_type(char const * name, uint32_t const size, uint32_t const alignment)
+{
+    std::lock_guard<std::mutex> lock(registry_mutex);
+
+    if (component_type_count >= MAX_COMPONENT_TYPES)
+    {
+        ERROR_LOG("Too many ECS component types registered");
+        assert(false);
+        return MAX_COMPONENT_TYPES - 1;
+    }
+
+    SComponentInfo & info = component_infos[component_type_count];
+    info.name = name;
+    info.size = size;
+    info.alignment = alignment;
+
+    return component_type_count++;
+}
+
+ECS::SComponentInfo const & ECS::get_component_info(ComponentTypeId const id)
+{
+    assert(id < MAX_COMPONENT_TYPES);
+    return component_infos[id];
+}
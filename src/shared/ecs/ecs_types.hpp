@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <type_traits>
+#include <typeinfo>
+
+namespace ECS
+{
+    struct SEntity
+    {
+        uint32_t index = UINT32_MAX;
+        uint32_t generation = 0;
+
+        bool operator==(SEntity const & rhs) const { return index == rhs.index && generation == rhs.generation; }
+        bool operator!=(SEntity const & rhs) const { return !(*this == rhs); }
+    };
+
+    constexpr SEntity INVALID_ENTITY = SEntity();
+
+    using ComponentTypeId = uint32_t;
+    using ComponentMask = uint64_t;
+
+    constexpr uint32_t MAX_COMPONENT_TYPES = 64;
+
+    // Every archetype stores its entities in fixed size chunks
+    constexpr size_t CHUNK_SIZE = 16 * 1024;
+
+    struct SComponentInfo
+    {
+        char const * name = nullptr;
+        uint32_t size = 0;
+        uint32_t alignment = 0;
+    };
+
+    // Assigns the next free id, use component_type_id<T>() rather than calling this directly
+    ComponentTypeId register_component_type(char const * name, uint32_t const size, uint32_t const alignment);
+    SComponentInfo const & get_component_info(ComponentTypeId const id);
+
+    // Components are plain data, which lets chunks move them around with memcpy and lets command
+    // buffers store them as raw bytes. Anything owning resources should hold a handle instead.
+    template <typename T>
+    ComponentTypeId component_type_id()
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "ECS components must be trivially copyable");
+        static ComponentTypeId const id = register_component_type(typeid(T).name(),
+                                                                  static_cast<uint32_t>(sizeof(T)),
+                                                                  static_cast<uint32_t>(alignof(T)));
+        return id;
+    }
+
+    inline ComponentMask component_bit(ComponentTypeId const id)
+    {
+        return ComponentMask(1) << id;
+    }
+
+    template <typename... Ts>
+    ComponentMask component_mask()
+    {
+        ComponentMask mask = 0;
+        using expand = int[];
+        (void)expand{ 0, (mask |= component_bit(component_type_id<Ts>()), 0)... };
+        return mask;
+    }
+}
@@ -0,0 +1,34 @@
+#include "query.hpp"
+
+ECS::CQuery::CQuery(ComponentMask const required, ComponentMask const excluded)
+: m_required(required)
+, m_excluded(excluded)
+, m_archetypes_checked(0)
+, m_archetypes()
+{
+}
+
+std::vector<ECS::CArchetype *> const & ECS::CQuery::GetArchetypes(CWorld & world)
+{
+    size_t const archetype_count = world.GetArchetypeCount();
+    for (; m_archetypes_checked < archetype_count; ++m_archetypes_checked)
+    {
+        CArchetype & archetype = world.GetArchetype(m_archetypes_checked);
+        ComponentMask const mask = archetype.GetMask();
+        if ((mask & m_required) == m_required && (mask & m_excluded) == 0)
+        {
+            m_archetypes.push_back(&archetype);
+        }
+    }
+    return m_archetypes;
+}
+
+size_t ECS::CQuery::CountEntities(CWorld & world)
+{
+    size_t count = 0;
+    for (CArchetype const * archetype : GetArchetypes(world))
+    {
+        count += archetype->GetEntityCount();
+    }
+    return count;
+}
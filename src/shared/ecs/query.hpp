@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "ecs/archetype.hpp"
+#include "ecs/ecs_types.hpp"
+#include "ecs/world.hpp"
+#include "utility/parallel_for.hpp"
+
+namespace ECS
+{
+    // Matches every archetype containing all of the required components and none of the excluded
+    // ones. The matching archetype list is cached and only new archetypes are checked on later
+    // calls, so a query object should be kept around (e.g. as a system member) rather than
+    // rebuilt every frame.
+    class CQuery
+    {
+    public:
+        CQuery(ComponentMask const required, ComponentMask const excluded = 0);
+
+        template <typename... Ts>
+        static CQuery Create(ComponentMask const excluded = 0)
+        {
+            return CQuery(component_mask<Ts...>(), excluded);
+        }
+
+        std::vector<CArchetype *> const & GetArchetypes(CWorld & world);
+        size_t CountEntities(CWorld & world);
+
+        // func(size_t count, SEntity const * entities, Ts * ... components) per chunk
+        template <typename... Ts, typename Func>
+        void ForEachChunk(CWorld & world, Func && func);
+
+        // func(SEntity entity, Ts & ... components) per entity
+        template <typename... Ts, typename Func>
+        void ForEach(CWorld & world, Func && func);
+
+        // As ForEachChunk but chunks are spread across the worker threads, func must be thread safe
+        template <typename... Ts, typename Func>
+        void ParallelForEachChunk(CWorld & world, Func && func);
+
+    private:
+        template <typename... Ts, typename Func, size_t... Is>
+        static void InvokeChunk(CArchetype & archetype,
+                                SChunk & chunk,
+                                uint32_t const * columns,
+                                Func & func,
+                                std::index_sequence<Is...>)
+        {
+            (void)columns;
+            func(static_cast<size_t>(chunk.count),
+                 static_cast<SEntity const *>(archetype.GetEntities(chunk)),
+                 static_cast<Ts *>(archetype.GetColumnData(chunk, columns[Is]))...);
+        }
+
+        template <typename... Ts>
+        static void GetColumns(CArchetype const & archetype, uint32_t * columns)
+        {
+            ComponentTypeId const types[] = { component_type_id<Ts>()..., 0 };
+            for (size_t i = 0; i < sizeof...(Ts); ++i)
+            {
+                columns[i] = archetype.GetColumn(types[i]);
+            }
+        }
+
+        ComponentMask m_required;
+        ComponentMask m_excluded;
+        size_t m_archetypes_checked;
+        std::vector<CArchetype *> m_archetypes;
+    };
+
+    template <typename... Ts, typename Func>
+    void CQuery::ForEachChunk(CWorld & world, Func && func)
+    {
+        uint32_t columns[sizeof...(Ts) + 1] = {};
+        for (CArchetype * archetype : GetArchetypes(world))
+        {
+            GetColumns<Ts...>(*archetype, columns);
+            for (size_t chunk = 0; chunk < archetype->GetChunkCount(); ++chunk)
+            {
+                InvokeChunk<Ts...>(*archetype, archetype->GetChunk(chunk), columns, func, std::index_sequence_for<Ts...>());
+            }
+        }
+    }
+
+    template <typename... Ts, typename Func>
+    void CQuery::ForEach(CWorld & world, Func && func)
+    {
+        ForEachChunk<Ts...>(world, [&func](size_t const count, SEntity const * entities, Ts * ... components)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                func(entities[i], components[i]...);
+            }
+        });
+    }
+
+    template <typename... Ts, typename Func>
+    void CQuery::ParallelForEachChunk(CWorld & world, Func && func)
+    {
+        struct SChunkRef
+        {
+            CArchetype * archetype;
+            SChunk * chunk;
+            uint32_t columns[sizeof...(Ts) + 1];
+        };
+
+        std::vector<SChunkRef> chunks;
+        for (CArchetype * archetype : GetArchetypes(world))
+        {
+            SChunkRef ref = {};
+            ref.archetype = archetype;
+            GetColumns<Ts...>(*archetype, ref.columns);
+            for (size_t chunk = 0; chunk < archetype->GetChunkCount(); ++chunk)
+            {
+                ref.chunk = &archetype->GetChunk(chunk);
+                chunks.push_back(ref);
+            }
+        }
+
+        // A chunk is already a decent amount of work so hand them out one at a time
+        Utility::parallel_for(chunks.size(), 1, [&](size_t const begin, size_t const end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                SChunkRef const & ref = chunks[i];
+                InvokeChunk<Ts...>(*ref.archetype, *ref.chunk, ref.columns, func, std::index_sequence_for<Ts...>());
+            }
+        });
+    }
+}
@@ -0,0 +1,105 @@
+#include "system_scheduler.hpp"
+
+#include "ecs/world.hpp"
+#include "utility/parallel_for.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+    bool systems_conflict(ECS::ISystem const & lhs, ECS::ISystem const & rhs)
+    {
+        ECS::ComponentMask const lhs_access = lhs.GetReadMask() | lhs.GetWriteMask();
+        ECS::ComponentMask const rhs_access = rhs.GetReadMask() | rhs.GetWriteMask();
+
+        return (lhs.GetWriteMask() & rhs_access) != 0
+            || (rhs.GetWriteMask() & lhs_access) != 0;
+    }
+}
+
+ECS::ISystem::~ISystem()
+{
+    // This page is intentionally left blank
+}
+
+ECS::CSystemScheduler::CSystemScheduler()
+: m_systems()
+, m_command_buffers()
+, m_stages()
+, m_stages_dirty(false)
+{
+}
+
+ECS::CSystemScheduler::~CSystemScheduler()
+{
+}
+
+void ECS::CSystemScheduler::AddSystem(std::unique_ptr<ISystem> system)
+{
+    m_systems.emplace_back(std::move(system));
+    m_command_buffers.emplace_back();
+    m_stages_dirty = true;
+}
+
+void ECS::CSystemScheduler::Update(CWorld & world, float const delta_time)
+{
+    if (m_stages_dirty == true)
+    {
+        BuildStages();
+    }
+
+    for (auto const & stage : m_stages)
+    {
+        Utility::parallel_for(stage.size(), 1, [&](size_t const begin, size_t const end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                size_t const system = stage[i];
+                m_systems[system]->Update(world, m_command_buffers[system], delta_time);
+            }
+        });
+
+        for (size_t const system : stage)
+        {
+            m_command_buffers[system].Playback(world);
+        }
+    }
+}
+
+size_t ECS::CSystemScheduler::GetStageCount()
+{
+    if (m_stages_dirty == true)
+    {
+        BuildStages();
+    }
+    return m_stages.size();
+}
+
+void ECS::CSystemScheduler::BuildStages()
+{
+    m_stages.clear();
+
+    std::vector<size_t> system_stage(m_systems.size(), 0);
+    for (size_t system = 0; system < m_systems.size(); ++system)
+    {
+        // Earliest stage after every conflicting system registered before this one
+        size_t stage = 0;
+        for (size_t earlier = 0; earlier < system; ++earlier)
+        {
+            if (systems_conflict(*m_systems[system], *m_systems[earlier]) == true)
+            {
+                stage = std::max(stage, system_stage[earlier] + 1);
+            }
+        }
+
+        system_stage[system] = stage;
+        if (stage >= m_stages.size())
+        {
+            m_stages.resize(stage + 1);
+        }
+        m_stages[stage].push_back(system);
+    }
+
+    m_stages_dirty = false;
+}
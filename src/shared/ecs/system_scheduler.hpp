@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cinttypes>
+#include <memory>
+#include <vector>
+
+#include "ecs/command_buffer.hpp"
+#include "ecs/ecs_types.hpp"
+
+namespace ECS
+{
+    class CWorld;
+
+    class ISystem
+    {
+    public:
+        virtual ~ISystem();
+
+        virtual char const * GetName() const = 0;
+
+        // Components the system reads and writes, used to work out which systems can run at the
+        // same time. Writes imply reads so they don't need listing twice.
+        virtual ComponentMask GetReadMask() const = 0;
+        virtual ComponentMask GetWriteMask() const = 0;
+
+        // May run on a worker thread alongside other systems. Component data can be read and
+        // written through queries but structural changes must go through the command buffer.
+        virtual void Update(CWorld & world, CCommandBuffer & commands, float const delta_time) = 0;
+    };
+
+    // Groups systems into stages where nothing in a stage writes a component another system in
+    // the same stage touches. Stages run in order, systems within a stage run in parallel and
+    // their command buffers are played back (in registration order) once the stage is done.
+    // A system always runs after any earlier registered system it conflicts with.
+    class CSystemScheduler
+    {
+    public:
+        CSystemScheduler();
+        ~CSystemScheduler();
+
+        void AddSystem(std::unique_ptr<ISystem> system);
+        void Update(CWorld & world, float const delta_time);
+
+        size_t GetStageCount();
+
+    private:
+        void BuildStages();
+
+        std::vector<std::unique_ptr<ISystem>> m_systems;
+        std::vector<CCommandBuffer> m_command_buffers;
+        std::vector<std::vector<size_t>> m_stages;
+        bool m_stages_dirty;
+    };
+}
@@ -0,0 +1,186 @@
+#include "world.hpp"
+
+#include "utility/logging.hpp"
+
+#include <cassert>
+
+ECS::CWorld::CWorld()
+: m_records()
+, m_free_indices()
+, m_entity_count(0)
+, m_archetypes()
+, m_archetype_lookup()
+{
+    // Entities with no components still need somewhere to live
+    GetOrCreateArchetype(0);
+}
+
+ECS::SEntity ECS::CWorld::CreateEntity()
+{
+    return CreateEntityRaw(0);
+}
+
+ECS::SEntity ECS::CWorld::CreateEntityRaw(ComponentMask const mask)
+{
+    SEntity entity;
+    if (m_free_indices.empty() == false)
+    {
+        entity.index = m_free_indices.back();
+        m_free_indices.pop_back();
+    }
+    else
+    {
+        entity.index = static_cast<uint32_t>(m_records.size());
+        m_records.emplace_back();
+    }
+
+    SEntityRecord & record = m_records[entity.index];
+    entity.generation = record.generation;
+
+    record.archetype = &GetOrCreateArchetype(mask);
+    record.archetype->Allocate(entity, record.chunk, record.row);
+
+    ++m_entity_count;
+    return entity;
+}
+
+void ECS::CWorld::DestroyEntity(SEntity const entity)
+{
+    if (IsAlive(entity) == false)
+    {
+        return;
+    }
+
+    SEntityRecord & record = m_records[entity.index];
+    RemoveFromArchetype(record);
+
+    record.archetype = nullptr;
+    ++record.generation;
+    m_free_indices.push_back(entity.index);
+    --m_entity_count;
+}
+
+bool ECS::CWorld::IsAlive(SEntity const entity) const
+{
+    return entity.index < m_records.size()
+        && m_records[entity.index].archetype != nullptr
+        && m_records[entity.index].generation == entity.generation;
+}
+
+void * ECS::CWorld::AddComponentRaw(SEntity const entity, ComponentTypeId const type)
+{
+    if (IsAlive(entity) == false)
+    {
+        ERROR_LOG("Adding a component to a dead entity");
+        return nullptr;
+    }
+
+    CArchetype & current = *m_records[entity.index].archetype;
+    if ((current.GetMask() & component_bit(type)) == 0)
+    {
+        CArchetype * destination = nullptr;
+        auto const edge = current.add_edges.find(type);
+        if (edge != current.add_edges.end())
+        {
+            destination = edge->second;
+        }
+        else
+        {
+            destination = &GetOrCreateArchetype(current.GetMask() | component_bit(type));
+            current.add_edges[type] = destination;
+        }
+        MoveEntity(entity, *destination);
+    }
+
+    return GetComponentRaw(entity, type);
+}
+
+void ECS::CWorld::RemoveComponentRaw(SEntity const entity, ComponentTypeId const type)
+{
+    if (IsAlive(entity) == false)
+    {
+        return;
+    }
+
+    CArchetype & current = *m_records[entity.index].archetype;
+    if ((current.GetMask() & component_bit(type)) == 0)
+    {
+        return;
+    }
+
+    CArchetype * destination = nullptr;
+    auto const edge = current.remove_edges.find(type);
+    if (edge != current.remove_edges.end())
+    {
+        destination = edge->second;
+    }
+    else
+    {
+        destination = &GetOrCreateArchetype(current.GetMask() & ~component_bit(type));
+        current.remove_edges[type] = destination;
+    }
+    MoveEntity(entity, *destination);
+}
+
+void * ECS::CWorld::GetComponentRaw(SEntity const entity, ComponentTypeId const type)
+{
+    if (IsAlive(entity) == false)
+    {
+        return nullptr;
+    }
+
+    SEntityRecord const & record = m_records[entity.index];
+    uint32_t const column = record.archetype->GetColumn(type);
+    if (column == CArchetype::INVALID_COLUMN)
+    {
+        return nullptr;
+    }
+    return record.archetype->GetComponent(record.chunk, record.row, column);
+}
+
+ECS::ComponentMask ECS::CWorld::GetComponentMask(SEntity const entity) const
+{
+    return IsAlive(entity) ? m_records[entity.index].archetype->GetMask() : 0;
+}
+
+ECS::CArchetype & ECS::CWorld::GetOrCreateArchetype(ComponentMask const mask)
+{
+    auto const found = m_archetype_lookup.find(mask);
+    if (found != m_archetype_lookup.end())
+    {
+        return *found->second;
+    }
+
+    m_archetypes.emplace_back(std::make_unique<CArchetype>(mask));
+    CArchetype * archetype = m_archetypes.back().get();
+    m_archetype_lookup[mask] = archetype;
+    return *archetype;
+}
+
+void ECS::CWorld::MoveEntity(SEntity const entity, CArchetype & destination)
+{
+    SEntityRecord & record = m_records[entity.index];
+    CArchetype & source = *record.archetype;
+
+    uint32_t new_chunk = 0;
+    uint32_t new_row = 0;
+    destination.Allocate(entity, new_chunk, new_row);
+    CArchetype::CopySharedComponents(source, record.chunk, record.row, destination, new_chunk, new_row);
+
+    RemoveFromArchetype(record);
+
+    record.archetype = &destination;
+    record.chunk = new_chunk;
+    record.row = new_row;
+}
+
+void ECS::CWorld::RemoveFromArchetype(SEntityRecord & record)
+{
+    SEntity const moved = record.archetype->Remove(record.chunk, record.row);
+    if (moved != INVALID_ENTITY)
+    {
+        SEntityRecord & moved_record = m_records[moved.index];
+        moved_record.chunk = record.chunk;
+        moved_record.row = record.row;
+    }
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "ecs/archetype.hpp"
+#include "ecs/ecs_types.hpp"
+
+namespace ECS
+{
+    // Owns every entity and archetype. Structural changes (creating or destroying entities,
+    // adding or removing components) move data between archetypes and invalidate any pointers
+    // into chunks, so they must not happen while iterating a query; record them in a
+    // CCommandBuffer and play it back afterwards instead.
+    class CWorld
+    {
+    public:
+        CWorld();
+
+        SEntity CreateEntity();
+
+        template <typename T, typename... Ts>
+        SEntity CreateEntity(T const & component, Ts const & ... components);
+
+        void DestroyEntity(SEntity const entity);
+        bool IsAlive(SEntity const entity) const;
+        size_t GetEntityCount() const { return m_entity_count; }
+
+        template <typename T>
+        void AddComponent(SEntity const entity, T const & component);
+
+        template <typename T>
+        void RemoveComponent(SEntity const entity);
+
+        template <typename T>
+        bool HasComponent(SEntity const entity) const;
+
+        // Returns nullptr if the entity is dead or doesn't have the component
+        template <typename T>
+        T * GetComponent(SEntity const entity);
+
+        // Type erased versions of the above, used by command buffer playback
+        SEntity CreateEntityRaw(ComponentMask const mask);
+        void * AddComponentRaw(SEntity const entity, ComponentTypeId const type);
+        void RemoveComponentRaw(SEntity const entity, ComponentTypeId const type);
+        void * GetComponentRaw(SEntity const entity, ComponentTypeId const type);
+        ComponentMask GetComponentMask(SEntity const entity) const;
+
+        // Archetypes are only ever appended, queries use the count to pick up new ones cheaply
+        size_t GetArchetypeCount() const { return m_archetypes.size(); }
+        CArchetype & GetArchetype(size_t const index) { return *m_archetypes[index]; }
+
+    private:
+        struct SEntityRecord
+        {
+            CArchetype * archetype = nullptr;
+            uint32_t chunk = 0;
+            uint32_t row = 0;
+            uint32_t generation = 0;
+        };
+
+        CArchetype & GetOrCreateArchetype(ComponentMask const mask);
+        void MoveEntity(SEntity const entity, CArchetype & destination);
+        void RemoveFromArchetype(SEntityRecord & record);
+
+        template <typename T>
+        void WriteComponent(SEntity const entity, T const & component)
+        {
+            std::memcpy(GetComponentRaw(entity, component_type_id<T>()), &component, sizeof(T));
+        }
+
+        std::vector<SEntityRecord> m_records;
+        std::vector<uint32_t> m_free_indices;
+        size_t m_entity_count;
+
+        std::vector<std::unique_ptr<CArchetype>> m_archetypes;
+        std::unordered_map<ComponentMask, CArchetype *> m_archetype_lookup;
+    };
+
+    template <typename T, typename... Ts>
+    SEntity CWorld::CreateEntity(T const & component, Ts const & ... components)
+    {
+        SEntity const entity = CreateEntityRaw(component_mask<T, Ts...>());
+
+        using expand = int[];
+        (void)expand{ 0, (WriteComponent(entity, component), 0), (WriteComponent(entity, components), 0)... };
+
+        return entity;
+    }
+
+    template <typename T>
+    void CWorld::AddComponent(SEntity const entity, T const & component)
+    {
+        void * data = AddComponentRaw(entity, component_type_id<T>());
+        if (data != nullptr)
+        {
+            std::memcpy(data, &component, sizeof(T));
+        }
+    }
+
+    template <typename T>
+    void CWorld::RemoveComponent(SEntity const entity)
+    {
+        RemoveComponentRaw(entity, component_type_id<T>());
+    }
+
+    template <typename T>
+    bool CWorld::HasComponent(SEntity const entity) const
+    {
+        return (GetComponentMask(entity) & component_bit(component_type_id<T>())) != 0;
+    }
+
+    template <typename T>
+    T * CWorld::GetComponent(SEntity const entity)
+    {
+        return static_cast<T *>(GetComponentRaw(entity, component_type_id<T>()));
+    }
+}
@@ -0,0 +1,154 @@
+#include "batch_math.hpp"
+
+#include "math/batch_math_kernels.hpp"
+#include "utility/cpu_features.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    BatchMath::SKernelTable const & select_kernels()
+    {
+        switch (Utility::get_simd_level())
+        {
+            case Utility::ESimdLevel::AVX512: return BatchMath::get_avx512_kernels();
+            case Utility::ESimdLevel::AVX2: return BatchMath::get_avx2_kernels();
+            case Utility::ESimdLevel::SSE41: return BatchMath::get_sse41_kernels();
+            case Utility::ESimdLevel::Scalar: break;
+        }
+        return BatchMath::get_scalar_kernels();
+    }
+}
+
+void BatchMath::transform_points(SMat4Stream const & matrices, SVec3Stream const & points, SVec3Stream const & out, size_t const begin, size_t const end)
+{
+    select_kernels().transform_points(matrices, points, out, begin, end);
+}
+
+void BatchMath::compose_trs(SVec3Stream const & translations, SQuatStream const & rotations, SVec3Stream const & scales, SMat4Stream const & out, size_t const begin, size_t const end)
+{
+    select_kernels().compose_trs(translations, rotations, scales, out, begin, end);
+}
+
+void BatchMath::transform_aabbs(SMat4Stream const & matrices, SAabbStream const & aabbs, SAabbStream const & out, size_t const begin, size_t const end)
+{
+    select_kernels().transform_aabbs(matrices, aabbs, out, begin, end);
+}
+
+void BatchMath::normalise_quats(SQuatStream const & quats, size_t const begin, size_t const end)
+{
+    select_kernels().normalise_quats(quats, begin, end);
+}
+
+void BatchMath::transform_points_scalar(SMat4Stream const & matrices, SVec3Stream const & points, SVec3Stream const & out, size_t const begin, size_t const end)
+{
+    float * const * m = matrices.m;
+    for (size_t i = begin; i < end; ++i)
+    {
+        float const px = points.x[i];
+        float const py = points.y[i];
+        float const pz = points.z[i];
+
+        out.x[i] = m[0][i] * px + m[4][i] * py + m[8][i] * pz + m[12][i];
+        out.y[i] = m[1][i] * px + m[5][i] * py + m[9][i] * pz + m[13][i];
+        out.z[i] = m[2][i] * px + m[6][i] * py + m[10][i] * pz + m[14][i];
+    }
+}
+
+void BatchMath::compose_trs_scalar(SVec3Stream const & translations, SQuatStream const & rotations, SVec3Stream const & scales, SMat4Stream const & out, size_t const begin, size_t const end)
+{
+    float * const * m = out.m;
+    for (size_t i = begin; i < end; ++i)
+    {
+        float const qx = rotations.x[i];
+        float const qy = rotations.y[i];
+        float const qz = rotations.z[i];
+        float const qw = rotations.w[i];
+
+        float const sx = scales.x[i];
+        float const sy = scales.y[i];
+        float const sz = scales.z[i];
+
+        float const xx = qx * qx;
+        float const yy = qy * qy;
+        float const zz = qz * qz;
+        float const xy = qx * qy;
+        float const xz = qx * qz;
+        float const yz = qy * qz;
+        float const wx = qw * qx;
+        float const wy = qw * qy;
+        float const wz = qw * qz;
+
+        m[0][i] = (1.0f - 2.0f * (yy + zz)) * sx;
+        m[1][i] = 2.0f * (xy + wz) * sx;
+        m[2][i] = 2.0f * (xz - wy) * sx;
+        m[3][i] = 0.0f;
+
+        m[4][i] = 2.0f * (xy - wz) * sy;
+        m[5][i] = (1.0f - 2.0f * (xx + zz)) * sy;
+        m[6][i] = 2.0f * (yz + wx) * sy;
+        m[7][i] = 0.0f;
+
+        m[8][i] = 2.0f * (xz + wy) * sz;
+        m[9][i] = 2.0f * (yz - wx) * sz;
+        m[10][i] = (1.0f - 2.0f * (xx + yy)) * sz;
+        m[11][i] = 0.0f;
+
+        m[12][i] = translations.x[i];
+        m[13][i] = translations.y[i];
+        m[14][i] = translations.z[i];
+        m[15][i] = 1.0f;
+    }
+}
+
+void BatchMath::transform_aabbs_scalar(SMat4Stream const & matrices, SAabbStream const & aabbs, SAabbStream const & out, size_t const begin, size_t const end)
+{
+    float * const * m = matrices.m;
+    for (size_t i = begin; i < end; ++i)
+    {
+        float const cx = aabbs.centre_x[i];
+        float const cy = aabbs.centre_y[i];
+        float const cz = aabbs.centre_z[i];
+        float const ex = aabbs.extent_x[i];
+        float const ey = aabbs.extent_y[i];
+        float const ez = aabbs.extent_z[i];
+
+        out.centre_x[i] = m[0][i] * cx + m[4][i] * cy + m[8][i] * cz + m[12][i];
+        out.centre_y[i] = m[1][i] * cx + m[5][i] * cy + m[9][i] * cz + m[13][i];
+        out.centre_z[i] = m[2][i] * cx + m[6][i] * cy + m[10][i] * cz + m[14][i];
+
+        out.extent_x[i] = std::fabs(m[0][i]) * ex + std::fabs(m[4][i]) * ey + std::fabs(m[8][i]) * ez;
+        out.extent_y[i] = std::fabs(m[1][i]) * ex + std::fabs(m[5][i]) * ey + std::fabs(m[9][i]) * ez;
+        out.extent_z[i] = std::fabs(m[2][i]) * ex + std::fabs(m[6][i]) * ey + std::fabs(m[10][i]) * ez;
+    }
+}
+
+void BatchMath::normalise_quats_scalar(SQuatStream const & quats, size_t const begin, size_t const end)
+{
+    for (size_t i = begin; i < end; ++i)
+    {
+        float const x = quats.x[i];
+        float const y = quats.y[i];
+        float const z = quats.z[i];
+        float const w = quats.w[i];
+
+        float const length = std::max(std::sqrt(x * x + y * y + z * z + w * w), 1.0e-30f);
+
+        quats.x[i] = x / length;
+        quats.y[i] = y / length;
+        quats.z[i] = z / length;
+        quats.w[i] = w / length;
+    }
+}
+
+BatchMath::SKernelTable const & BatchMath::get_scalar_kernels()
+{
+    static SKernelTable const table = {
+        &transform_points_scalar,
+        &compose_trs_scalar,
+        &transform_aabbs_scalar,
+        &normalise_quats_scalar
+    };
+    return table;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+
+// Batch maths over structure of arrays buffers. Every function processes items [begin, end) of
+// its streams, item i of each input stream pairs with item i of every other stream. Work is
+// dispatched at runtime to the widest kernel the CPU supports (see utility/cpu_features.hpp),
+// the *_scalar versions are the reference implementations the SIMD kernels must match.
+namespace BatchMath
+{
+    struct SVec3Stream
+    {
+        float * x = nullptr;
+        float * y = nullptr;
+        float * z = nullptr;
+    };
+
+    struct SQuatStream
+    {
+        float * x = nullptr;
+        float * y = nullptr;
+        float * z = nullptr;
+        float * w = nullptr;
+    };
+
+    // One stream per matrix element, indexed column major the same as glm (column * 4 + row)
+    struct SMat4Stream
+    {
+        float * m[16] = {};
+    };
+
+    struct SAabbStream
+    {
+        float * centre_x = nullptr;
+        float * centre_y = nullptr;
+        float * centre_z = nullptr;
+        float * extent_x = nullptr;
+        float * extent_y = nullptr;
+        float * extent_z = nullptr;
+    };
+
+    // out = matrix * vec4(point, 1), matrices are assumed to be affine
+    void transform_points(SMat4Stream const & matrices, SVec3Stream const & points, SVec3Stream const & out, size_t const begin, size_t const end);
+
+    // out = translate(t) * mat4_cast(r) * scale(s), rotations must be normalised
+    void compose_trs(SVec3Stream const & translations, SQuatStream const & rotations, SVec3Stream const & scales, SMat4Stream const & out, size_t const begin, size_t const end);
+
+    // Transforms centre/extent boxes, out is the axis aligned box enclosing each transformed box
+    void transform_aabbs(SMat4Stream const & matrices, SAabbStream const & aabbs, SAabbStream const & out, size_t const begin, size_t const end);
+
+    // Normalises in place, zero length quaternions are left as zero
+    void normalise_quats(SQuatStream const & quats, size_t const begin, size_t const end);
+
+    void transform_points_scalar(SMat4Stream const & matrices, SVec3Stream const & points, SVec3Stream const & out, size_t const begin, size_t const end);
+    void compose_trs_scalar(SVec3Stream const & translations, SQuatStream const & rotations, SVec3Stream const & scales, SMat4Stream const & out, size_t const begin, size_t const end);
+    void transform_aabbs_scalar(SMat4Stream const & matrices, SAabbStream const & aabbs, SAabbStream const & out, size_t const begin, size_t const end);
+    void normalise_quats_scalar(SQuatStream const & quats, size_t const begin, size_t const end);
+}
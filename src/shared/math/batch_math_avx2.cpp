@@ -0,0 +1,45 @@
+#include "math/batch_math_kernels.hpp"
+
+#include "utility/cpu_features.hpp"
+
+#if GOAT_ARCH_X86
+
+#include <immintrin.h>
+
+namespace
+{
+    struct SAvx2Ops
+    {
+        using Reg = __m256;
+        static constexpr size_t WIDTH = 8;
+
+        static Reg Load(float const * ptr) { return _mm256_loadu_ps(ptr); }
+        static void Store(float * ptr, Reg const v) { _mm256_storeu_ps(ptr, v); }
+        static Reg Set1(float const v) { return _mm256_set1_ps(v); }
+        static Reg Add(Reg const a, Reg const b) { return _mm256_add_ps(a, b); }
+        static Reg Sub(Reg const a, Reg const b) { return _mm256_sub_ps(a, b); }
+        static Reg Mul(Reg const a, Reg const b) { return _mm256_mul_ps(a, b); }
+        static Reg Div(Reg const a, Reg const b) { return _mm256_div_ps(a, b); }
+        static Reg MulAdd(Reg const a, Reg const b, Reg const c) { return _mm256_fmadd_ps(a, b, c); }
+        static Reg Abs(Reg const a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+        static Reg Sqrt(Reg const a) { return _mm256_sqrt_ps(a); }
+        static Reg Max(Reg const a, Reg const b) { return _mm256_max_ps(a, b); }
+    };
+
+#include "math/batch_math_simd.inl"
+}
+
+BatchMath::SKernelTable const & BatchMath::get_avx2_kernels()
+{
+    static SKernelTable const table = make_kernel_table<SAvx2Ops>();
+    return table;
+}
+
+#else
+
+BatchMath::SKernelTable const & BatchMath::get_avx2_kernels()
+{
+    return get_scalar_kernels();
+}
+
+#endif
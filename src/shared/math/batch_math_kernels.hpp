@@ -0,0 +1,21 @@
+#pragma once
+
+#include "math/batch_math.hpp"
+
+namespace BatchMath
+{
+    struct SKernelTable
+    {
+        void (*transform_points)(SMat4Stream const &, SVec3Stream const &, SVec3Stream const &, size_t, size_t);
+        void (*compose_trs)(SVec3Stream const &, SQuatStream const &, SVec3Stream const &, SMat4Stream const &, size_t, size_t);
+        void (*transform_aabbs)(SMat4Stream const &, SAabbStream const &, SAabbStream const &, size_t, size_t);
+        void (*normalise_quats)(SQuatStream const &, size_t, size_t);
+    };
+
+    // Each lives in its own translation unit built with the matching instruction set flags,
+    // on other architectures they hand back the scalar table
+    SKernelTable const & get_sse41_kernels();
+    SKernelTable const & get_avx2_kernels();
+    SKernelTable const & get_avx512_kernels();
+    SKernelTable const & get_scalar_kernels();
+}
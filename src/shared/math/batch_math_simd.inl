@@ -0,0 +1,172 @@
+// Shared body of the SIMD batch maths kernels. Include from inside an anonymous namespace after
+// defining a VecOps type wrapping one instruction set, see batch_math_sse41.cpp for an example.
+// Everything in here must stay internal to the including translation unit since each one is
+// compiled with different instruction set flags.
+
+template <typename VecOps>
+void simd_transform_points(BatchMath::SMat4Stream const & matrices, BatchMath::SVec3Stream const & points, BatchMath::SVec3Stream const & out, size_t const begin, size_t const end)
+{
+    using V = typename VecOps::Reg;
+    size_t i = begin;
+    for (; i + VecOps::WIDTH <= end; i += VecOps::WIDTH)
+    {
+        V const px = VecOps::Load(points.x + i);
+        V const py = VecOps::Load(points.y + i);
+        V const pz = VecOps::Load(points.z + i);
+
+        V rx = VecOps::Load(matrices.m[12] + i);
+        V ry = VecOps::Load(matrices.m[13] + i);
+        V rz = VecOps::Load(matrices.m[14] + i);
+
+        rx = VecOps::MulAdd(VecOps::Load(matrices.m[0] + i), px, rx);
+        ry = VecOps::MulAdd(VecOps::Load(matrices.m[1] + i), px, ry);
+        rz = VecOps::MulAdd(VecOps::Load(matrices.m[2] + i), px, rz);
+        rx = VecOps::MulAdd(VecOps::Load(matrices.m[4] + i), py, rx);
+        ry = VecOps::MulAdd(VecOps::Load(matrices.m[5] + i), py, ry);
+        rz = VecOps::MulAdd(VecOps::Load(matrices.m[6] + i), py, rz);
+        rx = VecOps::MulAdd(VecOps::Load(matrices.m[8] + i), pz, rx);
+        ry = VecOps::MulAdd(VecOps::Load(matrices.m[9] + i), pz, ry);
+        rz = VecOps::MulAdd(VecOps::Load(matrices.m[10] + i), pz, rz);
+
+        VecOps::Store(out.x + i, rx);
+        VecOps::Store(out.y + i, ry);
+        VecOps::Store(out.z + i, rz);
+    }
+    BatchMath::transform_points_scalar(matrices, points, out, i, end);
+}
+
+template <typename VecOps>
+void simd_compose_trs(BatchMath::SVec3Stream const & translations, BatchMath::SQuatStream const & rotations, BatchMath::SVec3Stream const & scales, BatchMath::SMat4Stream const & out, size_t const begin, size_t const end)
+{
+    using V = typename VecOps::Reg;
+    V const one = VecOps::Set1(1.0f);
+    V const two = VecOps::Set1(2.0f);
+    V const zero = VecOps::Set1(0.0f);
+
+    size_t i = begin;
+    for (; i + VecOps::WIDTH <= end; i += VecOps::WIDTH)
+    {
+        V const qx = VecOps::Load(rotations.x + i);
+        V const qy = VecOps::Load(rotations.y + i);
+        V const qz = VecOps::Load(rotations.z + i);
+        V const qw = VecOps::Load(rotations.w + i);
+
+        V const sx = VecOps::Load(scales.x + i);
+        V const sy = VecOps::Load(scales.y + i);
+        V const sz = VecOps::Load(scales.z + i);
+
+        V const xx = VecOps::Mul(qx, qx);
+        V const yy = VecOps::Mul(qy, qy);
+        V const zz = VecOps::Mul(qz, qz);
+        V const xy = VecOps::Mul(qx, qy);
+        V const xz = VecOps::Mul(qx, qz);
+        V const yz = VecOps::Mul(qy, qz);
+        V const wx = VecOps::Mul(qw, qx);
+        V const wy = VecOps::Mul(qw, qy);
+        V const wz = VecOps::Mul(qw, qz);
+
+        VecOps::Store(out.m[0] + i, VecOps::Mul(VecOps::Sub(one, VecOps::Mul(two, VecOps::Add(yy, zz))), sx));
+        VecOps::Store(out.m[1] + i, VecOps::Mul(VecOps::Mul(two, VecOps::Add(xy, wz)), sx));
+        VecOps::Store(out.m[2] + i, VecOps::Mul(VecOps::Mul(two, VecOps::Sub(xz, wy)), sx));
+        VecOps::Store(out.m[3] + i, zero);
+
+        VecOps::Store(out.m[4] + i, VecOps::Mul(VecOps::Mul(two, VecOps::Sub(xy, wz)), sy));
+        VecOps::Store(out.m[5] + i, VecOps::Mul(VecOps::Sub(one, VecOps::Mul(two, VecOps::Add(xx, zz))), sy));
+        VecOps::Store(out.m[6] + i, VecOps::Mul(VecOps::Mul(two, VecOps::Add(yz, wx)), sy));
+        VecOps::Store(out.m[7] + i, zero);
+
+        VecOps::Store(out.m[8] + i, VecOps::Mul(VecOps::Mul(two, VecOps::Add(xz, wy)), sz));
+        VecOps::Store(out.m[9] + i, VecOps::Mul(VecOps::Mul(two, VecOps::Sub(yz, wx)), sz));
+        VecOps::Store(out.m[10] + i, VecOps::Mul(VecOps::Sub(one, VecOps::Mul(two, VecOps::Add(xx, yy))), sz));
+        VecOps::Store(out.m[11] + i, zero);
+
+        VecOps::Store(out.m[12] + i, VecOps::Load(translations.x + i));
+        VecOps::Store(out.m[13] + i, VecOps::Load(translations.y + i));
+        VecOps::Store(out.m[14] + i, VecOps::Load(translations.z + i));
+        VecOps::Store(out.m[15] + i, one);
+    }
+    BatchMath::compose_trs_scalar(translations, rotations, scales, out, i, end);
+}
+
+template <typename VecOps>
+void simd_transform_aabbs(BatchMath::SMat4Stream const & matrices, BatchMath::SAabbStream const & aabbs, BatchMath::SAabbStream const & out, size_t const begin, size_t const end)
+{
+    using V = typename VecOps::Reg;
+    size_t i = begin;
+    for (; i + VecOps::WIDTH <= end; i += VecOps::WIDTH)
+    {
+        V const cx = VecOps::Load(aabbs.centre_x + i);
+        V const cy = VecOps::Load(aabbs.centre_y + i);
+        V const cz = VecOps::Load(aabbs.centre_z + i);
+        V const ex = VecOps::Load(aabbs.extent_x + i);
+        V const ey = VecOps::Load(aabbs.extent_y + i);
+        V const ez = VecOps::Load(aabbs.extent_z + i);
+
+        V const m0 = VecOps::Load(matrices.m[0] + i);
+        V const m1 = VecOps::Load(matrices.m[1] + i);
+        V const m2 = VecOps::Load(matrices.m[2] + i);
+        V const m4 = VecOps::Load(matrices.m[4] + i);
+        V const m5 = VecOps::Load(matrices.m[5] + i);
+        V const m6 = VecOps::Load(matrices.m[6] + i);
+        V const m8 = VecOps::Load(matrices.m[8] + i);
+        V const m9 = VecOps::Load(matrices.m[9] + i);
+        V const m10 = VecOps::Load(matrices.m[10] + i);
+
+        V const rcx = VecOps::MulAdd(m8, cz, VecOps::MulAdd(m4, cy, VecOps::MulAdd(m0, cx, VecOps::Load(matrices.m[12] + i))));
+        V const rcy = VecOps::MulAdd(m9, cz, VecOps::MulAdd(m5, cy, VecOps::MulAdd(m1, cx, VecOps::Load(matrices.m[13] + i))));
+        V const rcz = VecOps::MulAdd(m10, cz, VecOps::MulAdd(m6, cy, VecOps::MulAdd(m2, cx, VecOps::Load(matrices.m[14] + i))));
+
+        V const rex = VecOps::MulAdd(VecOps::Abs(m8), ez, VecOps::MulAdd(VecOps::Abs(m4), ey, VecOps::Mul(VecOps::Abs(m0), ex)));
+        V const rey = VecOps::MulAdd(VecOps::Abs(m9), ez, VecOps::MulAdd(VecOps::Abs(m5), ey, VecOps::Mul(VecOps::Abs(m1), ex)));
+        V const rez = VecOps::MulAdd(VecOps::Abs(m10), ez, VecOps::MulAdd(VecOps::Abs(m6), ey, VecOps::Mul(VecOps::Abs(m2), ex)));
+
+        VecOps::Store(out.centre_x + i, rcx);
+        VecOps::Store(out.centre_y + i, rcy);
+        VecOps::Store(out.centre_z + i, rcz);
+        VecOps::Store(out.extent_x + i, rex);
+        VecOps::Store(out.extent_y + i, rey);
+        VecOps::Store(out.extent_z + i, rez);
+    }
+    BatchMath::transform_aabbs_scalar(matrices, aabbs, out, i, end);
+}
+
+template <typename VecOps>
+void simd_normalise_quats(BatchMath::SQuatStream const & quats, size_t const begin, size_t const end)
+{
+    using V = typename VecOps::Reg;
+    V const smallest = VecOps::Set1(1.0e-30f);
+
+    size_t i = begin;
+    for (; i + VecOps::WIDTH <= end; i += VecOps::WIDTH)
+    {
+        V const x = VecOps::Load(quats.x + i);
+        V const y = VecOps::Load(quats.y + i);
+        V const z = VecOps::Load(quats.z + i);
+        V const w = VecOps::Load(quats.w + i);
+
+        V length_sq = VecOps::Mul(x, x);
+        length_sq = VecOps::MulAdd(y, y, length_sq);
+        length_sq = VecOps::MulAdd(z, z, length_sq);
+        length_sq = VecOps::MulAdd(w, w, length_sq);
+
+        // full precision divide rather than rsqrt so results match the scalar reference
+        V const length = VecOps::Max(VecOps::Sqrt(length_sq), smallest);
+
+        VecOps::Store(quats.x + i, VecOps::Div(x, length));
+        VecOps::Store(quats.y + i, VecOps::Div(y, length));
+        VecOps::Store(quats.z + i, VecOps::Div(z, length));
+        VecOps::Store(quats.w + i, VecOps::Div(w, length));
+    }
+    BatchMath::normalise_quats_scalar(quats, i, end);
+}
+
+template <typename VecOps>
+BatchMath::SKernelTable make_kernel_table()
+{
+    BatchMath::SKernelTable table;
+    table.transform_points = &simd_transform_points<VecOps>;
+    table.compose_trs = &simd_compose_trs<VecOps>;
+    table.transform_aabbs = &simd_transform_aabbs<VecOps>;
+    table.normalise_quats = &simd_normalise_quats<VecOps>;
+    return table;
+}
@@ -0,0 +1,45 @@
+#include "math/batch_math_kernels.hpp"
+
+#include "utility/cpu_features.hpp"
+
+#if GOAT_ARCH_X86
+
+#include <smmintrin.h>
+
+namespace
+{
+    struct SSse41Ops
+    {
+        using Reg = __m128;
+        static constexpr size_t WIDTH = 4;
+
+        static Reg Load(float const * ptr) { return _mm_loadu_ps(ptr); }
+        static void Store(float * ptr, Reg const v) { _mm_storeu_ps(ptr, v); }
+        static Reg Set1(float const v) { return _mm_set1_ps(v); }
+        static Reg Add(Reg const a, Reg const b) { return _mm_add_ps(a, b); }
+        static Reg Sub(Reg const a, Reg const b) { return _mm_sub_ps(a, b); }
+        static Reg Mul(Reg const a, Reg const b) { return _mm_mul_ps(a, b); }
+        static Reg Div(Reg const a, Reg const b) { return _mm_div_ps(a, b); }
+        static Reg MulAdd(Reg const a, Reg const b, Reg const c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+        static Reg Abs(Reg const a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+        static Reg Sqrt(Reg const a) { return _mm_sqrt_ps(a); }
+        static Reg Max(Reg const a, Reg const b) { return _mm_max_ps(a, b); }
+    };
+
+#include "math/batch_math_simd.inl"
+}
+
+BatchMath::SKernelTable const & BatchMath::get_sse41_kernels()
+{
+    static SKernelTable const table = make_kernel_table<SSse41Ops>();
+    return table;
+}
+
+#else
+
+BatchMath::SKernelTable const & BatchMath::get_sse41_kernels()
+{
+    return get_scalar_kernels();
+}
+
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cmath>
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+
+namespace Renderer
+{
+    struct SAabb
+    {
+        glm::vec3 min = glm::vec3(0.0f);
+        glm::vec3 max = glm::vec3(0.0f);
+
+        glm::vec3 Centre() const { return (min + max) * 0.5f; }
+        glm::vec3 Extents() const { return (max - min) * 0.5f; }
+    };
+
+    // Transforms the box and returns the axis aligned box enclosing the result (Arvo's method)
+    inline SAabb transform_aabb(SAabb const & aabb, glm::mat4 const & transform)
+    {
+        glm::vec3 const centre = aabb.Centre();
+        glm::vec3 const extents = aabb.Extents();
+
+        glm::vec3 world_centre(transform[3]);
+        glm::vec3 world_extents(0.0f);
+        for (int col = 0; col < 3; ++col)
+        {
+            for (int row = 0; row < 3; ++row)
+            {
+                world_centre[row] += transform[col][row] * centre[col];
+                world_extents[row] += std::fabs(transform[col][row]) * extents[col];
+            }
+        }
+
+        SAabb result;
+        result.min = world_centre - world_extents;
+        result.max = world_centre + world_extents;
+        return result;
+    }
+}
@@ -0,0 +1,153 @@
+#include "captured_frame.hpp"
+
+#include "utility/logging.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+
+namespace
+{
+    // Deflate's stored blocks can't hold more than this
+    constexpr size_t MAX_STORED_BLOCK = 65535;
+
+    std::array<uint32_t, 256> make_crc_table()
+    {
+        std::array<uint32_t, 256> table = {};
+        for (uint32_t n = 0; n < 256; ++n)
+        {
+            uint32_t c = n;
+            for (uint32_t k = 0; k < 8; ++k)
+            {
+                c = (c & 1) != 0 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        return table;
+    }
+
+    uint32_t update_crc(uint32_t crc, uint8_t const * data, size_t const size)
+    {
+        static std::array<uint32_t, 256> const table = make_crc_table();
+        for (size_t i = 0; i < size; ++i)
+        {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return crc;
+    }
+
+    void append_u32(std::vector<uint8_t> & out, uint32_t const value)
+    {
+        out.push_back(static_cast<uint8_t>(value >> 24));
+        out.push_back(static_cast<uint8_t>(value >> 16));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    void append_chunk(std::vector<uint8_t> & out, char const type[4], std::vector<uint8_t> const & data)
+    {
+        append_u32(out, static_cast<uint32_t>(data.size()));
+        size_t const type_start = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data.begin(), data.end());
+        // The CRC covers the type and the data but not the length
+        uint32_t const crc = update_crc(0xFFFFFFFFu, out.data() + type_start, out.size() - type_start) ^ 0xFFFFFFFFu;
+        append_u32(out, crc);
+    }
+
+    // Captures are read by diff tools and then thrown away, so the image data goes in stored
+    // (uncompressed) deflate blocks. Bigger files, but nothing to get wrong and no extra
+    // dependency for a zlib encoder.
+    std::vector<uint8_t> encode_png(Renderer::SCapturedFrame const & frame)
+    {
+        size_t const row_size = static_cast<size_t>(frame.width) * 4;
+
+        // Every row is prefixed with its filter type, zero for none
+        std::vector<uint8_t> scanlines;
+        scanlines.reserve((row_size + 1) * frame.height);
+        for (uint32_t y = 0; y < frame.height; ++y)
+        {
+            scanlines.push_back(0);
+            uint8_t const * row = frame.pixels.data() + row_size * y;
+            scanlines.insert(scanlines.end(), row, row + row_size);
+        }
+
+        std::vector<uint8_t> zlib;
+        zlib.reserve(scanlines.size() + scanlines.size() / MAX_STORED_BLOCK * 5 + 16);
+        // 32K window deflate, no preset dictionary, check bits making the header a multiple of 31
+        zlib.push_back(0x78);
+        zlib.push_back(0x01);
+
+        size_t offset = 0;
+        do
+        {
+            size_t const block_size = std::min(MAX_STORED_BLOCK, scanlines.size() - offset);
+            bool const final_block = offset + block_size == scanlines.size();
+            zlib.push_back(final_block == true ? 1 : 0);
+            zlib.push_back(static_cast<uint8_t>(block_size));
+            zlib.push_back(static_cast<uint8_t>(block_size >> 8));
+            zlib.push_back(static_cast<uint8_t>(~block_size));
+            zlib.push_back(static_cast<uint8_t>(~block_size >> 8));
+            zlib.insert(zlib.end(), scanlines.begin() + static_cast<std::ptrdiff_t>(offset), scanlines.begin() + static_cast<std::ptrdiff_t>(offset + block_size));
+            offset += block_size;
+        }
+        while (offset < scanlines.size());
+
+        uint32_t adler_a = 1;
+        uint32_t adler_b = 0;
+        for (uint8_t const value : scanlines)
+        {
+            adler_a = (adler_a + value) % 65521;
+            adler_b = (adler_b + adler_a) % 65521;
+        }
+        append_u32(zlib, (adler_b << 16) | adler_a);
+
+        std::vector<uint8_t> header;
+        append_u32(header, frame.width);
+        append_u32(header, frame.height);
+        header.push_back(8); // Bits per channel
+        header.push_back(6); // RGBA
+        header.push_back(0); // Deflate
+        header.push_back(0); // Adaptive filtering
+        header.push_back(0); // Not interlaced
+
+        std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        append_chunk(png, "IHDR", header);
+        append_chunk(png, "IDAT", zlib);
+        append_chunk(png, "IEND", {});
+        return png;
+    }
+}
+
+bool Renderer::save_captured_frame(SCapturedFrame const & frame, std::string const & filename, ECaptureFileFormat const format)
+{
+    if (frame.width == 0 || frame.height == 0 || frame.pixels.size() != static_cast<size_t>(frame.width) * frame.height * 4)
+    {
+        ERROR_LOG("Captured frame is invalid, not saving " + filename);
+        return false;
+    }
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (file.is_open() == false)
+    {
+        ERROR_LOG("Failed to open file: " + filename);
+        return false;
+    }
+
+    if (format == ECaptureFileFormat::Png)
+    {
+        std::vector<uint8_t> const png = encode_png(frame);
+        file.write(reinterpret_cast<char const *>(png.data()), static_cast<std::streamsize>(png.size()));
+    }
+    else
+    {
+        file.write(reinterpret_cast<char const *>(frame.pixels.data()), static_cast<std::streamsize>(frame.pixels.size()));
+    }
+
+    if (file.good() == false)
+    {
+        ERROR_LOG("Failed to write captured frame to " + filename);
+        return false;
+    }
+    return true;
+}
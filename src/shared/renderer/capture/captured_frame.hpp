@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+namespace Renderer
+{
+    enum class ECaptureFileFormat : uint8_t
+    {
+        // Lossless and opens in anything, what image diff tools expect
+        Png,
+        // Just the pixels, no header, for tools that compare bytes directly
+        Raw
+    };
+
+    // One rendered frame copied back from the GPU
+    struct SCapturedFrame
+    {
+        // Counted from the render context's first RenderFrame
+        uint64_t frame_index = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        // RGBA8, top row first with no padding between rows
+        std::vector<uint8_t> pixels;
+    };
+
+    bool save_captured_frame(SCapturedFrame const & frame, std::string const & filename, ECaptureFileFormat const format);
+}
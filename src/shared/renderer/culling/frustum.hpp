@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cinttypes>
+#include <cmath>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+namespace Renderer
+{
+    // Six planes stored as (normal.xyz, distance) with normals pointing into the frustum,
+    // a point p is inside a plane when dot(normal, p) + distance >= 0
+    struct SFrustum
+    {
+        static constexpr uint32_t PLANE_COUNT = 6;
+        glm::vec4 planes[PLANE_COUNT];
+    };
+
+    enum class EClipDepth : uint8_t
+    {
+        ZeroToOne,          // vulkan, dx and GLM_FORCE_DEPTH_ZERO_TO_ONE
+        NegativeOneToOne    // opengl default
+    };
+
+    // Gribb/Hartmann plane extraction from a combined view projection matrix
+    inline SFrustum extract_frustum(glm::mat4 const & view_projection, EClipDepth const clip_depth)
+    {
+        glm::vec4 const row0(view_projection[0][0], view_projection[1][0], view_projection[2][0], view_projection[3][0]);
+        glm::vec4 const row1(view_projection[0][1], view_projection[1][1], view_projection[2][1], view_projection[3][1]);
+        glm::vec4 const row2(view_projection[0][2], view_projection[1][2], view_projection[2][2], view_projection[3][2]);
+        glm::vec4 const row3(view_projection[0][3], view_projection[1][3], view_projection[2][3], view_projection[3][3]);
+
+        SFrustum frustum;
+        frustum.planes[0] = row3 + row0; // left
+        frustum.planes[1] = row3 - row0; // right
+        frustum.planes[2] = row3 + row1; // bottom
+        frustum.planes[3] = row3 - row1; // top
+        frustum.planes[4] = clip_depth == EClipDepth::ZeroToOne ? row2 : row3 + row2; // near
+        frustum.planes[5] = row3 - row2; // far
+
+        for (auto & plane : frustum.planes)
+        {
+            float const length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+            if (length > 0.0f)
+            {
+                plane = plane / length;
+            }
+        }
+        return frustum;
+    }
+}
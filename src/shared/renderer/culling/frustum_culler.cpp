@@ -0,0 +1,134 @@
+#include "frustum_culler.hpp"
+
+#include "renderer/culling/frustum_culling_kernels.hpp"
+#include "utility/cpu_features.hpp"
+#include "utility/parallel_for.hpp"
+
+#include <atomic>
+#include <cmath>
+
+namespace
+{
+    // Big enough that scheduling overhead is noise next to the plane tests
+    constexpr size_t CULL_CHUNK_SIZE = 4096;
+}
+
+uint32_t Renderer::CullingKernels::cull_scalar(SFrustum const & frustum,
+                                               SAabbStreams const & aabbs,
+                                               size_t const begin,
+                                               size_t const end,
+                                               uint8_t * visibility)
+{
+    uint32_t visible_count = 0;
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        uint8_t visible = 1;
+        for (auto const & plane : frustum.planes)
+        {
+            float const distance = plane.x * aabbs.centre_x[i]
+                                 + plane.y * aabbs.centre_y[i]
+                                 + plane.z * aabbs.centre_z[i]
+                                 + plane.w;
+            float const radius = std::fabs(plane.x) * aabbs.extent_x[i]
+                               + std::fabs(plane.y) * aabbs.extent_y[i]
+                               + std::fabs(plane.z) * aabbs.extent_z[i];
+            if (distance + radius < 0.0f)
+            {
+                visible = 0;
+                break;
+            }
+        }
+        visibility[i] = visible;
+        visible_count += visible;
+    }
+    return visible_count;
+}
+
+Renderer::CullingKernels::CullFunc Renderer::CullingKernels::select_cull_kernel()
+{
+#if GOAT_ARCH_X86
+    switch (Utility::get_simd_level())
+    {
+        case Utility::ESimdLevel::AVX512:
+        case Utility::ESimdLevel::AVX2:
+            return &cull_avx2;
+        case Utility::ESimdLevel::SSE41:
+            return &cull_sse41;
+        case Utility::ESimdLevel::Scalar:
+            break;
+    }
+#endif
+    return &cull_scalar;
+}
+
+void Renderer::CFrustumCuller::Clear()
+{
+    m_centre_x.clear();
+    m_centre_y.clear();
+    m_centre_z.clear();
+    m_extent_x.clear();
+    m_extent_y.clear();
+    m_extent_z.clear();
+    m_visibility.clear();
+}
+
+void Renderer::CFrustumCuller::Reserve(size_t const count)
+{
+    m_centre_x.reserve(count);
+    m_centre_y.reserve(count);
+    m_centre_z.reserve(count);
+    m_extent_x.reserve(count);
+    m_extent_y.reserve(count);
+    m_extent_z.reserve(count);
+    m_visibility.reserve(count);
+}
+
+uint32_t Renderer::CFrustumCuller::AddBounds(SAabb const & world_bounds)
+{
+    glm::vec3 const centre = world_bounds.Centre();
+    glm::vec3 const extents = world_bounds.Extents();
+
+    m_centre_x.push_back(centre.x);
+    m_centre_y.push_back(centre.y);
+    m_centre_z.push_back(centre.z);
+    m_extent_x.push_back(extents.x);
+    m_extent_y.push_back(extents.y);
+    m_extent_z.push_back(extents.z);
+
+    return static_cast<uint32_t>(m_centre_x.size() - 1);
+}
+
+Renderer::SCullStats Renderer::CFrustumCuller::Cull(SFrustum const & frustum)
+{
+    size_t const count = Count();
+    m_visibility.resize(count);
+
+    SCullStats stats;
+    if (count == 0)
+    {
+        return stats;
+    }
+
+    SAabbStreams streams;
+    streams.centre_x = m_centre_x.data();
+    streams.centre_y = m_centre_y.data();
+    streams.centre_z = m_centre_z.data();
+    streams.extent_x = m_extent_x.data();
+    streams.extent_y = m_extent_y.data();
+    streams.extent_z = m_extent_z.data();
+
+    CullingKernels::CullFunc const kernel = CullingKernels::select_cull_kernel();
+    uint8_t * visibility = m_visibility.data();
+    std::atomic<uint32_t> visible_count(0);
+
+    Utility::parallel_for(count, CULL_CHUNK_SIZE, [&](size_t const begin, size_t const end)
+    {
+        uint32_t const chunk_visible = kernel(frustum, streams, begin, end, visibility);
+        visible_count.fetch_add(chunk_visible, std::memory_order_relaxed);
+    });
+
+    stats.visible = visible_count.load();
+    stats.culled = static_cast<uint32_t>(count) - stats.visible;
+    return stats;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+
+#include "renderer/bounds.hpp"
+#include "renderer/culling/frustum.hpp"
+
+namespace Renderer
+{
+    struct SCullStats
+    {
+        uint32_t visible = 0;
+        uint32_t culled = 0;
+    };
+
+    // Flat structure of arrays of world space bounds stored as centre/extents, which makes the
+    // plane test a handful of multiply-adds per plane and keeps every lane of a register busy.
+    // Add all bounds for a frame, call Cull once and then query visibility by the returned index.
+    class CFrustumCuller
+    {
+    public:
+        void Clear();
+        void Reserve(size_t const count);
+
+        uint32_t AddBounds(SAabb const & world_bounds);
+        size_t Count() const { return m_centre_x.size(); }
+
+        // Tests every box against the frustum in parallel chunks using the widest supported kernel
+        SCullStats Cull(SFrustum const & frustum);
+
+        bool IsVisible(uint32_t const index) const { return m_visibility[index] != 0; }
+        std::vector<uint8_t> const & GetVisibility() const { return m_visibility; }
+
+    private:
+        std::vector<float> m_centre_x;
+        std::vector<float> m_centre_y;
+        std::vector<float> m_centre_z;
+        std::vector<float> m_extent_x;
+        std::vector<float> m_extent_y;
+        std::vector<float> m_extent_z;
+
+        std::vector<uint8_t> m_visibility;
+    };
+}
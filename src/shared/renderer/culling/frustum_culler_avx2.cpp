@@ -0,0 +1,78 @@
+#include "renderer/culling/frustum_culling_kernels.hpp"
+
+#include "utility/cpu_features.hpp"
+
+#if GOAT_ARCH_X86
+
+#include <immintrin.h>
+
+uint32_t Renderer::CullingKernels::cull_avx2(SFrustum const & frustum,
+                                             SAabbStreams const & aabbs,
+                                             size_t const begin,
+                                             size_t const end,
+                                             uint8_t * visibility)
+{
+    __m256 const sign_mask = _mm256_set1_ps(-0.0f);
+    __m256 const zero = _mm256_setzero_ps();
+
+    __m256 plane_x[SFrustum::PLANE_COUNT];
+    __m256 plane_y[SFrustum::PLANE_COUNT];
+    __m256 plane_z[SFrustum::PLANE_COUNT];
+    __m256 plane_w[SFrustum::PLANE_COUNT];
+    for (uint32_t p = 0; p < SFrustum::PLANE_COUNT; ++p)
+    {
+        plane_x[p] = _mm256_set1_ps(frustum.planes[p].x);
+        plane_y[p] = _mm256_set1_ps(frustum.planes[p].y);
+        plane_z[p] = _mm256_set1_ps(frustum.planes[p].z);
+        plane_w[p] = _mm256_set1_ps(frustum.planes[p].w);
+    }
+
+    uint32_t visible_count = 0;
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 const cx = _mm256_loadu_ps(aabbs.centre_x + i);
+        __m256 const cy = _mm256_loadu_ps(aabbs.centre_y + i);
+        __m256 const cz = _mm256_loadu_ps(aabbs.centre_z + i);
+        __m256 const ex = _mm256_loadu_ps(aabbs.extent_x + i);
+        __m256 const ey = _mm256_loadu_ps(aabbs.extent_y + i);
+        __m256 const ez = _mm256_loadu_ps(aabbs.extent_z + i);
+
+        __m256 outside = _mm256_setzero_ps();
+        for (uint32_t p = 0; p < SFrustum::PLANE_COUNT; ++p)
+        {
+            __m256 distance = _mm256_fmadd_ps(plane_x[p], cx, plane_w[p]);
+            distance = _mm256_fmadd_ps(plane_y[p], cy, distance);
+            distance = _mm256_fmadd_ps(plane_z[p], cz, distance);
+
+            __m256 radius = _mm256_mul_ps(_mm256_andnot_ps(sign_mask, plane_x[p]), ex);
+            radius = _mm256_fmadd_ps(_mm256_andnot_ps(sign_mask, plane_y[p]), ey, radius);
+            radius = _mm256_fmadd_ps(_mm256_andnot_ps(sign_mask, plane_z[p]), ez, radius);
+
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), zero, _CMP_LT_OQ));
+        }
+
+        uint32_t const visible_mask = static_cast<uint32_t>(~_mm256_movemask_ps(outside)) & 0xFFu;
+        for (uint32_t lane = 0; lane < 8; ++lane)
+        {
+            uint8_t const visible = static_cast<uint8_t>((visible_mask >> lane) & 1u);
+            visibility[i + lane] = visible;
+            visible_count += visible;
+        }
+    }
+
+    return visible_count + cull_scalar(frustum, aabbs, i, end, visibility);
+}
+
+#else
+
+uint32_t Renderer::CullingKernels::cull_avx2(SFrustum const & frustum,
+                                             SAabbStreams const & aabbs,
+                                             size_t const begin,
+                                             size_t const end,
+                                             uint8_t * visibility)
+{
+    return cull_scalar(frustum, aabbs, begin, end, visibility);
+}
+
+#endif
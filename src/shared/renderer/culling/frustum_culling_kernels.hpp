@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+
+#include "renderer/culling/frustum.hpp"
+
+namespace Renderer
+{
+    struct SAabbStreams
+    {
+        float const * centre_x = nullptr;
+        float const * centre_y = nullptr;
+        float const * centre_z = nullptr;
+        float const * extent_x = nullptr;
+        float const * extent_y = nullptr;
+        float const * extent_z = nullptr;
+    };
+
+    // Every kernel tests boxes [begin, end), writes 1 (visible) or 0 (culled) per box into
+    // visibility and returns the number of visible boxes. The SIMD versions live in their own
+    // translation units so only they get built with the wider instruction set flags.
+    namespace CullingKernels
+    {
+        using CullFunc = uint32_t (*)(SFrustum const & frustum,
+                                      SAabbStreams const & aabbs,
+                                      size_t const begin,
+                                      size_t const end,
+                                      uint8_t * visibility);
+
+        uint32_t cull_scalar(SFrustum const & frustum, SAabbStreams const & aabbs, size_t const begin, size_t const end, uint8_t * visibility);
+        uint32_t cull_sse41(SFrustum const & frustum, SAabbStreams const & aabbs, size_t const begin, size_t const end, uint8_t * visibility);
+        uint32_t cull_avx2(SFrustum const & frustum, SAabbStreams const & aabbs, size_t const begin, size_t const end, uint8_t * visibility);
+
+        // Picks the widest kernel the running CPU supports
+        CullFunc select_cull_kernel();
+    }
+}
@@ -0,0 +1,67 @@
+#include "draw_batch.hpp"
+
+#include "utility/memory/memory_tracker.hpp"
+
+Renderer::CDrawBatch::CDrawBatch(Memory::CFrameArena & arena)
+: m_arena(arena)
+, m_mesh_pool()
+, m_commands(arena.Allocator<SDrawCommand>())
+, m_command_meshes(arena.Allocator<CMesh const *>())
+, m_command_ranges(arena.Allocator<SMeshRange>())
+, m_instances(arena.Allocator<SDrawInstance>())
+{
+}
+
+void Renderer::CDrawBatch::Clear()
+{
+    m_mesh_pool.BeginFrame();
+    m_commands = m_arena.MakeVector<SDrawCommand>(m_commands.size());
+    m_command_meshes = m_arena.MakeVector<CMesh const *>(m_command_meshes.size());
+    m_command_ranges = m_arena.MakeVector<SMeshRange>(m_command_ranges.size());
+    m_instances = m_arena.MakeVector<SDrawInstance>(m_instances.size());
+}
+
+void Renderer::CDrawBatch::Add(IRenderable const & renderable)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    CMesh const & mesh = renderable.GetMesh();
+    if (mesh.GetIndexCount() == 0)
+    {
+        return;
+    }
+
+    uint32_t const instance = static_cast<uint32_t>(m_instances.size());
+    SDrawInstance draw_instance;
+    draw_instance.transform = renderable.GetTransformMatrix();
+    draw_instance.tint = renderable.GetTint();
+    m_instances.emplace_back(draw_instance);
+
+    // Instances are appended in command order, so another copy of the previous mesh is just
+    // one more instance of its command
+    if (m_command_meshes.empty() == false && m_command_meshes.back() == &mesh)
+    {
+        ++m_commands.back().instance_count;
+        return;
+    }
+
+    SDrawCommand command;
+    command.index_count = mesh.GetIndexCount();
+    command.instance_count = 1;
+    command.base_instance = instance;
+    m_commands.emplace_back(command);
+    m_command_meshes.emplace_back(&mesh);
+}
+
+void Renderer::CDrawBatch::Finish()
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    m_command_ranges.resize(m_command_meshes.size());
+    m_mesh_pool.Place(m_command_meshes.data(), m_command_meshes.size(), m_command_ranges.data());
+    for (size_t i = 0; i < m_commands.size(); ++i)
+    {
+        m_commands[i].first_index = m_command_ranges[i].first_index;
+        m_commands[i].base_vertex = m_command_ranges[i].base_vertex;
+    }
+}
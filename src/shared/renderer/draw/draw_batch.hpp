@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cinttypes>
+
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "renderer/renderable.hpp"
+#include "renderer/draw/mesh_pool.hpp"
+#include "utility/memory/frame_arena.hpp"
+
+namespace Renderer
+{
+    // Laid out like both DrawElementsIndirectCommand in GL and VkDrawIndexedIndirectCommand, so
+    // the same array goes straight into either backend's indirect buffer
+    struct SDrawCommand
+    {
+        uint32_t index_count = 0;
+        uint32_t instance_count = 0;
+        uint32_t first_index = 0;
+        int32_t base_vertex = 0;
+        // Index of the first instance's transform, read through a per instance vertex attribute
+        uint32_t base_instance = 0;
+    };
+    static_assert(sizeof(SDrawCommand) == 20, "SDrawCommand has to match the indirect command layout");
+
+    // Everything a renderable has of its own, read through per instance vertex attributes
+    struct SDrawInstance
+    {
+        glm::mat4 transform = glm::mat4(1.0f);
+        glm::vec4 tint = glm::vec4(1.0f);
+    };
+
+    // One frame's draws as indirect commands over the backend's resident mesh pool. Each added
+    // renderable gets an instance, and renderables added back to back with the same mesh become
+    // extra instances of one command. The commands and instances are built in the frame arena and
+    // streamed up every frame, the geometry only when the pool says a mesh isn't resident yet.
+    // Finish has to be called once everything is added, before the batch is uploaded.
+    class CDrawBatch
+    {
+    public:
+        explicit CDrawBatch(Memory::CFrameArena & arena = Memory::get_frame_arena());
+
+        // Starts a new frame's batch in the arena's current frame
+        void Clear();
+
+        void Add(IRenderable const & renderable);
+        // Places the frame's meshes in the pool and points the commands at them
+        void Finish();
+
+        CMeshPool const & GetMeshPool() const { return m_mesh_pool; }
+        Memory::arena_vector<SDrawCommand> const & GetCommands() const { return m_commands; }
+        Memory::arena_vector<SDrawInstance> const & GetInstances() const { return m_instances; }
+
+        bool IsEmpty() const { return m_commands.empty(); }
+
+    private:
+        Memory::CFrameArena & m_arena;
+        CMeshPool m_mesh_pool;
+        Memory::arena_vector<SDrawCommand> m_commands;
+        // The mesh each command draws, until Finish swaps them for ranges
+        Memory::arena_vector<CMesh const *> m_command_meshes;
+        Memory::arena_vector<SMeshRange> m_command_ranges;
+        Memory::arena_vector<SDrawInstance> m_instances;
+    };
+}
@@ -0,0 +1,107 @@
+#include "mesh_pool.hpp"
+
+#include "utility/memory/memory_tracker.hpp"
+
+#include <algorithm>
+
+namespace
+{
+    // Room for a few thousand small meshes before the first regrow
+    constexpr uint32_t MIN_VERTEX_CAPACITY = 64 * 1024;
+    constexpr uint32_t MIN_INDEX_CAPACITY = 128 * 1024;
+
+    uint32_t grow_capacity(uint32_t capacity, uint64_t const required)
+    {
+        // Twice what's needed leaves space for the meshes that turn up next
+        while (static_cast<uint64_t>(capacity) < required * 2 && capacity <= UINT32_MAX / 2)
+        {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+}
+
+Renderer::CMeshPool::CMeshPool()
+: m_vertex_capacity(MIN_VERTEX_CAPACITY)
+, m_index_capacity(MIN_INDEX_CAPACITY)
+, m_vertex_count(0)
+, m_index_count(0)
+, m_generation(0)
+, m_ranges()
+, m_uploads()
+{
+}
+
+void Renderer::CMeshPool::BeginFrame()
+{
+    m_uploads.clear();
+}
+
+void Renderer::CMeshPool::Place(CMesh const * const * meshes, size_t const count, SMeshRange * out_ranges)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    if (TryPlace(meshes, count, out_ranges) == false)
+    {
+        // Sized to fit every one of them, so the second go can't run out
+        Reset(meshes, count);
+        TryPlace(meshes, count, out_ranges);
+    }
+}
+
+bool Renderer::CMeshPool::TryPlace(CMesh const * const * meshes, size_t const count, SMeshRange * out_ranges)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        CMesh const & mesh = *meshes[i];
+        auto const existing = m_ranges.find(mesh.GetId());
+        if (existing != m_ranges.end())
+        {
+            out_ranges[i] = existing->second;
+            continue;
+        }
+
+        if (mesh.GetVertexCount() > m_vertex_capacity - m_vertex_count ||
+            mesh.GetIndexCount() > m_index_capacity - m_index_count)
+        {
+            return false;
+        }
+
+        SMeshRange range;
+        range.first_index = m_index_count;
+        range.index_count = mesh.GetIndexCount();
+        range.base_vertex = static_cast<int32_t>(m_vertex_count);
+        m_vertex_count += mesh.GetVertexCount();
+        m_index_count += mesh.GetIndexCount();
+
+        m_ranges.emplace(mesh.GetId(), range);
+        m_uploads.push_back({ &mesh, range });
+        out_ranges[i] = range;
+    }
+    return true;
+}
+
+void Renderer::CMeshPool::Reset(CMesh const * const * meshes, size_t const count)
+{
+    m_ranges.clear();
+    m_uploads.clear();
+    m_vertex_count = 0;
+    m_index_count = 0;
+    ++m_generation;
+
+    // The same mesh can be in the list more than once, it only needs space the once
+    uint64_t required_vertices = 0;
+    uint64_t required_indices = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (m_ranges.emplace(meshes[i]->GetId(), SMeshRange()).second == true)
+        {
+            required_vertices += meshes[i]->GetVertexCount();
+            required_indices += meshes[i]->GetIndexCount();
+        }
+    }
+    m_ranges.clear();
+
+    m_vertex_capacity = grow_capacity(std::max(m_vertex_capacity, MIN_VERTEX_CAPACITY), required_vertices);
+    m_index_capacity = grow_capacity(std::max(m_index_capacity, MIN_INDEX_CAPACITY), required_indices);
+}
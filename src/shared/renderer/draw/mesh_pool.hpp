@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <unordered_map>
+
+#include "renderer/mesh.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+namespace Renderer
+{
+    // Where one mesh's geometry sits in the pool. Indices are relative to base_vertex, so they go
+    // up untouched and the draw adds the offset.
+    struct SMeshRange
+    {
+        uint32_t first_index = 0;
+        uint32_t index_count = 0;
+        int32_t base_vertex = 0;
+    };
+
+    // A mesh placed this frame that the backend still has to copy into its buffers
+    struct SMeshUpload
+    {
+        CMesh const * mesh = nullptr;
+        SMeshRange range;
+    };
+
+    // Keeps track of which meshes are resident in a backend's GPU geometry buffers: one vertex
+    // buffer per attribute and one index buffer, sized to GetVertexCapacity and
+    // GetIndexCapacity. A mesh is copied up the first frame it's drawn and stays where it was
+    // put for as long as the buffers last, so a shared or unchanging mesh (a tilemap chunk
+    // between edits) costs nothing to draw again. Meshes never change after Create, and are
+    // keyed by their id, so a rebuilt one is just a new mesh.
+    //
+    // Space is handed out in order and never freed on its own. When a frame's meshes don't fit
+    // the pool starts again with only those meshes, growing first if they'd fill more than half
+    // of it, and bumps the generation so the backend knows to recreate its buffers rather than
+    // overwrite ranges earlier frames may still be drawing.
+    class CMeshPool
+    {
+    public:
+        CMeshPool();
+
+        // Forgets last frame's uploads
+        void BeginFrame();
+
+        // Finds or makes room for each mesh, writing where it went to out_ranges. The meshes have
+        // to stay alive until the backend has done the uploads.
+        void Place(CMesh const * const * meshes, size_t const count, SMeshRange * out_ranges);
+
+        Memory::tagged_vector<SMeshUpload, Memory::EMemoryTag::Renderer> const & GetUploads() const { return m_uploads; }
+
+        uint32_t GetVertexCapacity() const { return m_vertex_capacity; }
+        uint32_t GetIndexCapacity() const { return m_index_capacity; }
+        uint64_t GetGeneration() const { return m_generation; }
+        size_t GetResidentCount() const { return m_ranges.size(); }
+
+    private:
+        bool TryPlace(CMesh const * const * meshes, size_t const count, SMeshRange * out_ranges);
+        void Reset(CMesh const * const * meshes, size_t const count);
+
+        uint32_t m_vertex_capacity;
+        uint32_t m_index_capacity;
+        uint32_t m_vertex_count;
+        uint32_t m_index_count;
+        uint64_t m_generation;
+
+        std::unordered_map<uint64_t, SMeshRange> m_ranges;
+        Memory::tagged_vector<SMeshUpload, Memory::EMemoryTag::Renderer> m_uploads;
+    };
+}
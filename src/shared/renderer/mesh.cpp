@@ -0,0 +1,105 @@
+#include "mesh.hpp"
+
+#include "utility/memory/memory_tracker.hpp"
+
+#include <atomic>
+#include <cstring>
+
+#include <glm/common.hpp>
+
+namespace
+{
+    std::atomic<uint64_t> next_mesh_id(1);
+}
+
+Renderer::CMesh::CMesh()
+: m_id(next_mesh_id.fetch_add(1, std::memory_order_relaxed))
+, m_data()
+, m_positions(nullptr)
+, m_colours(nullptr)
+, m_indices(nullptr)
+, m_vertex_count(0)
+, m_index_count(0)
+, m_local_bounds()
+{
+}
+
+Renderer::MeshRef Renderer::CMesh::Create(glm::vec3 const * positions,
+                                          uint32_t const vertex_count,
+                                          glm::vec4 const * colours,
+                                          uint32_t const * indices,
+                                          uint32_t const index_count)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    // Not make_shared, the constructor is private
+    std::shared_ptr<CMesh> mesh(new CMesh());
+    mesh->m_vertex_count = vertex_count;
+    mesh->m_index_count = indices != nullptr && index_count > 0 ? index_count : vertex_count;
+
+    // Every stream is made of 4 byte values, so they pack with no padding between them
+    size_t const positions_size = sizeof(glm::vec3) * mesh->m_vertex_count;
+    size_t const colours_size = sizeof(glm::vec4) * mesh->m_vertex_count;
+    size_t const indices_size = sizeof(uint32_t) * mesh->m_index_count;
+    mesh->m_data.reset(new uint8_t[positions_size + colours_size + indices_size]);
+
+    glm::vec3 * const out_positions = reinterpret_cast<glm::vec3 *>(mesh->m_data.get());
+    glm::vec4 * const out_colours = reinterpret_cast<glm::vec4 *>(mesh->m_data.get() + positions_size);
+    uint32_t * const out_indices = reinterpret_cast<uint32_t *>(mesh->m_data.get() + positions_size + colours_size);
+
+    if (vertex_count > 0)
+    {
+        std::memcpy(out_positions, positions, positions_size);
+    }
+
+    for (uint32_t i = 0; i < vertex_count; ++i)
+    {
+        out_colours[i] = colours != nullptr ? colours[i] : glm::vec4(1.0f);
+    }
+
+    if (indices != nullptr && index_count > 0)
+    {
+        std::memcpy(out_indices, indices, indices_size);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < vertex_count; ++i)
+        {
+            out_indices[i] = i;
+        }
+    }
+
+    if (vertex_count > 0)
+    {
+        mesh->m_local_bounds.min = positions[0];
+        mesh->m_local_bounds.max = positions[0];
+        for (uint32_t i = 1; i < vertex_count; ++i)
+        {
+            mesh->m_local_bounds.min = glm::min(mesh->m_local_bounds.min, positions[i]);
+            mesh->m_local_bounds.max = glm::max(mesh->m_local_bounds.max, positions[i]);
+        }
+    }
+
+    mesh->m_positions = out_positions;
+    mesh->m_colours = out_colours;
+    mesh->m_indices = out_indices;
+    return mesh;
+}
+
+Renderer::MeshRef Renderer::CMesh::Create(std::vector<glm::vec3> const & positions,
+                                          std::vector<glm::vec4> const & colours,
+                                          std::vector<uint32_t> const & indices)
+{
+    // Short colour arrays are treated as missing rather than read past the end
+    return Create(positions.data(),
+                  static_cast<uint32_t>(positions.size()),
+                  colours.size() >= positions.size() ? colours.data() : nullptr,
+                  indices.data(),
+                  static_cast<uint32_t>(indices.size()));
+}
+
+Renderer::MeshRef const & Renderer::CMesh::Empty()
+{
+    static MeshRef const empty = Create(nullptr, 0, nullptr, nullptr, 0);
+    return empty;
+}
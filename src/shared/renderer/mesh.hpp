@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cinttypes>
+#include <memory>
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "renderer/bounds.hpp"
+
+namespace Renderer
+{
+    class CMesh;
+
+    // Meshes are only handed out through these, they live as long as something draws them
+    using MeshRef = std::shared_ptr<CMesh const>;
+
+    // Geometry built once and shared by every renderable that draws it. Nothing changes a mesh
+    // after Create, so it can be held from anywhere, any thread included, without copying it.
+    // Positions, colours and indices sit back to back in a single allocation.
+    class CMesh
+    {
+    public:
+        // Copies the geometry in. Without colours every vertex is white and without indices the
+        // vertices are drawn in order, 0, 1, 2...
+        static MeshRef Create(glm::vec3 const * positions,
+                              uint32_t const vertex_count,
+                              glm::vec4 const * colours,
+                              uint32_t const * indices,
+                              uint32_t const index_count);
+        static MeshRef Create(std::vector<glm::vec3> const & positions,
+                              std::vector<glm::vec4> const & colours,
+                              std::vector<uint32_t> const & indices);
+
+        // One mesh with nothing in it, for renderables with nothing to draw yet
+        static MeshRef const & Empty();
+
+        CMesh(CMesh const &) = delete;
+        CMesh & operator=(CMesh const &) = delete;
+
+        // Never reused for the life of the process, unlike the mesh's address, so anything
+        // keeping geometry around for a mesh (the GPU mesh pools) keys on this
+        uint64_t GetId() const { return m_id; }
+
+        uint32_t GetVertexCount() const { return m_vertex_count; }
+        uint32_t GetIndexCount() const { return m_index_count; }
+
+        glm::vec3 const * GetPositions() const { return m_positions; }
+        // One per vertex
+        glm::vec4 const * GetColours() const { return m_colours; }
+        uint32_t const * GetIndices() const { return m_indices; }
+
+        // Object space bounds of the positions, used for culling before anything is submitted
+        SAabb const & GetLocalBounds() const { return m_local_bounds; }
+
+    private:
+        CMesh();
+
+        uint64_t m_id;
+        std::unique_ptr<uint8_t[]> m_data;
+        glm::vec3 const * m_positions;
+        glm::vec4 const * m_colours;
+        uint32_t const * m_indices;
+        uint32_t m_vertex_count;
+        uint32_t m_index_count;
+        SAabb m_local_bounds;
+    };
+}
@@ -0,0 +1,48 @@
+#include "opengl_functions.hpp"
+
+#include "utility/logging.hpp"
+
+#include <string>
+#include <unordered_set>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+Renderer::SOpenGLFunctions Renderer::load_opengl_functions()
+{
+    // Drivers hand back their newest core version for a 3.2 request, apart from macOS which
+    // stops at 4.1
+    int major_version = 0;
+    int minor_version = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major_version);
+    glGetIntegerv(GL_MINOR_VERSION, &minor_version);
+    int const version = major_version * 10 + minor_version;
+
+    std::unordered_set<std::string> extensions;
+    int extension_count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extension_count);
+    for (int i = 0; i < extension_count; ++i)
+    {
+        extensions.emplace(reinterpret_cast<char const *>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i))));
+    }
+
+    SOpenGLFunctions functions;
+    if (version >= 43 || extensions.count("GL_ARB_multi_draw_indirect") > 0)
+    {
+        functions.multi_draw_elements_indirect = reinterpret_cast<SOpenGLFunctions::MultiDrawElementsIndirect>(glfwGetProcAddress("glMultiDrawElementsIndirect"));
+    }
+    if (version >= 44 || extensions.count("GL_ARB_buffer_storage") > 0)
+    {
+        functions.buffer_storage = reinterpret_cast<SOpenGLFunctions::BufferStorage>(glfwGetProcAddress("glBufferStorage"));
+    }
+    if (version >= 33 || extensions.count("GL_ARB_timer_query") > 0)
+    {
+        functions.get_query_object_ui64v = reinterpret_cast<SOpenGLFunctions::GetQueryObjectUi64v>(glfwGetProcAddress("glGetQueryObjectui64v"));
+    }
+
+    DEBUG_LOG("OpenGL " + std::to_string(major_version) + "." + std::to_string(minor_version)
+              + (functions.multi_draw_elements_indirect != nullptr ? ", multi draw indirect" : "")
+              + (functions.buffer_storage != nullptr ? ", buffer storage" : "")
+              + (functions.get_query_object_ui64v != nullptr ? ", timer queries" : ""));
+    return functions;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+
+#if defined(_WIN32) && !defined(_WIN64)
+#define GOAT_GL_API __stdcall
+#else
+#define GOAT_GL_API
+#endif
+
+namespace Renderer
+{
+    // Enums from past the 3.2 core context the window asks for, not every loader is generated
+    // with them
+    constexpr uint32_t DRAW_INDIRECT_BUFFER = 0x8F3F;
+    constexpr uint32_t MAP_PERSISTENT_BIT = 0x0040;
+    constexpr uint32_t MAP_COHERENT_BIT = 0x0080;
+    constexpr uint32_t TIME_ELAPSED = 0x88BF;
+
+    // Entry points from the same versions, loaded by hand for the same reason. Each is null
+    // unless the context version or an extension says the driver has it.
+    struct SOpenGLFunctions
+    {
+        // GL 4.3 or ARB_multi_draw_indirect
+        using MultiDrawElementsIndirect = void (GOAT_GL_API *)(uint32_t mode, uint32_t type, void const * indirect, int32_t draw_count, int32_t stride);
+        // GL 4.4 or ARB_buffer_storage
+        using BufferStorage = void (GOAT_GL_API *)(uint32_t target, std::ptrdiff_t size, void const * data, uint32_t flags);
+        // GL 3.3 or ARB_timer_query
+        using GetQueryObjectUi64v = void (GOAT_GL_API *)(uint32_t id, uint32_t pname, uint64_t * params);
+
+        MultiDrawElementsIndirect multi_draw_elements_indirect = nullptr;
+        BufferStorage buffer_storage = nullptr;
+        GetQueryObjectUi64v get_query_object_ui64v = nullptr;
+    };
+
+    // Needs a current context with GL loaded
+    SOpenGLFunctions load_opengl_functions();
+}
@@ -0,0 +1,95 @@
+#include "opengl_gpu_timer.hpp"
+
+#include <glad/glad.h>
+
+Renderer::OpenGLGpuTimer::OpenGLGpuTimer(SOpenGLFunctions::GetQueryObjectUi64v get_query_object_ui64v)
+: m_get_query_object_ui64v(get_query_object_ui64v)
+, m_queries()
+, m_current(0)
+, m_active(false)
+, m_latest()
+{
+    if (m_get_query_object_ui64v != nullptr)
+    {
+        for (SQuery & query : m_queries)
+        {
+            glGenQueries(1, &query.query);
+        }
+    }
+}
+
+Renderer::OpenGLGpuTimer::~OpenGLGpuTimer()
+{
+    for (SQuery & query : m_queries)
+    {
+        if (query.query != 0)
+        {
+            glDeleteQueries(1, &query.query);
+        }
+    }
+}
+
+void Renderer::OpenGLGpuTimer::Begin(uint64_t const frame_index)
+{
+    if (m_get_query_object_ui64v == nullptr || m_active == true)
+    {
+        return;
+    }
+
+    m_current = (m_current + 1) % GPU_TIMER_QUERY_COUNT;
+    SQuery & query = m_queries[m_current];
+    if (query.pending == true)
+    {
+        Resolve(query, true);
+    }
+
+    glBeginQuery(TIME_ELAPSED, query.query);
+    query.frame_index = frame_index;
+    query.pending = true;
+    m_active = true;
+}
+
+void Renderer::OpenGLGpuTimer::End()
+{
+    if (m_active == false)
+    {
+        return;
+    }
+
+    glEndQuery(TIME_ELAPSED);
+    m_active = false;
+
+    // Oldest first so the latest time only ever moves forward
+    for (uint32_t i = 1; i < GPU_TIMER_QUERY_COUNT; ++i)
+    {
+        SQuery & query = m_queries[(m_current + i) % GPU_TIMER_QUERY_COUNT];
+        if (query.pending == true)
+        {
+            Resolve(query, false);
+        }
+    }
+}
+
+void Renderer::OpenGLGpuTimer::Resolve(SQuery & query, bool const wait)
+{
+    if (wait == false)
+    {
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(query.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE)
+        {
+            return;
+        }
+    }
+
+    uint64_t nanoseconds = 0;
+    m_get_query_object_ui64v(query.query, GL_QUERY_RESULT, &nanoseconds);
+    query.pending = false;
+
+    if (m_latest.valid == false || query.frame_index > m_latest.frame_index)
+    {
+        m_latest.frame_index = query.frame_index;
+        m_latest.milliseconds = static_cast<float>(static_cast<double>(nanoseconds) / 1000000.0);
+        m_latest.valid = true;
+    }
+}
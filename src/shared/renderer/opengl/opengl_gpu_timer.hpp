@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cinttypes>
+
+#include "renderer/render_context.hpp"
+#include "renderer/opengl/opengl_functions.hpp"
+
+namespace Renderer
+{
+    // Frames timed at once, a frame only waits on a query if the GPU is this far behind
+    constexpr uint32_t GPU_TIMER_QUERY_COUNT = 4;
+
+    // Times each frame's GL work with a time elapsed query. Results are only read once the
+    // driver says they're available, so timing never stalls the frame.
+    class OpenGLGpuTimer
+    {
+    public:
+        // Needs a current context, get_query_object_ui64v is null where the driver can't time
+        // and then nothing is measured
+        explicit OpenGLGpuTimer(SOpenGLFunctions::GetQueryObjectUi64v get_query_object_ui64v);
+        ~OpenGLGpuTimer();
+
+        OpenGLGpuTimer(OpenGLGpuTimer const &) = delete;
+        OpenGLGpuTimer & operator=(OpenGLGpuTimer const &) = delete;
+
+        // Around everything drawn for the frame
+        void Begin(uint64_t const frame_index);
+        void End();
+
+        SGpuFrameTime GetLatest() const { return m_latest; }
+
+    private:
+        struct SQuery
+        {
+            uint32_t query = 0;
+            uint64_t frame_index = 0;
+            bool pending = false;
+        };
+
+        // Reads the query if it's finished, or waits for it with wait set
+        void Resolve(SQuery & query, bool const wait);
+
+        SOpenGLFunctions::GetQueryObjectUi64v m_get_query_object_ui64v;
+        std::array<SQuery, GPU_TIMER_QUERY_COUNT> m_queries;
+        uint32_t m_current;
+        bool m_active;
+        SGpuFrameTime m_latest;
+    };
+}
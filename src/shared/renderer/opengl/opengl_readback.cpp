@@ -0,0 +1,155 @@
+#include "opengl_readback.hpp"
+
+#include "utility/logging.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include <glad/glad.h>
+
+namespace
+{
+    constexpr GLuint64 FENCE_TIMEOUT_NS = 1000000000;
+}
+
+Renderer::OpenGLReadback::OpenGLReadback()
+: m_slots()
+, m_next_slot(0)
+, m_pending_count(0)
+, m_finished()
+{
+}
+
+Renderer::OpenGLReadback::~OpenGLReadback()
+{
+    for (SSlot & slot : m_slots)
+    {
+        if (slot.fence != nullptr)
+        {
+            glDeleteSync(static_cast<GLsync>(slot.fence));
+        }
+        if (slot.buffer != 0)
+        {
+            glDeleteBuffers(1, &slot.buffer);
+        }
+    }
+}
+
+void Renderer::OpenGLReadback::Capture(uint32_t const width, uint32_t const height, uint64_t const frame_index)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    if (width == 0 || height == 0)
+    {
+        return;
+    }
+
+    if (m_pending_count == READBACK_SLOT_COUNT)
+    {
+        ResolveOldest(true);
+    }
+
+    SSlot & slot = m_slots[m_next_slot];
+    size_t const size = static_cast<size_t>(width) * height * 4;
+
+    if (slot.buffer == 0)
+    {
+        glGenBuffers(1, &slot.buffer);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    if (slot.capacity < size)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+        slot.capacity = size;
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.width = width;
+    slot.height = height;
+    slot.frame_index = frame_index;
+
+    m_next_slot = (m_next_slot + 1) % READBACK_SLOT_COUNT;
+    ++m_pending_count;
+}
+
+bool Renderer::OpenGLReadback::Pop(SCapturedFrame & out_frame, bool const wait)
+{
+    if (m_finished.empty() == true && m_pending_count > 0)
+    {
+        ResolveOldest(wait);
+    }
+
+    if (m_finished.empty() == true)
+    {
+        return false;
+    }
+
+    out_frame = std::move(m_finished.front());
+    m_finished.pop_front();
+    return true;
+}
+
+bool Renderer::OpenGLReadback::ResolveOldest(bool const wait)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    SSlot & slot = m_slots[(m_next_slot + READBACK_SLOT_COUNT - m_pending_count) % READBACK_SLOT_COUNT];
+    GLsync const fence = static_cast<GLsync>(slot.fence);
+
+    // Without wait this is just a poll. Flushing makes sure the fence actually reaches the GPU,
+    // otherwise a wait could sit on a fence that was never submitted.
+    GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait == true ? FENCE_TIMEOUT_NS : 0);
+    while (wait == true && result == GL_TIMEOUT_EXPIRED)
+    {
+        result = glClientWaitSync(fence, 0, FENCE_TIMEOUT_NS);
+    }
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        return false;
+    }
+
+    glDeleteSync(fence);
+    slot.fence = nullptr;
+    --m_pending_count;
+
+    if (result == GL_WAIT_FAILED)
+    {
+        ERROR_LOG("Waiting on a readback fence failed, dropping the capture of frame " + std::to_string(slot.frame_index));
+        return false;
+    }
+
+    size_t const row_size = static_cast<size_t>(slot.width) * 4;
+    size_t const size = row_size * slot.height;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    uint8_t const * mapped = static_cast<uint8_t const *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT));
+    if (mapped == nullptr)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        ERROR_LOG("Failed to map readback buffer, dropping the capture of frame " + std::to_string(slot.frame_index));
+        return false;
+    }
+
+    SCapturedFrame frame;
+    frame.frame_index = slot.frame_index;
+    frame.width = slot.width;
+    frame.height = slot.height;
+    frame.pixels.resize(size);
+    // GL reads bottom row first, captures are stored top row first
+    for (uint32_t y = 0; y < slot.height; ++y)
+    {
+        std::memcpy(frame.pixels.data() + row_size * y, mapped + row_size * (slot.height - 1 - y), row_size);
+    }
+
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_finished.emplace_back(std::move(frame));
+    return true;
+}
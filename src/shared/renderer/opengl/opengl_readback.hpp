@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cinttypes>
+#include <deque>
+
+#include "renderer/capture/captured_frame.hpp"
+
+namespace Renderer
+{
+    // Copies in flight at once, a fourth request waits for the oldest
+    constexpr uint32_t READBACK_SLOT_COUNT = 3;
+
+    // Frame captures copied into pixel pack buffers. glReadPixels into a buffer returns as soon
+    // as the copy is queued, a fence after it says when the pixels can be mapped, so the frame
+    // never waits for the GPU to catch up the way reading into client memory would.
+    class OpenGLReadback
+    {
+    public:
+        // Needs a current context
+        OpenGLReadback();
+        ~OpenGLReadback();
+
+        OpenGLReadback(OpenGLReadback const &) = delete;
+        OpenGLReadback & operator=(OpenGLReadback const &) = delete;
+
+        // Queues a copy of the bound read framebuffer, after the frame is drawn and before the
+        // buffers are swapped
+        void Capture(uint32_t const width, uint32_t const height, uint64_t const frame_index);
+
+        bool Pop(SCapturedFrame & out_frame, bool const wait);
+
+    private:
+        struct SSlot
+        {
+            uint32_t buffer = 0;
+            size_t capacity = 0;
+            // GLsync, kept opaque so this header doesn't need the loader
+            void * fence = nullptr;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint64_t frame_index = 0;
+        };
+
+        // Moves the oldest copy into m_finished if it's done, or once it is with wait set
+        bool ResolveOldest(bool const wait);
+
+        std::array<SSlot, READBACK_SLOT_COUNT> m_slots;
+        uint32_t m_next_slot;
+        uint32_t m_pending_count;
+        std::deque<SCapturedFrame> m_finished;
+    };
+}
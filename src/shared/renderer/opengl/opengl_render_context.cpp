@@ -3,9 +3,13 @@
 #include "utility/logging.hpp"
 #include "utility/optional.hpp"
 #include "utility/file/file_helper.hpp"
+#include "utility/memory/memory_tracker.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cinttypes>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <set>
@@ -15,11 +19,44 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
-Renderer::OpenGLRenderContext::OpenGLRenderContext(GLFWwindow * glfw_window)
+namespace
+{
+    uint32_t compile_shader(GLenum const type, char const * source, std::string const & name)
+    {
+        uint32_t const shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+
+        int success = 0;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (success == 0)
+        {
+            char info_log[512];
+            glGetShaderInfoLog(shader, sizeof(info_log), nullptr, info_log);
+            ERROR_LOG("Failed to compile " + name + " shader:\n" + info_log);
+        }
+        return shader;
+    }
+}
+
+Renderer::OpenGLRenderContext::OpenGLRenderContext(GLFWwindow * glfw_window, bool const headless)
 : m_screen_width(0)
 , m_screen_height(0)
 , m_glsl_version("#version 150")
 , m_ptr_glfw_window(glfw_window)
+, m_headless(headless)
+, m_offscreen_target()
+, m_output_framebuffer(0)
+, m_output_width(0)
+, m_output_height(0)
+, m_dynamic_resolution()
+, m_scene_target()
+, m_scene_width(0)
+, m_scene_height(0)
+, m_scene_scaled(false)
+, m_scene_ended(true)
+, m_frame_index(0)
+, m_capture_requested(false)
 {
 }
 
@@ -28,15 +65,39 @@ Renderer::OpenGLRenderContext::~OpenGLRenderContext()
     if (temp_render_data != nullptr)
     {
         glDeleteProgram(temp_render_data->temp_shader_id);
-        glDeleteBuffers(1, &temp_render_data->vbo);
         glDeleteVertexArrays(1, &temp_render_data->vao);
+        glDeleteBuffers(1, &temp_render_data->position_buffer);
+        glDeleteBuffers(1, &temp_render_data->colour_buffer);
+        glDeleteBuffers(1, &temp_render_data->index_buffer);
+        temp_render_data->stream.reset();
     }
+
+    if (m_particle_render_data != nullptr)
+    {
+        glDeleteProgram(m_particle_render_data->shader_id);
+        glDeleteBuffers(1, &m_particle_render_data->quad_vbo);
+        glDeleteVertexArrays(1, &m_particle_render_data->vao);
+        m_particle_render_data->instance_stream.reset();
+    }
+
+    if (m_text_render_data != nullptr)
+    {
+        glDeleteProgram(m_text_render_data->shader_id);
+        glDeleteVertexArrays(1, &m_text_render_data->vao);
+        m_text_render_data->stream.reset();
+    }
+
+    m_readback.reset();
+    m_gpu_timer.reset();
+    DestroyColourTarget(m_scene_target);
+    DestroyColourTarget(m_offscreen_target);
 }
 
 bool Renderer::OpenGLRenderContext::Init()
 {
     glfwMakeContextCurrent(m_ptr_glfw_window);
-    glfwSwapInterval(1); // Enable vsync
+    // Headless never presents, so there is nothing to sync to
+    glfwSwapInterval(m_headless == true ? 0 : 1);
 
     if (gladLoadGL() == 0)
     {
@@ -44,6 +105,25 @@ bool Renderer::OpenGLRenderContext::Init()
 
         return false;
     }
+
+    m_gl_functions = load_opengl_functions();
+
+    if (m_headless == true)
+    {
+        int width = 0;
+        int height = 0;
+        glfwGetFramebufferSize(m_ptr_glfw_window, &width, &height);
+        if (CreateColourTarget(m_offscreen_target, static_cast<uint32_t>(width), static_cast<uint32_t>(height)) == false)
+        {
+            m_last_error = "Failed to create offscreen framebuffer";
+            ERROR_LOG(m_last_error);
+            return false;
+        }
+    }
+
+    m_texture_backend = std::make_unique<OpenGLTextureBackend>();
+    m_readback = std::make_unique<OpenGLReadback>();
+    m_gpu_timer = std::make_unique<OpenGLGpuTimer>(m_gl_functions.get_query_object_ui64v);
     return true;
 }
 
@@ -51,57 +131,692 @@ void Renderer::OpenGLRenderContext::ResizeScreen(uint32_t const width, uint32_t
 {
     m_screen_width = width;
     m_screen_height = height;
+
+    if (m_headless == true && CreateColourTarget(m_offscreen_target, width, height) == false)
+    {
+        ERROR_LOG("Failed to resize offscreen framebuffer");
+    }
 }
 
 void Renderer::OpenGLRenderContext::PreRender()
 {
-    int display_w, display_h;
-    glfwGetFramebufferSize(m_ptr_glfw_window, &display_w, &display_h);
-    glViewport(0, 0, display_w, display_h);
+    m_gpu_timer->Begin(m_frame_index);
+    m_scene_ended = false;
+
+    if (m_headless == true)
+    {
+        m_output_framebuffer = m_offscreen_target.framebuffer;
+        m_output_width = m_offscreen_target.width;
+        m_output_height = m_offscreen_target.height;
+    }
+    else
+    {
+        int display_w = 0;
+        int display_h = 0;
+        glfwGetFramebufferSize(m_ptr_glfw_window, &display_w, &display_h);
+        m_output_framebuffer = 0;
+        m_output_width = static_cast<uint32_t>(std::max(display_w, 0));
+        m_output_height = static_cast<uint32_t>(std::max(display_h, 0));
+    }
+
+    // Picked from the latest frame the GPU finished, a frame or two behind this one
+    m_dynamic_resolution.Update(m_gpu_timer->GetLatest(), m_frame_index);
+    m_dynamic_resolution.GetScaledSize(m_output_width, m_output_height, m_scene_width, m_scene_height);
+
+    m_scene_scaled = false;
+    if (m_dynamic_resolution.IsEnabled() == true && m_output_width > 0 && m_output_height > 0)
+    {
+        if (m_scene_target.width != m_output_width || m_scene_target.height != m_output_height)
+        {
+            if (CreateColourTarget(m_scene_target, m_output_width, m_output_height) == false)
+            {
+                ERROR_LOG("Failed to create the dynamic resolution target, drawing at full resolution");
+            }
+        }
+        m_scene_scaled = m_scene_target.framebuffer != 0 &&
+                         (m_scene_width != m_output_width || m_scene_height != m_output_height);
+    }
+
+    if (m_scene_scaled == true)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_scene_target.framebuffer);
+        glViewport(0, 0, static_cast<GLsizei>(m_scene_width), static_cast<GLsizei>(m_scene_height));
+    }
+    else
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_output_framebuffer);
+        glViewport(0, 0, static_cast<GLsizei>(m_output_width), static_cast<GLsizei>(m_output_height));
+    }
     glClearColor(0.20f, 0.15f, 0.60f, 1.00f);
     glClear(GL_COLOR_BUFFER_BIT);
 }
 
-void Renderer::OpenGLRenderContext::RenderFrame()
+void Renderer::OpenGLRenderContext::EndScene()
 {
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    if (m_scene_ended == true)
+    {
+        return;
+    }
+    m_scene_ended = true;
+
     if (temp_render_data != nullptr)
     {
-        if (temp_render_data->verts.empty() == false)
+        m_cull_stats = m_frustum_culler.Cull(extract_frustum(m_view_projection, EClipDepth::NegativeOneToOne));
+
+        m_draw_batch.Clear();
+        for (size_t i = 0; i < m_submitted_renderables.size(); ++i)
+        {
+            if (m_frustum_culler.IsVisible(static_cast<uint32_t>(i)) == true)
+            {
+                m_draw_batch.Add(*m_submitted_renderables[i]);
+            }
+        }
+
+        if (m_draw_batch.IsEmpty() == false)
         {
-            glBindVertexArray(temp_render_data->vao);
-            glBindBuffer(GL_ARRAY_BUFFER, temp_render_data->vbo);
-            auto & verts = temp_render_data->verts;
-            glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * verts.size(), verts.data(), GL_DYNAMIC_DRAW);
-            glUseProgram(temp_render_data->temp_shader_id);
-            glDrawArrays(GL_TRIANGLES, 0, verts.size());
+            m_draw_batch.Finish();
+            RenderBatch();
         }
-        temp_render_data->verts.clear();
-        temp_render_data->indicies.clear();
-        temp_render_data->cols.clear();
     }
 
-    glfwSwapBuffers(m_ptr_glfw_window);
+    m_submitted_renderables.clear();
+    m_frustum_culler.Clear();
+
+    RenderParticles();
+    m_submitted_emitters.clear();
+
+    if (m_scene_scaled == true)
+    {
+        // Filtered up over the whole output, which leaves nothing of it needing a clear
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_scene_target.framebuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_output_framebuffer);
+        glBlitFramebuffer(0, 0, static_cast<GLint>(m_scene_width), static_cast<GLint>(m_scene_height),
+                          0, 0, static_cast<GLint>(m_output_width), static_cast<GLint>(m_output_height),
+                          GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_output_framebuffer);
+        glViewport(0, 0, static_cast<GLsizei>(m_output_width), static_cast<GLsizei>(m_output_height));
+    }
+
+    // At full resolution whatever scale the scene was drawn at
+    RenderText();
+    m_submitted_text.clear();
+}
+
+void Renderer::OpenGLRenderContext::RenderFrame()
+{
+    EndScene();
+
+    // After the UI as well, it's all part of the frame's GPU time
+    m_gpu_timer->End();
+
+    if (m_capture_requested == true)
+    {
+        GLint viewport[4] = {};
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        m_readback->Capture(static_cast<uint32_t>(viewport[2]), static_cast<uint32_t>(viewport[3]), m_frame_index);
+        m_capture_requested = false;
+    }
+    ++m_frame_index;
+
+    if (m_headless == true)
+    {
+        // Nothing else submits the frame's commands without a swap
+        glFlush();
+    }
+    else
+    {
+        glfwSwapBuffers(m_ptr_glfw_window);
+    }
+}
+
+bool Renderer::OpenGLRenderContext::PopCapturedFrame(SCapturedFrame & out_frame, bool const wait)
+{
+    return m_readback != nullptr && m_readback->Pop(out_frame, wait);
+}
+
+Renderer::SGpuFrameTime Renderer::OpenGLRenderContext::GetGpuFrameTime() const
+{
+    return m_gpu_timer != nullptr ? m_gpu_timer->GetLatest() : SGpuFrameTime();
+}
+
+void Renderer::OpenGLRenderContext::SetDynamicResolution(SDynamicResolutionSettings const & settings)
+{
+    m_dynamic_resolution.SetSettings(settings);
+    if (settings.enabled == false)
+    {
+        DestroyColourTarget(m_scene_target);
+    }
 }
 
 void Renderer::OpenGLRenderContext::SubmitRenderable(IRenderable const * renderable)
 {
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
     if (temp_render_data == nullptr)
     {
         temp_render_data = init_new_renderdata();
     }
 
-    for(auto const & vert : renderable->GetVerts())
+    m_submitted_renderables.emplace_back(renderable);
+    m_frustum_culler.AddBounds(transform_aabb(renderable->GetMesh().GetLocalBounds(), renderable->GetTransformMatrix()));
+}
+
+void Renderer::OpenGLRenderContext::SubmitParticles(CParticleEmitter const * emitter)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    if (m_particle_render_data == nullptr)
+    {
+        m_particle_render_data = init_particle_renderdata();
+    }
+
+    m_submitted_emitters.emplace_back(emitter);
+}
+
+void Renderer::OpenGLRenderContext::SubmitText(CTextRenderer const * text)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    if (m_text_render_data == nullptr)
+    {
+        m_text_render_data = init_text_renderdata();
+    }
+
+    m_submitted_text.emplace_back(text);
+}
+
+bool Renderer::OpenGLRenderContext::CreateColourTarget(SColourTarget & target, uint32_t const width, uint32_t const height)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    DestroyColourTarget(target);
+
+    // A surfaceless context has no default framebuffer to draw into, so everything goes into
+    // one of these, as does a scene drawn at a lower resolution
+    glGenRenderbuffers(1, &target.colour);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.colour);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &target.framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target.colour);
+    GLenum const status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        DestroyColourTarget(target);
+        return false;
+    }
+
+    target.width = width;
+    target.height = height;
+    return true;
+}
+
+void Renderer::OpenGLRenderContext::DestroyColourTarget(SColourTarget & target)
+{
+    if (target.framebuffer != 0)
+    {
+        glDeleteFramebuffers(1, &target.framebuffer);
+    }
+    if (target.colour != 0)
+    {
+        glDeleteRenderbuffers(1, &target.colour);
+    }
+    target = SColourTarget();
+}
+
+void Renderer::OpenGLRenderContext::RenderBatch()
+{
+    SRenderData & data = *temp_render_data;
+    CMeshPool const & mesh_pool = m_draw_batch.GetMeshPool();
+    Memory::arena_vector<SDrawCommand> const & commands = m_draw_batch.GetCommands();
+    Memory::arena_vector<SDrawInstance> const & instances = m_draw_batch.GetInstances();
+
+    // New storage rather than writing over the old, which frames still in flight may be reading
+    if (data.mesh_generation != mesh_pool.GetGeneration())
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, data.position_buffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * mesh_pool.GetVertexCapacity(), nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, data.colour_buffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec4) * mesh_pool.GetVertexCapacity(), nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, data.index_buffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(uint32_t) * mesh_pool.GetIndexCapacity(), nullptr, GL_STATIC_DRAW);
+        data.mesh_generation = mesh_pool.GetGeneration();
+    }
+
+    // Only meshes that weren't resident yet, usually none. Everything goes through the array
+    // buffer binding so the vertex array's element buffer is left alone.
+    for (SMeshUpload const & upload : mesh_pool.GetUploads())
+    {
+        CMesh const & mesh = *upload.mesh;
+        size_t const first_vertex = static_cast<size_t>(upload.range.base_vertex);
+        glBindBuffer(GL_ARRAY_BUFFER, data.position_buffer);
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * first_vertex, sizeof(glm::vec3) * mesh.GetVertexCount(), mesh.GetPositions());
+        glBindBuffer(GL_ARRAY_BUFFER, data.colour_buffer);
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(glm::vec4) * first_vertex, sizeof(glm::vec4) * mesh.GetVertexCount(), mesh.GetColours());
+        glBindBuffer(GL_ARRAY_BUFFER, data.index_buffer);
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(uint32_t) * upload.range.first_index, sizeof(uint32_t) * mesh.GetIndexCount(), mesh.GetIndices());
+    }
+
+    size_t const instances_size = sizeof(SDrawInstance) * instances.size();
+    // Commands start 16 byte aligned after the instances
+    size_t const commands_offset = (instances_size + 15) & ~static_cast<size_t>(15);
+    size_t const region_size = commands_offset + sizeof(SDrawCommand) * commands.size();
+
+    uint8_t * region = data.stream->Map(region_size);
+    if (region == nullptr)
+    {
+        ERROR_LOG("Failed to map the draw stream, skipping the frame's geometry");
+        return;
+    }
+    std::memcpy(region, instances.data(), instances_size);
+    std::memcpy(region + commands_offset, commands.data(), sizeof(SDrawCommand) * commands.size());
+    data.stream->Unmap();
+
+    size_t const region_offset = data.stream->GetRegionOffset();
+    uint32_t const buffer = data.stream->GetBuffer();
+    glBindVertexArray(data.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, data.position_buffer);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), nullptr);
+    glBindBuffer(GL_ARRAY_BUFFER, data.colour_buffer);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), nullptr);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    // A mat4 attribute takes four locations, one column each, and the tint follows it
+    auto const point_instances = [](size_t const offset)
+    {
+        for (uint32_t column = 0; column < 4; ++column)
+        {
+            glVertexAttribPointer(2 + column, 4, GL_FLOAT, GL_FALSE, sizeof(SDrawInstance), reinterpret_cast<void const *>(offset + sizeof(glm::vec4) * column));
+        }
+        glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(SDrawInstance), reinterpret_cast<void const *>(offset + offsetof(SDrawInstance, tint)));
+    };
+    // The element buffer binding is part of the vertex array, so this stays with it
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.index_buffer);
+
+    glUseProgram(data.temp_shader_id);
+    glUniformMatrix4fv(data.view_projection_location, 1, GL_FALSE, &m_view_projection[0][0]);
+
+    if (m_gl_functions.multi_draw_elements_indirect != nullptr)
+    {
+        // Base instance offsets the per instance attributes, so every command finds its own
+        // instances and the whole frame is one call
+        point_instances(region_offset);
+        glBindBuffer(DRAW_INDIRECT_BUFFER, buffer);
+        m_gl_functions.multi_draw_elements_indirect(GL_TRIANGLES,
+                                                    GL_UNSIGNED_INT,
+                                                    reinterpret_cast<void const *>(region_offset + commands_offset),
+                                                    static_cast<GLsizei>(commands.size()),
+                                                    0);
+        glBindBuffer(DRAW_INDIRECT_BUFFER, 0);
+    }
+    else
+    {
+        // Without base instance the instance attributes are pointed at each command's instances
+        for (SDrawCommand const & command : commands)
+        {
+            point_instances(region_offset + sizeof(SDrawInstance) * command.base_instance);
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES,
+                                              static_cast<GLsizei>(command.index_count),
+                                              GL_UNSIGNED_INT,
+                                              reinterpret_cast<void const *>(sizeof(uint32_t) * command.first_index),
+                                              static_cast<GLsizei>(command.instance_count),
+                                              command.base_vertex);
+        }
+    }
+
+    data.stream->Fence();
+    glBindVertexArray(0);
+}
+
+void Renderer::OpenGLRenderContext::RenderParticles()
+{
+    if (m_submitted_emitters.empty() == true)
+    {
+        return;
+    }
+
+    SParticleRenderData const & data = *m_particle_render_data;
+
+    size_t particle_count = 0;
+    for (CParticleEmitter const * emitter : m_submitted_emitters)
+    {
+        particle_count += emitter->GetCount();
+    }
+    if (particle_count == 0)
+    {
+        return;
+    }
+
+    // Every emitter's arrays go into the frame's region as they are, no interleaving pass on the
+    // CPU and no copy through the driver
+    uint8_t * region = data.instance_stream->Map(particle_count * 4 * sizeof(float));
+    if (region == nullptr)
+    {
+        ERROR_LOG("Failed to map the particle stream, skipping particles");
+        return;
+    }
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glUseProgram(data.shader_id);
+    glUniformMatrix4fv(data.view_projection_location, 1, GL_FALSE, &m_view_projection[0][0]);
+    glBindVertexArray(data.vao);
+
+    size_t written = 0;
+    for (CParticleEmitter const * emitter : m_submitted_emitters)
+    {
+        size_t const stream_size = emitter->GetCount() * sizeof(float);
+        float const * streams[] = { emitter->GetPositionsX(), emitter->GetPositionsY(), emitter->GetPositionsZ(), emitter->GetLives() };
+        for (float const * stream : streams)
+        {
+            std::memcpy(region + written, stream, stream_size);
+            written += stream_size;
+        }
+    }
+    data.instance_stream->Unmap();
+
+    glBindBuffer(GL_ARRAY_BUFFER, data.instance_stream->GetBuffer());
+
+    size_t emitter_offset = data.instance_stream->GetRegionOffset();
+    for (CParticleEmitter const * emitter : m_submitted_emitters)
+    {
+        uint32_t const count = emitter->GetCount();
+        if (count == 0)
+        {
+            continue;
+        }
+
+        size_t const stream_size = count * sizeof(float);
+        for (uint32_t stream = 0; stream < 4; ++stream)
+        {
+            glVertexAttribPointer(stream + 1, 1, GL_FLOAT, GL_FALSE, sizeof(float), reinterpret_cast<void const *>(emitter_offset + stream_size * stream));
+        }
+        emitter_offset += stream_size * 4;
+
+        SParticleEmitterSettings const & settings = emitter->GetSettings();
+        glUniform4fv(data.start_colour_location, 1, &settings.start_colour[0]);
+        glUniform4fv(data.end_colour_location, 1, &settings.end_colour[0]);
+        glUniform2f(data.size_location, settings.start_size, settings.end_size);
+
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(count));
+    }
+
+    data.instance_stream->Fence();
+    glBindVertexArray(0);
+    glDisable(GL_BLEND);
+}
+
+void Renderer::OpenGLRenderContext::RenderText()
+{
+    // Text renderers sharing a font end up next to each other, each run of them is one draw
+    auto const atlas_less = [](CTextRenderer const * lhs, CTextRenderer const * rhs)
+    {
+        return lhs->GetFont().GetGpuTexture() < rhs->GetFont().GetGpuTexture();
+    };
+    std::stable_sort(m_submitted_text.begin(), m_submitted_text.end(), atlas_less);
+
+    size_t vertex_count = 0;
+    size_t index_count = 0;
+    for (CTextRenderer const * text : m_submitted_text)
+    {
+        if (text->GetFont().GetGpuTexture() != INVALID_GPU_TEXTURE)
+        {
+            vertex_count += text->GetVertices().size();
+            index_count += text->GetIndices().size();
+        }
+    }
+    if (index_count == 0)
+    {
+        return;
+    }
+
+    STextRenderData & data = *m_text_render_data;
+
+    size_t const indices_offset = vertex_count * sizeof(STextVertex);
+    uint8_t * region = data.stream->Map(indices_offset + index_count * sizeof(uint32_t));
+    if (region == nullptr)
+    {
+        ERROR_LOG("Failed to map the text stream, skipping text");
+        return;
+    }
+
+    STextVertex * vertices = reinterpret_cast<STextVertex *>(region);
+    uint32_t * indices = reinterpret_cast<uint32_t *>(region + indices_offset);
+    size_t vertices_written = 0;
+    size_t indices_written = 0;
+
+    data.draws.clear();
+    auto group_begin = m_submitted_text.begin();
+    while (group_begin != m_submitted_text.end())
+    {
+        auto const group_end = std::upper_bound(group_begin, m_submitted_text.end(), *group_begin, atlas_less);
+        uint32_t const atlas = (*group_begin)->GetFont().GetGpuTexture();
+        if (atlas == INVALID_GPU_TEXTURE)
+        {
+            group_begin = group_end;
+            continue;
+        }
+
+        // Indices are moved on by each renderer's place in the group, the draw adds the
+        // group's own first vertex
+        STextRenderData::SDraw draw;
+        draw.atlas = atlas;
+        draw.first_vertex = vertices_written;
+        draw.first_index = indices_written;
+        for (auto it = group_begin; it != group_end; ++it)
+        {
+            std::vector<STextVertex> const & text_vertices = (*it)->GetVertices();
+            std::vector<uint32_t> const & text_indices = (*it)->GetIndices();
+            uint32_t const index_base = static_cast<uint32_t>(vertices_written - draw.first_vertex);
+
+            std::memcpy(vertices + vertices_written, text_vertices.data(), text_vertices.size() * sizeof(STextVertex));
+            for (size_t i = 0; i < text_indices.size(); ++i)
+            {
+                indices[indices_written + i] = text_indices[i] + index_base;
+            }
+            vertices_written += text_vertices.size();
+            indices_written += text_indices.size();
+        }
+        draw.index_count = indices_written - draw.first_index;
+        data.draws.push_back(draw);
+        group_begin = group_end;
+    }
+    data.stream->Unmap();
+
+    size_t const region_offset = data.stream->GetRegionOffset();
+    uint32_t const buffer = data.stream->GetBuffer();
+    glBindVertexArray(data.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(STextVertex), reinterpret_cast<void const *>(region_offset + offsetof(STextVertex, position)));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(STextVertex), reinterpret_cast<void const *>(region_offset + offsetof(STextVertex, uv)));
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(STextVertex), reinterpret_cast<void const *>(region_offset + offsetof(STextVertex, colour)));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glUseProgram(data.shader_id);
+    glUniform2f(data.screen_size_location, static_cast<float>(m_output_width), static_cast<float>(m_output_height));
+    glUniform1i(data.atlas_location, 0);
+    glActiveTexture(GL_TEXTURE0);
+
+    for (STextRenderData::SDraw const & draw : data.draws)
+    {
+        // Texture backend ids are GL texture names
+        glBindTexture(GL_TEXTURE_2D, draw.atlas);
+        glDrawElementsBaseVertex(GL_TRIANGLES,
+                                 static_cast<GLsizei>(draw.index_count),
+                                 GL_UNSIGNED_INT,
+                                 reinterpret_cast<void const *>(region_offset + indices_offset + draw.first_index * sizeof(uint32_t)),
+                                 static_cast<GLint>(draw.first_vertex));
+    }
+
+    data.stream->Fence();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindVertexArray(0);
+    glDisable(GL_BLEND);
+}
+
+std::unique_ptr<Renderer::SParticleRenderData> Renderer::OpenGLRenderContext::init_particle_renderdata()
+{
+    std::unique_ptr<SParticleRenderData> data = std::make_unique<SParticleRenderData>();
+
+    glGenVertexArrays(1, &data->vao);
+    glBindVertexArray(data->vao);
+
+    float const corners[] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+    glGenBuffers(1, &data->quad_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, data->quad_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+    glEnableVertexAttribArray(0);
+
+    // Position x, y, z and life, each from its own stream and advanced once per instance. The
+    // pointers are set per draw as the stream offsets depend on the emitter's particle count.
+    data->instance_stream = std::make_unique<OpenGLStreamBuffer>(m_gl_functions.buffer_storage);
+    for (uint32_t attribute = 1; attribute <= 4; ++attribute)
+    {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
+    glBindVertexArray(0);
+
+    const char * vertex_source = "#version 330 core\n"
+    "layout (location = 0) in vec2 aCorner;\n"
+    "layout (location = 1) in float aPosX;\n"
+    "layout (location = 2) in float aPosY;\n"
+    "layout (location = 3) in float aPosZ;\n"
+    "layout (location = 4) in float aLife;\n"
+    "uniform mat4 uViewProjection;\n"
+    "uniform vec4 uStartColour;\n"
+    "uniform vec4 uEndColour;\n"
+    "uniform vec2 uSize;\n"
+    "out vec4 vColour;\n"
+    "out vec2 vCorner;\n"
+    "void main()\n"
+    "{\n"
+    // Expanded after projection so every particle faces the camera
+    "   vec4 centre = uViewProjection * vec4(aPosX, aPosY, aPosZ, 1.0);\n"
+    "   float size = mix(uSize.x, uSize.y, aLife);\n"
+    "   gl_Position = centre + vec4(aCorner * size * centre.w, 0.0, 0.0);\n"
+    "   vColour = mix(uStartColour, uEndColour, aLife);\n"
+    "   vCorner = aCorner;\n"
+    "}\0";
+
+    const char * fragment_source = "#version 330 core\n"
+    "in vec4 vColour;\n"
+    "in vec2 vCorner;\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "   float falloff = 1.0 - dot(vCorner, vCorner);\n"
+    "   if (falloff <= 0.0)\n"
+    "   {\n"
+    "       discard;\n"
+    "   }\n"
+    "   FragColor = vec4(vColour.rgb, vColour.a * falloff);\n"
+    "}\0";
+
+    uint32_t const vertex_shader = compile_shader(GL_VERTEX_SHADER, vertex_source, "particle vertex");
+    uint32_t const fragment_shader = compile_shader(GL_FRAGMENT_SHADER, fragment_source, "particle fragment");
+
+    data->shader_id = glCreateProgram();
+    glAttachShader(data->shader_id, vertex_shader);
+    glAttachShader(data->shader_id, fragment_shader);
+    glLinkProgram(data->shader_id);
+
+    int success = 0;
+    glGetProgramiv(data->shader_id, GL_LINK_STATUS, &success);
+    if (success == 0)
     {
-        temp_render_data->verts.emplace_back(vert);
+        char info_log[512];
+        glGetProgramInfoLog(data->shader_id, sizeof(info_log), nullptr, info_log);
+        ERROR_LOG(std::string("Failed to link particle shaders:\n") + info_log);
     }
-    for(auto const & index : renderable->GetIndices())
+
+    glDeleteShader(fragment_shader);
+    glDeleteShader(vertex_shader);
+
+    data->view_projection_location = glGetUniformLocation(data->shader_id, "uViewProjection");
+    data->start_colour_location = glGetUniformLocation(data->shader_id, "uStartColour");
+    data->end_colour_location = glGetUniformLocation(data->shader_id, "uEndColour");
+    data->size_location = glGetUniformLocation(data->shader_id, "uSize");
+
+    return data;
+}
+
+std::unique_ptr<Renderer::STextRenderData> Renderer::OpenGLRenderContext::init_text_renderdata()
+{
+    std::unique_ptr<STextRenderData> data = std::make_unique<STextRenderData>();
+
+    // Position, atlas coordinates and colour, pointed into the stream each frame
+    glGenVertexArrays(1, &data->vao);
+    glBindVertexArray(data->vao);
+    data->stream = std::make_unique<OpenGLStreamBuffer>(m_gl_functions.buffer_storage);
+    for (uint32_t attribute = 0; attribute < 3; ++attribute)
     {
-        temp_render_data->indicies.emplace_back(index);
+        glEnableVertexAttribArray(attribute);
     }
-    for(auto const & col : renderable->GetVertColours())
+    glBindVertexArray(0);
+
+    // The same as sdf_text_vertex.hlsl and sdf_text_frag.hlsl, flipped for GL's y up clip space
+    const char * vertex_source = "#version 330 core\n"
+    "layout (location = 0) in vec2 aPos;\n"
+    "layout (location = 1) in vec2 aUV;\n"
+    "layout (location = 2) in vec4 aColour;\n"
+    "uniform vec2 uScreenSize;\n"
+    "out vec2 vUV;\n"
+    "out vec4 vColour;\n"
+    "void main()\n"
+    "{\n"
+    "   vec2 clip = aPos / uScreenSize * 2.0 - 1.0;\n"
+    "   gl_Position = vec4(clip.x, -clip.y, 0.0, 1.0);\n"
+    "   vUV = aUV;\n"
+    "   vColour = aColour;\n"
+    "}\0";
+
+    // 0.5 is the glyph outline (SDF_ON_EDGE_VALUE), antialiased over about a screen pixel
+    const char * fragment_source = "#version 330 core\n"
+    "in vec2 vUV;\n"
+    "in vec4 vColour;\n"
+    "uniform sampler2D uAtlas;\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "   float distance = texture(uAtlas, vUV).r;\n"
+    "   float width = fwidth(distance) * 0.5;\n"
+    "   float coverage = smoothstep(0.5 - width, 0.5 + width, distance);\n"
+    "   FragColor = vec4(vColour.rgb, vColour.a * coverage);\n"
+    "}\0";
+
+    uint32_t const vertex_shader = compile_shader(GL_VERTEX_SHADER, vertex_source, "text vertex");
+    uint32_t const fragment_shader = compile_shader(GL_FRAGMENT_SHADER, fragment_source, "text fragment");
+
+    data->shader_id = glCreateProgram();
+    glAttachShader(data->shader_id, vertex_shader);
+    glAttachShader(data->shader_id, fragment_shader);
+    glLinkProgram(data->shader_id);
+
+    int success = 0;
+    glGetProgramiv(data->shader_id, GL_LINK_STATUS, &success);
+    if (success == 0)
     {
-        temp_render_data->cols.emplace_back(col);
+        char info_log[512];
+        glGetProgramInfoLog(data->shader_id, sizeof(info_log), nullptr, info_log);
+        ERROR_LOG(std::string("Failed to link text shaders:\n") + info_log);
     }
+
+    glDeleteShader(fragment_shader);
+    glDeleteShader(vertex_shader);
+
+    data->screen_size_location = glGetUniformLocation(data->shader_id, "uScreenSize");
+    data->atlas_location = glGetUniformLocation(data->shader_id, "uAtlas");
+
+    return data;
 }
 
 std::unique_ptr<Renderer::SRenderData>  Renderer::OpenGLRenderContext::init_new_renderdata()
@@ -111,17 +826,34 @@ std::unique_ptr<Renderer::SRenderData>  Renderer::OpenGLRenderContext::init_new_
     glGenVertexArrays(1, &data->vao);
     glBindVertexArray(data->vao);
   
-    glGenBuffers(1, &data->vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, data->vbo);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);  
+    // Position and colour from the mesh pool's buffers, given storage on the first batch, and a
+    // per instance transform and tint pointed into the stream each frame as the region moves
+    // round the ring
+    glGenBuffers(1, &data->position_buffer);
+    glGenBuffers(1, &data->colour_buffer);
+    glGenBuffers(1, &data->index_buffer);
+    data->stream = std::make_unique<OpenGLStreamBuffer>(m_gl_functions.buffer_storage);
+    for (uint32_t attribute = 0; attribute < 7; ++attribute)
+    {
+        glEnableVertexAttribArray(attribute);
+    }
+    for (uint32_t attribute = 2; attribute < 7; ++attribute)
+    {
+        glVertexAttribDivisor(attribute, 1);
+    }
+    glBindVertexArray(0);
 
     const char *vertexShaderSource = "#version 330 core\n"
     "layout (location = 0) in vec3 aPos;\n"
+    "layout (location = 1) in vec4 aColour;\n"
+    "layout (location = 2) in mat4 aTransform;\n"
+    "layout (location = 6) in vec4 aTint;\n"
+    "uniform mat4 uViewProjection;\n"
+    "out vec4 vColour;\n"
     "void main()\n"
     "{\n"
-    "   gl_Position = vec4(aPos.x, aPos.y, aPos.z, 1.0);\n"
+    "   gl_Position = uViewProjection * aTransform * vec4(aPos, 1.0);\n"
+    "   vColour = aColour * aTint;\n"
     "}\0";
 
     uint32_t vertexShader = 0;
@@ -141,10 +873,11 @@ std::unique_ptr<Renderer::SRenderData>  Renderer::OpenGLRenderContext::init_new_
         ERROR_LOG(error_str);
     }
     const char *fragmentShaderSource = "#version 330 core\n"
+    "in vec4 vColour;\n"
     "out vec4 FragColor;\n"
     "void main()\n"
     "{\n"
-    "   FragColor = vec4(1.0f, 1.0f, 1.0f, 1.0f);\n"
+    "   FragColor = vColour;\n"
     "}\0";
 
     uint32_t fragmentShader = 0;
@@ -180,5 +913,7 @@ std::unique_ptr<Renderer::SRenderData>  Renderer::OpenGLRenderContext::init_new_
     glDeleteShader(fragmentShader);
     glDeleteShader(vertexShader);
 
+    data->view_projection_location = glGetUniformLocation(data->temp_shader_id, "uViewProjection");
+
     return data;
 }
@@ -6,8 +6,15 @@
 
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
 
 #include "renderer/render_context.hpp"
+#include "renderer/draw/draw_batch.hpp"
+#include "renderer/opengl/opengl_functions.hpp"
+#include "renderer/opengl/opengl_gpu_timer.hpp"
+#include "renderer/opengl/opengl_readback.hpp"
+#include "renderer/opengl/opengl_stream_buffer.hpp"
+#include "renderer/opengl/opengl_texture_backend.hpp"
 
 struct GLFWwindow;
 
@@ -20,23 +27,89 @@ namespace Renderer
         uint32_t temp_shader_id = 0;
 
         uint32_t vao = 0;
-        uint32_t vbo = 0;
-        std::vector<glm::vec3> verts;
-        std::vector<uint32_t> indicies;
-        std::vector<glm::vec4> cols;
+        // The mesh pool's geometry, which stays put between frames. Made again at the pool's
+        // size whenever its generation changes.
+        uint32_t position_buffer = 0;
+        uint32_t colour_buffer = 0;
+        uint32_t index_buffer = 0;
+        uint64_t mesh_generation = UINT64_MAX;
+        // The frame's instances and indirect commands go in one region, bound as both
+        std::unique_ptr<OpenGLStreamBuffer> stream;
+
+        int32_t view_projection_location = -1;
+    };
+
+    struct SParticleRenderData
+    {
+        uint32_t shader_id = 0;
+
+        uint32_t vao = 0;
+        // The four corners of a unit quad, shared by every particle
+        uint32_t quad_vbo = 0;
+        // Each emitter's position and life streams back to back, one value per instance
+        std::unique_ptr<OpenGLStreamBuffer> instance_stream;
+
+        int32_t view_projection_location = -1;
+        int32_t start_colour_location = -1;
+        int32_t end_colour_location = -1;
+        int32_t size_location = -1;
+    };
+
+    struct STextRenderData
+    {
+        uint32_t shader_id = 0;
+
+        uint32_t vao = 0;
+        // Every submitted text renderer's vertices then indices
+        std::unique_ptr<OpenGLStreamBuffer> stream;
+
+        int32_t screen_size_location = -1;
+        int32_t atlas_location = -1;
+
+        // One per font atlas, kept to reuse the allocation
+        struct SDraw
+        {
+            uint32_t atlas = 0;
+            size_t first_vertex = 0;
+            size_t first_index = 0;
+            size_t index_count = 0;
+        };
+        std::vector<SDraw> draws;
+    };
+
+    // A framebuffer with just an RGBA8 colour buffer, nothing draws with depth yet
+    struct SColourTarget
+    {
+        uint32_t framebuffer = 0;
+        uint32_t colour = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
     };
 
     class OpenGLRenderContext : public IRenderContext
     {
     public:
-        OpenGLRenderContext(GLFWwindow * glfw_window);
+        // Headless draws into an offscreen framebuffer instead of the window's and never swaps,
+        // for contexts with no surface at all
+        OpenGLRenderContext(GLFWwindow * glfw_window, bool const headless);
         ~OpenGLRenderContext();
 
         virtual bool Init() override;
         virtual void ResizeScreen(uint32_t const width, uint32_t const height) override;
         virtual void PreRender() override;
+        virtual void EndScene() override;
         virtual void RenderFrame() override;
+        virtual void SetViewProjection(glm::mat4 const & view_projection) override { m_view_projection = view_projection; }
         virtual void SubmitRenderable(IRenderable const * renderable) override;
+        virtual void SubmitParticles(CParticleEmitter const * emitter) override;
+        virtual void SubmitText(CTextRenderer const * text) override;
+        virtual SCullStats GetCullStats() const override { return m_cull_stats; }
+        virtual ITextureBackend * GetTextureBackend() override { return m_texture_backend.get(); }
+        virtual void RequestCapture() override { m_capture_requested = true; }
+        virtual bool PopCapturedFrame(SCapturedFrame & out_frame, bool const wait) override;
+        virtual SGpuFrameTime GetGpuFrameTime() const override;
+        virtual void SetDynamicResolution(SDynamicResolutionSettings const & settings) override;
+        virtual float GetResolutionScale() const override { return m_dynamic_resolution.GetScale(); }
 
         bool HasError() const { return m_last_error.empty() == false; }
         std::string const GetLastError() const { return m_last_error; }
@@ -52,8 +125,61 @@ namespace Renderer
 
         GLFWwindow * m_ptr_glfw_window;
 
+        bool m_headless;
+        // Headless only, standing in for the window's framebuffer
+        SColourTarget m_offscreen_target;
+
+        // What the frame ends up in, the window's framebuffer or the offscreen one, and its size
+        uint32_t m_output_framebuffer;
+        uint32_t m_output_width;
+        uint32_t m_output_height;
+
+        // With dynamic resolution the scene is drawn into the corner of this, sized to match
+        // the output so changing scale never reallocates, then blitted up to the output
+        CDynamicResolution m_dynamic_resolution;
+        SColourTarget m_scene_target;
+        uint32_t m_scene_width;
+        uint32_t m_scene_height;
+        bool m_scene_scaled;
+        bool m_scene_ended;
+
+        uint64_t m_frame_index;
+        bool m_capture_requested;
+        std::unique_ptr<OpenGLReadback> m_readback;
+        std::unique_ptr<OpenGLGpuTimer> m_gpu_timer;
+
         std::unique_ptr<SRenderData> temp_render_data = nullptr;
 
+        std::unique_ptr<OpenGLTextureBackend> m_texture_backend;
+
+        // Renderables are only gathered on submit, geometry is copied in RenderFrame once
+        // culling has decided which of them are on screen
+        std::vector<IRenderable const *> m_submitted_renderables;
+        CFrustumCuller m_frustum_culler;
+        SCullStats m_cull_stats;
+
+        // The visible renderables as indirect commands, drawn with one glMultiDrawElementsIndirect
+        // on GL 4.3 and up
+        CDrawBatch m_draw_batch;
+        SOpenGLFunctions m_gl_functions;
+
+        std::unique_ptr<SParticleRenderData> m_particle_render_data = nullptr;
+        std::vector<CParticleEmitter const *> m_submitted_emitters;
+
+        std::unique_ptr<STextRenderData> m_text_render_data = nullptr;
+        std::vector<CTextRenderer const *> m_submitted_text;
+
+        glm::mat4 m_view_projection = glm::mat4(1.0f);
+
         std::unique_ptr<SRenderData> init_new_renderdata();
+        std::unique_ptr<SParticleRenderData> init_particle_renderdata();
+        std::unique_ptr<STextRenderData> init_text_renderdata();
+
+        bool CreateColourTarget(SColourTarget & target, uint32_t const width, uint32_t const height);
+        void DestroyColourTarget(SColourTarget & target);
+
+        void RenderBatch();
+        void RenderParticles();
+        void RenderText();
     };
 }
@@ -0,0 +1,181 @@
+#include "opengl_stream_buffer.hpp"
+
+#include "utility/logging.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+#include <algorithm>
+
+#include <glad/glad.h>
+
+namespace
+{
+    // Keeps every region start aligned for any attribute, index or indirect offset inside it
+    constexpr size_t REGION_ALIGNMENT = 256;
+    constexpr size_t MIN_REGION_SIZE = 64 * 1024;
+    constexpr GLuint64 FENCE_TIMEOUT_NS = 1000000000;
+
+    // Mapping through the copy target leaves the vertex array's bindings alone
+    constexpr GLenum STREAM_TARGET = GL_COPY_WRITE_BUFFER;
+}
+
+Renderer::OpenGLStreamBuffer::OpenGLStreamBuffer(SOpenGLFunctions::BufferStorage buffer_storage)
+: m_buffer_storage(buffer_storage)
+, m_buffer(0)
+, m_region_size(0)
+, m_region(0)
+, m_persistent_data(nullptr)
+, m_mapped(false)
+, m_fences()
+{
+    m_fences.fill(nullptr);
+}
+
+Renderer::OpenGLStreamBuffer::~OpenGLStreamBuffer()
+{
+    for (uint32_t region = 0; region < STREAM_REGION_COUNT; ++region)
+    {
+        if (m_fences[region] != nullptr)
+        {
+            glDeleteSync(static_cast<GLsync>(m_fences[region]));
+        }
+    }
+    Release();
+}
+
+uint8_t * Renderer::OpenGLStreamBuffer::Map(size_t const size)
+{
+    m_region = (m_region + 1) % STREAM_REGION_COUNT;
+
+    if (size > m_region_size)
+    {
+        for (uint32_t region = 0; region < STREAM_REGION_COUNT; ++region)
+        {
+            WaitForRegion(region);
+        }
+        Release();
+
+        // Rounded up so the next region starts aligned, with headroom for slow growth
+        size_t const wanted = std::max(std::max(size + size / 2, m_region_size * 2), MIN_REGION_SIZE);
+        if (Allocate((wanted + REGION_ALIGNMENT - 1) / REGION_ALIGNMENT * REGION_ALIGNMENT) == false)
+        {
+            return nullptr;
+        }
+        m_region = 0;
+    }
+
+    WaitForRegion(m_region);
+
+    if (m_persistent_data != nullptr)
+    {
+        return m_persistent_data + GetRegionOffset();
+    }
+
+    glBindBuffer(STREAM_TARGET, m_buffer);
+    void * data = glMapBufferRange(STREAM_TARGET,
+                                   static_cast<GLintptr>(GetRegionOffset()),
+                                   static_cast<GLsizeiptr>(size),
+                                   GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    glBindBuffer(STREAM_TARGET, 0);
+    m_mapped = data != nullptr;
+    return static_cast<uint8_t *>(data);
+}
+
+void Renderer::OpenGLStreamBuffer::Unmap()
+{
+    // Persistent coherent writes are visible to the next draw as they are
+    if (m_mapped == true)
+    {
+        glBindBuffer(STREAM_TARGET, m_buffer);
+        glUnmapBuffer(STREAM_TARGET);
+        glBindBuffer(STREAM_TARGET, 0);
+        m_mapped = false;
+    }
+}
+
+void Renderer::OpenGLStreamBuffer::Fence()
+{
+    if (m_fences[m_region] != nullptr)
+    {
+        glDeleteSync(static_cast<GLsync>(m_fences[m_region]));
+    }
+    m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool Renderer::OpenGLStreamBuffer::Allocate(size_t const region_size)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    GLsizeiptr const total_size = static_cast<GLsizeiptr>(region_size * STREAM_REGION_COUNT);
+
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(STREAM_TARGET, m_buffer);
+
+    if (m_buffer_storage != nullptr)
+    {
+        GLbitfield const flags = GL_MAP_WRITE_BIT | MAP_PERSISTENT_BIT | MAP_COHERENT_BIT;
+        m_buffer_storage(STREAM_TARGET, total_size, nullptr, flags);
+        m_persistent_data = static_cast<uint8_t *>(glMapBufferRange(STREAM_TARGET, 0, total_size, flags));
+        if (m_persistent_data == nullptr)
+        {
+            ERROR_LOG("Failed to persistently map stream buffer");
+        }
+    }
+    else
+    {
+        glBufferData(STREAM_TARGET, total_size, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(STREAM_TARGET, 0);
+
+    if (m_buffer_storage != nullptr && m_persistent_data == nullptr)
+    {
+        Release();
+        return false;
+    }
+
+    m_region_size = region_size;
+    return true;
+}
+
+void Renderer::OpenGLStreamBuffer::Release()
+{
+    if (m_buffer == 0)
+    {
+        return;
+    }
+
+    if (m_persistent_data != nullptr || m_mapped == true)
+    {
+        glBindBuffer(STREAM_TARGET, m_buffer);
+        glUnmapBuffer(STREAM_TARGET);
+        glBindBuffer(STREAM_TARGET, 0);
+    }
+    glDeleteBuffers(1, &m_buffer);
+
+    m_buffer = 0;
+    m_region_size = 0;
+    m_persistent_data = nullptr;
+    m_mapped = false;
+}
+
+void Renderer::OpenGLStreamBuffer::WaitForRegion(uint32_t const region)
+{
+    if (m_fences[region] == nullptr)
+    {
+        return;
+    }
+
+    GLsync const fence = static_cast<GLsync>(m_fences[region]);
+    // Flushing on the first wait makes sure the fence is actually submitted to the GPU
+    GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+    while (result == GL_TIMEOUT_EXPIRED)
+    {
+        result = glClientWaitSync(fence, 0, FENCE_TIMEOUT_NS);
+    }
+    if (result == GL_WAIT_FAILED)
+    {
+        ERROR_LOG("Waiting on a stream buffer fence failed");
+    }
+
+    glDeleteSync(fence);
+    m_fences[region] = nullptr;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+
+#include "renderer/opengl/opengl_functions.hpp"
+
+namespace Renderer
+{
+    // The CPU writes one region while the GPU may still be reading the other two
+    constexpr uint32_t STREAM_REGION_COUNT = 3;
+
+    // Per frame data written straight into driver memory. One buffer is split into a ring of
+    // STREAM_REGION_COUNT regions used in turn, each guarded by a fence placed after the draws
+    // reading it, so the CPU only waits if it gets a whole ring ahead of the GPU.
+    //
+    // With buffer storage the buffer is mapped once, persistent and coherent, and stays mapped.
+    // Without it each region is mapped unsynchronised for the frame, which still skips the copy
+    // and implicit sync glBufferData would cost since the fence already says the region is free.
+    class OpenGLStreamBuffer
+    {
+    public:
+        // Needs a current context, buffer_storage is null where the driver doesn't have it
+        explicit OpenGLStreamBuffer(SOpenGLFunctions::BufferStorage buffer_storage);
+        ~OpenGLStreamBuffer();
+
+        OpenGLStreamBuffer(OpenGLStreamBuffer const &) = delete;
+        OpenGLStreamBuffer & operator=(OpenGLStreamBuffer const &) = delete;
+
+        // Moves on to the next region, waiting for the GPU to be done with it, and returns size
+        // bytes to write into. Regions grow to fit, which waits on the whole ring and replaces
+        // the buffer. nullptr if it couldn't be mapped.
+        uint8_t * Map(size_t const size);
+        // Before drawing from what was written
+        void Unmap();
+        // After the last draw reading the region
+        void Fence();
+
+        // Changes when the regions grow, so bind it again every frame
+        uint32_t GetBuffer() const { return m_buffer; }
+        // Where the mapped region starts in the buffer
+        size_t GetRegionOffset() const { return m_region * m_region_size; }
+
+    private:
+        bool Allocate(size_t const region_size);
+        void Release();
+        void WaitForRegion(uint32_t const region);
+
+        SOpenGLFunctions::BufferStorage m_buffer_storage;
+        uint32_t m_buffer;
+        size_t m_region_size;
+        uint32_t m_region;
+        // Only with buffer storage, the whole ring
+        uint8_t * m_persistent_data;
+        bool m_mapped;
+        // GLsync, kept opaque so this header doesn't need the loader
+        std::array<void *, STREAM_REGION_COUNT> m_fences;
+    };
+}
@@ -0,0 +1,155 @@
+#include "opengl_texture_backend.hpp"
+
+#include "utility/logging.hpp"
+
+#include <vector>
+
+#include <glad/glad.h>
+
+namespace
+{
+    // Extension enums, not every loader is generated with them
+    constexpr GLenum COMPRESSED_RGBA_S3TC_DXT1 = 0x83F1;
+    constexpr GLenum COMPRESSED_RGBA_S3TC_DXT5 = 0x83F3;
+    constexpr GLenum COMPRESSED_RED_RGTC1 = 0x8DBB;
+    constexpr GLenum COMPRESSED_RG_RGTC2 = 0x8DBD;
+    constexpr GLenum COMPRESSED_RGBA_BPTC_UNORM = 0x8E8C;
+
+    GLenum get_internal_format(Renderer::ETextureFormat const format)
+    {
+        switch (format)
+        {
+        case Renderer::ETextureFormat::RGBA8:
+            return GL_RGBA8;
+        case Renderer::ETextureFormat::BC1:
+            return COMPRESSED_RGBA_S3TC_DXT1;
+        case Renderer::ETextureFormat::BC4:
+            return COMPRESSED_RED_RGTC1;
+        case Renderer::ETextureFormat::BC3:
+            return COMPRESSED_RGBA_S3TC_DXT5;
+        case Renderer::ETextureFormat::BC5:
+            return COMPRESSED_RG_RGTC2;
+        case Renderer::ETextureFormat::BC7:
+            return COMPRESSED_RGBA_BPTC_UNORM;
+        case Renderer::ETextureFormat::R8:
+            return GL_R8;
+        case Renderer::ETextureFormat::Count:
+            return GL_NONE;
+        }
+        return GL_NONE;
+    }
+}
+
+Renderer::OpenGLTextureBackend::OpenGLTextureBackend()
+: m_textures()
+, m_supported_formats()
+{
+    GLint format_count = 0;
+    glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &format_count);
+
+    std::vector<GLint> formats(static_cast<size_t>(format_count > 0 ? format_count : 0));
+    if (formats.empty() == false)
+    {
+        glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+    }
+
+    for (GLint const format : formats)
+    {
+        m_supported_formats.insert(static_cast<uint32_t>(format));
+    }
+
+    // RGTC is core since 3.0 but drivers don't always list it
+    m_supported_formats.insert(GL_RGBA8);
+    m_supported_formats.insert(GL_R8);
+    m_supported_formats.insert(COMPRESSED_RED_RGTC1);
+    m_supported_formats.insert(COMPRESSED_RG_RGTC2);
+}
+
+Renderer::OpenGLTextureBackend::~OpenGLTextureBackend()
+{
+    for (auto const & texture : m_textures)
+    {
+        GLuint const name = texture.first;
+        glDeleteTextures(1, &name);
+    }
+}
+
+bool Renderer::OpenGLTextureBackend::IsFormatSupported(ETextureFormat const format) const
+{
+    return m_supported_formats.count(get_internal_format(format)) > 0;
+}
+
+uint32_t Renderer::OpenGLTextureBackend::CreateTexture(ETextureFormat const format, uint32_t const width, uint32_t const height, uint32_t const mip_count)
+{
+    if (width == 0 || height == 0 || mip_count == 0)
+    {
+        return INVALID_GPU_TEXTURE;
+    }
+
+    if (IsFormatSupported(format) == false)
+    {
+        ERROR_LOG("Texture format " + std::to_string(static_cast<uint32_t>(format)) + " isn't supported by this driver");
+        return INVALID_GPU_TEXTURE;
+    }
+
+    GLuint name = 0;
+    glGenTextures(1, &name);
+    if (name == 0)
+    {
+        return INVALID_GPU_TEXTURE;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, name);
+
+    // Levels are only uploaded for the resident chain, the texture is complete once they all are
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(mip_count) - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mip_count > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    m_textures[name] = get_internal_format(format);
+    return name;
+}
+
+void Renderer::OpenGLTextureBackend::UploadMip(uint32_t const texture, uint32_t const level, uint32_t const width, uint32_t const height, void const * data, size_t const size)
+{
+    auto const found = m_textures.find(texture);
+    if (found == m_textures.end())
+    {
+        return;
+    }
+
+    GLenum const internal_format = found->second;
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if (internal_format == GL_RGBA8)
+    {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_RGBA8, static_cast<GLsizei>(width), static_cast<GLsizei>(height), 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    }
+    else if (internal_format == GL_R8)
+    {
+        // Rows of odd widths aren't 4 byte aligned
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_R8, static_cast<GLsizei>(width), static_cast<GLsizei>(height), 0, GL_RED, GL_UNSIGNED_BYTE, data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    else
+    {
+        glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), internal_format, static_cast<GLsizei>(width), static_cast<GLsizei>(height), 0, static_cast<GLsizei>(size), data);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Renderer::OpenGLTextureBackend::DestroyTexture(uint32_t const texture)
+{
+    if (m_textures.erase(texture) > 0)
+    {
+        GLuint const name = texture;
+        glDeleteTextures(1, &name);
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "renderer/texture/texture_backend.hpp"
+
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Renderer
+{
+    // Textures as GL texture names. Block compressed formats are only used if the driver lists
+    // them, there's no fallback decompression.
+    class OpenGLTextureBackend : public ITextureBackend
+    {
+    public:
+        // Needs a current context with GL loaded
+        OpenGLTextureBackend();
+        ~OpenGLTextureBackend();
+
+        OpenGLTextureBackend(OpenGLTextureBackend const &) = delete;
+        OpenGLTextureBackend & operator=(OpenGLTextureBackend const &) = delete;
+
+        virtual uint32_t CreateTexture(ETextureFormat const format, uint32_t const width, uint32_t const height, uint32_t const mip_count) override;
+        virtual void UploadMip(uint32_t const texture, uint32_t const level, uint32_t const width, uint32_t const height, void const * data, size_t const size) override;
+        virtual void DestroyTexture(uint32_t const texture) override;
+
+        bool IsFormatSupported(ETextureFormat const format) const;
+
+    private:
+        // Internal format per texture name, GL can't be asked for it before a level exists
+        std::unordered_map<uint32_t, uint32_t> m_textures;
+        std::unordered_set<uint32_t> m_supported_formats;
+    };
+}
@@ -0,0 +1,174 @@
+#include "particle_emitter.hpp"
+
+#include "utility/parallel_for.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+
+namespace
+{
+    // Big emitters are integrated in chunks across the worker pool as well, a chunk is big
+    // enough that scheduling is noise next to the kernel
+    constexpr size_t PARTICLE_CHUNK_SIZE = 16384;
+}
+
+Renderer::CParticleEmitter::CParticleEmitter(SParticleEmitterSettings const & settings)
+: m_settings(settings)
+, m_position_x()
+, m_position_y()
+, m_position_z()
+, m_velocity_x()
+, m_velocity_y()
+, m_velocity_z()
+, m_life()
+, m_life_rate()
+, m_dead_indices()
+, m_count(0)
+, m_spawn_accumulator(0.0f)
+, m_simulated_time(0.0)
+// Xorshift gets stuck on zero
+, m_random_state(settings.seed != 0 ? settings.seed : 1)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    size_t const capacity = m_settings.max_particles;
+    for (std::vector<float> * stream : { &m_position_x, &m_position_y, &m_position_z,
+                                         &m_velocity_x, &m_velocity_y, &m_velocity_z,
+                                         &m_life, &m_life_rate })
+    {
+        stream->resize(capacity, 0.0f);
+    }
+    m_dead_indices.resize(capacity, 0);
+}
+
+uint32_t Renderer::CParticleEmitter::Burst(uint32_t const count)
+{
+    uint32_t const spawned = std::min(count, m_settings.max_particles - m_count);
+    Spawn(spawned);
+    return spawned;
+}
+
+void Renderer::CParticleEmitter::Clear()
+{
+    m_count = 0;
+    m_spawn_accumulator = 0.0f;
+}
+
+uint32_t Renderer::CParticleEmitter::Assign(uint32_t const count,
+                                            float const * position_x,
+                                            float const * position_y,
+                                            float const * position_z,
+                                            float const * life)
+{
+    m_count = std::min(count, m_settings.max_particles);
+    m_spawn_accumulator = 0.0f;
+
+    std::copy(position_x, position_x + m_count, m_position_x.begin());
+    std::copy(position_y, position_y + m_count, m_position_y.begin());
+    std::copy(position_z, position_z + m_count, m_position_z.begin());
+    std::copy(life, life + m_count, m_life.begin());
+    std::fill(m_velocity_x.begin(), m_velocity_x.begin() + m_count, 0.0f);
+    std::fill(m_velocity_y.begin(), m_velocity_y.begin() + m_count, 0.0f);
+    std::fill(m_velocity_z.begin(), m_velocity_z.begin() + m_count, 0.0f);
+    std::fill(m_life_rate.begin(), m_life_rate.begin() + m_count, 0.0f);
+    return m_count;
+}
+
+void Renderer::CParticleEmitter::Update(float const dt, SParticleKernels const & kernels)
+{
+    m_simulated_time += dt;
+
+    if (m_count > 0)
+    {
+        SParticleStep step;
+        step.dt = dt;
+        step.gravity_x = m_settings.gravity.x * dt;
+        step.gravity_y = m_settings.gravity.y * dt;
+        step.gravity_z = m_settings.gravity.z * dt;
+        step.damping = std::max(0.0f, 1.0f - m_settings.drag * dt);
+
+        SParticleStreams const streams = GetStreams();
+        Utility::parallel_for(m_count, PARTICLE_CHUNK_SIZE, [&](size_t const begin, size_t const end)
+        {
+            kernels.integrate(streams, begin, end, step);
+        });
+
+        RemoveDead(kernels.find_dead(m_life.data(), 0, m_count, m_dead_indices.data()));
+    }
+
+    m_spawn_accumulator += m_settings.spawn_rate * dt;
+    float const whole = std::floor(m_spawn_accumulator);
+    m_spawn_accumulator -= whole;
+    Burst(static_cast<uint32_t>(std::min(whole, static_cast<float>(m_settings.max_particles))));
+}
+
+Renderer::SParticleStreams Renderer::CParticleEmitter::GetStreams()
+{
+    SParticleStreams streams;
+    streams.position_x = m_position_x.data();
+    streams.position_y = m_position_y.data();
+    streams.position_z = m_position_z.data();
+    streams.velocity_x = m_velocity_x.data();
+    streams.velocity_y = m_velocity_y.data();
+    streams.velocity_z = m_velocity_z.data();
+    streams.life = m_life.data();
+    streams.life_rate = m_life_rate.data();
+    return streams;
+}
+
+void Renderer::CParticleEmitter::Spawn(uint32_t const count)
+{
+    glm::vec3 const & position = m_settings.position;
+    glm::vec3 const & extents = m_settings.spawn_extents;
+    glm::vec3 const & min_velocity = m_settings.min_velocity;
+    glm::vec3 const & max_velocity = m_settings.max_velocity;
+
+    for (uint32_t i = m_count; i < m_count + count; ++i)
+    {
+        m_position_x[i] = position.x + RandomRange(-extents.x, extents.x);
+        m_position_y[i] = position.y + RandomRange(-extents.y, extents.y);
+        m_position_z[i] = position.z + RandomRange(-extents.z, extents.z);
+        m_velocity_x[i] = RandomRange(min_velocity.x, max_velocity.x);
+        m_velocity_y[i] = RandomRange(min_velocity.y, max_velocity.y);
+        m_velocity_z[i] = RandomRange(min_velocity.z, max_velocity.z);
+        m_life[i] = 0.0f;
+
+        // A zero lifetime still lives for the one update it was spawned in
+        float const lifetime = RandomRange(m_settings.min_lifetime, m_settings.max_lifetime);
+        m_life_rate[i] = lifetime > 0.0f ? 1.0f / lifetime : 1.0e30f;
+    }
+    m_count += count;
+}
+
+void Renderer::CParticleEmitter::RemoveDead(uint32_t const dead_count)
+{
+    // Walking backwards means everything past the particle being removed is already known to be
+    // alive, so whatever is swapped in from the end never needs checking again
+    for (uint32_t d = dead_count; d > 0; --d)
+    {
+        uint32_t const dead = m_dead_indices[d - 1];
+        uint32_t const last = --m_count;
+        if (dead != last)
+        {
+            m_position_x[dead] = m_position_x[last];
+            m_position_y[dead] = m_position_y[last];
+            m_position_z[dead] = m_position_z[last];
+            m_velocity_x[dead] = m_velocity_x[last];
+            m_velocity_y[dead] = m_velocity_y[last];
+            m_velocity_z[dead] = m_velocity_z[last];
+            m_life[dead] = m_life[last];
+            m_life_rate[dead] = m_life_rate[last];
+        }
+    }
+}
+
+float Renderer::CParticleEmitter::Random()
+{
+    m_random_state ^= m_random_state << 13;
+    m_random_state ^= m_random_state >> 17;
+    m_random_state ^= m_random_state << 5;
+    // Top 24 bits, exactly representable as a float in [0, 1)
+    return static_cast<float>(m_random_state >> 8) * (1.0f / 16777216.0f);
+}
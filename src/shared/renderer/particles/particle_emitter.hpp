@@ -0,0 +1,114 @@
+#pragma once
+
+#include "renderer/particles/particle_kernels.hpp"
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <cinttypes>
+#include <vector>
+
+namespace Renderer
+{
+    struct SParticleEmitterSettings
+    {
+        // Every array is allocated at this size up front, spawns past it are dropped
+        uint32_t max_particles = 10000;
+        // Particles per second, fractions carry over to the next update
+        float spawn_rate = 1000.0f;
+
+        float min_lifetime = 1.0f;
+        float max_lifetime = 2.0f;
+
+        // Particles start anywhere within spawn_extents of the position, with a velocity picked
+        // per axis between min_velocity and max_velocity
+        glm::vec3 position = glm::vec3(0.0f);
+        glm::vec3 spawn_extents = glm::vec3(0.0f);
+        glm::vec3 min_velocity = glm::vec3(-1.0f);
+        glm::vec3 max_velocity = glm::vec3(1.0f);
+
+        // Acceleration in units per second squared and the fraction of velocity lost per second
+        glm::vec3 gravity = glm::vec3(0.0f);
+        float drag = 0.0f;
+
+        // Interpolated over each particle's life when drawn
+        float start_size = 0.02f;
+        float end_size = 0.0f;
+        glm::vec4 start_colour = glm::vec4(1.0f);
+        glm::vec4 end_colour = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+
+        uint32_t seed = 1;
+
+        // Asks backends with compute to step a copy of the emitter on the GPU and draw that
+        // instead. The GPU pool is always full, dead particles respawn in place, so spawn_rate
+        // is ignored there. The emitter still steps on the CPU for backends without compute.
+        bool simulate_on_gpu = false;
+    };
+
+    // A fixed capacity pool of particles kept as one array per attribute. Live particles are
+    // always packed into [0, GetCount()), dead ones are swap-removed with the last live particle
+    // so nothing is allocated or shifted once the emitter is made. Draw order isn't stable.
+    class CParticleEmitter
+    {
+    public:
+        explicit CParticleEmitter(SParticleEmitterSettings const & settings);
+
+        CParticleEmitter(CParticleEmitter const &) = delete;
+        CParticleEmitter & operator=(CParticleEmitter const &) = delete;
+
+        SParticleEmitterSettings const & GetSettings() const { return m_settings; }
+        void SetPosition(glm::vec3 const & position) { m_settings.position = position; }
+        void SetSpawnRate(float const spawn_rate) { m_settings.spawn_rate = spawn_rate; }
+
+        // Spawns up to count particles immediately, returns how many fitted
+        uint32_t Burst(uint32_t const count);
+        void Clear();
+
+        // Replaces every particle with the given ones, standing still and never ageing, for
+        // putting back a recorded frame. Returns how many fitted.
+        uint32_t Assign(uint32_t const count,
+                        float const * position_x,
+                        float const * position_y,
+                        float const * position_z,
+                        float const * life);
+
+        // Moves every particle on by dt, kills those that have lived out their lifetime, then
+        // spawns this update's share of spawn_rate
+        void Update(float const dt, SParticleKernels const & kernels);
+
+        uint32_t GetCount() const { return m_count; }
+        uint32_t GetCapacity() const { return m_settings.max_particles; }
+        // Seconds stepped by Update so far, a GPU copy catches up to this
+        double GetSimulatedTime() const { return m_simulated_time; }
+
+        // GetCount() entries each, life runs from 0 at spawn to 1 at death
+        float const * GetPositionsX() const { return m_position_x.data(); }
+        float const * GetPositionsY() const { return m_position_y.data(); }
+        float const * GetPositionsZ() const { return m_position_z.data(); }
+        float const * GetLives() const { return m_life.data(); }
+
+    private:
+        SParticleStreams GetStreams();
+        void Spawn(uint32_t const count);
+        void RemoveDead(uint32_t const dead_count);
+        float Random();
+        float RandomRange(float const min, float const max) { return min + (max - min) * Random(); }
+
+        SParticleEmitterSettings m_settings;
+
+        std::vector<float> m_position_x;
+        std::vector<float> m_position_y;
+        std::vector<float> m_position_z;
+        std::vector<float> m_velocity_x;
+        std::vector<float> m_velocity_y;
+        std::vector<float> m_velocity_z;
+        std::vector<float> m_life;
+        std::vector<float> m_life_rate;
+        std::vector<uint32_t> m_dead_indices;
+
+        uint32_t m_count;
+        float m_spawn_accumulator;
+        double m_simulated_time;
+        uint32_t m_random_state;
+    };
+}
@@ -0,0 +1,57 @@
+#include "particle_kernels.hpp"
+
+#include "utility/cpu_features.hpp"
+
+namespace
+{
+    void integrate_scalar(Renderer::SParticleStreams const & streams, size_t const begin, size_t const end, Renderer::SParticleStep const & step)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            float const velocity_x = (streams.velocity_x[i] + step.gravity_x) * step.damping;
+            float const velocity_y = (streams.velocity_y[i] + step.gravity_y) * step.damping;
+            float const velocity_z = (streams.velocity_z[i] + step.gravity_z) * step.damping;
+            streams.velocity_x[i] = velocity_x;
+            streams.velocity_y[i] = velocity_y;
+            streams.velocity_z[i] = velocity_z;
+            streams.position_x[i] += velocity_x * step.dt;
+            streams.position_y[i] += velocity_y * step.dt;
+            streams.position_z[i] += velocity_z * step.dt;
+            streams.life[i] += streams.life_rate[i] * step.dt;
+        }
+    }
+
+    uint32_t find_dead_scalar(float const * life, size_t const begin, size_t const end, uint32_t * dead_indices)
+    {
+        uint32_t dead_count = 0;
+        for (size_t i = begin; i < end; ++i)
+        {
+            if (life[i] >= 1.0f)
+            {
+                dead_indices[dead_count++] = static_cast<uint32_t>(i);
+            }
+        }
+        return dead_count;
+    }
+}
+
+Renderer::SParticleKernels const & Renderer::get_scalar_particle_kernels()
+{
+    static SParticleKernels const table = {
+        &integrate_scalar,
+        &find_dead_scalar
+    };
+    return table;
+}
+
+Renderer::SParticleKernels const & Renderer::get_particle_kernels()
+{
+    switch (Utility::get_simd_level())
+    {
+        case Utility::ESimdLevel::AVX512:
+        case Utility::ESimdLevel::AVX2: return get_avx2_particle_kernels();
+        case Utility::ESimdLevel::SSE41: return get_sse41_particle_kernels();
+        case Utility::ESimdLevel::Scalar: break;
+    }
+    return get_scalar_particle_kernels();
+}
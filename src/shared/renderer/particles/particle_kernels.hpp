@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+
+namespace Renderer
+{
+    // One array per particle attribute, every kernel works on the index range [begin, end).
+    // Life runs from 0 at spawn to 1 at death, life_rate is one over the particle's lifetime.
+    struct SParticleStreams
+    {
+        float * position_x = nullptr;
+        float * position_y = nullptr;
+        float * position_z = nullptr;
+        float * velocity_x = nullptr;
+        float * velocity_y = nullptr;
+        float * velocity_z = nullptr;
+        float * life = nullptr;
+        float * life_rate = nullptr;
+    };
+
+    // Already scaled by the step, so the kernels don't redo it per particle
+    struct SParticleStep
+    {
+        float dt = 0.0f;
+        float gravity_x = 0.0f;
+        float gravity_y = 0.0f;
+        float gravity_z = 0.0f;
+        // Velocity is multiplied by this after gravity is added
+        float damping = 1.0f;
+    };
+
+    struct SParticleKernels
+    {
+        // velocity = (velocity + gravity) * damping, position += velocity * dt, life += life_rate * dt
+        void (*integrate)(SParticleStreams const & streams, size_t begin, size_t end, SParticleStep const & step);
+
+        // Writes the indices of particles whose life has reached 1 in ascending order and returns
+        // how many there were
+        uint32_t (*find_dead)(float const * life, size_t begin, size_t end, uint32_t * dead_indices);
+    };
+
+    // Each lives in its own translation unit built with the matching instruction set flags,
+    // on other architectures they hand back the scalar table
+    SParticleKernels const & get_sse41_particle_kernels();
+    SParticleKernels const & get_avx2_particle_kernels();
+    SParticleKernels const & get_scalar_particle_kernels();
+
+    // Picked from Utility::get_simd_level()
+    SParticleKernels const & get_particle_kernels();
+}
@@ -0,0 +1,41 @@
+#include "renderer/particles/particle_kernels.hpp"
+
+#include "utility/cpu_features.hpp"
+
+#if GOAT_ARCH_X86
+
+#include <immintrin.h>
+
+namespace
+{
+    struct SAvx2Ops
+    {
+        using Reg = __m256;
+        static constexpr size_t WIDTH = 8;
+
+        static Reg Load(float const * ptr) { return _mm256_loadu_ps(ptr); }
+        static void Store(float * ptr, Reg const v) { _mm256_storeu_ps(ptr, v); }
+        static Reg Set1(float const v) { return _mm256_set1_ps(v); }
+        static Reg Add(Reg const a, Reg const b) { return _mm256_add_ps(a, b); }
+        static Reg Mul(Reg const a, Reg const b) { return _mm256_mul_ps(a, b); }
+        static Reg MulAdd(Reg const a, Reg const b, Reg const c) { return _mm256_fmadd_ps(a, b, c); }
+        static uint32_t GreaterEqualMask(Reg const a, Reg const b) { return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GE_OQ))); }
+    };
+
+#include "renderer/particles/particle_kernels_simd.inl"
+}
+
+Renderer::SParticleKernels const & Renderer::get_avx2_particle_kernels()
+{
+    static SParticleKernels const table = make_particle_kernel_table<SAvx2Ops>();
+    return table;
+}
+
+#else
+
+Renderer::SParticleKernels const & Renderer::get_avx2_particle_kernels()
+{
+    return get_scalar_particle_kernels();
+}
+
+#endif
@@ -0,0 +1,89 @@
+// Included into an anonymous namespace by each instruction set's translation unit after it has
+// defined its ops struct, see audio/audio_kernels_simd.inl for the same pattern
+
+template <typename Ops>
+void integrate_simd(Renderer::SParticleStreams const & streams, size_t const begin, size_t const end, Renderer::SParticleStep const & step)
+{
+    using Reg = typename Ops::Reg;
+    constexpr size_t WIDTH = Ops::WIDTH;
+
+    Reg const dt = Ops::Set1(step.dt);
+    Reg const gravity_x = Ops::Set1(step.gravity_x);
+    Reg const gravity_y = Ops::Set1(step.gravity_y);
+    Reg const gravity_z = Ops::Set1(step.gravity_z);
+    Reg const damping = Ops::Set1(step.damping);
+
+    size_t i = begin;
+    for (; i + WIDTH <= end; i += WIDTH)
+    {
+        Reg const velocity_x = Ops::Mul(Ops::Add(Ops::Load(streams.velocity_x + i), gravity_x), damping);
+        Reg const velocity_y = Ops::Mul(Ops::Add(Ops::Load(streams.velocity_y + i), gravity_y), damping);
+        Reg const velocity_z = Ops::Mul(Ops::Add(Ops::Load(streams.velocity_z + i), gravity_z), damping);
+        Ops::Store(streams.velocity_x + i, velocity_x);
+        Ops::Store(streams.velocity_y + i, velocity_y);
+        Ops::Store(streams.velocity_z + i, velocity_z);
+        Ops::Store(streams.position_x + i, Ops::MulAdd(velocity_x, dt, Ops::Load(streams.position_x + i)));
+        Ops::Store(streams.position_y + i, Ops::MulAdd(velocity_y, dt, Ops::Load(streams.position_y + i)));
+        Ops::Store(streams.position_z + i, Ops::MulAdd(velocity_z, dt, Ops::Load(streams.position_z + i)));
+        Ops::Store(streams.life + i, Ops::MulAdd(Ops::Load(streams.life_rate + i), dt, Ops::Load(streams.life + i)));
+    }
+
+    for (; i < end; ++i)
+    {
+        float const velocity_x = (streams.velocity_x[i] + step.gravity_x) * step.damping;
+        float const velocity_y = (streams.velocity_y[i] + step.gravity_y) * step.damping;
+        float const velocity_z = (streams.velocity_z[i] + step.gravity_z) * step.damping;
+        streams.velocity_x[i] = velocity_x;
+        streams.velocity_y[i] = velocity_y;
+        streams.velocity_z[i] = velocity_z;
+        streams.position_x[i] += velocity_x * step.dt;
+        streams.position_y[i] += velocity_y * step.dt;
+        streams.position_z[i] += velocity_z * step.dt;
+        streams.life[i] += streams.life_rate[i] * step.dt;
+    }
+}
+
+template <typename Ops>
+uint32_t find_dead_simd(float const * life, size_t const begin, size_t const end, uint32_t * dead_indices)
+{
+    using Reg = typename Ops::Reg;
+    constexpr size_t WIDTH = Ops::WIDTH;
+
+    Reg const one = Ops::Set1(1.0f);
+
+    uint32_t dead_count = 0;
+    size_t i = begin;
+    for (; i + WIDTH <= end; i += WIDTH)
+    {
+        // Most blocks have nobody dying in them, so only those that do are walked lane by lane
+        uint32_t const dead_mask = Ops::GreaterEqualMask(Ops::Load(life + i), one);
+        if (dead_mask != 0)
+        {
+            for (uint32_t lane = 0; lane < WIDTH; ++lane)
+            {
+                if (((dead_mask >> lane) & 1u) != 0)
+                {
+                    dead_indices[dead_count++] = static_cast<uint32_t>(i + lane);
+                }
+            }
+        }
+    }
+
+    for (; i < end; ++i)
+    {
+        if (life[i] >= 1.0f)
+        {
+            dead_indices[dead_count++] = static_cast<uint32_t>(i);
+        }
+    }
+    return dead_count;
+}
+
+template <typename Ops>
+Renderer::SParticleKernels make_particle_kernel_table()
+{
+    Renderer::SParticleKernels table;
+    table.integrate = &integrate_simd<Ops>;
+    table.find_dead = &find_dead_simd<Ops>;
+    return table;
+}
@@ -0,0 +1,41 @@
+#include "renderer/particles/particle_kernels.hpp"
+
+#include "utility/cpu_features.hpp"
+
+#if GOAT_ARCH_X86
+
+#include <smmintrin.h>
+
+namespace
+{
+    struct SSse41Ops
+    {
+        using Reg = __m128;
+        static constexpr size_t WIDTH = 4;
+
+        static Reg Load(float const * ptr) { return _mm_loadu_ps(ptr); }
+        static void Store(float * ptr, Reg const v) { _mm_storeu_ps(ptr, v); }
+        static Reg Set1(float const v) { return _mm_set1_ps(v); }
+        static Reg Add(Reg const a, Reg const b) { return _mm_add_ps(a, b); }
+        static Reg Mul(Reg const a, Reg const b) { return _mm_mul_ps(a, b); }
+        static Reg MulAdd(Reg const a, Reg const b, Reg const c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+        static uint32_t GreaterEqualMask(Reg const a, Reg const b) { return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmpge_ps(a, b))); }
+    };
+
+#include "renderer/particles/particle_kernels_simd.inl"
+}
+
+Renderer::SParticleKernels const & Renderer::get_sse41_particle_kernels()
+{
+    static SParticleKernels const table = make_particle_kernel_table<SSse41Ops>();
+    return table;
+}
+
+#else
+
+Renderer::SParticleKernels const & Renderer::get_sse41_particle_kernels()
+{
+    return get_scalar_particle_kernels();
+}
+
+#endif
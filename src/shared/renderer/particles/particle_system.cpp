@@ -0,0 +1,69 @@
+#include "particle_system.hpp"
+
+#include "utility/parallel_for.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+Renderer::CParticleSystem::CParticleSystem()
+: m_kernels(get_particle_kernels())
+, m_emitters()
+, m_stats()
+{
+}
+
+Renderer::CParticleEmitter * Renderer::CParticleSystem::CreateEmitter(SParticleEmitterSettings const & settings)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    m_emitters.push_back(std::make_unique<CParticleEmitter>(settings));
+    return m_emitters.back().get();
+}
+
+void Renderer::CParticleSystem::DestroyEmitter(CParticleEmitter * emitter)
+{
+    auto const found = std::find_if(m_emitters.begin(), m_emitters.end(), [emitter](std::unique_ptr<CParticleEmitter> const & owned)
+    {
+        return owned.get() == emitter;
+    });
+
+    if (found != m_emitters.end())
+    {
+        std::swap(*found, m_emitters.back());
+        m_emitters.pop_back();
+    }
+}
+
+void Renderer::CParticleSystem::Update(float const dt)
+{
+    auto const start = std::chrono::steady_clock::now();
+
+    // One emitter per chunk, big emitters split their own integration further
+    Utility::parallel_for(m_emitters.size(), 1, [&](size_t const begin, size_t const end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            m_emitters[i]->Update(dt, m_kernels);
+        }
+    });
+
+    m_stats.emitters = static_cast<uint32_t>(m_emitters.size());
+    m_stats.particles = 0;
+    for (std::unique_ptr<CParticleEmitter> const & emitter : m_emitters)
+    {
+        m_stats.particles += emitter->GetCount();
+    }
+    m_stats.update_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Renderer::CParticleSystem::Submit(IRenderContext & render_context) const
+{
+    for (std::unique_ptr<CParticleEmitter> const & emitter : m_emitters)
+    {
+        if (emitter->GetCount() > 0)
+        {
+            render_context.SubmitParticles(emitter.get());
+        }
+    }
+}
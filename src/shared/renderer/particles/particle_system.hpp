@@ -0,0 +1,47 @@
+#pragma once
+
+#include "renderer/render_context.hpp"
+#include "renderer/particles/particle_emitter.hpp"
+
+#include <cinttypes>
+#include <memory>
+#include <vector>
+
+namespace Renderer
+{
+    struct SParticleStats
+    {
+        uint32_t emitters = 0;
+        uint32_t particles = 0;
+        // From the last Update
+        double update_ms = 0.0;
+    };
+
+    // Owns every emitter and steps them all at once, each emitter is independent so they're
+    // updated in parallel across the worker pool with the widest particle kernels the CPU has.
+    class CParticleSystem
+    {
+    public:
+        CParticleSystem();
+
+        CParticleSystem(CParticleSystem const &) = delete;
+        CParticleSystem & operator=(CParticleSystem const &) = delete;
+
+        // The emitter stays owned by the system and valid until it's destroyed
+        CParticleEmitter * CreateEmitter(SParticleEmitterSettings const & settings);
+        void DestroyEmitter(CParticleEmitter * emitter);
+
+        void Update(float const dt);
+
+        // One instanced draw per emitter with anything alive in it
+        void Submit(IRenderContext & render_context) const;
+
+        SParticleStats GetStats() const { return m_stats; }
+
+    private:
+        SParticleKernels const & m_kernels;
+        std::vector<std::unique_ptr<CParticleEmitter>> m_emitters;
+
+        SParticleStats m_stats;
+    };
+}
@@ -1,42 +1,40 @@
 #include "shape_2d.hpp"
 
-#include <utility>
+Renderer::MeshRef const & Renderer::get_triangle_mesh()
+{
+    static MeshRef const mesh = []()
+    {
+        glm::vec3 const verts[] =
+        {
+            glm::vec3(-0.5f, -0.5f, 0.0f),
+            glm::vec3( 0.5f, -0.5f, 0.0f),
+            glm::vec3( 0.0f,  0.5f, 0.0f)
+        };
+        uint32_t const indices[] = { 0, 1, 2 };
+        // White, the tint gives each triangle its colour
+        return CMesh::Create(verts, 3, nullptr, indices, 3);
+    }();
+    return mesh;
+}
 
 Renderer::CTriangle2d::CTriangle2d()
-: m_verts()
-, m_indices()
-, m_cols()
+: m_mesh(get_triangle_mesh())
 , m_transform_mat(1.0f)
-{   
-    m_verts.emplace_back(glm::vec3(-0.5f, -0.5f, 0.0f));
-    m_verts.emplace_back(glm::vec3( 0.5f, -0.5f, 0.0f));
-    m_verts.emplace_back(glm::vec3( 0.0f,  0.5f, 0.0f));
-
-    m_indices.emplace_back(0);
-    m_indices.emplace_back(1);
-    m_indices.emplace_back(2);
-
-    m_cols.emplace_back(glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
-    m_cols.emplace_back(glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
-    m_cols.emplace_back(glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
-}
-
-std::vector<glm::vec3> const & Renderer::CTriangle2d::GetVerts() const
+, m_tint(1.0f)
 {
-    return m_verts;
 }
 
-std::vector<uint32_t> const & Renderer::CTriangle2d::GetIndices() const
+Renderer::CMesh const & Renderer::CTriangle2d::GetMesh() const
 {
-    return m_indices;
+    return *m_mesh;
 }
 
-std::vector<glm::vec4> const & Renderer::CTriangle2d::GetVertColours() const
+glm::mat4 const & Renderer::CTriangle2d::GetTransformMatrix() const
 {
-    return m_cols;
+    return m_transform_mat;
 }
 
-glm::mat4 const & Renderer::CTriangle2d::GetTransformMatrix() const
+glm::vec4 const & Renderer::CTriangle2d::GetTint() const
 {
-    return m_transform_mat;
+    return m_tint;
 }
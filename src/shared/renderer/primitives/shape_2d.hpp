@@ -4,21 +4,26 @@
 
 namespace Renderer
 {
+    // The unit triangle every CTriangle2d draws, built the first time it's asked for
+    MeshRef const & get_triangle_mesh();
+
+    // Every triangle draws the same mesh
     class CTriangle2d : public IRenderable
     {
     public:
         CTriangle2d();
 
-        virtual std::vector<glm::vec3> const & GetVerts() const override;
-        virtual std::vector<uint32_t> const & GetIndices() const override;
-        virtual std::vector<glm::vec4> const & GetVertColours() const override;
+        virtual CMesh const & GetMesh() const override;
 
         virtual glm::mat4 const & GetTransformMatrix() const override;
+        virtual glm::vec4 const & GetTint() const override;
+
+        void SetTransformMatrix(glm::mat4 const & transform) { m_transform_mat = transform; }
+        void SetTint(glm::vec4 const & tint) { m_tint = tint; }
 
     private:
-        std::vector<glm::vec3> m_verts;
-        std::vector<uint32_t> m_indices;
-        std::vector<glm::vec4> m_cols;
+        MeshRef m_mesh;
         glm::mat4 m_transform_mat;
+        glm::vec4 m_tint;
     };
 }
@@ -0,0 +1,228 @@
+#include "tilemap.hpp"
+
+#include "utility/memory/memory_tracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+Renderer::CTilemapChunk::CTilemapChunk()
+: m_mesh(CMesh::Empty())
+, m_transform(nullptr)
+, m_tint(nullptr)
+, m_dirty(false)
+{
+}
+
+Renderer::CTilemap::CTilemap(uint32_t const width, uint32_t const height, float const tile_size)
+: m_width(width)
+, m_height(height)
+, m_chunks_wide((width + TILEMAP_CHUNK_SIZE - 1) / TILEMAP_CHUNK_SIZE)
+, m_chunks_high((height + TILEMAP_CHUNK_SIZE - 1) / TILEMAP_CHUNK_SIZE)
+, m_tile_size(tile_size)
+, m_transform(1.0f)
+, m_tint(1.0f)
+, m_tiles(static_cast<size_t>(width) * height, EMPTY_TILE)
+, m_palette()
+, m_chunks(static_cast<size_t>(m_chunks_wide) * m_chunks_high)
+, m_dirty_chunks()
+, m_build_verts()
+, m_build_cols()
+, m_build_indices()
+, m_stats()
+{
+    for (CTilemapChunk & chunk : m_chunks)
+    {
+        chunk.m_transform = &m_transform;
+        chunk.m_tint = &m_tint;
+    }
+    m_stats.chunks = static_cast<uint32_t>(m_chunks.size());
+}
+
+Renderer::TileId Renderer::CTilemap::GetTile(uint32_t const x, uint32_t const y) const
+{
+    if (x >= m_width || y >= m_height)
+    {
+        return EMPTY_TILE;
+    }
+    return m_tiles[static_cast<size_t>(y) * m_width + x];
+}
+
+void Renderer::CTilemap::SetTile(uint32_t const x, uint32_t const y, TileId const tile)
+{
+    if (x >= m_width || y >= m_height)
+    {
+        return;
+    }
+
+    TileId & current = m_tiles[static_cast<size_t>(y) * m_width + x];
+    if (current != tile)
+    {
+        current = tile;
+        MarkDirty((y / TILEMAP_CHUNK_SIZE) * m_chunks_wide + x / TILEMAP_CHUNK_SIZE);
+    }
+}
+
+void Renderer::CTilemap::Fill(uint32_t const x, uint32_t const y, uint32_t const width, uint32_t const height, TileId const tile)
+{
+    uint32_t const end_x = static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(x) + width, m_width));
+    uint32_t const end_y = static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(y) + height, m_height));
+    if (x >= end_x || y >= end_y)
+    {
+        return;
+    }
+
+    for (uint32_t row = y; row < end_y; ++row)
+    {
+        std::fill(m_tiles.begin() + static_cast<std::ptrdiff_t>(static_cast<size_t>(row) * m_width + x),
+                  m_tiles.begin() + static_cast<std::ptrdiff_t>(static_cast<size_t>(row) * m_width + end_x),
+                  tile);
+    }
+
+    for (uint32_t chunk_y = y / TILEMAP_CHUNK_SIZE; chunk_y <= (end_y - 1) / TILEMAP_CHUNK_SIZE; ++chunk_y)
+    {
+        for (uint32_t chunk_x = x / TILEMAP_CHUNK_SIZE; chunk_x <= (end_x - 1) / TILEMAP_CHUNK_SIZE; ++chunk_x)
+        {
+            MarkDirty(chunk_y * m_chunks_wide + chunk_x);
+        }
+    }
+}
+
+void Renderer::CTilemap::SetTileColour(TileId const tile, glm::vec4 const & colour)
+{
+    if (tile >= m_palette.size())
+    {
+        m_palette.resize(static_cast<size_t>(tile) + 1, glm::vec4(1.0f));
+    }
+    m_palette[tile] = colour;
+
+    for (uint32_t chunk = 0; chunk < m_chunks.size(); ++chunk)
+    {
+        if (m_chunks[chunk].IsEmpty() == false)
+        {
+            MarkDirty(chunk);
+        }
+    }
+}
+
+void Renderer::CTilemap::Update()
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    m_stats.rebuilt_chunks = static_cast<uint32_t>(m_dirty_chunks.size());
+    for (uint32_t const chunk : m_dirty_chunks)
+    {
+        BuildChunk(chunk % m_chunks_wide, chunk / m_chunks_wide);
+        m_chunks[chunk].m_dirty = false;
+    }
+    m_dirty_chunks.clear();
+}
+
+void Renderer::CTilemap::Submit(IRenderContext & render_context, glm::vec2 const & view_min, glm::vec2 const & view_max)
+{
+    m_stats.submitted_chunks = 0;
+
+    float const chunk_extent = m_tile_size * static_cast<float>(TILEMAP_CHUNK_SIZE);
+    if (chunk_extent <= 0.0f || view_max.x < 0.0f || view_max.y < 0.0f)
+    {
+        return;
+    }
+
+    auto chunk_index = [chunk_extent](float const position, uint32_t const count)
+    {
+        float const index = std::floor(std::max(position, 0.0f) / chunk_extent);
+        return static_cast<uint32_t>(std::min(index, static_cast<float>(count)));
+    };
+
+    uint32_t const first_x = chunk_index(view_min.x, m_chunks_wide);
+    uint32_t const first_y = chunk_index(view_min.y, m_chunks_high);
+    uint32_t const end_x = std::min(chunk_index(view_max.x, m_chunks_wide) + 1, m_chunks_wide);
+    uint32_t const end_y = std::min(chunk_index(view_max.y, m_chunks_high) + 1, m_chunks_high);
+
+    for (uint32_t chunk_y = first_y; chunk_y < end_y; ++chunk_y)
+    {
+        for (uint32_t chunk_x = first_x; chunk_x < end_x; ++chunk_x)
+        {
+            CTilemapChunk const & chunk = m_chunks[static_cast<size_t>(chunk_y) * m_chunks_wide + chunk_x];
+            if (chunk.IsEmpty() == false)
+            {
+                render_context.SubmitRenderable(&chunk);
+                ++m_stats.submitted_chunks;
+            }
+        }
+    }
+}
+
+void Renderer::CTilemap::BuildChunk(uint32_t const chunk_x, uint32_t const chunk_y)
+{
+    CTilemapChunk & chunk = m_chunks[static_cast<size_t>(chunk_y) * m_chunks_wide + chunk_x];
+
+    // Cleared rather than freed, they're reused by every chunk built after this one
+    m_build_verts.clear();
+    m_build_indices.clear();
+    m_build_cols.clear();
+
+    uint32_t const first_x = chunk_x * TILEMAP_CHUNK_SIZE;
+    uint32_t const first_y = chunk_y * TILEMAP_CHUNK_SIZE;
+    uint32_t const end_x = std::min(first_x + TILEMAP_CHUNK_SIZE, m_width);
+    uint32_t const end_y = std::min(first_y + TILEMAP_CHUNK_SIZE, m_height);
+
+    size_t tile_count = 0;
+    for (uint32_t y = first_y; y < end_y; ++y)
+    {
+        TileId const * row = m_tiles.data() + static_cast<size_t>(y) * m_width;
+        tile_count += static_cast<size_t>(end_x - first_x) - static_cast<size_t>(std::count(row + first_x, row + end_x, EMPTY_TILE));
+    }
+    if (tile_count == 0)
+    {
+        chunk.m_mesh = CMesh::Empty();
+        return;
+    }
+
+    m_build_verts.reserve(tile_count * 4);
+    m_build_indices.reserve(tile_count * 6);
+    m_build_cols.reserve(tile_count * 4);
+
+    for (uint32_t y = first_y; y < end_y; ++y)
+    {
+        TileId const * row = m_tiles.data() + static_cast<size_t>(y) * m_width;
+        for (uint32_t x = first_x; x < end_x; ++x)
+        {
+            TileId const tile = row[x];
+            if (tile == EMPTY_TILE)
+            {
+                continue;
+            }
+
+            glm::vec3 const min(static_cast<float>(x) * m_tile_size, static_cast<float>(y) * m_tile_size, 0.0f);
+            glm::vec3 const max = min + glm::vec3(m_tile_size, m_tile_size, 0.0f);
+
+            uint32_t const base = static_cast<uint32_t>(m_build_verts.size());
+            m_build_verts.emplace_back(min);
+            m_build_verts.emplace_back(glm::vec3(max.x, min.y, 0.0f));
+            m_build_verts.emplace_back(max);
+            m_build_verts.emplace_back(glm::vec3(min.x, max.y, 0.0f));
+
+            uint32_t const quad[] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+            m_build_indices.insert(m_build_indices.end(), std::begin(quad), std::end(quad));
+
+            glm::vec4 const colour = tile < m_palette.size() ? m_palette[tile] : glm::vec4(1.0f);
+            m_build_cols.push_back(colour);
+            m_build_cols.push_back(colour);
+            m_build_cols.push_back(colour);
+            m_build_cols.push_back(colour);
+        }
+    }
+
+    // Meshes never change once made, so the chunk gets a new one. Being a new mesh is also what
+    // has the mesh pool upload it, the old one's geometry is never drawn again.
+    chunk.m_mesh = CMesh::Create(m_build_verts, m_build_cols, m_build_indices);
+}
+
+void Renderer::CTilemap::MarkDirty(uint32_t const chunk)
+{
+    if (m_chunks[chunk].m_dirty == false)
+    {
+        m_chunks[chunk].m_dirty = true;
+        m_dirty_chunks.push_back(chunk);
+    }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "renderer/render_context.hpp"
+#include "renderer/renderable.hpp"
+
+#include <glm/vec2.hpp>
+
+#include <cinttypes>
+#include <vector>
+
+namespace Renderer
+{
+    // Tiles per chunk side, a 4096x4096 map is 128x128 chunks and a screen's worth of tiles
+    // covers a few dozen
+    constexpr uint32_t TILEMAP_CHUNK_SIZE = 32;
+
+    using TileId = uint16_t;
+    constexpr TileId EMPTY_TILE = 0;
+
+    // One chunk's worth of tiles as a single renderable. Its mesh is only replaced when one of
+    // its tiles changes, the rest of the time it's submitted as is and stays resident in the
+    // render context's mesh pool, so the GPU only sees a chunk's geometry again after a rebuild.
+    class CTilemapChunk : public IRenderable
+    {
+    public:
+        CTilemapChunk();
+
+        virtual CMesh const & GetMesh() const override { return *m_mesh; }
+
+        virtual glm::mat4 const & GetTransformMatrix() const override { return *m_transform; }
+        virtual glm::vec4 const & GetTint() const override { return *m_tint; }
+
+        bool IsEmpty() const { return m_mesh->GetIndexCount() == 0; }
+
+    private:
+        friend class CTilemap;
+
+        MeshRef m_mesh;
+        // Shared with every other chunk of the map
+        glm::mat4 const * m_transform;
+        glm::vec4 const * m_tint;
+        bool m_dirty;
+    };
+
+    struct STilemapStats
+    {
+        uint32_t chunks = 0;
+        // From the last Update and Submit
+        uint32_t rebuilt_chunks = 0;
+        uint32_t submitted_chunks = 0;
+    };
+
+    // A grid of tiles drawn a chunk at a time. Tile x runs along +x and tile y along +y from the
+    // map's origin, each tile_size wide, and each tile id is drawn as a quad of its palette colour.
+    class CTilemap
+    {
+    public:
+        CTilemap(uint32_t const width, uint32_t const height, float const tile_size);
+
+        CTilemap(CTilemap const &) = delete;
+        CTilemap & operator=(CTilemap const &) = delete;
+
+        uint32_t GetWidth() const { return m_width; }
+        uint32_t GetHeight() const { return m_height; }
+
+        TileId GetTile(uint32_t const x, uint32_t const y) const;
+        void SetTile(uint32_t const x, uint32_t const y, TileId const tile);
+        // Clipped to the map
+        void Fill(uint32_t const x, uint32_t const y, uint32_t const width, uint32_t const height, TileId const tile);
+
+        // Rebuilds every chunk with tiles, so best set up before the map is filled
+        void SetTileColour(TileId const tile, glm::vec4 const & colour);
+
+        void SetTransform(glm::mat4 const & transform) { m_transform = transform; }
+        void SetTint(glm::vec4 const & tint) { m_tint = tint; }
+
+        // Rebuilds the geometry of chunks whose tiles changed since the last update
+        void Update();
+
+        // Submits the non-empty chunks overlapping the view rectangle, given in map space. Only
+        // the overlapping chunk range is visited, however big the map is.
+        void Submit(IRenderContext & render_context, glm::vec2 const & view_min, glm::vec2 const & view_max);
+
+        STilemapStats GetStats() const { return m_stats; }
+
+    private:
+        void BuildChunk(uint32_t const chunk_x, uint32_t const chunk_y);
+        void MarkDirty(uint32_t const chunk);
+
+        uint32_t m_width;
+        uint32_t m_height;
+        uint32_t m_chunks_wide;
+        uint32_t m_chunks_high;
+        float m_tile_size;
+        glm::mat4 m_transform;
+        glm::vec4 m_tint;
+
+        std::vector<TileId> m_tiles;
+        std::vector<glm::vec4> m_palette;
+        std::vector<CTilemapChunk> m_chunks;
+        std::vector<uint32_t> m_dirty_chunks;
+
+        // A chunk's geometry is gathered here then copied into its new mesh, kept between builds
+        std::vector<glm::vec3> m_build_verts;
+        std::vector<glm::vec4> m_build_cols;
+        std::vector<uint32_t> m_build_indices;
+
+        STilemapStats m_stats;
+    };
+}
@@ -2,10 +2,27 @@
 
 #include <cinttypes>
 
+#include <glm/mat4x4.hpp>
+
 #include "renderer/renderable.hpp"
+#include "renderer/capture/captured_frame.hpp"
+#include "renderer/culling/frustum_culler.hpp"
+#include "renderer/particles/particle_emitter.hpp"
+#include "renderer/resolution/dynamic_resolution.hpp"
+#include "renderer/text/text_renderer.hpp"
+#include "renderer/texture/texture_backend.hpp"
 
 namespace Renderer
 {
+    // How long the GPU spent on one frame, timed with queries around its work
+    struct SGpuFrameTime
+    {
+        uint64_t frame_index = 0;
+        float milliseconds = 0.0f;
+        // False until a frame has been timed, and always where the device can't time them
+        bool valid = false;
+    };
+
     class IRenderContext
     {
     public:
@@ -13,7 +30,50 @@ namespace Renderer
         virtual bool Init() = 0;
         virtual void ResizeScreen(uint32_t const width, uint32_t const height) = 0;
         virtual void PreRender() = 0;
+
+        // Draws everything submitted since PreRender, scaled up to the output if it was drawn at
+        // a lower resolution. Whatever is drawn between this and RenderFrame, the UI, goes on top
+        // at full resolution. RenderFrame ends the scene itself if this wasn't called.
+        virtual void EndScene() = 0;
         virtual void RenderFrame() = 0;
+
+        // The camera everything submitted is drawn and culled with, in OpenGL's clip space (y up,
+        // depth -1 to 1, glm's default) whichever backend is drawing. Holds until it's set again,
+        // identity until then, which draws positions as they are in clip space.
+        virtual void SetViewProjection(glm::mat4 const & view_projection) = 0;
         virtual void SubmitRenderable(IRenderable const * renderable) = 0;
+
+        // Drawn as one instanced draw of the emitter's live particles, the emitter has to stay
+        // alive and unchanged until RenderFrame
+        virtual void SubmitParticles(CParticleEmitter const * emitter) = 0;
+
+        // Everything the text renderer batched this frame, drawn over the scene at full
+        // resolution with one draw. Goes after its EndFrame, and the text renderer has to stay
+        // alive and unchanged until RenderFrame.
+        virtual void SubmitText(CTextRenderer const * text) = 0;
+
+        // Visible/culled counts from the most recently rendered frame
+        virtual SCullStats GetCullStats() const = 0;
+
+        // Where the texture streamer creates and uploads textures, nullptr until Init succeeds
+        virtual ITextureBackend * GetTextureBackend() = 0;
+
+        // Copies the frame the next RenderFrame draws back to the CPU. Nothing waits on the copy
+        // there, it turns up in PopCapturedFrame once the GPU has finished, a frame or so later.
+        virtual void RequestCapture() = 0;
+
+        // Oldest finished capture first. With wait set it blocks on the oldest outstanding copy
+        // instead of returning false, for draining every capture before shutting down.
+        virtual bool PopCapturedFrame(SCapturedFrame & out_frame, bool const wait) = 0;
+
+        // The latest frame the GPU has finished and timed, which trails RenderFrame by a frame or
+        // two since the timings are only read once they're ready
+        virtual SGpuFrameTime GetGpuFrameTime() const = 0;
+
+        // Draws the scene at a fraction of the output's resolution picked each frame from the GPU
+        // time, so the frame rate holds under load. Off by default.
+        virtual void SetDynamicResolution(SDynamicResolutionSettings const & settings) = 0;
+        // Of the frame being drawn, 1 at full resolution
+        virtual float GetResolutionScale() const = 0;
     };
 }
@@ -0,0 +1,82 @@
+#include "render_system.hpp"
+
+#include "renderer/render_context.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+#include <utility>
+
+Renderer::CRenderSystem::CEntityRenderable::CEntityRenderable(CMesh const & mesh, glm::mat4 const & transform, glm::vec4 const & tint)
+: m_mesh(&mesh)
+, m_transform(transform)
+, m_tint(tint)
+{
+}
+
+Renderer::CRenderSystem::CRenderSystem()
+: m_query(ECS::CQuery::Create<STransformComponent, SMeshComponent>())
+, m_meshes()
+, m_renderables()
+{
+}
+
+ECS::ComponentMask Renderer::CRenderSystem::GetReadMask() const
+{
+    return ECS::component_mask<STransformComponent, SMeshComponent>();
+}
+
+ECS::ComponentMask Renderer::CRenderSystem::GetWriteMask() const
+{
+    return 0;
+}
+
+void Renderer::CRenderSystem::Update(ECS::CWorld & world, ECS::CCommandBuffer & commands, float const delta_time)
+{
+    (void)commands;
+    (void)delta_time;
+
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    m_renderables.clear();
+    m_query.ForEach<STransformComponent, SMeshComponent>(world, [this](ECS::SEntity const entity, STransformComponent const & transform, SMeshComponent const & mesh)
+    {
+        (void)entity;
+
+        // An entity can be given a mesh before it's loaded, it just isn't drawn until then
+        CMesh const * const source = GetMesh(mesh.mesh);
+        if (source != nullptr)
+        {
+            m_renderables.emplace_back(*source, transform.transform, mesh.tint);
+        }
+    });
+}
+
+void Renderer::CRenderSystem::Submit(IRenderContext & render_context) const
+{
+    for (CEntityRenderable const & renderable : m_renderables)
+    {
+        render_context.SubmitRenderable(&renderable);
+    }
+}
+
+uint32_t Renderer::CRenderSystem::AddMesh(MeshRef mesh)
+{
+    m_meshes.emplace_back(std::move(mesh));
+    return static_cast<uint32_t>(m_meshes.size() - 1);
+}
+
+void Renderer::CRenderSystem::RemoveMesh(uint32_t const mesh)
+{
+    if (mesh < m_meshes.size())
+    {
+        m_meshes[mesh] = nullptr;
+    }
+}
+
+Renderer::CMesh const * Renderer::CRenderSystem::GetMesh(uint32_t const mesh) const
+{
+    if (mesh >= m_meshes.size())
+    {
+        return nullptr;
+    }
+    return m_meshes[mesh].get();
+}
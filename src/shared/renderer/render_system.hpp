@@ -0,0 +1,75 @@
+#pragma once
+
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <cinttypes>
+#include <vector>
+
+#include "ecs/query.hpp"
+#include "ecs/system_scheduler.hpp"
+#include "renderer/renderable.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+namespace Renderer
+{
+    class IRenderContext;
+
+    constexpr uint32_t INVALID_MESH = UINT32_MAX;
+
+    struct STransformComponent
+    {
+        glm::mat4 transform = glm::mat4(1.0f);
+    };
+
+    // Meshes own their geometry so entities refer to one by its index in CRenderSystem
+    struct SMeshComponent
+    {
+        uint32_t mesh = INVALID_MESH;
+        glm::vec4 tint = glm::vec4(1.0f);
+    };
+
+    // Turns every entity with a transform and a mesh into a renderable. Update only reads
+    // components so it can run alongside other systems, Submit then hands what it found to the
+    // render context from the render thread. The renderables stay alive until the next Update,
+    // which has to be after the context's RenderFrame.
+    class CRenderSystem : public ECS::ISystem
+    {
+    public:
+        CRenderSystem();
+
+        virtual char const * GetName() const override { return "Render"; }
+        virtual ECS::ComponentMask GetReadMask() const override;
+        virtual ECS::ComponentMask GetWriteMask() const override;
+        virtual void Update(ECS::CWorld & world, ECS::CCommandBuffer & commands, float const delta_time) override;
+
+        void Submit(IRenderContext & render_context) const;
+
+        uint32_t AddMesh(MeshRef mesh);
+        // Lets the mesh go, anything still referring to it just stops being drawn. Its index
+        // isn't handed out again.
+        void RemoveMesh(uint32_t const mesh);
+        // nullptr for INVALID_MESH or anything else that wasn't added
+        CMesh const * GetMesh(uint32_t const mesh) const;
+
+    private:
+        class CEntityRenderable : public IRenderable
+        {
+        public:
+            CEntityRenderable(CMesh const & mesh, glm::mat4 const & transform, glm::vec4 const & tint);
+
+            virtual CMesh const & GetMesh() const override { return *m_mesh; }
+            virtual glm::mat4 const & GetTransformMatrix() const override { return m_transform; }
+            virtual glm::vec4 const & GetTint() const override { return m_tint; }
+
+        private:
+            CMesh const * m_mesh;
+            glm::mat4 m_transform;
+            glm::vec4 m_tint;
+        };
+
+        ECS::CQuery m_query;
+        Memory::tagged_vector<MeshRef, Memory::EMemoryTag::Renderer> m_meshes;
+        Memory::tagged_vector<CEntityRenderable, Memory::EMemoryTag::Renderer> m_renderables;
+    };
+}
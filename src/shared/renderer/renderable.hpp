@@ -1,21 +1,24 @@
 #pragma once
 
-#include <vector>
-#include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 #include <glm/mat4x4.hpp>
 
+#include "renderer/mesh.hpp"
+
 namespace Renderer
 {
+    // One instance of a mesh. The geometry is shared and immutable, all a renderable has of its
+    // own is where it is and what colour it's tinted.
     class IRenderable
     {
     public:
         virtual ~IRenderable();
 
-        virtual std::vector<glm::vec3> const & GetVerts() const = 0;
-        virtual std::vector<uint32_t> const & GetIndices() const = 0;
-        virtual std::vector<glm::vec4> const & GetVertColours() const = 0;
+        virtual CMesh const & GetMesh() const = 0;
 
         virtual glm::mat4 const & GetTransformMatrix() const = 0;
+
+        // Multiplies every vertex colour of the mesh
+        virtual glm::vec4 const & GetTint() const = 0;
     };
 }
@@ -0,0 +1,81 @@
+#include "dynamic_resolution.hpp"
+
+#include "renderer/render_context.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+Renderer::CDynamicResolution::CDynamicResolution()
+: m_settings()
+, m_scale(1.0f)
+, m_frames_under(0)
+, m_scale_frame_index(0)
+, m_next_timed_frame_index(0)
+{
+}
+
+void Renderer::CDynamicResolution::SetSettings(SDynamicResolutionSettings const & settings)
+{
+    m_settings = settings;
+    m_settings.min_scale = std::min(std::max(m_settings.min_scale, 0.01f), 1.0f);
+    m_settings.max_scale = std::min(std::max(m_settings.max_scale, m_settings.min_scale), 1.0f);
+    m_scale = std::min(std::max(m_scale, m_settings.min_scale), m_settings.max_scale);
+    m_frames_under = 0;
+}
+
+void Renderer::CDynamicResolution::Update(SGpuFrameTime const & gpu_time, uint64_t const next_frame_index)
+{
+    if (m_settings.enabled == false ||
+        gpu_time.valid == false ||
+        gpu_time.frame_index < m_next_timed_frame_index ||
+        gpu_time.milliseconds <= 0.0f)
+    {
+        return;
+    }
+    m_next_timed_frame_index = gpu_time.frame_index + 1;
+
+    if (gpu_time.frame_index < m_scale_frame_index)
+    {
+        return;
+    }
+
+    float const target = m_settings.target_milliseconds;
+    float new_scale = m_scale;
+    if (gpu_time.milliseconds > target * (1.0f + m_settings.decrease_margin))
+    {
+        // Straight to the scale that should bring it back under, aiming a margin below the
+        // target so the next frame doesn't land right on it
+        new_scale = m_scale * std::sqrt(target * (1.0f - m_settings.decrease_margin) / gpu_time.milliseconds);
+        m_frames_under = 0;
+    }
+    else if (gpu_time.milliseconds < target * (1.0f - m_settings.increase_margin))
+    {
+        if (++m_frames_under >= m_settings.increase_frames)
+        {
+            float const estimate = m_scale * std::sqrt(target * (1.0f - m_settings.increase_margin) / gpu_time.milliseconds);
+            new_scale = std::min(estimate, m_scale + m_settings.increase_step);
+            m_frames_under = 0;
+        }
+    }
+    else
+    {
+        m_frames_under = 0;
+    }
+
+    new_scale = std::min(std::max(new_scale, m_settings.min_scale), m_settings.max_scale);
+    if (new_scale != m_scale)
+    {
+        m_scale = new_scale;
+        m_scale_frame_index = next_frame_index;
+    }
+}
+
+void Renderer::CDynamicResolution::GetScaledSize(uint32_t const width,
+                                                 uint32_t const height,
+                                                 uint32_t & out_width,
+                                                 uint32_t & out_height) const
+{
+    float const scale = GetScale();
+    out_width = std::min(std::max(static_cast<uint32_t>(std::lround(width * scale)), 1u), std::max(width, 1u));
+    out_height = std::min(std::max(static_cast<uint32_t>(std::lround(height * scale)), 1u), std::max(height, 1u));
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cinttypes>
+
+namespace Renderer
+{
+    struct SGpuFrameTime;
+
+    struct SDynamicResolutionSettings
+    {
+        bool enabled = false;
+        // The GPU time a frame should fit in, a 60 Hz frame with a little to spare
+        float target_milliseconds = 15.0f;
+        // Fraction of the output's width and height the scene is drawn at
+        float min_scale = 0.5f;
+        float max_scale = 1.0f;
+
+        // The scale drops as soon as a frame runs over the target by more than decrease_margin,
+        // but only rises after increase_frames frames in a row under it by more than
+        // increase_margin, and then by at most increase_step. Between the two it's left alone.
+        float decrease_margin = 0.05f;
+        float increase_margin = 0.15f;
+        uint32_t increase_frames = 30;
+        float increase_step = 0.05f;
+    };
+
+    // Picks the scale the scene is drawn at each frame from how long the GPU took over recent
+    // ones. GPU time is assumed to go with the number of pixels drawn, the square of the scale.
+    class CDynamicResolution
+    {
+    public:
+        CDynamicResolution();
+
+        void SetSettings(SDynamicResolutionSettings const & settings);
+        SDynamicResolutionSettings const & GetSettings() const { return m_settings; }
+        bool IsEnabled() const { return m_settings.enabled; }
+
+        // Takes the latest timing before next_frame_index is drawn. Each frame is only counted
+        // once, and frames drawn before the last change of scale are ignored since they say
+        // nothing about the new one.
+        void Update(SGpuFrameTime const & gpu_time, uint64_t const next_frame_index);
+
+        // 1 when disabled
+        float GetScale() const { return m_settings.enabled == true ? m_scale : 1.0f; }
+
+        // The size to draw the scene at for an output of width by height, at least a pixel
+        void GetScaledSize(uint32_t const width, uint32_t const height, uint32_t & out_width, uint32_t & out_height) const;
+
+    private:
+        SDynamicResolutionSettings m_settings;
+        float m_scale;
+        uint32_t m_frames_under;
+        // The first frame drawn at the current scale, and the next frame that hasn't been counted
+        uint64_t m_scale_frame_index;
+        uint64_t m_next_timed_frame_index;
+    };
+}
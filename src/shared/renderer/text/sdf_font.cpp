@@ -0,0 +1,240 @@
+#include "sdf_font.hpp"
+
+#include "utility/logging.hpp"
+#include "utility/file/file_helper.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+#include <algorithm>
+
+// imgui compiles its own copy with everything static, so this one is too
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "imstb_truetype.h"
+
+namespace
+{
+    // Texels left empty between glyphs on top of each one's distance field padding
+    constexpr uint32_t GLYPH_GAP = 1;
+}
+
+Renderer::CSdfFont::CSdfFont()
+: m_settings()
+, m_font_data()
+, m_font_info()
+, m_scale(0.0f)
+, m_ascent(0.0f)
+, m_line_height(0.0f)
+, m_glyphs()
+, m_packer(0, 0)
+, m_atlas()
+, m_atlas_size(0)
+, m_atlas_dirty(false)
+, m_gpu_texture(INVALID_GPU_TEXTURE)
+{
+}
+
+Renderer::CSdfFont::~CSdfFont()
+{
+    // This page is intentionally left blank
+}
+
+bool Renderer::CSdfFont::Load(std::string const & filename, SSdfFontSettings const & settings)
+{
+    // The font file is an asset, the atlas is tagged Renderer whatever the scope
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Assets);
+
+    m_font_data = FileHelpers::read_file(filename);
+    if (m_font_data.empty() == true)
+    {
+        ERROR_LOG("Failed to read font: " + filename);
+        return false;
+    }
+
+    unsigned char const * data = reinterpret_cast<unsigned char const *>(m_font_data.data());
+    m_font_info = std::make_unique<stbtt_fontinfo>();
+    int const offset = stbtt_GetFontOffsetForIndex(data, 0);
+    if (offset < 0 || stbtt_InitFont(m_font_info.get(), data, offset) == 0)
+    {
+        ERROR_LOG("Not a TrueType font: " + filename);
+        m_font_info.reset();
+        m_font_data.clear();
+        return false;
+    }
+
+    m_settings = settings;
+    m_scale = stbtt_ScaleForPixelHeight(m_font_info.get(), m_settings.sdf_size);
+
+    int ascent = 0;
+    int descent = 0;
+    int line_gap = 0;
+    stbtt_GetFontVMetrics(m_font_info.get(), &ascent, &descent, &line_gap);
+    m_ascent = static_cast<float>(ascent) * m_scale;
+    m_line_height = static_cast<float>(ascent - descent + line_gap) * m_scale;
+
+    m_glyphs.clear();
+    m_atlas_size = std::min(m_settings.initial_atlas_size, m_settings.max_atlas_size);
+    m_atlas.assign(static_cast<size_t>(m_atlas_size) * m_atlas_size, 0);
+    m_packer = CSkylinePacker(m_atlas_size, m_atlas_size);
+    m_atlas_dirty = true;
+    return true;
+}
+
+Renderer::SGlyph const * Renderer::CSdfFont::GetGlyph(uint32_t const codepoint)
+{
+    auto const found = m_glyphs.find(codepoint);
+    if (found != m_glyphs.end())
+    {
+        return &found->second;
+    }
+
+    if (m_font_info == nullptr)
+    {
+        return nullptr;
+    }
+
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    SGlyph glyph;
+    if (Rasterise(codepoint, glyph) == true)
+    {
+        return &m_glyphs.emplace(codepoint, glyph).first->second;
+    }
+
+    // Missing codepoints share the fallback glyph from then on rather than being looked up again
+    if (stbtt_FindGlyphIndex(m_font_info.get(), static_cast<int>(codepoint)) == 0 && codepoint != '?')
+    {
+        SGlyph const * fallback = GetGlyph('?');
+        if (fallback != nullptr)
+        {
+            return &m_glyphs.emplace(codepoint, *fallback).first->second;
+        }
+    }
+    return nullptr;
+}
+
+float Renderer::CSdfFont::GetKerning(SGlyph const & left, SGlyph const & right) const
+{
+    if (m_font_info == nullptr)
+    {
+        return 0.0f;
+    }
+    return static_cast<float>(stbtt_GetGlyphKernAdvance(m_font_info.get(), static_cast<int>(left.glyph_index), static_cast<int>(right.glyph_index))) * m_scale;
+}
+
+void Renderer::CSdfFont::Upload(ITextureBackend & backend)
+{
+    if (m_atlas_dirty == false || m_atlas_size == 0)
+    {
+        return;
+    }
+
+    if (m_gpu_texture != INVALID_GPU_TEXTURE)
+    {
+        backend.DestroyTexture(m_gpu_texture);
+    }
+
+    m_gpu_texture = backend.CreateTexture(ETextureFormat::R8, m_atlas_size, m_atlas_size, 1);
+    if (m_gpu_texture == INVALID_GPU_TEXTURE)
+    {
+        ERROR_LOG("Failed to create the glyph atlas texture");
+        return;
+    }
+
+    backend.UploadMip(m_gpu_texture, 0, m_atlas_size, m_atlas_size, m_atlas.data(), m_atlas.size());
+    m_atlas_dirty = false;
+}
+
+void Renderer::CSdfFont::ReleaseGpuTexture(ITextureBackend & backend)
+{
+    if (m_gpu_texture != INVALID_GPU_TEXTURE)
+    {
+        backend.DestroyTexture(m_gpu_texture);
+        m_gpu_texture = INVALID_GPU_TEXTURE;
+    }
+    m_atlas_dirty = true;
+}
+
+bool Renderer::CSdfFont::Rasterise(uint32_t const codepoint, SGlyph & out_glyph)
+{
+    int const glyph_index = stbtt_FindGlyphIndex(m_font_info.get(), static_cast<int>(codepoint));
+    if (glyph_index == 0)
+    {
+        return false;
+    }
+
+    int advance = 0;
+    int bearing = 0;
+    stbtt_GetGlyphHMetrics(m_font_info.get(), glyph_index, &advance, &bearing);
+
+    out_glyph.glyph_index = static_cast<uint32_t>(glyph_index);
+    out_glyph.advance = static_cast<float>(advance) * m_scale;
+
+    int width = 0;
+    int height = 0;
+    int offset_x = 0;
+    int offset_y = 0;
+    float const distance_scale = static_cast<float>(SDF_ON_EDGE_VALUE) / static_cast<float>(std::max(m_settings.padding, 1u));
+    unsigned char * sdf = stbtt_GetGlyphSDF(m_font_info.get(), m_scale, glyph_index, static_cast<int>(m_settings.padding),
+                                            SDF_ON_EDGE_VALUE, distance_scale, &width, &height, &offset_x, &offset_y);
+
+    // Whitespace has nothing to draw, just an advance
+    if (sdf == nullptr)
+    {
+        return true;
+    }
+
+    out_glyph.offset_x = static_cast<float>(offset_x);
+    out_glyph.offset_y = static_cast<float>(offset_y);
+    out_glyph.width = static_cast<uint32_t>(width);
+    out_glyph.height = static_cast<uint32_t>(height);
+
+    bool placed = false;
+    while (placed == false)
+    {
+        placed = m_packer.Pack(out_glyph.width + GLYPH_GAP, out_glyph.height + GLYPH_GAP, out_glyph.atlas_x, out_glyph.atlas_y);
+        if (placed == false && GrowAtlas() == false)
+        {
+            break;
+        }
+    }
+
+    if (placed == true)
+    {
+        for (uint32_t row = 0; row < out_glyph.height; ++row)
+        {
+            unsigned char const * source = sdf + static_cast<size_t>(row) * out_glyph.width;
+            std::copy(source, source + out_glyph.width, m_atlas.begin() + static_cast<std::ptrdiff_t>((static_cast<size_t>(out_glyph.atlas_y) + row) * m_atlas_size + out_glyph.atlas_x));
+        }
+        m_atlas_dirty = true;
+    }
+    else
+    {
+        ERROR_LOG("Glyph atlas is full, codepoint " + std::to_string(codepoint) + " won't be drawn");
+    }
+
+    stbtt_FreeSDF(sdf, nullptr);
+    return placed;
+}
+
+bool Renderer::CSdfFont::GrowAtlas()
+{
+    uint32_t const new_size = m_atlas_size * 2;
+    if (new_size > m_settings.max_atlas_size || new_size == 0)
+    {
+        return false;
+    }
+
+    // Rows keep their place in the bigger atlas, so glyph positions don't change
+    Memory::tagged_vector<uint8_t, Memory::EMemoryTag::Renderer> atlas(static_cast<size_t>(new_size) * new_size, 0);
+    for (uint32_t row = 0; row < m_atlas_size; ++row)
+    {
+        auto const source = m_atlas.begin() + static_cast<std::ptrdiff_t>(static_cast<size_t>(row) * m_atlas_size);
+        std::copy(source, source + m_atlas_size, atlas.begin() + static_cast<std::ptrdiff_t>(static_cast<size_t>(row) * new_size));
+    }
+
+    m_atlas = std::move(atlas);
+    m_atlas_size = new_size;
+    m_packer.Grow(new_size, new_size);
+    m_atlas_dirty = true;
+    return true;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "renderer/texture/atlas_packer.hpp"
+#include "renderer/texture/texture_backend.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+#include <cinttypes>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct stbtt_fontinfo;
+
+namespace Renderer
+{
+    // Distance field texels at exactly this value are on the glyph's outline, inside is higher
+    constexpr uint8_t SDF_ON_EDGE_VALUE = 128;
+
+    struct SSdfFontSettings
+    {
+        // Pixel height glyphs are rasterised at, anything from about half to four times this
+        // size still looks sharp
+        float sdf_size = 32.0f;
+        // Distance field spread past the outline in texels, also the gap between glyphs
+        uint32_t padding = 4;
+        uint32_t initial_atlas_size = 256;
+        uint32_t max_atlas_size = 4096;
+    };
+
+    // Everything in pixels at the font's SDF size
+    struct SGlyph
+    {
+        uint32_t glyph_index = 0;
+        float advance = 0.0f;
+        // Top left of the bitmap from the pen position on the baseline, y down
+        float offset_x = 0.0f;
+        float offset_y = 0.0f;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t atlas_x = 0;
+        uint32_t atlas_y = 0;
+    };
+
+    // A TrueType font whose glyphs are rasterised as signed distance fields the first time
+    // they're asked for and packed into one single channel atlas. The atlas starts small and
+    // doubles when full; glyphs never move when it grows, so atlas positions handed out stay
+    // valid and only the size used to turn them into texture coordinates changes.
+    class CSdfFont
+    {
+    public:
+        CSdfFont();
+        ~CSdfFont();
+
+        CSdfFont(CSdfFont const &) = delete;
+        CSdfFont & operator=(CSdfFont const &) = delete;
+
+        bool Load(std::string const & filename, SSdfFontSettings const & settings = SSdfFontSettings());
+
+        // Falls back to '?' for codepoints the font doesn't have, nullptr if the atlas is full
+        SGlyph const * GetGlyph(uint32_t const codepoint);
+        float GetKerning(SGlyph const & left, SGlyph const & right) const;
+
+        float GetSdfSize() const { return m_settings.sdf_size; }
+        float GetAscent() const { return m_ascent; }
+        float GetLineHeight() const { return m_line_height; }
+
+        uint32_t GetAtlasSize() const { return m_atlas_size; }
+        Memory::tagged_vector<uint8_t, Memory::EMemoryTag::Renderer> const & GetAtlasPixels() const { return m_atlas; }
+
+        // Recreates the atlas texture if glyphs were added since the last upload
+        void Upload(ITextureBackend & backend);
+        void ReleaseGpuTexture(ITextureBackend & backend);
+        uint32_t GetGpuTexture() const { return m_gpu_texture; }
+
+    private:
+        bool Rasterise(uint32_t const codepoint, SGlyph & out_glyph);
+        bool GrowAtlas();
+
+        SSdfFontSettings m_settings;
+        std::vector<char> m_font_data;
+        std::unique_ptr<stbtt_fontinfo> m_font_info;
+        float m_scale;
+        float m_ascent;
+        float m_line_height;
+
+        std::unordered_map<uint32_t, SGlyph> m_glyphs;
+
+        CSkylinePacker m_packer;
+        Memory::tagged_vector<uint8_t, Memory::EMemoryTag::Renderer> m_atlas;
+        uint32_t m_atlas_size;
+        bool m_atlas_dirty;
+        uint32_t m_gpu_texture;
+    };
+}
@@ -0,0 +1,278 @@
+#include "text_renderer.hpp"
+
+#include "utility/memory/memory_tracker.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    constexpr uint32_t REPLACEMENT_CODEPOINT = 0xFFFD;
+
+    uint64_t hash_bytes(uint64_t hash, void const * data, size_t const size)
+    {
+        uint8_t const * bytes = static_cast<uint8_t const *>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    uint64_t hash_layout(std::string const & text, float const size, float const max_width)
+    {
+        uint64_t hash = hash_bytes(14695981039346656037ull, text.data(), text.size());
+        hash = hash_bytes(hash, &size, sizeof(size));
+        return hash_bytes(hash, &max_width, sizeof(max_width));
+    }
+
+    // Next codepoint from UTF-8, malformed sequences come out as U+FFFD one byte at a time
+    uint32_t decode_utf8(std::string const & text, size_t & cursor)
+    {
+        uint8_t const lead = static_cast<uint8_t>(text[cursor++]);
+        if (lead < 0x80)
+        {
+            return lead;
+        }
+
+        size_t continuation = 0;
+        uint32_t codepoint = 0;
+        if ((lead & 0xE0) == 0xC0)
+        {
+            continuation = 1;
+            codepoint = lead & 0x1F;
+        }
+        else if ((lead & 0xF0) == 0xE0)
+        {
+            continuation = 2;
+            codepoint = lead & 0x0F;
+        }
+        else if ((lead & 0xF8) == 0xF0)
+        {
+            continuation = 3;
+            codepoint = lead & 0x07;
+        }
+        else
+        {
+            return REPLACEMENT_CODEPOINT;
+        }
+
+        if (cursor + continuation > text.size())
+        {
+            return REPLACEMENT_CODEPOINT;
+        }
+
+        for (size_t i = 0; i < continuation; ++i)
+        {
+            uint8_t const byte = static_cast<uint8_t>(text[cursor + i]);
+            if ((byte & 0xC0) != 0x80)
+            {
+                return REPLACEMENT_CODEPOINT;
+            }
+            codepoint = (codepoint << 6) | (byte & 0x3F);
+        }
+        cursor += continuation;
+        return codepoint;
+    }
+}
+
+Renderer::CTextRenderer::CTextRenderer(CSdfFont & font)
+: m_font(font)
+, m_layouts()
+// Frame zero means never drawn
+, m_frame(1)
+, m_vertices()
+, m_indices()
+, m_stats()
+{
+}
+
+void Renderer::CTextRenderer::BeginFrame()
+{
+    m_vertices.clear();
+    m_indices.clear();
+
+    m_stats = STextStats();
+}
+
+void Renderer::CTextRenderer::DrawText(std::string const & text, glm::vec2 const & position, STextStyle const & style)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    SLayout const & layout = GetLayout(text, style);
+
+    uint32_t const first_vertex = static_cast<uint32_t>(m_vertices.size());
+    m_vertices.reserve(m_vertices.size() + layout.glyphs.size() * 4);
+    m_indices.reserve(m_indices.size() + layout.glyphs.size() * 6);
+
+    // Texture coordinates stay in texels until EndFrame, glyphs added later in the frame can
+    // still grow the atlas
+    for (SLayoutGlyph const & glyph : layout.glyphs)
+    {
+        glm::vec2 const min = position + glyph.min;
+        glm::vec2 const max = position + glyph.max;
+        glm::vec2 const uv_min(static_cast<float>(glyph.atlas_x), static_cast<float>(glyph.atlas_y));
+        glm::vec2 const uv_max(static_cast<float>(glyph.atlas_x + glyph.width), static_cast<float>(glyph.atlas_y + glyph.height));
+
+        m_vertices.push_back({ min, uv_min, style.colour });
+        m_vertices.push_back({ glm::vec2(max.x, min.y), glm::vec2(uv_max.x, uv_min.y), style.colour });
+        m_vertices.push_back({ max, uv_max, style.colour });
+        m_vertices.push_back({ glm::vec2(min.x, max.y), glm::vec2(uv_min.x, uv_max.y), style.colour });
+    }
+
+    for (uint32_t i = 0; i < layout.glyphs.size(); ++i)
+    {
+        uint32_t const base = first_vertex + i * 4;
+        uint32_t const quad[] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+        m_indices.insert(m_indices.end(), std::begin(quad), std::end(quad));
+    }
+
+    ++m_stats.draws;
+    m_stats.glyphs += static_cast<uint32_t>(layout.glyphs.size());
+}
+
+glm::vec2 Renderer::CTextRenderer::MeasureText(std::string const & text, STextStyle const & style)
+{
+    return GetLayout(text, style).extent;
+}
+
+void Renderer::CTextRenderer::EndFrame(ITextureBackend & backend)
+{
+    m_font.Upload(backend);
+
+    float const texel_size = m_font.GetAtlasSize() > 0 ? 1.0f / static_cast<float>(m_font.GetAtlasSize()) : 0.0f;
+    for (STextVertex & vertex : m_vertices)
+    {
+        vertex.uv *= texel_size;
+    }
+
+    // The whole cache is only walked every so often, it's a lot of entries to visit every frame
+    if (m_frame % TEXT_LAYOUT_CACHE_FRAMES == 0)
+    {
+        for (auto it = m_layouts.begin(); it != m_layouts.end(); )
+        {
+            if (it->second.last_used_frame + TEXT_LAYOUT_CACHE_FRAMES < m_frame)
+            {
+                it = m_layouts.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    m_stats.cached_layouts = static_cast<uint32_t>(m_layouts.size());
+    ++m_frame;
+}
+
+Renderer::CTextRenderer::SLayout const & Renderer::CTextRenderer::GetLayout(std::string const & text, STextStyle const & style)
+{
+    SLayout & layout = m_layouts[hash_layout(text, style.size, style.max_width)];
+
+    // A hash collision just means the entry gets laid out again for whichever string asked last
+    if (layout.last_used_frame == 0 || layout.size != style.size || layout.max_width != style.max_width || layout.text != text)
+    {
+        layout.text = text;
+        layout.size = style.size;
+        layout.max_width = style.max_width;
+        BuildLayout(layout);
+        ++m_stats.layout_misses;
+    }
+    else
+    {
+        ++m_stats.layout_hits;
+    }
+
+    layout.last_used_frame = m_frame;
+    return layout;
+}
+
+void Renderer::CTextRenderer::BuildLayout(SLayout & layout)
+{
+    layout.glyphs.clear();
+    layout.extent = glm::vec2(0.0f);
+
+    float const scale = m_font.GetSdfSize() > 0.0f ? layout.size / m_font.GetSdfSize() : 0.0f;
+    float const line_height = m_font.GetLineHeight() * scale;
+
+    float pen_x = 0.0f;
+    float baseline = m_font.GetAscent() * scale;
+    SGlyph const * previous = nullptr;
+
+    // Where the current line can be broken, the first glyph after its last space and the pen
+    // position that glyph starts at
+    size_t break_glyph = 0;
+    float break_pen = 0.0f;
+    bool can_break = false;
+
+    size_t cursor = 0;
+    while (cursor < layout.text.size())
+    {
+        uint32_t const codepoint = decode_utf8(layout.text, cursor);
+        if (codepoint == '\n')
+        {
+            pen_x = 0.0f;
+            baseline += line_height;
+            previous = nullptr;
+            can_break = false;
+            continue;
+        }
+
+        SGlyph const * glyph = m_font.GetGlyph(codepoint);
+        if (glyph == nullptr)
+        {
+            continue;
+        }
+
+        if (previous != nullptr)
+        {
+            pen_x += m_font.GetKerning(*previous, *glyph) * scale;
+        }
+        previous = glyph;
+
+        if (codepoint == ' ')
+        {
+            pen_x += glyph->advance * scale;
+            break_glyph = layout.glyphs.size();
+            break_pen = pen_x;
+            can_break = true;
+            continue;
+        }
+
+        if (glyph->width > 0 && glyph->height > 0)
+        {
+            SLayoutGlyph placed;
+            placed.min = glm::vec2(pen_x + glyph->offset_x * scale, baseline + glyph->offset_y * scale);
+            placed.max = placed.min + glm::vec2(static_cast<float>(glyph->width), static_cast<float>(glyph->height)) * scale;
+            placed.atlas_x = glyph->atlas_x;
+            placed.atlas_y = glyph->atlas_y;
+            placed.width = glyph->width;
+            placed.height = glyph->height;
+            layout.glyphs.push_back(placed);
+
+            // Overflowing moves the word so far down to the start of the next line
+            if (layout.max_width > 0.0f && placed.max.x > layout.max_width && can_break == true)
+            {
+                glm::vec2 const offset(-break_pen, line_height);
+                for (size_t i = break_glyph; i < layout.glyphs.size(); ++i)
+                {
+                    layout.glyphs[i].min += offset;
+                    layout.glyphs[i].max += offset;
+                }
+                pen_x -= break_pen;
+                baseline += line_height;
+                can_break = false;
+            }
+        }
+
+        pen_x += glyph->advance * scale;
+    }
+
+    for (SLayoutGlyph const & glyph : layout.glyphs)
+    {
+        layout.extent.x = std::max(layout.extent.x, glyph.max.x);
+    }
+    layout.extent.y = baseline - m_font.GetAscent() * scale + line_height;
+}
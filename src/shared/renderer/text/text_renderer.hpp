@@ -0,0 +1,106 @@
+#pragma once
+
+#include "renderer/text/sdf_font.hpp"
+
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+#include <cinttypes>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Renderer
+{
+    // Layouts not drawn for this many frames are dropped from the cache
+    constexpr uint64_t TEXT_LAYOUT_CACHE_FRAMES = 120;
+
+    struct STextVertex
+    {
+        glm::vec2 position;
+        glm::vec2 uv;
+        glm::vec4 colour;
+    };
+
+    struct STextStyle
+    {
+        // Pixel height of a line
+        float size = 16.0f;
+        glm::vec4 colour = glm::vec4(1.0f);
+        // Lines are wrapped at spaces to fit, zero for no wrapping
+        float max_width = 0.0f;
+    };
+
+    struct STextStats
+    {
+        uint32_t draws = 0;
+        uint32_t glyphs = 0;
+        uint32_t layout_hits = 0;
+        uint32_t layout_misses = 0;
+        uint32_t cached_layouts = 0;
+    };
+
+    // Batches every string drawn in a frame into one list of quads over the font's glyph atlas,
+    // drawn with one call. Laying out a string (decoding, kerning, wrapping) is cached by its
+    // content, size and wrap width, so text that doesn't change costs a lookup and a copy of its
+    // quads each frame; position and colour are applied when the quads are copied.
+    class CTextRenderer
+    {
+    public:
+        explicit CTextRenderer(CSdfFont & font);
+
+        CTextRenderer(CTextRenderer const &) = delete;
+        CTextRenderer & operator=(CTextRenderer const &) = delete;
+
+        void BeginFrame();
+
+        // Position is the top left of the first line in screen pixels, y down
+        void DrawText(std::string const & text, glm::vec2 const & position, STextStyle const & style = STextStyle());
+        glm::vec2 MeasureText(std::string const & text, STextStyle const & style = STextStyle());
+
+        // Uploads any glyphs added this frame and drops stale layouts
+        void EndFrame(ITextureBackend & backend);
+
+        // Two triangles per glyph, texture coordinates are into GetFont().GetGpuTexture()
+        std::vector<STextVertex> const & GetVertices() const { return m_vertices; }
+        std::vector<uint32_t> const & GetIndices() const { return m_indices; }
+
+        CSdfFont & GetFont() { return m_font; }
+        CSdfFont const & GetFont() const { return m_font; }
+        STextStats GetStats() const { return m_stats; }
+
+    private:
+        // Offsets in pixels from the text's top left at the layout's size, atlas rects in texels
+        struct SLayoutGlyph
+        {
+            glm::vec2 min;
+            glm::vec2 max;
+            uint32_t atlas_x = 0;
+            uint32_t atlas_y = 0;
+            uint32_t width = 0;
+            uint32_t height = 0;
+        };
+
+        struct SLayout
+        {
+            std::string text;
+            float size = 0.0f;
+            float max_width = 0.0f;
+            glm::vec2 extent = glm::vec2(0.0f);
+            std::vector<SLayoutGlyph> glyphs;
+            uint64_t last_used_frame = 0;
+        };
+
+        SLayout const & GetLayout(std::string const & text, STextStyle const & style);
+        void BuildLayout(SLayout & layout);
+
+        CSdfFont & m_font;
+        std::unordered_map<uint64_t, SLayout> m_layouts;
+        uint64_t m_frame;
+
+        std::vector<STextVertex> m_vertices;
+        std::vector<uint32_t> m_indices;
+
+        STextStats m_stats;
+    };
+}
@@ -0,0 +1,159 @@
+#include "atlas_packer.hpp"
+
+#include <algorithm>
+#include <limits>
+
+Renderer::CSkylinePacker::CSkylinePacker(uint32_t const width, uint32_t const height)
+: m_width(width)
+, m_height(height)
+, m_used_area(0)
+, m_skyline()
+{
+    Reset();
+}
+
+void Renderer::CSkylinePacker::Reset()
+{
+    SSkylineNode floor;
+    floor.width = m_width;
+
+    m_skyline.clear();
+    m_skyline.push_back(floor);
+    m_used_area = 0;
+}
+
+void Renderer::CSkylinePacker::Grow(uint32_t const width, uint32_t const height)
+{
+    if (width > m_width)
+    {
+        SSkylineNode & last = m_skyline.back();
+        if (last.y == 0)
+        {
+            last.width += width - m_width;
+        }
+        else
+        {
+            SSkylineNode floor;
+            floor.x = m_width;
+            floor.width = width - m_width;
+            m_skyline.push_back(floor);
+        }
+        m_width = width;
+    }
+    m_height = std::max(m_height, height);
+}
+
+bool Renderer::CSkylinePacker::Pack(uint32_t const width, uint32_t const height, uint32_t & out_x, uint32_t & out_y)
+{
+    if (width == 0 || height == 0)
+    {
+        return false;
+    }
+
+    // Lowest top edge wins, ties go to the narrowest segment so wide gaps are left for wide rectangles
+    size_t best_node = m_skyline.size();
+    uint32_t best_top = std::numeric_limits<uint32_t>::max();
+    uint32_t best_width = std::numeric_limits<uint32_t>::max();
+    uint32_t best_y = 0;
+
+    for (size_t i = 0; i < m_skyline.size(); ++i)
+    {
+        uint32_t y = 0;
+        if (Fit(i, width, height, y) == false)
+        {
+            continue;
+        }
+
+        uint32_t const top = y + height;
+        if (top < best_top || (top == best_top && m_skyline[i].width < best_width))
+        {
+            best_node = i;
+            best_top = top;
+            best_width = m_skyline[i].width;
+            best_y = y;
+        }
+    }
+
+    if (best_node == m_skyline.size())
+    {
+        return false;
+    }
+
+    out_x = m_skyline[best_node].x;
+    out_y = best_y;
+    AddNode(best_node, out_x, best_y + height, width);
+    m_used_area += static_cast<uint64_t>(width) * height;
+    return true;
+}
+
+float Renderer::CSkylinePacker::GetOccupancy() const
+{
+    uint64_t const area = static_cast<uint64_t>(m_width) * m_height;
+    return area > 0 ? static_cast<float>(static_cast<double>(m_used_area) / static_cast<double>(area)) : 0.0f;
+}
+
+bool Renderer::CSkylinePacker::Fit(size_t const node, uint32_t const width, uint32_t const height, uint32_t & out_y) const
+{
+    uint32_t const x = m_skyline[node].x;
+    if (x + width > m_width)
+    {
+        return false;
+    }
+
+    // The rectangle rests on the highest segment it spans
+    uint32_t y = 0;
+    uint32_t remaining = width;
+    for (size_t i = node; remaining > 0; ++i)
+    {
+        y = std::max(y, m_skyline[i].y);
+        if (y + height > m_height)
+        {
+            return false;
+        }
+        remaining -= std::min(remaining, m_skyline[i].width);
+    }
+
+    out_y = y;
+    return true;
+}
+
+void Renderer::CSkylinePacker::AddNode(size_t const node, uint32_t const x, uint32_t const y, uint32_t const width)
+{
+    SSkylineNode added;
+    added.x = x;
+    added.y = y;
+    added.width = width;
+    m_skyline.insert(m_skyline.begin() + static_cast<std::ptrdiff_t>(node), added);
+
+    // Shrink or remove the segments the new one now covers
+    uint32_t const right = x + width;
+    size_t i = node + 1;
+    while (i < m_skyline.size() && m_skyline[i].x < right)
+    {
+        SSkylineNode & covered = m_skyline[i];
+        uint32_t const covered_right = covered.x + covered.width;
+        if (covered_right <= right)
+        {
+            m_skyline.erase(m_skyline.begin() + static_cast<std::ptrdiff_t>(i));
+            continue;
+        }
+
+        covered.width = covered_right - right;
+        covered.x = right;
+        break;
+    }
+
+    // Neighbours at the same height become one segment
+    for (size_t j = 0; j + 1 < m_skyline.size(); )
+    {
+        if (m_skyline[j].y == m_skyline[j + 1].y)
+        {
+            m_skyline[j].width += m_skyline[j + 1].width;
+            m_skyline.erase(m_skyline.begin() + static_cast<std::ptrdiff_t>(j + 1));
+        }
+        else
+        {
+            ++j;
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+
+namespace Renderer
+{
+    // Skyline bottom left rectangle packer. The packed area is kept as a list of horizontal
+    // segments (the skyline) and each rectangle goes wherever its top edge ends up lowest, so
+    // it's cheap enough to add rectangles one at a time at runtime and packs almost as tightly
+    // as maxrects when fed tallest first.
+    class CSkylinePacker
+    {
+    public:
+        CSkylinePacker(uint32_t const width, uint32_t const height);
+
+        void Reset();
+
+        // Makes the area bigger without moving anything that's already packed
+        void Grow(uint32_t const width, uint32_t const height);
+
+        // False when there's no room left, nothing is changed in that case
+        bool Pack(uint32_t const width, uint32_t const height, uint32_t & out_x, uint32_t & out_y);
+
+        uint32_t GetWidth() const { return m_width; }
+        uint32_t GetHeight() const { return m_height; }
+
+        // Fraction of the area covered by packed rectangles
+        float GetOccupancy() const;
+
+    private:
+        struct SSkylineNode
+        {
+            uint32_t x = 0;
+            uint32_t y = 0;
+            uint32_t width = 0;
+        };
+
+        // Lowest y a rectangle starting on the given node can sit at, false if it doesn't fit there
+        bool Fit(size_t const node, uint32_t const width, uint32_t const height, uint32_t & out_y) const;
+        void AddNode(size_t const node, uint32_t const x, uint32_t const y, uint32_t const width);
+
+        uint32_t m_width;
+        uint32_t m_height;
+        uint64_t m_used_area;
+        std::vector<SSkylineNode> m_skyline;
+    };
+}
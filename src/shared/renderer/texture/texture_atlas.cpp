@@ -0,0 +1,265 @@
+#include "texture_atlas.hpp"
+
+#include "utility/logging.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+    constexpr size_t ATLAS_TEXEL_SIZE = 4;
+
+    uint32_t align_up(uint32_t const value, uint32_t const alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // 2x2 box filter, odd edges repeat their last texel
+    void downsample(std::vector<uint8_t> const & source, uint32_t const width, uint32_t const height,
+                    std::vector<uint8_t> & out_level, uint32_t const out_width, uint32_t const out_height)
+    {
+        out_level.resize(static_cast<size_t>(out_width) * out_height * ATLAS_TEXEL_SIZE);
+        for (uint32_t y = 0; y < out_height; ++y)
+        {
+            uint32_t const y0 = std::min(y * 2, height - 1);
+            uint32_t const y1 = std::min(y * 2 + 1, height - 1);
+            for (uint32_t x = 0; x < out_width; ++x)
+            {
+                uint32_t const x0 = std::min(x * 2, width - 1);
+                uint32_t const x1 = std::min(x * 2 + 1, width - 1);
+                for (size_t channel = 0; channel < ATLAS_TEXEL_SIZE; ++channel)
+                {
+                    uint32_t const sum = source[(static_cast<size_t>(y0) * width + x0) * ATLAS_TEXEL_SIZE + channel] +
+                                         source[(static_cast<size_t>(y0) * width + x1) * ATLAS_TEXEL_SIZE + channel] +
+                                         source[(static_cast<size_t>(y1) * width + x0) * ATLAS_TEXEL_SIZE + channel] +
+                                         source[(static_cast<size_t>(y1) * width + x1) * ATLAS_TEXEL_SIZE + channel];
+                    out_level[(static_cast<size_t>(y) * out_width + x) * ATLAS_TEXEL_SIZE + channel] = static_cast<uint8_t>((sum + 2) / 4);
+                }
+            }
+        }
+    }
+}
+
+Renderer::CTextureAtlas::SPage::SPage(uint32_t const size)
+: packer(size, size)
+, pixels(static_cast<size_t>(size) * size * ATLAS_TEXEL_SIZE, 0)
+, gpu_texture(INVALID_GPU_TEXTURE)
+, dirty(true)
+{
+}
+
+Renderer::CTextureAtlas::CTextureAtlas(SAtlasSettings const & settings)
+: m_settings(settings)
+, m_border(0)
+, m_alignment(1)
+, m_pages()
+{
+    m_settings.mip_count = std::max(m_settings.mip_count, 1u);
+    m_alignment = 1u << (m_settings.mip_count - 1);
+    m_border = std::max(m_settings.padding, m_settings.mip_count > 1 ? m_alignment : 0u);
+}
+
+bool Renderer::CTextureAtlas::Add(SAtlasImage const & image, SAtlasRegion & out_region)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    if (image.width == 0 || image.height == 0 || image.pixels == nullptr)
+    {
+        ERROR_LOG("Can't add an empty image to a texture atlas");
+        return false;
+    }
+
+    uint32_t const padded_width = align_up(image.width + m_border * 2, m_alignment);
+    uint32_t const padded_height = align_up(image.height + m_border * 2, m_alignment);
+
+    uint32_t page = 0;
+    uint32_t x = 0;
+    uint32_t y = 0;
+    if (Place(padded_width, padded_height, page, x, y) == false)
+    {
+        ERROR_LOG("No room in the texture atlas for a " + std::to_string(image.width) + "x" + std::to_string(image.height) + " image");
+        return false;
+    }
+
+    Blit(image, page, x, y);
+
+    float const page_size = static_cast<float>(m_settings.page_size);
+    out_region.page = page;
+    out_region.x = x + m_border;
+    out_region.y = y + m_border;
+    out_region.width = image.width;
+    out_region.height = image.height;
+    out_region.uv_min = glm::vec2(static_cast<float>(out_region.x) / page_size, static_cast<float>(out_region.y) / page_size);
+    out_region.uv_max = glm::vec2(static_cast<float>(out_region.x + image.width) / page_size, static_cast<float>(out_region.y + image.height) / page_size);
+    return true;
+}
+
+bool Renderer::CTextureAtlas::AddAll(std::vector<SAtlasImage> const & images, std::vector<SAtlasRegion> & out_regions)
+{
+    std::vector<size_t> order(images.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&images](size_t const lhs, size_t const rhs)
+    {
+        if (images[lhs].height != images[rhs].height)
+        {
+            return images[lhs].height > images[rhs].height;
+        }
+        return images[lhs].width > images[rhs].width;
+    });
+
+    out_regions.assign(images.size(), SAtlasRegion());
+
+    bool success = true;
+    for (size_t const index : order)
+    {
+        success = Add(images[index], out_regions[index]) && success;
+    }
+    return success;
+}
+
+void Renderer::CTextureAtlas::Clear()
+{
+    for (SPage & page : m_pages)
+    {
+        page.packer.Reset();
+        std::fill(page.pixels.begin(), page.pixels.end(), static_cast<uint8_t>(0));
+        page.dirty = true;
+    }
+}
+
+Renderer::STextureDesc Renderer::CTextureAtlas::GetPage(uint32_t const page) const
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    STextureDesc desc;
+    desc.format = ETextureFormat::RGBA8;
+    desc.width = m_settings.page_size;
+    desc.height = m_settings.page_size;
+    desc.mips.push_back(m_pages[page].pixels);
+
+    uint32_t width = desc.width;
+    uint32_t height = desc.height;
+    while (desc.mips.size() < m_settings.mip_count && (width > 1 || height > 1))
+    {
+        uint32_t const next_width = std::max(width / 2, 1u);
+        uint32_t const next_height = std::max(height / 2, 1u);
+
+        std::vector<uint8_t> level;
+        downsample(desc.mips.back(), width, height, level, next_width, next_height);
+        desc.mips.push_back(std::move(level));
+
+        width = next_width;
+        height = next_height;
+    }
+    return desc;
+}
+
+void Renderer::CTextureAtlas::Upload(ITextureBackend & backend)
+{
+    for (uint32_t i = 0; i < m_pages.size(); ++i)
+    {
+        SPage & page = m_pages[i];
+        if (page.dirty == false)
+        {
+            continue;
+        }
+
+        STextureDesc const desc = GetPage(i);
+
+        if (page.gpu_texture != INVALID_GPU_TEXTURE)
+        {
+            backend.DestroyTexture(page.gpu_texture);
+        }
+
+        page.gpu_texture = backend.CreateTexture(desc.format, desc.width, desc.height, static_cast<uint32_t>(desc.mips.size()));
+        if (page.gpu_texture == INVALID_GPU_TEXTURE)
+        {
+            ERROR_LOG("Failed to create a texture for atlas page " + std::to_string(i));
+            continue;
+        }
+
+        for (uint32_t level = 0; level < desc.mips.size(); ++level)
+        {
+            uint32_t const width = std::max(desc.width >> level, 1u);
+            uint32_t const height = std::max(desc.height >> level, 1u);
+            backend.UploadMip(page.gpu_texture, level, width, height, desc.mips[level].data(), desc.mips[level].size());
+        }
+        page.dirty = false;
+    }
+}
+
+void Renderer::CTextureAtlas::ReleaseGpuTextures(ITextureBackend & backend)
+{
+    for (SPage & page : m_pages)
+    {
+        if (page.gpu_texture != INVALID_GPU_TEXTURE)
+        {
+            backend.DestroyTexture(page.gpu_texture);
+            page.gpu_texture = INVALID_GPU_TEXTURE;
+        }
+        page.dirty = true;
+    }
+}
+
+bool Renderer::CTextureAtlas::Place(uint32_t const width, uint32_t const height, uint32_t & out_page, uint32_t & out_x, uint32_t & out_y)
+{
+    if (width > m_settings.page_size || height > m_settings.page_size)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < m_pages.size(); ++i)
+    {
+        if (m_pages[i].packer.Pack(width, height, out_x, out_y) == true)
+        {
+            out_page = i;
+            return true;
+        }
+    }
+
+    if (m_pages.size() >= m_settings.max_pages)
+    {
+        return false;
+    }
+
+    m_pages.emplace_back(m_settings.page_size);
+    out_page = static_cast<uint32_t>(m_pages.size() - 1);
+    return m_pages.back().packer.Pack(width, height, out_x, out_y);
+}
+
+void Renderer::CTextureAtlas::Blit(SAtlasImage const & image, uint32_t const page, uint32_t const x, uint32_t const y)
+{
+    SPage & target = m_pages[page];
+    target.dirty = true;
+
+    // The image and its border in one pass, border texels copy the nearest edge texel
+    uint32_t const page_size = m_settings.page_size;
+    uint32_t const padded_width = std::min(image.width + m_border * 2, page_size - x);
+    uint32_t const padded_height = std::min(image.height + m_border * 2, page_size - y);
+    for (uint32_t row = 0; row < padded_height; ++row)
+    {
+        uint32_t const source_row = std::min(row > m_border ? row - m_border : 0u, image.height - 1);
+        uint8_t const * source = image.pixels + static_cast<size_t>(source_row) * image.width * ATLAS_TEXEL_SIZE;
+        uint8_t * destination = target.pixels.data() + (static_cast<size_t>(y + row) * page_size + x) * ATLAS_TEXEL_SIZE;
+
+        for (uint32_t column = 0; column < padded_width; ++column)
+        {
+            uint32_t const source_column = std::min(column > m_border ? column - m_border : 0u, image.width - 1);
+            std::copy(source + source_column * ATLAS_TEXEL_SIZE, source + (source_column + 1) * ATLAS_TEXEL_SIZE, destination + column * ATLAS_TEXEL_SIZE);
+        }
+    }
+}
+
+glm::vec2 Renderer::remap_uv(SAtlasRegion const & region, glm::vec2 const & uv)
+{
+    return region.uv_min + (region.uv_max - region.uv_min) * uv;
+}
+
+void Renderer::remap_uvs(SAtlasRegion const & region, glm::vec2 * uvs, size_t const count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        uvs[i] = remap_uv(region, uvs[i]);
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "renderer/texture/atlas_packer.hpp"
+#include "renderer/texture/texture_backend.hpp"
+#include "renderer/texture/texture_file.hpp"
+
+#include <glm/vec2.hpp>
+
+#include <cinttypes>
+#include <vector>
+
+namespace Renderer
+{
+    struct SAtlasSettings
+    {
+        uint32_t page_size = 2048;
+        uint32_t max_pages = 8;
+        // Texels of border around every image, filled by extending its edges so filtering
+        // near an edge never picks up a neighbour
+        uint32_t padding = 2;
+        // Images are placed on 2^(mip_count - 1) texel boundaries with at least that much border,
+        // so every mip level keeps them apart too
+        uint32_t mip_count = 1;
+    };
+
+    // Where an image ended up, uv_min/uv_max are the image's corners in page space
+    struct SAtlasRegion
+    {
+        uint32_t page = 0;
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        glm::vec2 uv_min = glm::vec2(0.0f);
+        glm::vec2 uv_max = glm::vec2(0.0f);
+    };
+
+    // Tightly packed RGBA8 pixels, rows top to bottom
+    struct SAtlasImage
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint8_t const * pixels = nullptr;
+    };
+
+    // Packs many small RGBA8 images into a few large pages so everything drawn with them can
+    // share a texture (one draw per page rather than per image). Images can be added one at a
+    // time as they show up at runtime, or all at once when cooking, which packs tighter; either
+    // way GetPage gives the mipped page to save with save_texture or Upload sends dirty pages
+    // to the GPU.
+    class CTextureAtlas
+    {
+    public:
+        explicit CTextureAtlas(SAtlasSettings const & settings = SAtlasSettings());
+
+        CTextureAtlas(CTextureAtlas const &) = delete;
+        CTextureAtlas & operator=(CTextureAtlas const &) = delete;
+
+        // Fails if the image is bigger than a page or every page is full
+        bool Add(SAtlasImage const & image, SAtlasRegion & out_region);
+
+        // Packed tallest first, regions come back in the order the images were given
+        bool AddAll(std::vector<SAtlasImage> const & images, std::vector<SAtlasRegion> & out_regions);
+
+        // Empties every page, regions handed out before are no longer valid
+        void Clear();
+
+        uint32_t GetPageCount() const { return static_cast<uint32_t>(m_pages.size()); }
+        float GetOccupancy(uint32_t const page) const { return m_pages[page].packer.GetOccupancy(); }
+
+        // The page with its mip chain built
+        STextureDesc GetPage(uint32_t const page) const;
+
+        // Recreates the GPU texture of every page changed since the last upload
+        void Upload(ITextureBackend & backend);
+        void ReleaseGpuTextures(ITextureBackend & backend);
+        uint32_t GetGpuTexture(uint32_t const page) const { return m_pages[page].gpu_texture; }
+
+    private:
+        struct SPage
+        {
+            explicit SPage(uint32_t const size);
+
+            CSkylinePacker packer;
+            std::vector<uint8_t> pixels;
+            uint32_t gpu_texture = INVALID_GPU_TEXTURE;
+            bool dirty = true;
+        };
+
+        bool Place(uint32_t const width, uint32_t const height, uint32_t & out_page, uint32_t & out_x, uint32_t & out_y);
+        void Blit(SAtlasImage const & image, uint32_t const page, uint32_t const x, uint32_t const y);
+
+        SAtlasSettings m_settings;
+        uint32_t m_border;
+        uint32_t m_alignment;
+        std::vector<SPage> m_pages;
+    };
+
+    // Moves a texture coordinate for the image on its own into the atlas
+    glm::vec2 remap_uv(SAtlasRegion const & region, glm::vec2 const & uv);
+    void remap_uvs(SAtlasRegion const & region, glm::vec2 * uvs, size_t const count);
+}
@@ -0,0 +1,6 @@
+#include "texture_backend.hpp"
+
+Renderer::ITextureBackend::~ITextureBackend()
+{
+    // This page is intentionally left blank
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "renderer/texture/texture_format.hpp"
+
+#include <cinttypes>
+#include <cstddef>
+
+namespace Renderer
+{
+    constexpr uint32_t INVALID_GPU_TEXTURE = 0;
+
+    // The part of a render context the texture streamer needs. A texture is created with the
+    // number of levels that are going to be resident and every level is uploaded once before
+    // it's sampled; changing which levels are resident means creating a new texture, so memory
+    // is really given back when levels are dropped.
+    class ITextureBackend
+    {
+    public:
+        virtual ~ITextureBackend();
+
+        // Returns INVALID_GPU_TEXTURE if the format isn't supported or the allocation failed
+        virtual uint32_t CreateTexture(ETextureFormat const format, uint32_t const width, uint32_t const height, uint32_t const mip_count) = 0;
+        virtual void UploadMip(uint32_t const texture, uint32_t const level, uint32_t const width, uint32_t const height, void const * data, size_t const size) = 0;
+        virtual void DestroyTexture(uint32_t const texture) = 0;
+    };
+}
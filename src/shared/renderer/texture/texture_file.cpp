@@ -0,0 +1,208 @@
+#include "texture_file.hpp"
+
+#include "utility/logging.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    using namespace Renderer;
+
+    size_t align_up(size_t const value)
+    {
+        return (value + TEXTURE_FILE_ALIGNMENT - 1) & ~(TEXTURE_FILE_ALIGNMENT - 1);
+    }
+
+    // Bytes per 4x4 block, zero for formats that aren't block compressed
+    size_t get_block_size(ETextureFormat const format)
+    {
+        switch (format)
+        {
+        case ETextureFormat::BC1:
+        case ETextureFormat::BC4:
+            return 8;
+        case ETextureFormat::BC3:
+        case ETextureFormat::BC5:
+        case ETextureFormat::BC7:
+            return 16;
+        case ETextureFormat::RGBA8:
+        case ETextureFormat::R8:
+        case ETextureFormat::Count:
+            return 0;
+        }
+        return 0;
+    }
+}
+
+size_t Renderer::get_texture_level_size(ETextureFormat const format, uint32_t const width, uint32_t const height)
+{
+    size_t const block_size = get_block_size(format);
+    if (block_size == 0)
+    {
+        return static_cast<size_t>(width) * height * (format == ETextureFormat::R8 ? 1 : 4);
+    }
+
+    size_t const blocks_wide = (static_cast<size_t>(width) + 3) / 4;
+    size_t const blocks_high = (static_cast<size_t>(height) + 3) / 4;
+    return blocks_wide * blocks_high * block_size;
+}
+
+bool Renderer::save_texture(STextureDesc const & texture, std::string const & filename)
+{
+    if (texture.format >= ETextureFormat::Count || texture.width == 0 || texture.height == 0 ||
+        texture.mips.empty() == true || texture.mips.size() > MAX_TEXTURE_MIPS)
+    {
+        ERROR_LOG("Texture description is invalid, not saving " + filename);
+        return false;
+    }
+
+    std::vector<STextureFileMip> mips(texture.mips.size());
+    size_t offset = align_up(sizeof(STextureFileHeader) + mips.size() * sizeof(STextureFileMip));
+    for (size_t i = 0; i < mips.size(); ++i)
+    {
+        STextureFileMip & mip = mips[i];
+        mip.width = std::max(texture.width >> i, 1u);
+        mip.height = std::max(texture.height >> i, 1u);
+        mip.offset = offset;
+        mip.size = texture.mips[i].size();
+
+        if (mip.size != get_texture_level_size(texture.format, mip.width, mip.height))
+        {
+            ERROR_LOG("Mip " + std::to_string(i) + " is the wrong size, not saving " + filename);
+            return false;
+        }
+        offset = align_up(offset + mip.size);
+    }
+
+    STextureFileHeader header;
+    header.magic = TEXTURE_FILE_MAGIC;
+    header.version = TEXTURE_FILE_VERSION;
+    header.file_size = offset;
+    header.format = static_cast<uint32_t>(texture.format);
+    header.width = texture.width;
+    header.height = texture.height;
+    header.mip_count = static_cast<uint32_t>(mips.size());
+
+    std::vector<uint8_t> file(offset, 0);
+    std::memcpy(file.data(), &header, sizeof(header));
+    std::memcpy(file.data() + sizeof(header), mips.data(), mips.size() * sizeof(STextureFileMip));
+    for (size_t i = 0; i < mips.size(); ++i)
+    {
+        std::copy(texture.mips[i].begin(), texture.mips[i].end(), file.begin() + static_cast<std::ptrdiff_t>(mips[i].offset));
+    }
+
+    std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+    if (stream.is_open() == false)
+    {
+        ERROR_LOG("Failed to open file for writing: " + filename);
+        return false;
+    }
+    stream.write(reinterpret_cast<char const *>(file.data()), static_cast<std::streamsize>(file.size()));
+    return stream.good();
+}
+
+Renderer::CTextureFile::CTextureFile()
+: m_file()
+, m_mips(nullptr)
+, m_format(ETextureFormat::RGBA8)
+, m_mip_count(0)
+{
+}
+
+bool Renderer::CTextureFile::Open(std::string const & filename)
+{
+    Close();
+
+    if (m_file.Open(filename) == false)
+    {
+        return false;
+    }
+
+    if (Validate(filename) == false)
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void Renderer::CTextureFile::Close()
+{
+    m_file.Close();
+
+    m_mips = nullptr;
+    m_format = ETextureFormat::RGBA8;
+    m_mip_count = 0;
+}
+
+size_t Renderer::CTextureFile::GetChainSize(uint32_t const first_level) const
+{
+    size_t size = 0;
+    for (uint32_t level = first_level; level < m_mip_count; ++level)
+    {
+        size += static_cast<size_t>(m_mips[level].size);
+    }
+    return size;
+}
+
+bool Renderer::CTextureFile::Validate(std::string const & filename)
+{
+    uint8_t const * data = m_file.GetData();
+    size_t const size = m_file.GetSize();
+
+    if (size < sizeof(STextureFileHeader))
+    {
+        ERROR_LOG("File too small: " + filename);
+        return false;
+    }
+
+    STextureFileHeader const & header = *reinterpret_cast<STextureFileHeader const *>(data);
+    if (header.magic != TEXTURE_FILE_MAGIC)
+    {
+        ERROR_LOG("Not a texture file: " + filename);
+        return false;
+    }
+    if (header.version != TEXTURE_FILE_VERSION)
+    {
+        ERROR_LOG("Unsupported file version " + std::to_string(header.version) + ": " + filename);
+        return false;
+    }
+    if (header.file_size != size || header.mip_count == 0 || header.mip_count > MAX_TEXTURE_MIPS ||
+        sizeof(STextureFileHeader) + header.mip_count * sizeof(STextureFileMip) > size)
+    {
+        ERROR_LOG("File is truncated: " + filename);
+        return false;
+    }
+    if (header.format >= static_cast<uint32_t>(ETextureFormat::Count))
+    {
+        ERROR_LOG("Unknown texture format " + std::to_string(header.format) + ": " + filename);
+        return false;
+    }
+
+    ETextureFormat const format = static_cast<ETextureFormat>(header.format);
+    STextureFileMip const * mips = reinterpret_cast<STextureFileMip const *>(data + sizeof(STextureFileHeader));
+
+    // Only the table is checked, none of the level data is touched so none of it gets paged in
+    for (uint32_t level = 0; level < header.mip_count; ++level)
+    {
+        STextureFileMip const & mip = mips[level];
+        bool const valid = mip.width == std::max(header.width >> level, 1u) &&
+                           mip.height == std::max(header.height >> level, 1u) &&
+                           mip.size == get_texture_level_size(format, mip.width, mip.height) &&
+                           mip.offset % TEXTURE_FILE_ALIGNMENT == 0 &&
+                           mip.offset <= size &&
+                           mip.size <= size - mip.offset;
+        if (valid == false)
+        {
+            ERROR_LOG("Texture mip " + std::to_string(level) + " is malformed: " + filename);
+            return false;
+        }
+    }
+
+    m_mips = mips;
+    m_format = format;
+    m_mip_count = header.mip_count;
+    return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "renderer/texture/texture_format.hpp"
+#include "utility/file/mapped_file.hpp"
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+namespace Renderer
+{
+    // Bytes in one level of the given size, block compressed formats round up to whole blocks
+    size_t get_texture_level_size(ETextureFormat const format, uint32_t const width, uint32_t const height);
+
+    // What gets saved, usually by an import tool that has already compressed every level
+    struct STextureDesc
+    {
+        ETextureFormat format = ETextureFormat::RGBA8;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        // Largest first, each level half the size of the last down to 1x1 (or fewer levels)
+        std::vector<std::vector<uint8_t>> mips;
+    };
+
+    bool save_texture(STextureDesc const & texture, std::string const & filename);
+
+    // A texture file mapped and left on disk. Opening reads the header and mip table and checks
+    // them, level data is only paged in once something asks for it, so opening costs the same
+    // however big the texture is.
+    class CTextureFile
+    {
+    public:
+        CTextureFile();
+
+        CTextureFile(CTextureFile const &) = delete;
+        CTextureFile & operator=(CTextureFile const &) = delete;
+
+        bool Open(std::string const & filename);
+        void Close();
+        bool IsOpen() const { return m_file.IsOpen(); }
+
+        ETextureFormat GetFormat() const { return m_format; }
+        uint32_t GetWidth() const { return m_mip_count > 0 ? m_mips[0].width : 0; }
+        uint32_t GetHeight() const { return m_mip_count > 0 ? m_mips[0].height : 0; }
+        uint32_t GetMipCount() const { return m_mip_count; }
+
+        STextureFileMip const & GetMip(uint32_t const level) const { return m_mips[level]; }
+        uint8_t const * GetMipData(uint32_t const level) const { return m_file.GetData() + m_mips[level].offset; }
+
+        // Total size of every level from first_level down to the smallest
+        size_t GetChainSize(uint32_t const first_level) const;
+
+    private:
+        bool Validate(std::string const & filename);
+
+        FileHelpers::CMappedFile m_file;
+
+        STextureFileMip const * m_mips;
+        ETextureFormat m_format;
+        uint32_t m_mip_count;
+    };
+}
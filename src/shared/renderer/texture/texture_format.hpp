@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <type_traits>
+
+// On disk layout of texture files: a header, a table with one entry per mip level (largest
+// first), then each level's block compressed data starting on a TEXTURE_FILE_ALIGNMENT boundary.
+// Levels are stored exactly as the GPU wants them so streaming one in is a straight copy out
+// of the mapped file. Little endian only.
+namespace Renderer
+{
+    constexpr uint32_t TEXTURE_FILE_MAGIC = 0x58455447; // GTEX
+
+    // Bump whenever any of the structs below change, older files are rejected rather than guessed at
+    constexpr uint32_t TEXTURE_FILE_VERSION = 1;
+
+    constexpr size_t TEXTURE_FILE_ALIGNMENT = 16;
+
+    // Enough for a 64k texture
+    constexpr uint32_t MAX_TEXTURE_MIPS = 17;
+
+    enum class ETextureFormat : uint32_t
+    {
+        // Uncompressed, 4 bytes per texel
+        RGBA8,
+        // 4x4 blocks, 8 bytes each
+        BC1,
+        BC4,
+        // 4x4 blocks, 16 bytes each
+        BC3,
+        BC5,
+        BC7,
+        // Uncompressed, 1 byte per texel, for distance fields and masks
+        R8,
+
+        Count
+    };
+
+    struct STextureFileHeader
+    {
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint64_t file_size = 0;
+        uint32_t format = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t mip_count = 0;
+    };
+
+    // The mip table follows straight after the header
+    struct STextureFileMip
+    {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    static_assert(sizeof(STextureFileHeader) == 32, "Texture file header layout changed");
+    static_assert(sizeof(STextureFileMip) == 24, "Texture file mip layout changed");
+    static_assert(std::is_standard_layout<STextureFileMip>::value, "Texture file structs must be plain data");
+}
@@ -0,0 +1,457 @@
+#include "texture_streamer.hpp"
+
+#include "utility/logging.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace
+{
+    // Loads in flight at once, promotions past this wait for a later update
+    constexpr size_t MAX_PENDING_LOADS = 8;
+
+    // Upload budget per update so a burst of finished loads is spread over a few frames rather
+    // than all landing on one. At least one load is always applied.
+    constexpr size_t MAX_UPLOAD_BYTES_PER_UPDATE = 16 * 1024 * 1024;
+
+    // A sharper level is kept until the texture is this much smaller than it needs, so a size
+    // wobbling around a power of two doesn't reload the level every other frame
+    constexpr float DEMOTE_HYSTERESIS = 1.25f;
+
+    uint32_t get_level_extent(Renderer::CTextureFile const & file, uint32_t const level)
+    {
+        Renderer::STextureFileMip const & mip = file.GetMip(level);
+        return std::max(mip.width, mip.height);
+    }
+
+    // Sharpest level that isn't minified when drawn screen_pixels across
+    uint32_t get_mip_for_size(uint32_t const extent, float const screen_pixels, float const bias)
+    {
+        float const ratio = static_cast<float>(extent) / (screen_pixels * bias);
+        if (ratio <= 1.0f)
+        {
+            return 0;
+        }
+        return static_cast<uint32_t>(std::floor(std::log2(ratio)));
+    }
+}
+
+Renderer::CTextureStreamer::CTextureStreamer(ITextureBackend & backend, size_t const budget_bytes)
+: m_backend(backend)
+, m_budget_bytes(budget_bytes)
+// Frame zero means never requested
+, m_frame(1)
+, m_textures()
+, m_free_slots()
+, m_resident_bytes(0)
+, m_promotions()
+, m_ready()
+, m_thread()
+, m_mutex()
+, m_wake()
+, m_requests()
+, m_completed()
+, m_running(true)
+, m_stats()
+{
+    m_thread = std::thread(&CTextureStreamer::ThreadMain, this);
+}
+
+Renderer::CTextureStreamer::~CTextureStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+
+    for (STexture const & texture : m_textures)
+    {
+        if (texture.gpu_texture != INVALID_GPU_TEXTURE)
+        {
+            m_backend.DestroyTexture(texture.gpu_texture);
+        }
+    }
+}
+
+Renderer::STextureHandle Renderer::CTextureStreamer::Load(std::string const & filename)
+{
+    // The streamer's own storage is tagged Renderer whatever the scope says
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Assets);
+
+    std::shared_ptr<CTextureFile> file = std::make_shared<CTextureFile>();
+    if (file->Open(filename) == false)
+    {
+        return INVALID_TEXTURE;
+    }
+
+    uint32_t const slot = AllocateSlot();
+    STexture & texture = m_textures[slot];
+    texture.alive = true;
+    texture.file = std::move(file);
+    texture.gpu_texture = INVALID_GPU_TEXTURE;
+    texture.resident_mip = texture.file->GetMipCount();
+    texture.pending_mip = NO_MIP;
+    texture.resident_bytes = 0;
+    texture.requested_pixels = 0.0f;
+    texture.screen_pixels = 0.0f;
+    texture.last_request_frame = 0;
+
+    texture.tail_mip = texture.file->GetMipCount() - 1;
+    while (texture.tail_mip > 0 && get_level_extent(*texture.file, texture.tail_mip - 1) <= TEXTURE_TAIL_SIZE)
+    {
+        --texture.tail_mip;
+    }
+    texture.target_mip = texture.tail_mip;
+
+    QueueLoad(slot, texture.tail_mip);
+
+    STextureHandle handle;
+    handle.index = slot;
+    handle.generation = texture.generation;
+    return handle;
+}
+
+void Renderer::CTextureStreamer::Unload(STextureHandle const texture)
+{
+    STexture * const found = Find(texture);
+    if (found == nullptr)
+    {
+        return;
+    }
+
+    if (found->gpu_texture != INVALID_GPU_TEXTURE)
+    {
+        m_backend.DestroyTexture(found->gpu_texture);
+        m_resident_bytes -= found->resident_bytes;
+    }
+
+    // The streaming thread may still hold the file, anything it sends back is ignored
+    found->file.reset();
+    found->gpu_texture = INVALID_GPU_TEXTURE;
+    found->resident_bytes = 0;
+    found->alive = false;
+    ++found->generation;
+    m_free_slots.push_back(texture.index);
+}
+
+bool Renderer::CTextureStreamer::IsAlive(STextureHandle const texture) const
+{
+    return Find(texture) != nullptr;
+}
+
+void Renderer::CTextureStreamer::RequestSize(STextureHandle const texture, float const screen_pixels)
+{
+    STexture * const found = Find(texture);
+    if (found != nullptr)
+    {
+        found->requested_pixels = std::max(found->requested_pixels, screen_pixels);
+        found->last_request_frame = m_frame;
+    }
+}
+
+uint32_t Renderer::CTextureStreamer::GetGpuTexture(STextureHandle const texture) const
+{
+    STexture const * const found = Find(texture);
+    return found != nullptr ? found->gpu_texture : INVALID_GPU_TEXTURE;
+}
+
+uint32_t Renderer::CTextureStreamer::GetResidentMip(STextureHandle const texture) const
+{
+    STexture const * const found = Find(texture);
+    return found != nullptr ? found->resident_mip : 0;
+}
+
+void Renderer::CTextureStreamer::Update()
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    m_stats.promotions = 0;
+    m_stats.demotions = 0;
+    m_stats.uploaded_bytes = 0;
+
+    ApplyLoads();
+    ChooseLevels();
+    QueueLoads();
+
+    m_stats.textures = static_cast<uint32_t>(m_textures.size() - m_free_slots.size());
+    m_stats.pending_loads = 0;
+    for (STexture & texture : m_textures)
+    {
+        m_stats.pending_loads += texture.alive == true && texture.pending_mip != NO_MIP ? 1 : 0;
+        texture.requested_pixels = 0.0f;
+    }
+    m_stats.resident_bytes = m_resident_bytes;
+    m_stats.budget_bytes = m_budget_bytes;
+
+    ++m_frame;
+}
+
+Renderer::CTextureStreamer::STexture * Renderer::CTextureStreamer::Find(STextureHandle const texture)
+{
+    if (texture.index < m_textures.size() &&
+        m_textures[texture.index].alive == true &&
+        m_textures[texture.index].generation == texture.generation)
+    {
+        return &m_textures[texture.index];
+    }
+    return nullptr;
+}
+
+Renderer::CTextureStreamer::STexture const * Renderer::CTextureStreamer::Find(STextureHandle const texture) const
+{
+    return const_cast<CTextureStreamer *>(this)->Find(texture);
+}
+
+uint32_t Renderer::CTextureStreamer::AllocateSlot()
+{
+    if (m_free_slots.empty() == false)
+    {
+        uint32_t const slot = m_free_slots.back();
+        m_free_slots.pop_back();
+        return slot;
+    }
+
+    m_textures.emplace_back();
+    return static_cast<uint32_t>(m_textures.size() - 1);
+}
+
+void Renderer::CTextureStreamer::ApplyLoads()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (SLoad & load : m_completed)
+        {
+            m_ready.push_back(std::move(load));
+        }
+        m_completed.clear();
+    }
+
+    while (m_ready.empty() == false)
+    {
+        SLoad & load = m_ready.front();
+        if (m_stats.uploaded_bytes > 0 && m_stats.uploaded_bytes + load.data.size() > MAX_UPLOAD_BYTES_PER_UPDATE)
+        {
+            break;
+        }
+
+        STexture & texture = m_textures[load.slot];
+        if (texture.alive == true && texture.generation == load.generation && texture.pending_mip == load.first_mip)
+        {
+            CTextureFile const & file = *texture.file;
+            uint32_t const mip_count = file.GetMipCount() - load.first_mip;
+            STextureFileMip const & top = file.GetMip(load.first_mip);
+
+            uint32_t const gpu_texture = m_backend.CreateTexture(file.GetFormat(), top.width, top.height, mip_count);
+            if (gpu_texture != INVALID_GPU_TEXTURE)
+            {
+                // Smallest first, it's the order the data was read in
+                size_t offset = 0;
+                for (uint32_t level = file.GetMipCount(); level-- > load.first_mip; )
+                {
+                    STextureFileMip const & mip = file.GetMip(level);
+                    m_backend.UploadMip(gpu_texture, level - load.first_mip, mip.width, mip.height, load.data.data() + offset, static_cast<size_t>(mip.size));
+                    offset += static_cast<size_t>(mip.size);
+                }
+
+                if (texture.gpu_texture != INVALID_GPU_TEXTURE)
+                {
+                    m_backend.DestroyTexture(texture.gpu_texture);
+                }
+
+                m_stats.promotions += load.first_mip < texture.resident_mip ? 1 : 0;
+                m_stats.demotions += load.first_mip > texture.resident_mip ? 1 : 0;
+                m_stats.uploaded_bytes += load.data.size();
+
+                m_resident_bytes = m_resident_bytes - texture.resident_bytes + load.data.size();
+                texture.gpu_texture = gpu_texture;
+                texture.resident_mip = load.first_mip;
+                texture.resident_bytes = load.data.size();
+            }
+            else
+            {
+                ERROR_LOG("Failed to create a texture for streamed mip " + std::to_string(load.first_mip));
+            }
+            texture.pending_mip = NO_MIP;
+        }
+
+        m_ready.pop_front();
+    }
+}
+
+void Renderer::CTextureStreamer::ChooseLevels()
+{
+    // Each texture's level for its size, then if that doesn't fit the budget levels are dropped
+    // one at a time from whichever texture is then magnified least
+    using SDrop = std::pair<float, uint32_t>;
+    std::priority_queue<SDrop, std::vector<SDrop>, std::greater<SDrop>> drops;
+
+    auto magnification = [](STexture const & texture, uint32_t const level)
+    {
+        return texture.screen_pixels / static_cast<float>(get_level_extent(*texture.file, level));
+    };
+
+    size_t wanted_bytes = 0;
+    for (uint32_t slot = 0; slot < m_textures.size(); ++slot)
+    {
+        STexture & texture = m_textures[slot];
+        if (texture.alive == false)
+        {
+            continue;
+        }
+
+        // Between requests the last size is kept until it goes stale
+        if (texture.last_request_frame == m_frame)
+        {
+            texture.screen_pixels = texture.requested_pixels;
+        }
+        else if (texture.last_request_frame == 0 || texture.last_request_frame + TEXTURE_STALE_FRAMES < m_frame)
+        {
+            texture.screen_pixels = 0.0f;
+        }
+
+        uint32_t target = texture.tail_mip;
+        if (texture.screen_pixels > 0.0f)
+        {
+            uint32_t const extent = get_level_extent(*texture.file, 0);
+            target = get_mip_for_size(extent, texture.screen_pixels, 1.0f);
+            if (target > texture.resident_mip)
+            {
+                target = std::max(texture.resident_mip, get_mip_for_size(extent, texture.screen_pixels, DEMOTE_HYSTERESIS));
+            }
+            target = std::min(target, texture.tail_mip);
+        }
+        texture.target_mip = target;
+        wanted_bytes += texture.file->GetChainSize(target);
+
+        if (target < texture.tail_mip)
+        {
+            drops.emplace(magnification(texture, target + 1), slot);
+        }
+    }
+    m_stats.wanted_bytes = wanted_bytes;
+
+    size_t total_bytes = wanted_bytes;
+    while (total_bytes > m_budget_bytes && drops.empty() == false)
+    {
+        uint32_t const slot = drops.top().second;
+        drops.pop();
+
+        STexture & texture = m_textures[slot];
+        total_bytes -= static_cast<size_t>(texture.file->GetMip(texture.target_mip).size);
+        ++texture.target_mip;
+
+        if (texture.target_mip < texture.tail_mip)
+        {
+            drops.emplace(magnification(texture, texture.target_mip + 1), slot);
+        }
+    }
+}
+
+void Renderer::CTextureStreamer::QueueLoads()
+{
+    size_t pending = 0;
+    m_promotions.clear();
+
+    // Demotions go first and always, they're what make room for the promotions
+    for (uint32_t slot = 0; slot < m_textures.size(); ++slot)
+    {
+        STexture const & texture = m_textures[slot];
+        if (texture.alive == false)
+        {
+            continue;
+        }
+
+        if (texture.pending_mip != NO_MIP)
+        {
+            ++pending;
+        }
+        else if (texture.target_mip > texture.resident_mip)
+        {
+            QueueLoad(slot, texture.target_mip);
+            ++pending;
+        }
+        else if (texture.target_mip < texture.resident_mip)
+        {
+            m_promotions.push_back(slot);
+        }
+    }
+
+    // Then the most magnified textures get their sharper levels first
+    std::sort(m_promotions.begin(), m_promotions.end(), [this](uint32_t const lhs, uint32_t const rhs)
+    {
+        STexture const & left = m_textures[lhs];
+        STexture const & right = m_textures[rhs];
+        uint32_t const left_extent = left.resident_mip < left.file->GetMipCount() ? get_level_extent(*left.file, left.resident_mip) : 1;
+        uint32_t const right_extent = right.resident_mip < right.file->GetMipCount() ? get_level_extent(*right.file, right.resident_mip) : 1;
+        return left.screen_pixels / static_cast<float>(left_extent) > right.screen_pixels / static_cast<float>(right_extent);
+    });
+
+    for (uint32_t const slot : m_promotions)
+    {
+        if (pending >= MAX_PENDING_LOADS)
+        {
+            break;
+        }
+        QueueLoad(slot, m_textures[slot].target_mip);
+        ++pending;
+    }
+}
+
+void Renderer::CTextureStreamer::QueueLoad(uint32_t const slot, uint32_t const first_mip)
+{
+    STexture & texture = m_textures[slot];
+    texture.pending_mip = first_mip;
+
+    SLoad load;
+    load.slot = slot;
+    load.generation = texture.generation;
+    load.first_mip = first_mip;
+    load.file = texture.file;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_requests.push_back(std::move(load));
+    }
+    m_wake.notify_one();
+}
+
+void Renderer::CTextureStreamer::ThreadMain()
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Assets);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_running == true)
+    {
+        if (m_requests.empty() == true)
+        {
+            m_wake.wait(lock);
+            continue;
+        }
+
+        SLoad load = std::move(m_requests.front());
+        m_requests.pop_front();
+
+        // Reading the mapping is what pulls the levels in from disk, so it's done unlocked
+        lock.unlock();
+
+        CTextureFile const & file = *load.file;
+        load.data.resize(file.GetChainSize(load.first_mip));
+
+        size_t offset = 0;
+        for (uint32_t level = file.GetMipCount(); level-- > load.first_mip; )
+        {
+            size_t const size = static_cast<size_t>(file.GetMip(level).size);
+            std::copy(file.GetMipData(level), file.GetMipData(level) + size, load.data.begin() + static_cast<std::ptrdiff_t>(offset));
+            offset += size;
+        }
+
+        lock.lock();
+        m_completed.push_back(std::move(load));
+    }
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "renderer/texture/texture_backend.hpp"
+#include "renderer/texture/texture_file.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+#include <cinttypes>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Renderer
+{
+    struct STextureHandle
+    {
+        uint32_t index = UINT32_MAX;
+        uint32_t generation = 0;
+
+        bool operator==(STextureHandle const & rhs) const { return index == rhs.index && generation == rhs.generation; }
+        bool operator!=(STextureHandle const & rhs) const { return !(*this == rhs); }
+    };
+
+    constexpr STextureHandle INVALID_TEXTURE = STextureHandle();
+
+    // Levels this big or smaller are never dropped, it's what gets drawn while sharper ones load
+    constexpr uint32_t TEXTURE_TAIL_SIZE = 64;
+
+    // How long a texture keeps its sharper levels after it was last drawn
+    constexpr uint64_t TEXTURE_STALE_FRAMES = 60;
+
+    struct STextureStreamingStats
+    {
+        uint32_t textures = 0;
+        uint32_t pending_loads = 0;
+        // Applied during the last update
+        uint32_t promotions = 0;
+        uint32_t demotions = 0;
+        size_t uploaded_bytes = 0;
+        // What every texture would have at the size it's drawn, before the budget cuts it down
+        size_t wanted_bytes = 0;
+        size_t resident_bytes = 0;
+        size_t budget_bytes = 0;
+    };
+
+    // Keeps only the mip levels each texture needs for the size it's drawn on screen resident on
+    // the GPU, within a memory budget. Loading a texture just maps its file; the small tail
+    // levels then come in on the streaming thread and sharper levels follow as the texture is
+    // drawn bigger. When everything wanted doesn't fit, levels are dropped first from the
+    // textures that would be magnified least without them, so quality falls off evenly.
+    //
+    // The streaming thread only copies level data out of the mapped files (which is where the
+    // disk reads happen); creating textures and uploading is done in Update, so everything but
+    // that thread has to be on the thread that owns the render context.
+    class CTextureStreamer
+    {
+    public:
+        CTextureStreamer(ITextureBackend & backend, size_t const budget_bytes);
+        ~CTextureStreamer();
+
+        CTextureStreamer(CTextureStreamer const &) = delete;
+        CTextureStreamer & operator=(CTextureStreamer const &) = delete;
+
+        STextureHandle Load(std::string const & filename);
+        void Unload(STextureHandle const texture);
+        bool IsAlive(STextureHandle const texture) const;
+
+        // Called for every draw of the texture with its longest edge in screen pixels, the
+        // biggest size asked for in a frame wins. Textures that stop being asked for fall back
+        // to their tail after TEXTURE_STALE_FRAMES.
+        void RequestSize(STextureHandle const texture, float const screen_pixels);
+
+        // INVALID_GPU_TEXTURE until the tail has loaded, the returned texture can change on any update
+        uint32_t GetGpuTexture(STextureHandle const texture) const;
+        // Level 0 of the GPU texture is this level of the file
+        uint32_t GetResidentMip(STextureHandle const texture) const;
+
+        void SetBudget(size_t const budget_bytes) { m_budget_bytes = budget_bytes; }
+
+        // Once per frame, after the frame's RequestSize calls
+        void Update();
+
+        STextureStreamingStats GetStats() const { return m_stats; }
+
+    private:
+        static constexpr uint32_t NO_MIP = UINT32_MAX;
+
+        struct STexture
+        {
+            std::shared_ptr<CTextureFile const> file;
+            uint32_t generation = 0;
+            bool alive = false;
+
+            uint32_t gpu_texture = INVALID_GPU_TEXTURE;
+            // mip_count while nothing is resident
+            uint32_t resident_mip = 0;
+            uint32_t tail_mip = 0;
+            uint32_t target_mip = 0;
+            uint32_t pending_mip = NO_MIP;
+            size_t resident_bytes = 0;
+
+            float requested_pixels = 0.0f;
+            float screen_pixels = 0.0f;
+            uint64_t last_request_frame = 0;
+        };
+
+        // Everything from first_mip down, read by the streaming thread
+        struct SLoad
+        {
+            uint32_t slot = 0;
+            uint32_t generation = 0;
+            uint32_t first_mip = 0;
+            std::shared_ptr<CTextureFile const> file;
+            Memory::tagged_vector<uint8_t, Memory::EMemoryTag::Assets> data;
+        };
+
+        STexture * Find(STextureHandle const texture);
+        STexture const * Find(STextureHandle const texture) const;
+        uint32_t AllocateSlot();
+
+        void ApplyLoads();
+        void ChooseLevels();
+        void QueueLoads();
+        void QueueLoad(uint32_t const slot, uint32_t const first_mip);
+
+        void ThreadMain();
+
+        ITextureBackend & m_backend;
+        size_t m_budget_bytes;
+        uint64_t m_frame;
+
+        Memory::tagged_vector<STexture, Memory::EMemoryTag::Renderer> m_textures;
+        Memory::tagged_vector<uint32_t, Memory::EMemoryTag::Renderer> m_free_slots;
+        size_t m_resident_bytes;
+
+        // Reused each update
+        Memory::tagged_vector<uint32_t, Memory::EMemoryTag::Renderer> m_promotions;
+        std::deque<SLoad> m_ready;
+
+        std::thread m_thread;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::deque<SLoad> m_requests;
+        Memory::tagged_vector<SLoad, Memory::EMemoryTag::Renderer> m_completed;
+        bool m_running;
+
+        STextureStreamingStats m_stats;
+    };
+}
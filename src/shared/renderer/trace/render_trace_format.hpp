@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cinttypes>
+
+namespace Renderer
+{
+    // A render trace is everything handed to an IRenderContext, in order, as a header followed by
+    // records. Every record is an ERenderTraceOp byte then its fields packed back to back in the
+    // writing machine's byte order, which is little endian on everything the engine runs on.
+    //
+    //   Resize       width u32, height u32
+    //   PreRender    nothing
+    //   RenderFrame  nothing, ends a frame. EndScene isn't recorded, it always comes before.
+    //   Mesh         id u32, vertex count u32, index count u32, then the positions as 3 f32
+    //                each, the colours as 4 f32 each and the indices as u32 each
+    //   Renderable   mesh id u32, transform as 16 f32 in column order, tint 4 f32
+    //   Particles    count u32, start size f32, end size f32, start colour 4 f32, end colour
+    //                4 f32, then count f32 of each of position x, y, z and life
+    //   Capture      nothing, a RequestCapture before the frame it applies to
+    //   Camera       view projection as 16 f32 in column order
+    //
+    // A mesh is written once, the first time geometry with its contents is submitted, and every
+    // renderable after that refers to it by id.
+    constexpr uint32_t RENDER_TRACE_MAGIC = 0x52545247; // "GRTR"
+    // 2 added the renderable's tint, 3 the camera
+    constexpr uint32_t RENDER_TRACE_VERSION = 3;
+
+    struct SRenderTraceHeader
+    {
+        uint32_t magic = RENDER_TRACE_MAGIC;
+        uint32_t version = RENDER_TRACE_VERSION;
+        // The size the context was created at, before any Resize record
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    enum class ERenderTraceOp : uint8_t
+    {
+        Resize,
+        PreRender,
+        RenderFrame,
+        Mesh,
+        Renderable,
+        Particles,
+        Capture,
+        Camera
+    };
+}
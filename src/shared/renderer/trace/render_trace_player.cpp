@@ -0,0 +1,291 @@
+#include "render_trace_player.hpp"
+
+#include "utility/logging.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+Renderer::CTraceRenderable::CTraceRenderable(CMesh const & mesh, glm::mat4 const & transform, glm::vec4 const & tint)
+: m_mesh(&mesh)
+, m_transform_mat(transform)
+, m_tint(tint)
+{
+}
+
+Renderer::CMesh const & Renderer::CTraceRenderable::GetMesh() const
+{
+    return *m_mesh;
+}
+
+glm::mat4 const & Renderer::CTraceRenderable::GetTransformMatrix() const
+{
+    return m_transform_mat;
+}
+
+glm::vec4 const & Renderer::CTraceRenderable::GetTint() const
+{
+    return m_tint;
+}
+
+Renderer::CRenderTracePlayer::CRenderTracePlayer()
+: m_file()
+, m_header()
+, m_offset(0)
+, m_frame_count(0)
+, m_frames_played(0)
+, m_replay_captures(false)
+, m_meshes()
+, m_renderables()
+, m_emitters()
+, m_particle_scratch()
+{
+}
+
+bool Renderer::CRenderTracePlayer::Open(std::string const & filename)
+{
+    m_meshes.clear();
+    m_renderables.clear();
+    m_frame_count = 0;
+    m_offset = 0;
+
+    if (m_file.Open(filename) == false)
+    {
+        ERROR_LOG("Failed to open render trace " + filename);
+        return false;
+    }
+
+    if (Read(m_header) == false ||
+        m_header.magic != RENDER_TRACE_MAGIC ||
+        m_header.version != RENDER_TRACE_VERSION)
+    {
+        ERROR_LOG(filename + " isn't a render trace this version can play");
+        m_file.Close();
+        return false;
+    }
+
+    // Meshes are loaded on the way through, playing only needs to skip over them
+    ERenderTraceOp op = ERenderTraceOp::PreRender;
+    uint32_t emitter_count = 0;
+    while (m_offset < m_file.GetSize())
+    {
+        if (PlayRecord(nullptr, op, emitter_count) == false)
+        {
+            ERROR_LOG("Bad record in render trace " + filename + " at byte " + std::to_string(m_offset));
+            m_file.Close();
+            return false;
+        }
+        if (op == ERenderTraceOp::RenderFrame)
+        {
+            ++m_frame_count;
+        }
+    }
+
+    Rewind();
+    return true;
+}
+
+bool Renderer::CRenderTracePlayer::SubmitFrame(IRenderContext & context)
+{
+    // The context is done with last frame's renderables once it has rendered them
+    m_renderables.clear();
+
+    if (m_frames_played == m_frame_count)
+    {
+        return false;
+    }
+
+    ERenderTraceOp op = ERenderTraceOp::PreRender;
+    uint32_t emitter_count = 0;
+    while (op != ERenderTraceOp::RenderFrame && PlayRecord(&context, op, emitter_count) == true)
+    {
+    }
+    ++m_frames_played;
+    return true;
+}
+
+void Renderer::CRenderTracePlayer::Rewind()
+{
+    m_offset = sizeof(SRenderTraceHeader);
+    m_frames_played = 0;
+}
+
+bool Renderer::CRenderTracePlayer::Read(void * out, size_t const size)
+{
+    if (size > m_file.GetSize() - m_offset)
+    {
+        return false;
+    }
+    std::memcpy(out, m_file.GetData() + m_offset, size);
+    m_offset += size;
+    return true;
+}
+
+bool Renderer::CRenderTracePlayer::Skip(size_t const size)
+{
+    if (size > m_file.GetSize() - m_offset)
+    {
+        return false;
+    }
+    m_offset += size;
+    return true;
+}
+
+bool Renderer::CRenderTracePlayer::PlayRecord(IRenderContext * context, ERenderTraceOp & out_op, uint32_t & emitter_count)
+{
+    if (Read(out_op) == false)
+    {
+        return false;
+    }
+
+    switch (out_op)
+    {
+    case ERenderTraceOp::Resize:
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        if (Read(width) == false || Read(height) == false)
+        {
+            return false;
+        }
+        if (context != nullptr)
+        {
+            context->ResizeScreen(width, height);
+        }
+        return true;
+    }
+    case ERenderTraceOp::PreRender:
+    case ERenderTraceOp::RenderFrame:
+        return true;
+    case ERenderTraceOp::Mesh:
+        return ReadMesh();
+    case ERenderTraceOp::Renderable:
+    {
+        uint32_t mesh_id = 0;
+        glm::mat4 transform(1.0f);
+        glm::vec4 tint(1.0f);
+        if (Read(mesh_id) == false || Read(transform) == false || Read(tint) == false || mesh_id >= m_meshes.size())
+        {
+            return false;
+        }
+        if (context != nullptr)
+        {
+            m_renderables.emplace_back(*m_meshes[mesh_id], transform, tint);
+            context->SubmitRenderable(&m_renderables.back());
+        }
+        return true;
+    }
+    case ERenderTraceOp::Particles:
+        return ReadParticles(context, emitter_count++);
+    case ERenderTraceOp::Camera:
+    {
+        glm::mat4 view_projection(1.0f);
+        if (Read(view_projection) == false)
+        {
+            return false;
+        }
+        if (context != nullptr)
+        {
+            context->SetViewProjection(view_projection);
+        }
+        return true;
+    }
+    case ERenderTraceOp::Capture:
+        if (context != nullptr && m_replay_captures == true)
+        {
+            context->RequestCapture();
+        }
+        return true;
+    }
+    return false;
+}
+
+bool Renderer::CRenderTracePlayer::ReadMesh()
+{
+    uint32_t mesh_id = 0;
+    uint32_t vertex_count = 0;
+    uint32_t index_count = 0;
+    if (Read(mesh_id) == false || Read(vertex_count) == false || Read(index_count) == false)
+    {
+        return false;
+    }
+
+    size_t const vertex_size = vertex_count * (sizeof(glm::vec3) + sizeof(glm::vec4));
+    size_t const index_size = index_count * sizeof(uint32_t);
+
+    // Loaded when the trace was opened, playing it again only has to step over it
+    if (mesh_id < m_meshes.size())
+    {
+        return Skip(vertex_size + index_size);
+    }
+    if (mesh_id != m_meshes.size() || vertex_size + index_size > m_file.GetSize() - m_offset)
+    {
+        return false;
+    }
+
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    // Copied out before the mesh is made, nothing in the file is aligned
+    std::vector<glm::vec3> verts(vertex_count);
+    std::vector<glm::vec4> colours(vertex_count);
+    std::vector<uint32_t> indices(index_count);
+    Read(verts.data(), vertex_count * sizeof(glm::vec3));
+    Read(colours.data(), vertex_count * sizeof(glm::vec4));
+    Read(indices.data(), index_size);
+
+    m_meshes.push_back(CMesh::Create(verts, colours, indices));
+    return true;
+}
+
+bool Renderer::CRenderTracePlayer::ReadParticles(IRenderContext * context, uint32_t const emitter_index)
+{
+    uint32_t count = 0;
+    SParticleEmitterSettings settings;
+    if (Read(count) == false ||
+        Read(settings.start_size) == false ||
+        Read(settings.end_size) == false ||
+        Read(settings.start_colour) == false ||
+        Read(settings.end_colour) == false)
+    {
+        return false;
+    }
+
+    size_t const stream_size = count * sizeof(float);
+    if (context == nullptr)
+    {
+        return Skip(stream_size * 4);
+    }
+    if (stream_size * 4 > m_file.GetSize() - m_offset)
+    {
+        return false;
+    }
+
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    if (emitter_index >= m_emitters.size())
+    {
+        m_emitters.resize(emitter_index + 1);
+    }
+
+    // Emitters can't change how they look once made, so one that doesn't match is remade too
+    std::unique_ptr<CParticleEmitter> & emitter = m_emitters[emitter_index];
+    if (emitter == nullptr ||
+        emitter->GetCapacity() < count ||
+        emitter->GetSettings().start_size != settings.start_size ||
+        emitter->GetSettings().end_size != settings.end_size ||
+        emitter->GetSettings().start_colour != settings.start_colour ||
+        emitter->GetSettings().end_colour != settings.end_colour)
+    {
+        settings.max_particles = std::max(count, emitter != nullptr ? emitter->GetCapacity() : 1u);
+        settings.spawn_rate = 0.0f;
+        emitter.reset(new CParticleEmitter(settings));
+    }
+
+    m_particle_scratch.resize(count * 4);
+    Read(m_particle_scratch.data(), stream_size * 4);
+
+    float const * streams = m_particle_scratch.data();
+    emitter->Assign(count, streams, streams + count, streams + count * 2, streams + count * 3);
+    context->SubmitParticles(emitter.get());
+    return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cinttypes>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "renderer/render_context.hpp"
+#include "renderer/trace/render_trace_format.hpp"
+#include "utility/file/mapped_file.hpp"
+
+namespace Renderer
+{
+    // A renderable from a trace, drawing one of the player's meshes
+    class CTraceRenderable : public IRenderable
+    {
+    public:
+        CTraceRenderable(CMesh const & mesh, glm::mat4 const & transform, glm::vec4 const & tint);
+
+        virtual CMesh const & GetMesh() const override;
+
+        virtual glm::mat4 const & GetTransformMatrix() const override;
+        virtual glm::vec4 const & GetTint() const override;
+
+    private:
+        CMesh const * m_mesh;
+        glm::mat4 m_transform_mat;
+        glm::vec4 m_tint;
+    };
+
+    // Plays a render trace back into any render context a frame at a time, straight from the
+    // mapped file. Rendering the same trace against each backend compares them on identical work.
+    class CRenderTracePlayer
+    {
+    public:
+        CRenderTracePlayer();
+
+        CRenderTracePlayer(CRenderTracePlayer const &) = delete;
+        CRenderTracePlayer & operator=(CRenderTracePlayer const &) = delete;
+
+        // Checks every record up front, so a truncated or corrupt trace fails here rather than
+        // halfway through playing it
+        bool Open(std::string const & filename);
+
+        uint32_t GetWidth() const { return m_header.width; }
+        uint32_t GetHeight() const { return m_header.height; }
+        uint32_t GetFrameCount() const { return m_frame_count; }
+        uint32_t GetFramesPlayed() const { return m_frames_played; }
+
+        // Captures recorded in the trace are only requested again when this is set
+        void SetReplayCaptures(bool const replay_captures) { m_replay_captures = replay_captures; }
+
+        // Submits the next frame's resizes, renderables, particles and captures. Its PreRender
+        // and RenderFrame are left to the caller, which is already between the two when asked
+        // to draw. Everything submitted stays alive until the next call. Returns false once
+        // every frame has been played.
+        bool SubmitFrame(IRenderContext & context);
+
+        void Rewind();
+
+    private:
+        FileHelpers::CMappedFile m_file;
+        SRenderTraceHeader m_header;
+        size_t m_offset;
+        uint32_t m_frame_count;
+        uint32_t m_frames_played;
+        bool m_replay_captures;
+
+        // Indexed by mesh id, they're numbered in the order they first appear. Each is shared by
+        // every renderable drawing it, so the mesh pool uploads it once for the whole replay.
+        std::vector<MeshRef> m_meshes;
+
+        // A deque so what was already submitted doesn't move as the frame grows
+        std::deque<CTraceRenderable> m_renderables;
+
+        // Reused in the order the frame submits them, remade when one is too small
+        std::vector<std::unique_ptr<CParticleEmitter>> m_emitters;
+        std::vector<float> m_particle_scratch;
+
+        // Records are packed with no alignment, everything is copied out rather than cast
+        bool Read(void * out, size_t const size);
+        bool Skip(size_t const size);
+        template <typename T>
+        bool Read(T & out) { return Read(&out, sizeof(T)); }
+
+        // Reads one record, submitting it to the context when there is one. Returns false at
+        // the end of the trace or on a bad record.
+        bool PlayRecord(IRenderContext * context, ERenderTraceOp & out_op, uint32_t & emitter_count);
+        bool ReadMesh();
+        bool ReadParticles(IRenderContext * context, uint32_t const emitter_index);
+    };
+}
@@ -0,0 +1,169 @@
+#include "render_trace_recorder.hpp"
+
+#include "renderer/trace/render_trace_format.hpp"
+#include "utility/logging.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+namespace
+{
+    constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+    constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+    uint64_t fnv1a(uint64_t hash, void const * data, size_t const size)
+    {
+        uint8_t const * bytes = static_cast<uint8_t const *>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash = (hash ^ bytes[i]) * FNV_PRIME;
+        }
+        return hash;
+    }
+}
+
+Renderer::CRenderTraceRecorder::CRenderTraceRecorder(IRenderContext & context,
+                                                     std::string const & filename,
+                                                     uint32_t const width,
+                                                     uint32_t const height)
+: m_context(context)
+, m_file(filename, std::ios::binary | std::ios::trunc)
+, m_frame_data()
+, m_mesh_ids()
+{
+    if (m_file.good() == false)
+    {
+        ERROR_LOG("Failed to open render trace " + filename);
+        return;
+    }
+
+    SRenderTraceHeader header;
+    header.width = width;
+    header.height = height;
+    m_file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+}
+
+Renderer::CRenderTraceRecorder::~CRenderTraceRecorder()
+{
+    // Whatever was submitted after the last RenderFrame, so a trace cut short still replays
+    if (m_frame_data.empty() == false && m_file.good() == true)
+    {
+        m_file.write(reinterpret_cast<char const *>(m_frame_data.data()), static_cast<std::streamsize>(m_frame_data.size()));
+    }
+}
+
+bool Renderer::CRenderTraceRecorder::Init()
+{
+    return m_context.Init();
+}
+
+void Renderer::CRenderTraceRecorder::ResizeScreen(uint32_t const width, uint32_t const height)
+{
+    Write(ERenderTraceOp::Resize);
+    Write(width);
+    Write(height);
+    m_context.ResizeScreen(width, height);
+}
+
+void Renderer::CRenderTraceRecorder::PreRender()
+{
+    Write(ERenderTraceOp::PreRender);
+    m_context.PreRender();
+}
+
+void Renderer::CRenderTraceRecorder::RenderFrame()
+{
+    Write(ERenderTraceOp::RenderFrame);
+    m_context.RenderFrame();
+
+    if (m_file.good() == true)
+    {
+        m_file.write(reinterpret_cast<char const *>(m_frame_data.data()), static_cast<std::streamsize>(m_frame_data.size()));
+    }
+    // Keeps its capacity, most frames are about the size of the last one
+    m_frame_data.clear();
+}
+
+void Renderer::CRenderTraceRecorder::SetViewProjection(glm::mat4 const & view_projection)
+{
+    Write(ERenderTraceOp::Camera);
+    Write(view_projection);
+    m_context.SetViewProjection(view_projection);
+}
+
+void Renderer::CRenderTraceRecorder::SubmitRenderable(IRenderable const * renderable)
+{
+    uint32_t const mesh_id = InternMesh(renderable->GetMesh());
+    Write(ERenderTraceOp::Renderable);
+    Write(mesh_id);
+    Write(renderable->GetTransformMatrix());
+    Write(renderable->GetTint());
+    m_context.SubmitRenderable(renderable);
+}
+
+void Renderer::CRenderTraceRecorder::SubmitParticles(CParticleEmitter const * emitter)
+{
+    SParticleEmitterSettings const & settings = emitter->GetSettings();
+    uint32_t const count = emitter->GetCount();
+    size_t const stream_size = count * sizeof(float);
+
+    Write(ERenderTraceOp::Particles);
+    Write(count);
+    Write(settings.start_size);
+    Write(settings.end_size);
+    Write(settings.start_colour);
+    Write(settings.end_colour);
+    Write(emitter->GetPositionsX(), stream_size);
+    Write(emitter->GetPositionsY(), stream_size);
+    Write(emitter->GetPositionsZ(), stream_size);
+    Write(emitter->GetLives(), stream_size);
+    m_context.SubmitParticles(emitter);
+}
+
+void Renderer::CRenderTraceRecorder::RequestCapture()
+{
+    Write(ERenderTraceOp::Capture);
+    m_context.RequestCapture();
+}
+
+bool Renderer::CRenderTraceRecorder::PopCapturedFrame(SCapturedFrame & out_frame, bool const wait)
+{
+    return m_context.PopCapturedFrame(out_frame, wait);
+}
+
+uint32_t Renderer::CRenderTraceRecorder::InternMesh(CMesh const & mesh)
+{
+    uint32_t const vertex_count = mesh.GetVertexCount();
+    uint32_t const index_count = mesh.GetIndexCount();
+
+    // Hashing the contents rather than the mesh's address keeps identical meshes built
+    // separately the same id, and stops a reused address picking up a stale id
+    uint64_t hash = FNV_OFFSET_BASIS;
+    hash = fnv1a(hash, mesh.GetPositions(), vertex_count * sizeof(glm::vec3));
+    hash = fnv1a(hash, mesh.GetColours(), vertex_count * sizeof(glm::vec4));
+    hash = fnv1a(hash, mesh.GetIndices(), index_count * sizeof(uint32_t));
+
+    auto const found = m_mesh_ids.find(hash);
+    if (found != m_mesh_ids.end())
+    {
+        return found->second;
+    }
+
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    uint32_t const mesh_id = static_cast<uint32_t>(m_mesh_ids.size());
+    m_mesh_ids.emplace(hash, mesh_id);
+
+    Write(ERenderTraceOp::Mesh);
+    Write(mesh_id);
+    Write(vertex_count);
+    Write(index_count);
+    Write(mesh.GetPositions(), vertex_count * sizeof(glm::vec3));
+    Write(mesh.GetColours(), vertex_count * sizeof(glm::vec4));
+    Write(mesh.GetIndices(), index_count * sizeof(uint32_t));
+    return mesh_id;
+}
+
+void Renderer::CRenderTraceRecorder::Write(void const * data, size_t const size)
+{
+    uint8_t const * bytes = static_cast<uint8_t const *>(data);
+    m_frame_data.insert(m_frame_data.end(), bytes, bytes + size);
+}
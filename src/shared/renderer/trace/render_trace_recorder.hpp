@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cinttypes>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "renderer/render_context.hpp"
+
+namespace Renderer
+{
+    // Sits in front of another render context, passing every call on and writing what was
+    // submitted to a render trace (see render_trace_format.hpp) for goat_replay to play back.
+    // Each frame is built up in memory and written out at RenderFrame.
+    class CRenderTraceRecorder : public IRenderContext
+    {
+    public:
+        // The context has to outlive the recorder, width and height are what it was made at
+        CRenderTraceRecorder(IRenderContext & context,
+                             std::string const & filename,
+                             uint32_t const width,
+                             uint32_t const height);
+        ~CRenderTraceRecorder();
+
+        CRenderTraceRecorder(CRenderTraceRecorder const &) = delete;
+        CRenderTraceRecorder & operator=(CRenderTraceRecorder const &) = delete;
+
+        bool IsOpen() const { return m_file.good(); }
+
+        virtual bool Init() override;
+        virtual void ResizeScreen(uint32_t const width, uint32_t const height) override;
+        virtual void PreRender() override;
+        virtual void EndScene() override { m_context.EndScene(); }
+        virtual void RenderFrame() override;
+        virtual void SetViewProjection(glm::mat4 const & view_projection) override;
+        virtual void SubmitRenderable(IRenderable const * renderable) override;
+        virtual void SubmitParticles(CParticleEmitter const * emitter) override;
+        // Passed straight on, text isn't part of a trace
+        virtual void SubmitText(CTextRenderer const * text) override { m_context.SubmitText(text); }
+        virtual SCullStats GetCullStats() const override { return m_context.GetCullStats(); }
+        virtual ITextureBackend * GetTextureBackend() override { return m_context.GetTextureBackend(); }
+        virtual void RequestCapture() override;
+        virtual bool PopCapturedFrame(SCapturedFrame & out_frame, bool const wait) override;
+        virtual SGpuFrameTime GetGpuFrameTime() const override { return m_context.GetGpuFrameTime(); }
+        virtual void SetDynamicResolution(SDynamicResolutionSettings const & settings) override { m_context.SetDynamicResolution(settings); }
+        virtual float GetResolutionScale() const override { return m_context.GetResolutionScale(); }
+
+    private:
+        IRenderContext & m_context;
+        std::ofstream m_file;
+        std::vector<uint8_t> m_frame_data;
+
+        // Content hashes of every mesh written so far and the id it was given
+        std::unordered_map<uint64_t, uint32_t> m_mesh_ids;
+
+        uint32_t InternMesh(CMesh const & mesh);
+        void Write(void const * data, size_t const size);
+        template <typename T>
+        void Write(T const & value) { Write(&value, sizeof(T)); }
+    };
+}
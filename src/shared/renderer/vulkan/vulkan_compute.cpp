@@ -0,0 +1,606 @@
+#include "vulkan_compute.hpp"
+
+#include "utility/logging.hpp"
+#include "utility/file/file_helper.hpp"
+
+#include <cstring>
+
+namespace
+{
+    // Descriptor sets come from a pool that's reset with each batch
+    constexpr uint32_t MAX_DISPATCHES_PER_BATCH = 64;
+    constexpr uint32_t MAX_COMPUTE_BINDINGS = 8;
+}
+
+bool Renderer::find_compute_queue_family(VkPhysicalDevice physical_device, uint32_t & out_family)
+{
+    uint32_t family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &family_count, nullptr);
+    std::vector<VkQueueFamilyProperties> families(family_count);
+    vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &family_count, families.data());
+
+    bool found = false;
+    for (uint32_t i = 0; i < family_count; ++i)
+    {
+        bool const compute = (families[i].queueFlags & VK_QUEUE_COMPUTE_BIT) == VK_QUEUE_COMPUTE_BIT;
+        bool const graphics = (families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) == VK_QUEUE_GRAPHICS_BIT;
+        if (compute == true && graphics == false)
+        {
+            out_family = i;
+            return true;
+        }
+        if (compute == true && found == false)
+        {
+            out_family = i;
+            found = true;
+        }
+    }
+    return found;
+}
+
+Renderer::VulkanCompute::VulkanCompute(VkPhysicalDevice physical_device, VkDevice logical_device, uint32_t const compute_family, uint32_t const graphics_family)
+: m_physical_device(physical_device)
+, m_logical_device(logical_device)
+, m_compute_family(compute_family)
+, m_graphics_family(graphics_family)
+, m_queue(VK_NULL_HANDLE)
+, m_command_pool(VK_NULL_HANDLE)
+, m_command_buffer(VK_NULL_HANDLE)
+, m_descriptor_pool(VK_NULL_HANDLE)
+, m_fence(VK_NULL_HANDLE)
+, m_finished_semaphore(VK_NULL_HANDLE)
+, m_recording(false)
+, m_recorded_work(false)
+, m_buffers()
+, m_free_buffer_slots()
+, m_pipelines()
+, m_free_pipeline_slots()
+{
+}
+
+Renderer::VulkanCompute::~VulkanCompute()
+{
+    if (m_fence != VK_NULL_HANDLE)
+    {
+        vkWaitForFences(m_logical_device, 1, &m_fence, VK_TRUE, UINT64_MAX);
+        vkDestroyFence(m_logical_device, m_fence, nullptr);
+    }
+
+    for (SPipeline & pipeline : m_pipelines)
+    {
+        Release(pipeline);
+    }
+    for (SBuffer & buffer : m_buffers)
+    {
+        Release(buffer);
+    }
+
+    if (m_finished_semaphore != VK_NULL_HANDLE)
+    {
+        vkDestroySemaphore(m_logical_device, m_finished_semaphore, nullptr);
+    }
+    if (m_descriptor_pool != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorPool(m_logical_device, m_descriptor_pool, nullptr);
+    }
+    if (m_command_pool != VK_NULL_HANDLE)
+    {
+        vkDestroyCommandPool(m_logical_device, m_command_pool, nullptr);
+    }
+}
+
+bool Renderer::VulkanCompute::Init()
+{
+    vkGetDeviceQueue(m_logical_device, m_compute_family, 0, &m_queue);
+
+    VkCommandPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.queueFamilyIndex = m_compute_family;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+    if (vkCreateCommandPool(m_logical_device, &pool_info, nullptr, &m_command_pool) != VK_SUCCESS)
+    {
+        ERROR_LOG("Failed to create the compute command pool");
+        return false;
+    }
+
+    VkCommandBufferAllocateInfo command_info = {};
+    command_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    command_info.commandPool = m_command_pool;
+    command_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    command_info.commandBufferCount = 1;
+
+    if (vkAllocateCommandBuffers(m_logical_device, &command_info, &m_command_buffer) != VK_SUCCESS)
+    {
+        ERROR_LOG("Failed to allocate the compute command buffer");
+        return false;
+    }
+
+    VkDescriptorPoolSize pool_size = {};
+    pool_size.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    pool_size.descriptorCount = MAX_DISPATCHES_PER_BATCH * MAX_COMPUTE_BINDINGS;
+
+    VkDescriptorPoolCreateInfo descriptor_pool_info = {};
+    descriptor_pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    descriptor_pool_info.maxSets = MAX_DISPATCHES_PER_BATCH;
+    descriptor_pool_info.poolSizeCount = 1;
+    descriptor_pool_info.pPoolSizes = &pool_size;
+
+    if (vkCreateDescriptorPool(m_logical_device, &descriptor_pool_info, nullptr, &m_descriptor_pool) != VK_SUCCESS)
+    {
+        ERROR_LOG("Failed to create the compute descriptor pool");
+        return false;
+    }
+
+    // Signalled so the first Begin doesn't wait on anything
+    VkFenceCreateInfo fence_info = {};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    VkSemaphoreCreateInfo semaphore_info = {};
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    if (vkCreateFence(m_logical_device, &fence_info, nullptr, &m_fence) != VK_SUCCESS ||
+        vkCreateSemaphore(m_logical_device, &semaphore_info, nullptr, &m_finished_semaphore) != VK_SUCCESS)
+    {
+        ERROR_LOG("Failed to create compute synchronisation objects");
+        return false;
+    }
+
+    return true;
+}
+
+uint32_t Renderer::VulkanCompute::CreateBuffer(VkDeviceSize const size, VkBufferUsageFlags const extra_usage)
+{
+    if (size == 0)
+    {
+        return INVALID_COMPUTE_BUFFER;
+    }
+
+    SBuffer buffer;
+    buffer.size = size;
+
+    // Concurrent sharing saves ownership transfers when graphics reads what compute wrote on
+    // another queue family
+    uint32_t const families[] = { m_compute_family, m_graphics_family };
+
+    VkBufferCreateInfo buffer_info = {};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size = size;
+    buffer_info.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | extra_usage;
+    if (m_compute_family != m_graphics_family)
+    {
+        buffer_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        buffer_info.queueFamilyIndexCount = 2;
+        buffer_info.pQueueFamilyIndices = families;
+    }
+    else
+    {
+        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    }
+
+    if (vkCreateBuffer(m_logical_device, &buffer_info, nullptr, &buffer.buffer) != VK_SUCCESS)
+    {
+        ERROR_LOG("Failed to create compute buffer");
+        return INVALID_COMPUTE_BUFFER;
+    }
+
+    VkMemoryRequirements requirements = {};
+    vkGetBufferMemoryRequirements(m_logical_device, buffer.buffer, &requirements);
+
+    VkMemoryAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = requirements.size;
+
+    if (FindMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, alloc_info.memoryTypeIndex) == false ||
+        vkAllocateMemory(m_logical_device, &alloc_info, nullptr, &buffer.memory) != VK_SUCCESS ||
+        vkBindBufferMemory(m_logical_device, buffer.buffer, buffer.memory, 0) != VK_SUCCESS ||
+        vkMapMemory(m_logical_device, buffer.memory, 0, size, 0, &buffer.mapped) != VK_SUCCESS)
+    {
+        ERROR_LOG("Failed to allocate compute buffer memory");
+        Release(buffer);
+        return INVALID_COMPUTE_BUFFER;
+    }
+
+    uint32_t slot = 0;
+    if (m_free_buffer_slots.empty() == false)
+    {
+        slot = m_free_buffer_slots.back();
+        m_free_buffer_slots.pop_back();
+        m_buffers[slot] = buffer;
+    }
+    else
+    {
+        slot = static_cast<uint32_t>(m_buffers.size());
+        m_buffers.push_back(buffer);
+    }
+    return slot + 1;
+}
+
+void Renderer::VulkanCompute::DestroyBuffer(uint32_t const buffer)
+{
+    if (buffer == INVALID_COMPUTE_BUFFER || buffer > m_buffers.size() || m_buffers[buffer - 1].buffer == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    // The last batch or a frame reading its results may still be using it
+    vkWaitForFences(m_logical_device, 1, &m_fence, VK_TRUE, UINT64_MAX);
+    vkDeviceWaitIdle(m_logical_device);
+
+    Release(m_buffers[buffer - 1]);
+    m_free_buffer_slots.push_back(buffer - 1);
+}
+
+bool Renderer::VulkanCompute::WriteBuffer(uint32_t const buffer, VkDeviceSize const offset, void const * data, VkDeviceSize const size)
+{
+    if (buffer == INVALID_COMPUTE_BUFFER || buffer > m_buffers.size() || m_buffers[buffer - 1].mapped == nullptr ||
+        offset + size > m_buffers[buffer - 1].size)
+    {
+        return false;
+    }
+
+    std::memcpy(static_cast<uint8_t *>(m_buffers[buffer - 1].mapped) + offset, data, static_cast<size_t>(size));
+    return true;
+}
+
+bool Renderer::VulkanCompute::ReadBuffer(uint32_t const buffer, VkDeviceSize const offset, void * out_data, VkDeviceSize const size) const
+{
+    if (buffer == INVALID_COMPUTE_BUFFER || buffer > m_buffers.size() || m_buffers[buffer - 1].mapped == nullptr ||
+        offset + size > m_buffers[buffer - 1].size)
+    {
+        return false;
+    }
+
+    std::memcpy(out_data, static_cast<uint8_t const *>(m_buffers[buffer - 1].mapped) + offset, static_cast<size_t>(size));
+    return true;
+}
+
+VkBuffer Renderer::VulkanCompute::GetBuffer(uint32_t const buffer) const
+{
+    if (buffer == INVALID_COMPUTE_BUFFER || buffer > m_buffers.size())
+    {
+        return VK_NULL_HANDLE;
+    }
+    return m_buffers[buffer - 1].buffer;
+}
+
+VkDeviceSize Renderer::VulkanCompute::GetBufferSize(uint32_t const buffer) const
+{
+    if (buffer == INVALID_COMPUTE_BUFFER || buffer > m_buffers.size())
+    {
+        return 0;
+    }
+    return m_buffers[buffer - 1].size;
+}
+
+uint32_t Renderer::VulkanCompute::CreatePipeline(std::string const & spirv_filename, uint32_t const binding_count, uint32_t const push_constant_size)
+{
+    if (binding_count > MAX_COMPUTE_BINDINGS)
+    {
+        ERROR_LOG("Compute pipelines can have at most " + std::to_string(MAX_COMPUTE_BINDINGS) + " bindings");
+        return INVALID_COMPUTE_PIPELINE;
+    }
+
+    std::vector<char> const shader_code = FileHelpers::read_file(spirv_filename);
+    if (shader_code.empty() == true)
+    {
+        ERROR_LOG("Failed to load compute shader: " + spirv_filename);
+        return INVALID_COMPUTE_PIPELINE;
+    }
+
+    SPipeline pipeline;
+    pipeline.binding_count = binding_count;
+    pipeline.push_constant_size = push_constant_size;
+
+    VkDescriptorSetLayoutBinding bindings[MAX_COMPUTE_BINDINGS] = {};
+    for (uint32_t i = 0; i < binding_count; ++i)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo set_layout_info = {};
+    set_layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    set_layout_info.bindingCount = binding_count;
+    set_layout_info.pBindings = bindings;
+
+    VkPushConstantRange push_constant_range = {};
+    push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    push_constant_range.offset = 0;
+    push_constant_range.size = push_constant_size;
+
+    VkShaderModuleCreateInfo module_info = {};
+    module_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    module_info.codeSize = shader_code.size();
+    module_info.pCode = reinterpret_cast<uint32_t const *>(shader_code.data());
+
+    VkShaderModule shader_module = VK_NULL_HANDLE;
+    bool success = vkCreateDescriptorSetLayout(m_logical_device, &set_layout_info, nullptr, &pipeline.set_layout) == VK_SUCCESS &&
+                   vkCreateShaderModule(m_logical_device, &module_info, nullptr, &shader_module) == VK_SUCCESS;
+
+    if (success == true)
+    {
+        VkPipelineLayoutCreateInfo layout_info = {};
+        layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        layout_info.setLayoutCount = 1;
+        layout_info.pSetLayouts = &pipeline.set_layout;
+        layout_info.pushConstantRangeCount = push_constant_size > 0 ? 1 : 0;
+        layout_info.pPushConstantRanges = &push_constant_range;
+
+        success = vkCreatePipelineLayout(m_logical_device, &layout_info, nullptr, &pipeline.layout) == VK_SUCCESS;
+    }
+
+    if (success == true)
+    {
+        VkComputePipelineCreateInfo pipeline_info = {};
+        pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipeline_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipeline_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipeline_info.stage.module = shader_module;
+        pipeline_info.stage.pName = "main";
+        pipeline_info.layout = pipeline.layout;
+
+        success = vkCreateComputePipelines(m_logical_device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &pipeline.pipeline) == VK_SUCCESS;
+    }
+
+    if (shader_module != VK_NULL_HANDLE)
+    {
+        vkDestroyShaderModule(m_logical_device, shader_module, nullptr);
+    }
+
+    if (success == false)
+    {
+        ERROR_LOG("Failed to create compute pipeline for " + spirv_filename);
+        Release(pipeline);
+        return INVALID_COMPUTE_PIPELINE;
+    }
+
+    uint32_t slot = 0;
+    if (m_free_pipeline_slots.empty() == false)
+    {
+        slot = m_free_pipeline_slots.back();
+        m_free_pipeline_slots.pop_back();
+        m_pipelines[slot] = pipeline;
+    }
+    else
+    {
+        slot = static_cast<uint32_t>(m_pipelines.size());
+        m_pipelines.push_back(pipeline);
+    }
+    return slot + 1;
+}
+
+void Renderer::VulkanCompute::DestroyPipeline(uint32_t const pipeline)
+{
+    if (pipeline == INVALID_COMPUTE_PIPELINE || pipeline > m_pipelines.size() || m_pipelines[pipeline - 1].pipeline == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    vkWaitForFences(m_logical_device, 1, &m_fence, VK_TRUE, UINT64_MAX);
+
+    Release(m_pipelines[pipeline - 1]);
+    m_free_pipeline_slots.push_back(pipeline - 1);
+}
+
+bool Renderer::VulkanCompute::Begin()
+{
+    if (m_recording == true)
+    {
+        return true;
+    }
+
+    // Also what makes it safe to reset the pool and command buffer the last batch used
+    vkWaitForFences(m_logical_device, 1, &m_fence, VK_TRUE, UINT64_MAX);
+    vkResetDescriptorPool(m_logical_device, m_descriptor_pool, 0);
+    vkResetCommandBuffer(m_command_buffer, 0);
+
+    VkCommandBufferBeginInfo begin_info = {};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(m_command_buffer, &begin_info) != VK_SUCCESS)
+    {
+        ERROR_LOG("Failed to begin the compute command buffer");
+        return false;
+    }
+
+    m_recording = true;
+    m_recorded_work = false;
+    return true;
+}
+
+void Renderer::VulkanCompute::FillBuffer(uint32_t const buffer, uint32_t const value)
+{
+    VkBuffer const vulkan_buffer = GetBuffer(buffer);
+    if (m_recording == false || vulkan_buffer == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    vkCmdFillBuffer(m_command_buffer, vulkan_buffer, 0, VK_WHOLE_SIZE, value);
+
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(m_command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    m_recorded_work = true;
+}
+
+void Renderer::VulkanCompute::Dispatch(uint32_t const pipeline,
+                                       std::initializer_list<uint32_t> const buffers,
+                                       void const * push_constants,
+                                       uint32_t const group_count_x,
+                                       uint32_t const group_count_y,
+                                       uint32_t const group_count_z)
+{
+    if (m_recording == false || pipeline == INVALID_COMPUTE_PIPELINE || pipeline > m_pipelines.size())
+    {
+        return;
+    }
+
+    SPipeline const & compute_pipeline = m_pipelines[pipeline - 1];
+    if (compute_pipeline.pipeline == VK_NULL_HANDLE || buffers.size() != compute_pipeline.binding_count)
+    {
+        ERROR_LOG("Compute dispatch doesn't match its pipeline's bindings");
+        return;
+    }
+
+    VkDescriptorSetAllocateInfo set_info = {};
+    set_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    set_info.descriptorPool = m_descriptor_pool;
+    set_info.descriptorSetCount = 1;
+    set_info.pSetLayouts = &compute_pipeline.set_layout;
+
+    VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+    if (vkAllocateDescriptorSets(m_logical_device, &set_info, &descriptor_set) != VK_SUCCESS)
+    {
+        ERROR_LOG("Ran out of compute descriptor sets, at most " + std::to_string(MAX_DISPATCHES_PER_BATCH) + " dispatches per batch");
+        return;
+    }
+
+    VkDescriptorBufferInfo buffer_infos[MAX_COMPUTE_BINDINGS] = {};
+    VkWriteDescriptorSet writes[MAX_COMPUTE_BINDINGS] = {};
+    uint32_t binding = 0;
+    for (uint32_t const buffer : buffers)
+    {
+        buffer_infos[binding].buffer = GetBuffer(buffer);
+        buffer_infos[binding].offset = 0;
+        buffer_infos[binding].range = VK_WHOLE_SIZE;
+
+        writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[binding].dstSet = descriptor_set;
+        writes[binding].dstBinding = binding;
+        writes[binding].descriptorCount = 1;
+        writes[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[binding].pBufferInfo = &buffer_infos[binding];
+        ++binding;
+    }
+    vkUpdateDescriptorSets(m_logical_device, binding, writes, 0, nullptr);
+
+    vkCmdBindPipeline(m_command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, compute_pipeline.pipeline);
+    vkCmdBindDescriptorSets(m_command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, compute_pipeline.layout, 0, 1, &descriptor_set, 0, nullptr);
+    if (compute_pipeline.push_constant_size > 0 && push_constants != nullptr)
+    {
+        vkCmdPushConstants(m_command_buffer, compute_pipeline.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, compute_pipeline.push_constant_size, push_constants);
+    }
+    vkCmdDispatch(m_command_buffer, group_count_x, group_count_y, group_count_z);
+
+    ComputeBarrier();
+    m_recorded_work = true;
+}
+
+VkSemaphore Renderer::VulkanCompute::Submit()
+{
+    if (m_recording == false)
+    {
+        return VK_NULL_HANDLE;
+    }
+    m_recording = false;
+
+    if (vkEndCommandBuffer(m_command_buffer) != VK_SUCCESS)
+    {
+        ERROR_LOG("Failed to record the compute command buffer");
+        return VK_NULL_HANDLE;
+    }
+
+    // An empty batch leaves the fence signalled and the semaphore unsignalled
+    if (m_recorded_work == false)
+    {
+        return VK_NULL_HANDLE;
+    }
+
+    VkSubmitInfo submit_info = {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &m_command_buffer;
+    submit_info.signalSemaphoreCount = 1;
+    submit_info.pSignalSemaphores = &m_finished_semaphore;
+
+    vkResetFences(m_logical_device, 1, &m_fence);
+    if (vkQueueSubmit(m_queue, 1, &submit_info, m_fence) != VK_SUCCESS)
+    {
+        ERROR_LOG("Failed to submit compute work");
+
+        // Put the fence back so the next Begin doesn't wait forever
+        VkSubmitInfo empty_submit = {};
+        empty_submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        vkQueueSubmit(m_queue, 1, &empty_submit, m_fence);
+        return VK_NULL_HANDLE;
+    }
+    return m_finished_semaphore;
+}
+
+void Renderer::VulkanCompute::Wait()
+{
+    vkWaitForFences(m_logical_device, 1, &m_fence, VK_TRUE, UINT64_MAX);
+}
+
+void Renderer::VulkanCompute::ComputeBarrier()
+{
+    // Covers later dispatches and fills in the batch and reading back on the host. The graphics
+    // queue is covered by waiting on the semaphore at the stages that read the results.
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(m_command_buffer,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+bool Renderer::VulkanCompute::FindMemoryType(uint32_t const type_bits, VkMemoryPropertyFlags const properties, uint32_t & out_type) const
+{
+    VkPhysicalDeviceMemoryProperties memory_properties = {};
+    vkGetPhysicalDeviceMemoryProperties(m_physical_device, &memory_properties);
+
+    for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i)
+    {
+        if ((type_bits & (1u << i)) != 0 && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            out_type = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Renderer::VulkanCompute::Release(SBuffer & buffer)
+{
+    if (buffer.mapped != nullptr)
+    {
+        vkUnmapMemory(m_logical_device, buffer.memory);
+    }
+    if (buffer.buffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(m_logical_device, buffer.buffer, nullptr);
+    }
+    if (buffer.memory != VK_NULL_HANDLE)
+    {
+        vkFreeMemory(m_logical_device, buffer.memory, nullptr);
+    }
+    buffer = SBuffer();
+}
+
+void Renderer::VulkanCompute::Release(SPipeline & pipeline)
+{
+    if (pipeline.pipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(m_logical_device, pipeline.pipeline, nullptr);
+    }
+    if (pipeline.layout != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineLayout(m_logical_device, pipeline.layout, nullptr);
+    }
+    if (pipeline.set_layout != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(m_logical_device, pipeline.set_layout, nullptr);
+    }
+    pipeline = SPipeline();
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cinttypes>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace Renderer
+{
+    constexpr uint32_t INVALID_COMPUTE_BUFFER = 0;
+    constexpr uint32_t INVALID_COMPUTE_PIPELINE = 0;
+
+    // The queue family compute work is submitted to. A family with compute but no graphics is
+    // preferred, as that's usually an async compute queue running alongside rendering. Otherwise
+    // it's the first family that can do compute, which every graphics family must be able to.
+    // Returns false if the device has no compute support at all.
+    bool find_compute_queue_family(VkPhysicalDevice physical_device, uint32_t & out_family);
+
+    // Storage buffers, compute pipelines and one batch of dispatches at a time on the compute
+    // queue. Work is recorded between Begin and Submit. Every dispatch is followed by a barrier
+    // so the next one sees its writes. Submit hands back a semaphore for the graphics submission
+    // to wait on before it reads anything the batch wrote.
+    //
+    // Buffers are host visible and coherent so they can be written and read back without
+    // staging. That is device local as well on integrated GPUs and software rasterisers like
+    // lavapipe. On discrete cards it costs bandwidth, which is fine while the buffers are small.
+    class VulkanCompute
+    {
+    public:
+        // graphics_family is only used to share buffers between the two queues when they differ
+        VulkanCompute(VkPhysicalDevice physical_device, VkDevice logical_device, uint32_t const compute_family, uint32_t const graphics_family);
+        ~VulkanCompute();
+
+        VulkanCompute(VulkanCompute const &) = delete;
+        VulkanCompute & operator=(VulkanCompute const &) = delete;
+
+        bool Init();
+
+        // Storage usage is always included. Add VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT or
+        // VK_BUFFER_USAGE_VERTEX_BUFFER_BIT for buffers the graphics side reads as well.
+        uint32_t CreateBuffer(VkDeviceSize const size, VkBufferUsageFlags const extra_usage = 0);
+        void DestroyBuffer(uint32_t const buffer);
+        bool WriteBuffer(uint32_t const buffer, VkDeviceSize const offset, void const * data, VkDeviceSize const size);
+        // Wait for the batch that wrote it first
+        bool ReadBuffer(uint32_t const buffer, VkDeviceSize const offset, void * out_data, VkDeviceSize const size) const;
+        // VK_NULL_HANDLE for an unknown buffer
+        VkBuffer GetBuffer(uint32_t const buffer) const;
+        VkDeviceSize GetBufferSize(uint32_t const buffer) const;
+
+        // Loads SPIR-V with a "main" entry point whose bindings 0 to binding_count - 1 are all
+        // storage buffers
+        uint32_t CreatePipeline(std::string const & spirv_filename, uint32_t const binding_count, uint32_t const push_constant_size);
+        void DestroyPipeline(uint32_t const pipeline);
+
+        // Waits for the previous batch and starts recording a new one
+        bool Begin();
+        bool IsRecording() const { return m_recording; }
+
+        // Fills the buffer with value, visible to dispatches recorded after it
+        void FillBuffer(uint32_t const buffer, uint32_t const value);
+
+        // Binds buffers to bindings 0, 1, 2... in order
+        void Dispatch(uint32_t const pipeline,
+                      std::initializer_list<uint32_t> const buffers,
+                      void const * push_constants,
+                      uint32_t const group_count_x,
+                      uint32_t const group_count_y = 1,
+                      uint32_t const group_count_z = 1);
+
+        // Ends the batch and submits it. The returned semaphore is signalled when it finishes and
+        // has to be waited on exactly once. VK_NULL_HANDLE if nothing was recorded or the submit
+        // failed.
+        VkSemaphore Submit();
+
+        // Blocks until the last submitted batch has finished, needed before reading buffers back
+        void Wait();
+
+    private:
+        struct SBuffer
+        {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkDeviceSize size = 0;
+            void * mapped = nullptr;
+        };
+
+        struct SPipeline
+        {
+            VkDescriptorSetLayout set_layout = VK_NULL_HANDLE;
+            VkPipelineLayout layout = VK_NULL_HANDLE;
+            VkPipeline pipeline = VK_NULL_HANDLE;
+            uint32_t binding_count = 0;
+            uint32_t push_constant_size = 0;
+        };
+
+        bool FindMemoryType(uint32_t const type_bits, VkMemoryPropertyFlags const properties, uint32_t & out_type) const;
+        void Release(SBuffer & buffer);
+        void Release(SPipeline & pipeline);
+        void ComputeBarrier();
+
+        VkPhysicalDevice m_physical_device;
+        VkDevice m_logical_device;
+        uint32_t m_compute_family;
+        uint32_t m_graphics_family;
+
+        VkQueue m_queue;
+        VkCommandPool m_command_pool;
+        VkCommandBuffer m_command_buffer;
+        VkDescriptorPool m_descriptor_pool;
+        VkFence m_fence;
+        VkSemaphore m_finished_semaphore;
+        bool m_recording;
+        bool m_recorded_work;
+
+        // Ids are slot + 1 so zero stays invalid
+        std::vector<SBuffer> m_buffers;
+        std::vector<uint32_t> m_free_buffer_slots;
+        std::vector<SPipeline> m_pipelines;
+        std::vector<uint32_t> m_free_pipeline_slots;
+    };
+}
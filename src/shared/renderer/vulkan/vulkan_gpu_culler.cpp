@@ -0,0 +1,100 @@
+#include "vulkan_gpu_culler.hpp"
+
+#include "utility/logging.hpp"
+
+#include <algorithm>
+#include <string>
+
+namespace
+{
+    // Matches [numthreads] in the shader
+    constexpr uint32_t CULL_GROUP_SIZE = 64;
+
+    struct SCullConstants
+    {
+        float planes[Renderer::SFrustum::PLANE_COUNT][4];
+        uint32_t object_count;
+    };
+}
+
+Renderer::VulkanGpuCuller::VulkanGpuCuller(VulkanCompute & compute)
+: m_compute(compute)
+, m_pipeline(INVALID_COMPUTE_PIPELINE)
+, m_object_buffer(INVALID_COMPUTE_BUFFER)
+, m_draw_buffer(INVALID_COMPUTE_BUFFER)
+, m_count_buffer(INVALID_COMPUTE_BUFFER)
+, m_object_count(0)
+, m_capacity(0)
+{
+}
+
+Renderer::VulkanGpuCuller::~VulkanGpuCuller()
+{
+    m_compute.DestroyBuffer(m_object_buffer);
+    m_compute.DestroyBuffer(m_draw_buffer);
+    m_compute.DestroyBuffer(m_count_buffer);
+    m_compute.DestroyPipeline(m_pipeline);
+}
+
+bool Renderer::VulkanGpuCuller::Init()
+{
+    m_pipeline = m_compute.CreatePipeline("shaders/frustum_cull_comp.spv", 3, sizeof(SCullConstants));
+    m_count_buffer = m_compute.CreateBuffer(sizeof(uint32_t), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+    return m_pipeline != INVALID_COMPUTE_PIPELINE && m_count_buffer != INVALID_COMPUTE_BUFFER;
+}
+
+bool Renderer::VulkanGpuCuller::SetObjects(std::vector<SGpuCullObject> const & objects)
+{
+    uint32_t const count = static_cast<uint32_t>(objects.size());
+    if (count > m_capacity)
+    {
+        // Grown by half again so a slowly growing scene doesn't reallocate every frame
+        uint32_t const capacity = std::max(count, m_capacity + m_capacity / 2);
+
+        m_compute.DestroyBuffer(m_object_buffer);
+        m_compute.DestroyBuffer(m_draw_buffer);
+        m_object_buffer = m_compute.CreateBuffer(sizeof(SGpuCullObject) * capacity);
+        m_draw_buffer = m_compute.CreateBuffer(sizeof(VkDrawIndexedIndirectCommand) * capacity, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+
+        if (m_object_buffer == INVALID_COMPUTE_BUFFER || m_draw_buffer == INVALID_COMPUTE_BUFFER)
+        {
+            ERROR_LOG("Failed to allocate GPU culling buffers for " + std::to_string(count) + " objects");
+            m_object_count = 0;
+            m_capacity = 0;
+            return false;
+        }
+        m_capacity = capacity;
+    }
+
+    m_object_count = count;
+    return count == 0 || m_compute.WriteBuffer(m_object_buffer, 0, objects.data(), sizeof(SGpuCullObject) * count);
+}
+
+void Renderer::VulkanGpuCuller::Record(SFrustum const & frustum)
+{
+    m_compute.FillBuffer(m_count_buffer, 0);
+    if (m_object_count == 0)
+    {
+        return;
+    }
+
+    SCullConstants constants;
+    for (uint32_t p = 0; p < SFrustum::PLANE_COUNT; ++p)
+    {
+        constants.planes[p][0] = frustum.planes[p].x;
+        constants.planes[p][1] = frustum.planes[p].y;
+        constants.planes[p][2] = frustum.planes[p].z;
+        constants.planes[p][3] = frustum.planes[p].w;
+    }
+    constants.object_count = m_object_count;
+
+    uint32_t const group_count = (m_object_count + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE;
+    m_compute.Dispatch(m_pipeline, { m_object_buffer, m_draw_buffer, m_count_buffer }, &constants, group_count);
+}
+
+uint32_t Renderer::VulkanGpuCuller::ReadDrawCount() const
+{
+    uint32_t count = 0;
+    m_compute.ReadBuffer(m_count_buffer, 0, &count, sizeof(count));
+    return count;
+}
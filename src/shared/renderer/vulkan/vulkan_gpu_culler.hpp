@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <glm/vec4.hpp>
+
+#include <cinttypes>
+#include <vector>
+
+#include "renderer/culling/frustum.hpp"
+#include "renderer/vulkan/vulkan_compute.hpp"
+
+namespace Renderer
+{
+    // World space bounds plus the indexed draw to emit if they're visible, laid out to match
+    // frustum_cull_comp.hlsl
+    struct SGpuCullObject
+    {
+        glm::vec4 centre;
+        glm::vec4 extents;
+        uint32_t index_count = 0;
+        uint32_t first_index = 0;
+        int32_t vertex_offset = 0;
+        uint32_t padding = 0;
+    };
+    static_assert(sizeof(SGpuCullObject) == 48, "SGpuCullObject has to match the compute shader");
+
+    // Frustum culling on the GPU. Each visible object appends a VkDrawIndexedIndirectCommand
+    // with its index as first_instance. The number appended is written to a separate count
+    // buffer, ready for vkCmdDrawIndexedIndirectCount. Appending means the draw order changes
+    // from frame to frame.
+    class VulkanGpuCuller
+    {
+    public:
+        explicit VulkanGpuCuller(VulkanCompute & compute);
+        ~VulkanGpuCuller();
+
+        VulkanGpuCuller(VulkanGpuCuller const &) = delete;
+        VulkanGpuCuller & operator=(VulkanGpuCuller const &) = delete;
+
+        bool Init();
+
+        // Buffers only grow. Call this outside a compute batch, or before the batch's first Record.
+        bool SetObjects(std::vector<SGpuCullObject> const & objects);
+        uint32_t GetObjectCount() const { return m_object_count; }
+
+        // Clears the count and dispatches the cull into the compute batch being recorded
+        void Record(SFrustum const & frustum);
+
+        // Sized for every object being visible
+        VkBuffer GetDrawBuffer() const { return m_compute.GetBuffer(m_draw_buffer); }
+        VkBuffer GetDrawCountBuffer() const { return m_compute.GetBuffer(m_count_buffer); }
+
+        // For stats, wait on the batch that culled first
+        uint32_t ReadDrawCount() const;
+
+    private:
+        VulkanCompute & m_compute;
+        uint32_t m_pipeline;
+
+        uint32_t m_object_buffer;
+        uint32_t m_draw_buffer;
+        uint32_t m_count_buffer;
+        uint32_t m_object_count;
+        uint32_t m_capacity;
+    };
+}
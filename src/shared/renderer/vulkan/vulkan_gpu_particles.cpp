@@ -0,0 +1,97 @@
+#include "vulkan_gpu_particles.hpp"
+
+#include "utility/memory/memory_tracker.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // Matches [numthreads] in the shader
+    constexpr uint32_t PARTICLE_GROUP_SIZE = 64;
+
+    struct SParticleConstants
+    {
+        float origin_dt[4];
+        float gravity_damping[4];
+        float extents_min_lifetime[4];
+        float min_velocity_max_lifetime[4];
+        float max_velocity[4];
+        uint32_t particle_count;
+        uint32_t seed;
+    };
+
+    void set(float (&out)[4], glm::vec3 const & xyz, float const w)
+    {
+        out[0] = xyz.x;
+        out[1] = xyz.y;
+        out[2] = xyz.z;
+        out[3] = w;
+    }
+}
+
+Renderer::VulkanGpuParticles::VulkanGpuParticles(VulkanCompute & compute, SParticleEmitterSettings const & settings)
+: m_compute(compute)
+, m_settings(settings)
+, m_pipeline(INVALID_COMPUTE_PIPELINE)
+, m_particle_buffer(INVALID_COMPUTE_BUFFER)
+, m_step(0)
+{
+}
+
+Renderer::VulkanGpuParticles::~VulkanGpuParticles()
+{
+    m_compute.DestroyBuffer(m_particle_buffer);
+    m_compute.DestroyPipeline(m_pipeline);
+}
+
+bool Renderer::VulkanGpuParticles::Init()
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    m_pipeline = m_compute.CreatePipeline("shaders/particle_simulate_comp.spv", 1, sizeof(SParticleConstants));
+    m_particle_buffer = m_compute.CreateBuffer(sizeof(SGpuParticle) * std::max(m_settings.max_particles, 1u), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+    if (m_pipeline == INVALID_COMPUTE_PIPELINE || m_particle_buffer == INVALID_COMPUTE_BUFFER)
+    {
+        return false;
+    }
+
+    std::mt19937 rng(m_settings.seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    auto random_range = [&](glm::vec3 const & low, glm::vec3 const & high)
+    {
+        return low + (high - low) * glm::vec3(unit(rng), unit(rng), unit(rng));
+    };
+
+    std::vector<SGpuParticle> particles(m_settings.max_particles);
+    for (SGpuParticle & particle : particles)
+    {
+        float const lifetime = m_settings.min_lifetime + (m_settings.max_lifetime - m_settings.min_lifetime) * unit(rng);
+        particle.position_life = glm::vec4(m_settings.position + random_range(-m_settings.spawn_extents, m_settings.spawn_extents), unit(rng));
+        particle.velocity_rate = glm::vec4(random_range(m_settings.min_velocity, m_settings.max_velocity), lifetime > 0.0f ? 1.0f / lifetime : 1.0e30f);
+    }
+
+    return particles.empty() == true || m_compute.WriteBuffer(m_particle_buffer, 0, particles.data(), sizeof(SGpuParticle) * particles.size());
+}
+
+void Renderer::VulkanGpuParticles::Record(float const dt)
+{
+    if (m_settings.max_particles == 0)
+    {
+        return;
+    }
+
+    SParticleConstants constants;
+    set(constants.origin_dt, m_settings.position, dt);
+    set(constants.gravity_damping, m_settings.gravity * dt, std::max(0.0f, 1.0f - m_settings.drag * dt));
+    set(constants.extents_min_lifetime, m_settings.spawn_extents, m_settings.min_lifetime);
+    set(constants.min_velocity_max_lifetime, m_settings.min_velocity, m_settings.max_lifetime);
+    set(constants.max_velocity, m_settings.max_velocity, 0.0f);
+    constants.particle_count = m_settings.max_particles;
+    // A new seed each step so particles dying together don't respawn identically
+    constants.seed = m_settings.seed * 2654435761u + m_step++;
+
+    uint32_t const group_count = (m_settings.max_particles + PARTICLE_GROUP_SIZE - 1) / PARTICLE_GROUP_SIZE;
+    m_compute.Dispatch(m_pipeline, { m_particle_buffer }, &constants, group_count);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <cinttypes>
+
+#include "renderer/particles/particle_emitter.hpp"
+#include "renderer/vulkan/vulkan_compute.hpp"
+
+namespace Renderer
+{
+    // Laid out to match particle_simulate_comp.hlsl
+    struct SGpuParticle
+    {
+        // xyz position, w life from 0 at spawn to 1 at death
+        glm::vec4 position_life;
+        // xyz velocity, w one over the lifetime
+        glm::vec4 velocity_rate;
+    };
+    static_assert(sizeof(SGpuParticle) == 32, "SGpuParticle has to match the compute shader");
+
+    // The GPU counterpart of CParticleEmitter, for effects too big to step on the CPU. The pool
+    // holds max_particles and is always full. A particle that dies is respawned in place by the
+    // shader, so spawn_rate is ignored and the emission rate comes from the lifetimes. The buffer
+    // can also be bound as per-instance vertex data to draw from.
+    class VulkanGpuParticles
+    {
+    public:
+        VulkanGpuParticles(VulkanCompute & compute, SParticleEmitterSettings const & settings);
+        ~VulkanGpuParticles();
+
+        VulkanGpuParticles(VulkanGpuParticles const &) = delete;
+        VulkanGpuParticles & operator=(VulkanGpuParticles const &) = delete;
+
+        // Seeds the pool with lives spread over [0, 1) so particles don't all die together
+        bool Init();
+
+        SParticleEmitterSettings const & GetSettings() const { return m_settings; }
+        void SetPosition(glm::vec3 const & position) { m_settings.position = position; }
+
+        // Dispatches one step into the compute batch being recorded
+        void Record(float const dt);
+
+        VkBuffer GetParticleBuffer() const { return m_compute.GetBuffer(m_particle_buffer); }
+        uint32_t GetCount() const { return m_settings.max_particles; }
+
+    private:
+        VulkanCompute & m_compute;
+        SParticleEmitterSettings m_settings;
+
+        uint32_t m_pipeline;
+        uint32_t m_particle_buffer;
+        uint32_t m_step;
+    };
+}
@@ -0,0 +1,113 @@
+#include "vulkan_gpu_timer.hpp"
+
+#include "utility/logging.hpp"
+
+#include <vector>
+
+Renderer::VulkanGpuTimer::VulkanGpuTimer(VkPhysicalDevice physical_device, VkDevice logical_device, uint32_t const queue_family)
+: m_physical_device(physical_device)
+, m_logical_device(logical_device)
+, m_queue_family(queue_family)
+, m_query_pool(VK_NULL_HANDLE)
+, m_timestamp_period(1.0)
+, m_timestamp_mask(0)
+, m_slots()
+, m_latest()
+{
+}
+
+Renderer::VulkanGpuTimer::~VulkanGpuTimer()
+{
+    if (m_query_pool != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(m_logical_device, m_query_pool, nullptr);
+    }
+}
+
+bool Renderer::VulkanGpuTimer::Init()
+{
+    uint32_t queue_family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(m_physical_device, &queue_family_count, nullptr);
+    std::vector<VkQueueFamilyProperties> queue_families(queue_family_count);
+    vkGetPhysicalDeviceQueueFamilyProperties(m_physical_device, &queue_family_count, queue_families.data());
+
+    uint32_t const valid_bits = m_queue_family < queue_family_count ? queue_families[m_queue_family].timestampValidBits : 0;
+    if (valid_bits == 0)
+    {
+        return false;
+    }
+    m_timestamp_mask = valid_bits >= 64 ? ~0ull : (1ull << valid_bits) - 1;
+
+    VkPhysicalDeviceProperties properties = {};
+    vkGetPhysicalDeviceProperties(m_physical_device, &properties);
+    m_timestamp_period = static_cast<double>(properties.limits.timestampPeriod);
+
+    VkQueryPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    pool_info.queryCount = VULKAN_GPU_TIMER_SLOT_COUNT * 2;
+
+    if (vkCreateQueryPool(m_logical_device, &pool_info, nullptr, &m_query_pool) != VK_SUCCESS)
+    {
+        ERROR_LOG("Failed to create timestamp query pool");
+        m_query_pool = VK_NULL_HANDLE;
+        return false;
+    }
+    return true;
+}
+
+void Renderer::VulkanGpuTimer::Begin(VkCommandBuffer command_buffer, uint32_t const image_index, uint64_t const frame_index)
+{
+    if (m_query_pool == VK_NULL_HANDLE || image_index >= VULKAN_GPU_TIMER_SLOT_COUNT)
+    {
+        return;
+    }
+
+    vkCmdResetQueryPool(command_buffer, m_query_pool, image_index * 2, 2);
+    vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_query_pool, image_index * 2);
+
+    m_slots[image_index].frame_index = frame_index;
+    m_slots[image_index].written = true;
+}
+
+void Renderer::VulkanGpuTimer::End(VkCommandBuffer command_buffer, uint32_t const image_index)
+{
+    if (m_query_pool == VK_NULL_HANDLE || image_index >= VULKAN_GPU_TIMER_SLOT_COUNT)
+    {
+        return;
+    }
+
+    vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_query_pool, image_index * 2 + 1);
+}
+
+void Renderer::VulkanGpuTimer::Resolve(uint32_t const image_index)
+{
+    if (m_query_pool == VK_NULL_HANDLE || image_index >= VULKAN_GPU_TIMER_SLOT_COUNT || m_slots[image_index].written == false)
+    {
+        return;
+    }
+
+    SSlot & slot = m_slots[image_index];
+    slot.written = false;
+
+    uint64_t timestamps[2] = {};
+    if (vkGetQueryPoolResults(m_logical_device,
+                              m_query_pool,
+                              image_index * 2,
+                              2,
+                              sizeof(timestamps),
+                              timestamps,
+                              sizeof(uint64_t),
+                              VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+    {
+        return;
+    }
+
+    uint64_t const ticks = (timestamps[1] - timestamps[0]) & m_timestamp_mask;
+    if (m_latest.valid == false || slot.frame_index > m_latest.frame_index)
+    {
+        m_latest.frame_index = slot.frame_index;
+        m_latest.milliseconds = static_cast<float>(static_cast<double>(ticks) * m_timestamp_period / 1000000.0);
+        m_latest.valid = true;
+    }
+}
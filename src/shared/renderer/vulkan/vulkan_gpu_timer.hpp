@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cinttypes>
+
+#include "renderer/render_context.hpp"
+
+namespace Renderer
+{
+    // One pair of timestamps per swapchain image, images past this aren't timed
+    constexpr uint32_t VULKAN_GPU_TIMER_SLOT_COUNT = 8;
+
+    // Times each frame's command buffer with timestamps written at its start and end. A slot is
+    // only read back once the fence for its image has been waited on, so reading never stalls.
+    class VulkanGpuTimer
+    {
+    public:
+        VulkanGpuTimer(VkPhysicalDevice physical_device, VkDevice logical_device, uint32_t const queue_family);
+        ~VulkanGpuTimer();
+
+        VulkanGpuTimer(VulkanGpuTimer const &) = delete;
+        VulkanGpuTimer & operator=(VulkanGpuTimer const &) = delete;
+
+        // False if the queue can't write timestamps, nothing is timed then
+        bool Init();
+
+        // At the start and end of the image's command buffer, outside any render pass
+        void Begin(VkCommandBuffer command_buffer, uint32_t const image_index, uint64_t const frame_index);
+        void End(VkCommandBuffer command_buffer, uint32_t const image_index);
+
+        // Once the image's last submit is known to be finished
+        void Resolve(uint32_t const image_index);
+
+        SGpuFrameTime GetLatest() const { return m_latest; }
+
+    private:
+        struct SSlot
+        {
+            uint64_t frame_index = 0;
+            bool written = false;
+        };
+
+        VkPhysicalDevice m_physical_device;
+        VkDevice m_logical_device;
+        uint32_t m_queue_family;
+
+        VkQueryPool m_query_pool;
+        // Nanoseconds per timestamp tick and the bits of each timestamp that count
+        double m_timestamp_period;
+        uint64_t m_timestamp_mask;
+
+        std::array<SSlot, VULKAN_GPU_TIMER_SLOT_COUNT> m_slots;
+        SGpuFrameTime m_latest;
+    };
+}
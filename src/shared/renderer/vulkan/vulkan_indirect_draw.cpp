@@ -0,0 +1,299 @@
+#include "vulkan_indirect_draw.hpp"
+
+#include "utility/logging.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+
+Renderer::VulkanIndirectDraw::VulkanIndirectDraw(VkPhysicalDevice physical_device, VkDevice logical_device, SFeatures const & features)
+: m_physical_device(physical_device)
+, m_logical_device(logical_device)
+, m_features(features)
+, m_positions()
+, m_colours()
+, m_indices()
+, m_mesh_generation(UINT64_MAX)
+, m_images()
+{
+}
+
+Renderer::VulkanIndirectDraw::~VulkanIndirectDraw()
+{
+    for (SImageBuffers & image : m_images)
+    {
+        for (SBuffer * buffer : { &image.instances, &image.commands, &image.draw_count })
+        {
+            Release(*buffer);
+        }
+    }
+    for (SBuffer * buffer : { &m_positions, &m_colours, &m_indices })
+    {
+        Release(*buffer);
+    }
+}
+
+std::array<VkVertexInputBindingDescription, 3> Renderer::VulkanIndirectDraw::GetBindingDescriptions()
+{
+    std::array<VkVertexInputBindingDescription, 3> bindings = {};
+    bindings[0].binding = 0;
+    bindings[0].stride = sizeof(glm::vec3);
+    bindings[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    bindings[1].binding = 1;
+    bindings[1].stride = sizeof(glm::vec4);
+    bindings[1].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    // Advanced per instance, so a command's first instance selects its transforms and tints
+    bindings[2].binding = 2;
+    bindings[2].stride = sizeof(SDrawInstance);
+    bindings[2].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+    return bindings;
+}
+
+std::array<VkVertexInputAttributeDescription, 7> Renderer::VulkanIndirectDraw::GetAttributeDescriptions()
+{
+    std::array<VkVertexInputAttributeDescription, 7> attributes = {};
+    attributes[0].location = 0;
+    attributes[0].binding = 0;
+    attributes[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+    attributes[0].offset = 0;
+
+    attributes[1].location = 1;
+    attributes[1].binding = 1;
+    attributes[1].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    attributes[1].offset = 0;
+
+    // One location per matrix column
+    for (uint32_t column = 0; column < 4; ++column)
+    {
+        attributes[2 + column].location = 2 + column;
+        attributes[2 + column].binding = 2;
+        attributes[2 + column].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+        attributes[2 + column].offset = static_cast<uint32_t>(sizeof(glm::vec4) * column);
+    }
+
+    attributes[6].location = 6;
+    attributes[6].binding = 2;
+    attributes[6].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    attributes[6].offset = static_cast<uint32_t>(offsetof(SDrawInstance, tint));
+    return attributes;
+}
+
+bool Renderer::VulkanIndirectDraw::Upload(uint32_t const image_index, CDrawBatch const & batch)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    // The swapchain can come back with more images after a resize
+    if (image_index >= m_images.size())
+    {
+        m_images.resize(image_index + 1);
+    }
+
+    SImageBuffers & image = m_images[image_index];
+    image.cpu_commands.assign(batch.GetCommands().begin(), batch.GetCommands().end());
+    if (image.cpu_commands.empty() == true)
+    {
+        return true;
+    }
+
+    Memory::arena_vector<SDrawInstance> const & instances = batch.GetInstances();
+    uint32_t const draw_count = static_cast<uint32_t>(image.cpu_commands.size());
+
+    bool const written = UploadMeshes(batch.GetMeshPool())
+        && Write(image.instances, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, instances.data(), sizeof(SDrawInstance) * instances.size())
+        && Write(image.commands, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, image.cpu_commands.data(), sizeof(SDrawCommand) * draw_count)
+        && Write(image.draw_count, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, &draw_count, sizeof(draw_count));
+
+    if (written == false)
+    {
+        // Drawing half written buffers would be worse than skipping the frame's geometry
+        image.cpu_commands.clear();
+    }
+    return written;
+}
+
+void Renderer::VulkanIndirectDraw::Record(VkCommandBuffer command_buffer, uint32_t const image_index) const
+{
+    if (image_index >= m_images.size() || m_images[image_index].cpu_commands.empty() == true)
+    {
+        return;
+    }
+
+    SImageBuffers const & image = m_images[image_index];
+    uint32_t const draw_count = static_cast<uint32_t>(image.cpu_commands.size());
+    Bind(command_buffer, image);
+
+    if (m_features.draw_indirect_first_instance == false)
+    {
+        // Indirect commands can't start past instance zero, so each one is drawn directly
+        for (SDrawCommand const & command : image.cpu_commands)
+        {
+            vkCmdDrawIndexed(command_buffer, command.index_count, command.instance_count, command.first_index, command.base_vertex, command.base_instance);
+        }
+    }
+    else if (m_features.draw_indirect_count == true)
+    {
+        // The count is read on the GPU, RecordCulled uses the same call with a compute pass's
+        // commands
+        vkCmdDrawIndexedIndirectCount(command_buffer, image.commands.buffer, 0, image.draw_count.buffer, 0, draw_count, sizeof(SDrawCommand));
+    }
+    else
+    {
+        uint32_t const max_per_call = m_features.multi_draw_indirect == true ? std::max(m_features.max_draw_indirect_count, 1u) : 1u;
+        for (uint32_t first = 0; first < draw_count; first += max_per_call)
+        {
+            uint32_t const count = std::min(max_per_call, draw_count - first);
+            vkCmdDrawIndexedIndirect(command_buffer, image.commands.buffer, sizeof(SDrawCommand) * first, count, sizeof(SDrawCommand));
+        }
+    }
+}
+
+void Renderer::VulkanIndirectDraw::RecordCulled(VkCommandBuffer command_buffer,
+                                                uint32_t const image_index,
+                                                VkBuffer draws,
+                                                VkBuffer draw_count,
+                                                uint32_t const max_draw_count) const
+{
+    if (image_index >= m_images.size() || m_images[image_index].cpu_commands.empty() == true ||
+        draws == VK_NULL_HANDLE || draw_count == VK_NULL_HANDLE || max_draw_count == 0)
+    {
+        return;
+    }
+
+    Bind(command_buffer, m_images[image_index]);
+    vkCmdDrawIndexedIndirectCount(command_buffer, draws, 0, draw_count, 0, max_draw_count, sizeof(VkDrawIndexedIndirectCommand));
+}
+
+void Renderer::VulkanIndirectDraw::Bind(VkCommandBuffer command_buffer, SImageBuffers const & image) const
+{
+    VkBuffer const vertex_buffers[] = { m_positions.buffer, m_colours.buffer, image.instances.buffer };
+    VkDeviceSize const offsets[] = { 0, 0, 0 };
+    vkCmdBindVertexBuffers(command_buffer, 0, 3, vertex_buffers, offsets);
+    vkCmdBindIndexBuffer(command_buffer, m_indices.buffer, 0, VK_INDEX_TYPE_UINT32);
+}
+
+bool Renderer::VulkanIndirectDraw::UploadMeshes(CMeshPool const & mesh_pool)
+{
+    if (m_mesh_generation != mesh_pool.GetGeneration())
+    {
+        // The pool has started again from the beginning, over ranges other images' frames may
+        // still be drawing
+        if (m_positions.buffer != VK_NULL_HANDLE)
+        {
+            vkDeviceWaitIdle(m_logical_device);
+        }
+
+        bool const reserved = Reserve(m_positions, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, sizeof(glm::vec3) * mesh_pool.GetVertexCapacity())
+            && Reserve(m_colours, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, sizeof(glm::vec4) * mesh_pool.GetVertexCapacity())
+            && Reserve(m_indices, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, sizeof(uint32_t) * mesh_pool.GetIndexCapacity());
+        if (reserved == false)
+        {
+            return false;
+        }
+        m_mesh_generation = mesh_pool.GetGeneration();
+    }
+
+    // Only meshes that weren't resident yet, into ranges nothing has drawn from
+    for (SMeshUpload const & upload : mesh_pool.GetUploads())
+    {
+        CMesh const & mesh = *upload.mesh;
+        size_t const first_vertex = static_cast<size_t>(upload.range.base_vertex);
+        std::memcpy(static_cast<glm::vec3 *>(m_positions.mapped) + first_vertex, mesh.GetPositions(), sizeof(glm::vec3) * mesh.GetVertexCount());
+        std::memcpy(static_cast<glm::vec4 *>(m_colours.mapped) + first_vertex, mesh.GetColours(), sizeof(glm::vec4) * mesh.GetVertexCount());
+        std::memcpy(static_cast<uint32_t *>(m_indices.mapped) + upload.range.first_index, mesh.GetIndices(), sizeof(uint32_t) * mesh.GetIndexCount());
+    }
+    return true;
+}
+
+bool Renderer::VulkanIndirectDraw::Write(SBuffer & buffer, VkBufferUsageFlags const usage, void const * data, VkDeviceSize const size)
+{
+    if (size == 0)
+    {
+        return true;
+    }
+    if (Reserve(buffer, usage, size) == false)
+    {
+        return false;
+    }
+
+    std::memcpy(buffer.mapped, data, static_cast<size_t>(size));
+    return true;
+}
+
+bool Renderer::VulkanIndirectDraw::Reserve(SBuffer & buffer, VkBufferUsageFlags const usage, VkDeviceSize const size)
+{
+    if (buffer.capacity < size)
+    {
+        // Only ever grows, with headroom so a scene growing a little each frame doesn't
+        // reallocate every time
+        Release(buffer);
+        VkDeviceSize const capacity = std::max<VkDeviceSize>(size + size / 2, 4096);
+
+        VkBufferCreateInfo buffer_info = {};
+        buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_info.size = capacity;
+        buffer_info.usage = usage;
+        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(m_logical_device, &buffer_info, nullptr, &buffer.buffer) != VK_SUCCESS)
+        {
+            ERROR_LOG("Failed to create draw buffer");
+            return false;
+        }
+
+        VkMemoryRequirements requirements = {};
+        vkGetBufferMemoryRequirements(m_logical_device, buffer.buffer, &requirements);
+
+        VkMemoryAllocateInfo alloc_info = {};
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.allocationSize = requirements.size;
+
+        if (FindMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, alloc_info.memoryTypeIndex) == false ||
+            vkAllocateMemory(m_logical_device, &alloc_info, nullptr, &buffer.memory) != VK_SUCCESS ||
+            vkBindBufferMemory(m_logical_device, buffer.buffer, buffer.memory, 0) != VK_SUCCESS ||
+            vkMapMemory(m_logical_device, buffer.memory, 0, capacity, 0, &buffer.mapped) != VK_SUCCESS)
+        {
+            ERROR_LOG("Failed to allocate draw buffer memory");
+            Release(buffer);
+            return false;
+        }
+        buffer.capacity = capacity;
+    }
+    return true;
+}
+
+bool Renderer::VulkanIndirectDraw::FindMemoryType(uint32_t const type_bits, VkMemoryPropertyFlags const properties, uint32_t & out_type) const
+{
+    VkPhysicalDeviceMemoryProperties memory_properties = {};
+    vkGetPhysicalDeviceMemoryProperties(m_physical_device, &memory_properties);
+
+    for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i)
+    {
+        if ((type_bits & (1u << i)) != 0 && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            out_type = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Renderer::VulkanIndirectDraw::Release(SBuffer & buffer)
+{
+    if (buffer.mapped != nullptr)
+    {
+        vkUnmapMemory(m_logical_device, buffer.memory);
+    }
+    if (buffer.buffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(m_logical_device, buffer.buffer, nullptr);
+    }
+    if (buffer.memory != VK_NULL_HANDLE)
+    {
+        vkFreeMemory(m_logical_device, buffer.memory, nullptr);
+    }
+    buffer = SBuffer();
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cinttypes>
+#include <vector>
+
+#include "renderer/draw/draw_batch.hpp"
+
+namespace Renderer
+{
+    // Draws a CDrawBatch with as few commands as the device allows. The batch's mesh pool lives in
+    // one set of host visible geometry buffers that only take the meshes it says are new, while
+    // the instances and commands go into buffers of their own per swapchain image so a frame
+    // never writes what another in flight is reading. The draws are vkCmdDrawIndexedIndirectCount when Vulkan 1.2's
+    // drawIndirectCount is there, one vkCmdDrawIndexedIndirect per maxDrawIndirectCount commands
+    // otherwise, and plain indexed draws if the device can't offset instances indirectly.
+    class VulkanIndirectDraw
+    {
+    public:
+        struct SFeatures
+        {
+            bool draw_indirect_count = false;
+            bool multi_draw_indirect = false;
+            bool draw_indirect_first_instance = false;
+            uint32_t max_draw_indirect_count = 1;
+        };
+
+        VulkanIndirectDraw(VkPhysicalDevice physical_device, VkDevice logical_device, SFeatures const & features);
+        ~VulkanIndirectDraw();
+
+        VulkanIndirectDraw(VulkanIndirectDraw const &) = delete;
+        VulkanIndirectDraw & operator=(VulkanIndirectDraw const &) = delete;
+
+        // Position, colour and per instance a transform taking locations 2 to 5 and a tint at 6,
+        // for the pipeline the batch is drawn with
+        static std::array<VkVertexInputBindingDescription, 3> GetBindingDescriptions();
+        static std::array<VkVertexInputAttributeDescription, 7> GetAttributeDescriptions();
+
+        // Copies the batch's new meshes into the geometry buffers and its instances and commands
+        // into the image's buffers, which the GPU has to be finished with
+        bool Upload(uint32_t const image_index, CDrawBatch const & batch);
+
+        // Binds the image's buffers and draws everything last uploaded to them. Goes inside a
+        // render pass with a pipeline using the descriptions above.
+        void Record(VkCommandBuffer command_buffer, uint32_t const image_index) const;
+
+        // Draws from the image's streams with commands a compute pass wrote instead of the
+        // batch's own, as many as it counted into draw_count and at most max_draw_count. Each
+        // command's first instance picks the batch instance it draws. Needs draw_indirect_count
+        // and draw_indirect_first_instance.
+        void RecordCulled(VkCommandBuffer command_buffer,
+                          uint32_t const image_index,
+                          VkBuffer draws,
+                          VkBuffer draw_count,
+                          uint32_t const max_draw_count) const;
+
+    private:
+        struct SBuffer
+        {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkDeviceSize capacity = 0;
+            void * mapped = nullptr;
+        };
+
+        struct SImageBuffers
+        {
+            SBuffer instances;
+            SBuffer commands;
+            SBuffer draw_count;
+            // Kept on the CPU as well for devices drawing them one by one
+            std::vector<SDrawCommand> cpu_commands;
+        };
+
+        void Bind(VkCommandBuffer command_buffer, SImageBuffers const & image) const;
+        bool UploadMeshes(CMeshPool const & mesh_pool);
+        bool Reserve(SBuffer & buffer, VkBufferUsageFlags const usage, VkDeviceSize const size);
+        bool Write(SBuffer & buffer, VkBufferUsageFlags const usage, void const * data, VkDeviceSize const size);
+        bool FindMemoryType(uint32_t const type_bits, VkMemoryPropertyFlags const properties, uint32_t & out_type) const;
+        void Release(SBuffer & buffer);
+
+        VkPhysicalDevice m_physical_device;
+        VkDevice m_logical_device;
+        SFeatures m_features;
+
+        // The mesh pool's geometry, shared by every image
+        SBuffer m_positions;
+        SBuffer m_colours;
+        SBuffer m_indices;
+        uint64_t m_mesh_generation;
+
+        std::vector<SImageBuffers> m_images;
+    };
+}
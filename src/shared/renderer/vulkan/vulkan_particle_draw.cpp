@@ -0,0 +1,318 @@
+#include "vulkan_particle_draw.hpp"
+
+#include "utility/logging.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace
+{
+    // Position x, y, z and life
+    constexpr uint32_t PARTICLE_STREAM_COUNT = 4;
+
+    // Drawn as a strip, the same corners as the GL backend
+    float const QUAD_CORNERS[] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+}
+
+Renderer::VulkanParticleDraw::VulkanParticleDraw(VkPhysicalDevice physical_device, VkDevice logical_device)
+: m_physical_device(physical_device)
+, m_logical_device(logical_device)
+, m_corners()
+, m_images()
+{
+}
+
+Renderer::VulkanParticleDraw::~VulkanParticleDraw()
+{
+    for (SImageBuffers & image : m_images)
+    {
+        Release(image.particles);
+    }
+    Release(m_corners);
+}
+
+std::array<VkVertexInputBindingDescription, 5> Renderer::VulkanParticleDraw::GetBindingDescriptions()
+{
+    std::array<VkVertexInputBindingDescription, 5> bindings = {};
+    bindings[0].binding = 0;
+    bindings[0].stride = sizeof(float) * 2;
+    bindings[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    // One binding per stream, all pointing into the same buffer at different offsets
+    for (uint32_t stream = 0; stream < PARTICLE_STREAM_COUNT; ++stream)
+    {
+        bindings[1 + stream].binding = 1 + stream;
+        bindings[1 + stream].stride = sizeof(float);
+        bindings[1 + stream].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+    }
+    return bindings;
+}
+
+std::array<VkVertexInputAttributeDescription, 5> Renderer::VulkanParticleDraw::GetAttributeDescriptions()
+{
+    std::array<VkVertexInputAttributeDescription, 5> attributes = {};
+    attributes[0].location = 0;
+    attributes[0].binding = 0;
+    attributes[0].format = VK_FORMAT_R32G32_SFLOAT;
+    attributes[0].offset = 0;
+
+    for (uint32_t stream = 0; stream < PARTICLE_STREAM_COUNT; ++stream)
+    {
+        attributes[1 + stream].location = 1 + stream;
+        attributes[1 + stream].binding = 1 + stream;
+        attributes[1 + stream].format = VK_FORMAT_R32_SFLOAT;
+        attributes[1 + stream].offset = 0;
+    }
+    return attributes;
+}
+
+std::array<VkVertexInputBindingDescription, 2> Renderer::VulkanParticleDraw::GetGpuBindingDescriptions()
+{
+    std::array<VkVertexInputBindingDescription, 2> bindings = {};
+    bindings[0].binding = 0;
+    bindings[0].stride = sizeof(float) * 2;
+    bindings[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    bindings[1].binding = 1;
+    bindings[1].stride = sizeof(SGpuParticle);
+    bindings[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+    return bindings;
+}
+
+std::array<VkVertexInputAttributeDescription, 5> Renderer::VulkanParticleDraw::GetGpuAttributeDescriptions()
+{
+    std::array<VkVertexInputAttributeDescription, 5> attributes = GetAttributeDescriptions();
+
+    // position_life holds x, y, z and life one float after another
+    for (uint32_t stream = 0; stream < PARTICLE_STREAM_COUNT; ++stream)
+    {
+        attributes[1 + stream].binding = 1;
+        attributes[1 + stream].offset = static_cast<uint32_t>(offsetof(SGpuParticle, position_life) + sizeof(float) * stream);
+    }
+    return attributes;
+}
+
+bool Renderer::VulkanParticleDraw::Upload(uint32_t const image_index,
+                                          std::vector<CParticleEmitter const *> const & emitters,
+                                          std::vector<VulkanGpuParticles const *> const & gpu_emitters)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    // The swapchain can come back with more images after a resize
+    if (image_index >= m_images.size())
+    {
+        m_images.resize(image_index + 1);
+    }
+
+    SImageBuffers & image = m_images[image_index];
+    image.draws.clear();
+    image.gpu_draws.clear();
+
+    size_t particle_count = 0;
+    for (CParticleEmitter const * emitter : emitters)
+    {
+        particle_count += emitter->GetCount();
+    }
+    if (particle_count == 0 && gpu_emitters.empty() == true)
+    {
+        return true;
+    }
+
+    if (m_corners.buffer == VK_NULL_HANDLE)
+    {
+        if (Reserve(m_corners, sizeof(QUAD_CORNERS)) == false)
+        {
+            return false;
+        }
+        std::memcpy(m_corners.mapped, QUAD_CORNERS, sizeof(QUAD_CORNERS));
+    }
+
+    for (VulkanGpuParticles const * gpu_emitter : gpu_emitters)
+    {
+        SEmitterDraw draw;
+        draw.gpu_buffer = gpu_emitter->GetParticleBuffer();
+        draw.count = gpu_emitter->GetCount();
+        draw.constants = GetConstants(gpu_emitter->GetSettings());
+        if (draw.gpu_buffer != VK_NULL_HANDLE && draw.count > 0)
+        {
+            image.gpu_draws.emplace_back(draw);
+        }
+    }
+
+    if (particle_count == 0)
+    {
+        return true;
+    }
+
+    if (Reserve(image.particles, sizeof(float) * PARTICLE_STREAM_COUNT * particle_count) == false)
+    {
+        return false;
+    }
+
+    uint8_t * const region = static_cast<uint8_t *>(image.particles.mapped);
+    VkDeviceSize written = 0;
+    for (CParticleEmitter const * emitter : emitters)
+    {
+        uint32_t const count = emitter->GetCount();
+        if (count == 0)
+        {
+            continue;
+        }
+
+        SEmitterDraw draw;
+        draw.offset = written;
+        draw.count = count;
+        draw.constants = GetConstants(emitter->GetSettings());
+        image.draws.emplace_back(draw);
+
+        size_t const stream_size = count * sizeof(float);
+        float const * streams[] = { emitter->GetPositionsX(), emitter->GetPositionsY(), emitter->GetPositionsZ(), emitter->GetLives() };
+        for (float const * stream : streams)
+        {
+            std::memcpy(region + written, stream, stream_size);
+            written += stream_size;
+        }
+    }
+    return true;
+}
+
+void Renderer::VulkanParticleDraw::Record(VkCommandBuffer command_buffer,
+                                          uint32_t const image_index,
+                                          VkPipeline pipeline,
+                                          VkPipeline gpu_pipeline,
+                                          VkPipelineLayout layout,
+                                          glm::mat4 const & view_projection) const
+{
+    if (image_index >= m_images.size())
+    {
+        return;
+    }
+
+    SImageBuffers const & image = m_images[image_index];
+    if (image.gpu_draws.empty() == false && gpu_pipeline != VK_NULL_HANDLE)
+    {
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, gpu_pipeline);
+
+        for (SEmitterDraw const & draw : image.gpu_draws)
+        {
+            VkBuffer const vertex_buffers[] = { m_corners.buffer, draw.gpu_buffer };
+            VkDeviceSize const offsets[] = { 0, 0 };
+            vkCmdBindVertexBuffers(command_buffer, 0, 2, vertex_buffers, offsets);
+
+            SConstants constants = draw.constants;
+            constants.view_projection = view_projection;
+            vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(SConstants), &constants);
+
+            vkCmdDraw(command_buffer, 4, draw.count, 0, 0);
+        }
+    }
+
+    if (image.draws.empty() == true)
+    {
+        return;
+    }
+
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+
+    for (SEmitterDraw const & draw : image.draws)
+    {
+        VkDeviceSize const stream_size = draw.count * sizeof(float);
+        VkBuffer const vertex_buffers[] = { m_corners.buffer, image.particles.buffer, image.particles.buffer, image.particles.buffer, image.particles.buffer };
+        VkDeviceSize const offsets[] = { 0, draw.offset, draw.offset + stream_size, draw.offset + stream_size * 2, draw.offset + stream_size * 3 };
+        vkCmdBindVertexBuffers(command_buffer, 0, 5, vertex_buffers, offsets);
+
+        SConstants constants = draw.constants;
+        constants.view_projection = view_projection;
+        vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(SConstants), &constants);
+
+        vkCmdDraw(command_buffer, 4, draw.count, 0, 0);
+    }
+}
+
+Renderer::VulkanParticleDraw::SConstants Renderer::VulkanParticleDraw::GetConstants(SParticleEmitterSettings const & settings)
+{
+    SConstants constants;
+    constants.start_colour = settings.start_colour;
+    constants.end_colour = settings.end_colour;
+    constants.size = glm::vec4(settings.start_size, settings.end_size, 0.0f, 0.0f);
+    return constants;
+}
+
+bool Renderer::VulkanParticleDraw::Reserve(SBuffer & buffer, VkDeviceSize const size)
+{
+    if (buffer.capacity >= size)
+    {
+        return true;
+    }
+
+    // Only ever grows, with headroom so an emitter filling up over a few frames doesn't
+    // reallocate every time
+    Release(buffer);
+    VkDeviceSize const capacity = std::max<VkDeviceSize>(size + size / 2, 4096);
+
+    VkBufferCreateInfo buffer_info = {};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size = capacity;
+    buffer_info.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(m_logical_device, &buffer_info, nullptr, &buffer.buffer) != VK_SUCCESS)
+    {
+        ERROR_LOG("Failed to create particle buffer");
+        return false;
+    }
+
+    VkMemoryRequirements requirements = {};
+    vkGetBufferMemoryRequirements(m_logical_device, buffer.buffer, &requirements);
+
+    VkMemoryAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = requirements.size;
+
+    if (FindMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, alloc_info.memoryTypeIndex) == false ||
+        vkAllocateMemory(m_logical_device, &alloc_info, nullptr, &buffer.memory) != VK_SUCCESS ||
+        vkBindBufferMemory(m_logical_device, buffer.buffer, buffer.memory, 0) != VK_SUCCESS ||
+        vkMapMemory(m_logical_device, buffer.memory, 0, capacity, 0, &buffer.mapped) != VK_SUCCESS)
+    {
+        ERROR_LOG("Failed to allocate particle buffer memory");
+        Release(buffer);
+        return false;
+    }
+    buffer.capacity = capacity;
+    return true;
+}
+
+bool Renderer::VulkanParticleDraw::FindMemoryType(uint32_t const type_bits, VkMemoryPropertyFlags const properties, uint32_t & out_type) const
+{
+    VkPhysicalDeviceMemoryProperties memory_properties = {};
+    vkGetPhysicalDeviceMemoryProperties(m_physical_device, &memory_properties);
+
+    for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i)
+    {
+        if ((type_bits & (1u << i)) != 0 && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            out_type = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Renderer::VulkanParticleDraw::Release(SBuffer & buffer)
+{
+    if (buffer.mapped != nullptr)
+    {
+        vkUnmapMemory(m_logical_device, buffer.memory);
+    }
+    if (buffer.buffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(m_logical_device, buffer.buffer, nullptr);
+    }
+    if (buffer.memory != VK_NULL_HANDLE)
+    {
+        vkFreeMemory(m_logical_device, buffer.memory, nullptr);
+    }
+    buffer = SBuffer();
+}
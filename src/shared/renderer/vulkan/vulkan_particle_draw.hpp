@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include <array>
+#include <cinttypes>
+#include <vector>
+
+#include "renderer/particles/particle_emitter.hpp"
+#include "renderer/vulkan/vulkan_gpu_particles.hpp"
+
+namespace Renderer
+{
+    // Draws particle emitters as instanced camera facing quads, the same way the GL backend does.
+    // Each emitter's position and life arrays are copied as they are into a host visible buffer,
+    // one per swapchain image, and read back as four per instance streams so nothing is
+    // interleaved on the CPU. Pools simulated on the GPU are drawn straight from their particle
+    // buffers with a second pipeline reading the same attributes out of SGpuParticle.
+    class VulkanParticleDraw
+    {
+    public:
+        // Pushed for each emitter's draw, laid out to match particle_vertex.hlsl
+        struct SConstants
+        {
+            glm::mat4 view_projection = glm::mat4(1.0f);
+            glm::vec4 start_colour = glm::vec4(1.0f);
+            glm::vec4 end_colour = glm::vec4(1.0f);
+            // x is the size at spawn, y at death
+            glm::vec4 size = glm::vec4(0.0f);
+        };
+
+        VulkanParticleDraw(VkPhysicalDevice physical_device, VkDevice logical_device);
+        ~VulkanParticleDraw();
+
+        VulkanParticleDraw(VulkanParticleDraw const &) = delete;
+        VulkanParticleDraw & operator=(VulkanParticleDraw const &) = delete;
+
+        // A quad corner per vertex, then position x, y, z and life per instance each from its own
+        // binding, for the pipeline the particles are drawn with
+        static std::array<VkVertexInputBindingDescription, 5> GetBindingDescriptions();
+        static std::array<VkVertexInputAttributeDescription, 5> GetAttributeDescriptions();
+        // The same locations with the particle ones read per instance out of SGpuParticle
+        static std::array<VkVertexInputBindingDescription, 2> GetGpuBindingDescriptions();
+        static std::array<VkVertexInputAttributeDescription, 5> GetGpuAttributeDescriptions();
+
+        // Copies the emitters' live particles into the image's buffer, which the GPU has to be
+        // finished with, and notes which GPU pools to draw
+        bool Upload(uint32_t const image_index,
+                    std::vector<CParticleEmitter const *> const & emitters,
+                    std::vector<VulkanGpuParticles const *> const & gpu_emitters);
+
+        // One instanced strip per emitter last uploaded to the image. Goes inside a render pass,
+        // the pipelines have to use the descriptions above and both take SConstants as their
+        // push constants through layout.
+        void Record(VkCommandBuffer command_buffer,
+                    uint32_t const image_index,
+                    VkPipeline pipeline,
+                    VkPipeline gpu_pipeline,
+                    VkPipelineLayout layout,
+                    glm::mat4 const & view_projection) const;
+
+    private:
+        struct SBuffer
+        {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkDeviceSize capacity = 0;
+            void * mapped = nullptr;
+        };
+
+        struct SEmitterDraw
+        {
+            // The GPU pool's own buffer, or null for streams in the image's buffer
+            VkBuffer gpu_buffer = VK_NULL_HANDLE;
+            VkDeviceSize offset = 0;
+            uint32_t count = 0;
+            SConstants constants;
+        };
+
+        struct SImageBuffers
+        {
+            SBuffer particles;
+            std::vector<SEmitterDraw> draws;
+            std::vector<SEmitterDraw> gpu_draws;
+        };
+
+        static SConstants GetConstants(SParticleEmitterSettings const & settings);
+
+        bool Reserve(SBuffer & buffer, VkDeviceSize const size);
+        bool FindMemoryType(uint32_t const type_bits, VkMemoryPropertyFlags const properties, uint32_t & out_type) const;
+        void Release(SBuffer & buffer);
+
+        VkPhysicalDevice m_physical_device;
+        VkDevice m_logical_device;
+
+        // Never changes, shared by every image
+        SBuffer m_corners;
+        std::vector<SImageBuffers> m_images;
+    };
+}
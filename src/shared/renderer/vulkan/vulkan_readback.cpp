@@ -0,0 +1,258 @@
+#include "vulkan_readback.hpp"
+
+#include "utility/logging.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+#include <cstring>
+#include <string>
+#include <utility>
+
+Renderer::VulkanReadback::VulkanReadback(VkPhysicalDevice physical_device, VkDevice logical_device)
+: m_physical_device(physical_device)
+, m_logical_device(logical_device)
+, m_slots()
+, m_next_slot(0)
+, m_pending_count(0)
+, m_finished()
+{
+}
+
+Renderer::VulkanReadback::~VulkanReadback()
+{
+    for (SSlot & slot : m_slots)
+    {
+        Release(slot);
+    }
+}
+
+bool Renderer::VulkanReadback::Record(VkCommandBuffer command_buffer,
+                                      VkImage image,
+                                      VkImageLayout const layout,
+                                      VkFormat const format,
+                                      VkExtent2D const extent,
+                                      VkFence frame_fence,
+                                      uint64_t const frame_index)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    if (m_pending_count == VULKAN_READBACK_SLOT_COUNT)
+    {
+        ResolveOldest(true);
+    }
+
+    SSlot & slot = m_slots[m_next_slot];
+    VkDeviceSize const size = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+    if (slot.capacity < size && Allocate(slot, size) == false)
+    {
+        return false;
+    }
+
+    VkImageMemoryBarrier to_transfer = {};
+    to_transfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    to_transfer.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    to_transfer.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    to_transfer.oldLayout = layout;
+    to_transfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    to_transfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    to_transfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    to_transfer.image = image;
+    to_transfer.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    to_transfer.subresourceRange.levelCount = 1;
+    to_transfer.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &to_transfer);
+
+    VkBufferImageCopy region = {};
+    region.bufferOffset = 0;
+    // Zero means tightly packed rows
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = { 0, 0, 0 };
+    region.imageExtent = { extent.width, extent.height, 1 };
+
+    vkCmdCopyImageToBuffer(command_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.buffer, 1, &region);
+
+    // Back to whatever comes next expects, presenting or the next frame's render pass
+    VkImageMemoryBarrier to_original = to_transfer;
+    to_original.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    to_original.dstAccessMask = 0;
+    to_original.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    to_original.newLayout = layout;
+
+    // And the copy made visible to the host once the fence is signalled
+    VkBufferMemoryBarrier to_host = {};
+    to_host.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    to_host.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    to_host.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    to_host.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    to_host.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    to_host.buffer = slot.buffer;
+    to_host.offset = 0;
+    to_host.size = size;
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+                         0,
+                         0, nullptr,
+                         1, &to_host,
+                         1, &to_original);
+
+    slot.fence = frame_fence;
+    slot.format = format;
+    slot.extent = extent;
+    slot.frame_index = frame_index;
+
+    m_next_slot = (m_next_slot + 1) % VULKAN_READBACK_SLOT_COUNT;
+    ++m_pending_count;
+    return true;
+}
+
+bool Renderer::VulkanReadback::Pop(SCapturedFrame & out_frame, bool const wait)
+{
+    if (m_finished.empty() == true && m_pending_count > 0)
+    {
+        ResolveOldest(wait);
+    }
+
+    if (m_finished.empty() == true)
+    {
+        return false;
+    }
+
+    out_frame = std::move(m_finished.front());
+    m_finished.pop_front();
+    return true;
+}
+
+bool Renderer::VulkanReadback::ResolveOldest(bool const wait)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    SSlot & slot = m_slots[(m_next_slot + VULKAN_READBACK_SLOT_COUNT - m_pending_count) % VULKAN_READBACK_SLOT_COUNT];
+
+    // The frame fences are reused, so by now this one may guard a later frame instead. Frames
+    // finish in order, so that only ever means waiting a little longer than needed.
+    VkResult const result = wait == true
+        ? vkWaitForFences(m_logical_device, 1, &slot.fence, VK_TRUE, UINT64_MAX)
+        : vkGetFenceStatus(m_logical_device, slot.fence);
+    if (result == VK_NOT_READY || result == VK_TIMEOUT)
+    {
+        return false;
+    }
+
+    slot.fence = VK_NULL_HANDLE;
+    --m_pending_count;
+
+    if (result != VK_SUCCESS)
+    {
+        ERROR_LOG("Waiting on a frame fence failed, dropping the capture of frame " + std::to_string(slot.frame_index));
+        return false;
+    }
+
+    SCapturedFrame frame;
+    frame.frame_index = slot.frame_index;
+    frame.width = slot.extent.width;
+    frame.height = slot.extent.height;
+    frame.pixels.resize(static_cast<size_t>(frame.width) * frame.height * 4);
+    std::memcpy(frame.pixels.data(), slot.mapped, frame.pixels.size());
+
+    // Swapchains usually come back BGRA, captures are always RGBA
+    if (slot.format == VK_FORMAT_B8G8R8A8_UNORM || slot.format == VK_FORMAT_B8G8R8A8_SRGB)
+    {
+        for (size_t i = 0; i < frame.pixels.size(); i += 4)
+        {
+            std::swap(frame.pixels[i], frame.pixels[i + 2]);
+        }
+    }
+
+    m_finished.emplace_back(std::move(frame));
+    return true;
+}
+
+bool Renderer::VulkanReadback::Allocate(SSlot & slot, VkDeviceSize const size)
+{
+    Release(slot);
+
+    VkBufferCreateInfo buffer_info = {};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size = size;
+    buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(m_logical_device, &buffer_info, nullptr, &slot.buffer) != VK_SUCCESS)
+    {
+        ERROR_LOG("Failed to create readback buffer");
+        return false;
+    }
+
+    VkMemoryRequirements requirements = {};
+    vkGetBufferMemoryRequirements(m_logical_device, slot.buffer, &requirements);
+
+    VkMemoryAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = requirements.size;
+
+    // Cached memory makes the CPU's read back out of it far quicker, coherent saves the
+    // invalidate. Any host visible memory does if there's nothing with both.
+    VkMemoryPropertyFlags const preferred = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+    VkMemoryPropertyFlags const required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    bool const found = FindMemoryType(requirements.memoryTypeBits, preferred, alloc_info.memoryTypeIndex)
+        || FindMemoryType(requirements.memoryTypeBits, required, alloc_info.memoryTypeIndex);
+
+    if (found == false ||
+        vkAllocateMemory(m_logical_device, &alloc_info, nullptr, &slot.memory) != VK_SUCCESS ||
+        vkBindBufferMemory(m_logical_device, slot.buffer, slot.memory, 0) != VK_SUCCESS ||
+        vkMapMemory(m_logical_device, slot.memory, 0, size, 0, &slot.mapped) != VK_SUCCESS)
+    {
+        ERROR_LOG("Failed to allocate readback buffer memory");
+        Release(slot);
+        return false;
+    }
+
+    slot.capacity = size;
+    return true;
+}
+
+void Renderer::VulkanReadback::Release(SSlot & slot)
+{
+    if (slot.mapped != nullptr)
+    {
+        vkUnmapMemory(m_logical_device, slot.memory);
+    }
+    if (slot.buffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(m_logical_device, slot.buffer, nullptr);
+    }
+    if (slot.memory != VK_NULL_HANDLE)
+    {
+        vkFreeMemory(m_logical_device, slot.memory, nullptr);
+    }
+    slot = SSlot();
+}
+
+bool Renderer::VulkanReadback::FindMemoryType(uint32_t const type_bits, VkMemoryPropertyFlags const properties, uint32_t & out_type) const
+{
+    VkPhysicalDeviceMemoryProperties memory_properties = {};
+    vkGetPhysicalDeviceMemoryProperties(m_physical_device, &memory_properties);
+
+    for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i)
+    {
+        if ((type_bits & (1u << i)) != 0 && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            out_type = i;
+            return true;
+        }
+    }
+    return false;
+}
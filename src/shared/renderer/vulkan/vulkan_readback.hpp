@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cinttypes>
+#include <deque>
+
+#include "renderer/capture/captured_frame.hpp"
+
+namespace Renderer
+{
+    // Copies in flight at once, another request waits for the oldest
+    constexpr uint32_t VULKAN_READBACK_SLOT_COUNT = 3;
+
+    // Frame captures copied into host visible buffers by the frame's own command buffer. Nothing
+    // waits for the copy when it's recorded, the frame's fence says when the pixels can be read.
+    class VulkanReadback
+    {
+    public:
+        VulkanReadback(VkPhysicalDevice physical_device, VkDevice logical_device);
+        ~VulkanReadback();
+
+        VulkanReadback(VulkanReadback const &) = delete;
+        VulkanReadback & operator=(VulkanReadback const &) = delete;
+
+        // Records a copy of the image after the render pass that drew it. The image has to be
+        // created with transfer source usage and is left in the layout it's in, frame_fence is
+        // the fence the command buffer is going to be submitted with.
+        bool Record(VkCommandBuffer command_buffer,
+                    VkImage image,
+                    VkImageLayout const layout,
+                    VkFormat const format,
+                    VkExtent2D const extent,
+                    VkFence frame_fence,
+                    uint64_t const frame_index);
+
+        bool Pop(SCapturedFrame & out_frame, bool const wait);
+
+    private:
+        struct SSlot
+        {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkDeviceSize capacity = 0;
+            void * mapped = nullptr;
+            // Only set while the copy is outstanding
+            VkFence fence = VK_NULL_HANDLE;
+            VkFormat format = VK_FORMAT_UNDEFINED;
+            VkExtent2D extent = {};
+            uint64_t frame_index = 0;
+        };
+
+        // Moves the oldest copy into m_finished if it's done, or once it is with wait set
+        bool ResolveOldest(bool const wait);
+
+        bool Allocate(SSlot & slot, VkDeviceSize const size);
+        void Release(SSlot & slot);
+        bool FindMemoryType(uint32_t const type_bits, VkMemoryPropertyFlags const properties, uint32_t & out_type) const;
+
+        VkPhysicalDevice m_physical_device;
+        VkDevice m_logical_device;
+
+        std::array<SSlot, VULKAN_READBACK_SLOT_COUNT> m_slots;
+        uint32_t m_next_slot;
+        uint32_t m_pending_count;
+        std::deque<SCapturedFrame> m_finished;
+    };
+}
@@ -3,7 +3,9 @@
 #include "utility/logging.hpp"
 #include "utility/optional.hpp"
 #include "utility/file/file_helper.hpp"
+#include "utility/memory/memory_tracker.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cinttypes>
 #include <iostream>
@@ -16,12 +18,22 @@
 
 constexpr bool bVerbose = false;
 constexpr size_t MAX_FRAMES_IN_FLIGHT = 2;
+// A GPU particle pool catching up after a stall moves on by at most this much in one step
+constexpr double MAX_GPU_PARTICLE_STEP = 0.1;
 
 namespace
 {
+    // OpenGL's clip space to Vulkan's, where y points down and depth runs 0 to 1
+    glm::mat4 const gl_to_vulkan_clip(glm::vec4(1.0f, 0.0f, 0.0f, 0.0f),
+                                      glm::vec4(0.0f, -1.0f, 0.0f, 0.0f),
+                                      glm::vec4(0.0f, 0.0f, 0.5f, 0.0f),
+                                      glm::vec4(0.0f, 0.0f, 0.5f, 1.0f));
+
     struct SQueueFamilyIndices {
         GOAT::optional<uint32_t> graphicsFamily;
         GOAT::optional<uint32_t> presentFamily;
+        // Not needed to render, compute work is skipped without it
+        GOAT::optional<uint32_t> computeFamily;
 
         bool isComplete() const
         {
@@ -37,6 +49,13 @@ namespace
             indices.graphicsFamily.Value(),
             indices.presentFamily.Value()
         };
+        if (indices.computeFamily.HasValue() == true)
+        {
+            queue_families.insert(indices.computeFamily.Value());
+        }
+
+        // Has to outlive the create infos pointing at it
+        static float const priorities = 1.0f;
 
         for (uint32_t const queue_family : queue_families)
         {
@@ -45,8 +64,6 @@ namespace
             queue_info.queueFamilyIndex = queue_family;
             queue_info.pNext = nullptr;
             queue_info.queueCount = 1;
-
-            float priorities = 1.0f;
             queue_info.pQueuePriorities = &priorities;
 
             queue_create_infos.emplace_back(queue_info);
@@ -73,8 +90,16 @@ namespace
                 indices.graphicsFamily = i;
             }
 
+            // Headless has nothing to present to, the graphics queue stands in
             VkBool32 present_support = false;
-            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present_support);
+            if (surface != VK_NULL_HANDLE)
+            {
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present_support);
+            }
+            else
+            {
+                present_support = (queue.queueFlags & VK_QUEUE_GRAPHICS_BIT) == VK_QUEUE_GRAPHICS_BIT;
+            }
             if (present_support == true)
             {
                 indices.presentFamily = i;
@@ -87,6 +112,12 @@ namespace
             i++;
         }
 
+        uint32_t compute_family = 0;
+        if (Renderer::find_compute_queue_family(device, compute_family) == true)
+        {
+            indices.computeFamily = compute_family;
+        }
+
         return indices;
     }
 // ------------------------------------------------------------------------------------------------------------------------- //
@@ -223,6 +254,13 @@ namespace
     bool const is_device_suitable(VkPhysicalDevice device, VkSurfaceKHR surface)
     {
         SQueueFamilyIndices const family_queue = find_queue_families(device, surface);
+
+        // Without a surface there's no swapchain, so neither its extension nor its formats matter
+        if (surface == VK_NULL_HANDLE)
+        {
+            return family_queue.graphicsFamily.HasValue() == true;
+        }
+
         bool const extensions_supported = check_device_extension_support(device);
 
         bool swap_chain_adequate = false;
@@ -293,9 +331,12 @@ VkShaderModule create_shader_module(VkDevice device, std::vector<char> const & s
 
 // ------------------------------------------------------------------------------------------------------------------------- //
 
-Renderer::VulkanRenderContext::VulkanRenderContext(GLFWwindow * glfw_window)
+Renderer::VulkanRenderContext::VulkanRenderContext(GLFWwindow * glfw_window, bool const headless)
 : m_ptr_glfw_window(glfw_window)
+, m_headless(headless)
 {
+    SetViewProjection(glm::mat4(1.0f));
+
     VkApplicationInfo app_info;
     app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
     app_info.pApplicationName = "GOAT Engine app";
@@ -308,9 +349,13 @@ Renderer::VulkanRenderContext::VulkanRenderContext(GLFWwindow * glfw_window)
     create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     create_info.pApplicationInfo = &app_info;
 
+    // Only presenting needs the window system's surface extensions
     uint32_t glfw_extension_count = 0;
-    const char ** glfw_extensions;
-    glfw_extensions = glfwGetRequiredInstanceExtensions(&glfw_extension_count);
+    const char ** glfw_extensions = nullptr;
+    if (m_headless == false)
+    {
+        glfw_extensions = glfwGetRequiredInstanceExtensions(&glfw_extension_count);
+    }
 
     create_info.ppEnabledExtensionNames = glfw_extensions;
     create_info.enabledExtensionCount = glfw_extension_count;
@@ -323,7 +368,11 @@ Renderer::VulkanRenderContext::VulkanRenderContext(GLFWwindow * glfw_window)
         m_last_error = "Failed to create Vulkan instance";
     }
 
-    if (HasError() == false)
+    if (m_headless == true)
+    {
+        m_final_layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    }
+    else if (HasError() == false)
     {
         if (glfwCreateWindowSurface(m_instance, glfw_window, nullptr, &m_surface) != VK_SUCCESS)
         {
@@ -337,7 +386,19 @@ Renderer::VulkanRenderContext::~VulkanRenderContext()
     // Wait for current work to finish before cleaning up
     vkDeviceWaitIdle(m_logical_device);
 
+    // Textures go before the device and the command pool uploads are recorded from
+    m_texture_backend.reset();
+    m_gpu_emitters.clear();
+    m_retired_gpu_emitters.clear();
+    m_gpu_culler.reset();
+    m_compute.reset();
+    m_indirect_draw.reset();
+    m_particle_draw.reset();
+    m_readback.reset();
+    m_gpu_timer.reset();
+
     CleanupSwapChain();
+    m_scene_target.reset();
 
     for (auto const fence : m_inflight_fences)
     {
@@ -495,11 +556,62 @@ bool Renderer::VulkanRenderContext::Init()
         return false;
     }
 
+    m_texture_backend = std::make_unique<VulkanTextureBackend>(m_physical_device, m_logical_device, m_graphics_queue, m_command_pool);
+
+    m_indirect_draw = std::make_unique<VulkanIndirectDraw>(m_physical_device, m_logical_device, m_indirect_features);
+    m_particle_draw = std::make_unique<VulkanParticleDraw>(m_physical_device, m_logical_device);
+    m_readback = std::make_unique<VulkanReadback>(m_physical_device, m_logical_device);
+    m_scene_target = std::make_unique<VulkanSceneTarget>(m_physical_device, m_logical_device);
+
+    SQueueFamilyIndices const indices = find_queue_families(m_physical_device, m_surface);
+    if (indices.computeFamily.HasValue() == true)
+    {
+        m_compute = std::make_unique<VulkanCompute>(m_physical_device,
+                                                    m_logical_device,
+                                                    indices.computeFamily.Value(),
+                                                    indices.graphicsFamily.Value());
+        if (m_compute->Init() == true)
+        {
+            DEBUG_LOG("Compute queue created");
+
+            // The culled commands' count is only known on the GPU and each starts at its own
+            // instance
+            if (m_indirect_features.draw_indirect_count == true && m_indirect_features.draw_indirect_first_instance == true)
+            {
+                m_gpu_culler = std::make_unique<VulkanGpuCuller>(*m_compute);
+                if (m_gpu_culler->Init() == true)
+                {
+                    DEBUG_LOG("Culling on the GPU");
+                }
+                else
+                {
+                    ERROR_LOG("Failed to create the GPU culler, culling on the CPU");
+                    m_gpu_culler.reset();
+                }
+            }
+        }
+        else
+        {
+            // Rendering doesn't depend on it, so carry on without
+            ERROR_LOG("Failed to create compute queue");
+            m_compute.reset();
+        }
+    }
+
+    m_gpu_timer = std::make_unique<VulkanGpuTimer>(m_physical_device, m_logical_device, indices.graphicsFamily.Value());
+    if (m_gpu_timer->Init() == false)
+    {
+        DEBUG_LOG("Graphics queue has no timestamps, frames won't be timed on the GPU");
+        m_gpu_timer.reset();
+    }
+
     return true;
 }
 
 void Renderer::VulkanRenderContext::ResizeScreen(uint32_t const width, uint32_t const height)
 {
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
     DEBUG_LOG("Recreating swap chain");
     RecreateSwapChain();
 }
@@ -508,23 +620,77 @@ void Renderer::VulkanRenderContext::PreRender()
 {
 }
 
+void Renderer::VulkanRenderContext::SetViewProjection(glm::mat4 const & view_projection)
+{
+    m_view_projection = gl_to_vulkan_clip * view_projection;
+}
+
 void Renderer::VulkanRenderContext::RenderFrame()
 {
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
     vkWaitForFences(m_logical_device, 1, &m_inflight_fences[m_current_frame], VK_TRUE, UINT64_MAX);
 
     uint32_t image_index = 0;
-    VkResult result = vkAcquireNextImageKHR(m_logical_device,
-                                            m_swapchain,
-                                            UINT64_MAX,
-                                            m_image_available_semaphores[m_current_frame],
-                                            VK_NULL_HANDLE,
-                                            &image_index);
+    VkResult result = VK_SUCCESS;
+    if (m_headless == true)
+    {
+        // Offscreen images are simply used in turn, nothing has to hand them back
+        image_index = m_next_offscreen_image;
+        m_next_offscreen_image = (m_next_offscreen_image + 1) % static_cast<uint32_t>(m_swapchain_images.size());
+    }
+    else
+    {
+        result = vkAcquireNextImageKHR(m_logical_device,
+                                       m_swapchain,
+                                       UINT64_MAX,
+                                       m_image_available_semaphores[m_current_frame],
+                                       VK_NULL_HANDLE,
+                                       &image_index);
+    }
+
+    // The image's command buffer and draw buffers are rewritten below, so whichever frame last
+    // used them has to be done
+    if(m_images_inflight[image_index] != VK_NULL_HANDLE)
+    {
+        vkWaitForFences(m_logical_device, 1, &m_images_inflight[image_index], VK_TRUE, UINT64_MAX);
+    }
+    m_images_inflight[image_index] = m_inflight_fences[m_current_frame];
+
+    // Every frame up to MAX_FRAMES_IN_FLIGHT ago is done after the wait at the top
+    m_retired_gpu_emitters.erase(std::remove_if(m_retired_gpu_emitters.begin(), m_retired_gpu_emitters.end(),
+                                                [this](std::pair<uint64_t, std::unique_ptr<VulkanGpuParticles>> const & retired)
+                                                {
+                                                    return retired.first + MAX_FRAMES_IN_FLIGHT <= m_frame_index;
+                                                }),
+                                 m_retired_gpu_emitters.end());
+
+    // Whatever the image's last frame timed is finished now
+    if (m_gpu_timer != nullptr)
+    {
+        m_gpu_timer->Resolve(image_index);
+        m_dynamic_resolution.Update(m_gpu_timer->GetLatest(), m_frame_index);
+    }
 
-    if(m_images_inflight[m_current_frame] != VK_NULL_HANDLE)
+    m_dynamic_resolution.GetScaledSize(m_surface_extent.width, m_surface_extent.height, m_scene_extent.width, m_scene_extent.height);
+    m_scene_scaled = false;
+    if (m_dynamic_resolution.IsEnabled() == true && m_upscale_supported == true)
     {
-        vkWaitForFences(m_logical_device, 1, &m_images_inflight[m_current_frame], VK_TRUE, UINT64_MAX);
+        // Made the first time it's needed, the device is idle after a resize so nothing is
+        // still using the old images
+        if (m_scene_target->IsCreated() == false &&
+            m_scene_target->Create(m_swapchain_format, m_surface_extent, static_cast<uint32_t>(m_swapchain_images.size())) == false)
+        {
+            ERROR_LOG("Failed to create the dynamic resolution target, drawing at full resolution");
+            m_upscale_supported = false;
+        }
+        m_scene_scaled = m_scene_target->IsCreated() == true &&
+                         (m_scene_extent.width != m_surface_extent.width || m_scene_extent.height != m_surface_extent.height);
+    }
+    if (m_scene_scaled == false)
+    {
+        m_scene_extent = m_surface_extent;
     }
-    m_images_inflight[m_current_frame] = m_inflight_fences[m_current_frame];
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR)
     {
@@ -535,12 +701,113 @@ void Renderer::VulkanRenderContext::RenderFrame()
         DEBUG_LOG("VK_SUBOPTIMAL_KHR");
     }
 
+    m_draw_batch.Clear();
+    if (m_gpu_culler == nullptr)
+    {
+        m_cull_stats = m_frustum_culler.Cull(extract_frustum(m_view_projection, EClipDepth::ZeroToOne));
+
+        for (size_t i = 0; i < m_submitted_renderables.size(); ++i)
+        {
+            if (m_frustum_culler.IsVisible(static_cast<uint32_t>(i)) == true)
+            {
+                m_draw_batch.Add(*m_submitted_renderables[i]);
+            }
+        }
+    }
+    else
+    {
+        // Everything is batched and each instance gets a cull object, in instance order, so a
+        // culled command's first instance finds its transform again
+        m_cull_objects.clear();
+        for (IRenderable const * renderable : m_submitted_renderables)
+        {
+            size_t const instance_count = m_draw_batch.GetInstances().size();
+            m_draw_batch.Add(*renderable);
+            if (m_draw_batch.GetInstances().size() == instance_count)
+            {
+                continue;
+            }
+
+            SAabb const bounds = transform_aabb(renderable->GetMesh().GetLocalBounds(), renderable->GetTransformMatrix());
+
+            SGpuCullObject object;
+            object.centre = glm::vec4(bounds.Centre(), 0.0f);
+            object.extents = glm::vec4(bounds.Extents(), 0.0f);
+            m_cull_objects.emplace_back(object);
+        }
+    }
+    m_draw_batch.Finish();
+
+    // Where each instance's geometry is in the mesh pool is only known once the batch is finished
+    if (m_gpu_culler != nullptr)
+    {
+        for (SDrawCommand const & command : m_draw_batch.GetCommands())
+        {
+            for (uint32_t instance = 0; instance < command.instance_count; ++instance)
+            {
+                SGpuCullObject & object = m_cull_objects[command.base_instance + instance];
+                object.index_count = command.index_count;
+                object.first_index = command.first_index;
+                object.vertex_offset = command.base_vertex;
+            }
+        }
+    }
+    m_submitted_renderables.clear();
+    m_frustum_culler.Clear();
+
+    if (m_gpu_culler != nullptr || m_submitted_gpu_emitters.empty() == false)
+    {
+        RecordCompute();
+    }
+
+    // Pools that weren't submitted this frame are done with once the frames drawing them are
+    m_drawn_gpu_emitters.clear();
+    for (auto it = m_gpu_emitters.begin(); it != m_gpu_emitters.end();)
+    {
+        if (it->second.last_frame != m_frame_index)
+        {
+            m_retired_gpu_emitters.emplace_back(it->second.last_frame, std::move(it->second.particles));
+            it = m_gpu_emitters.erase(it);
+            continue;
+        }
+        if (it->second.particles != nullptr)
+        {
+            m_drawn_gpu_emitters.emplace_back(it->second.particles.get());
+        }
+        ++it;
+    }
+    m_submitted_gpu_emitters.clear();
+
+    m_indirect_draw->Upload(image_index, m_draw_batch);
+    m_particle_draw->Upload(image_index, m_submitted_emitters, m_drawn_gpu_emitters);
+    m_submitted_emitters.clear();
+    if (RecordCommandBuffer(image_index) == false)
+    {
+        return;
+    }
+
     VkSubmitInfo submit_info = {};
     submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-    VkSemaphore wait_semaphores[] = { m_image_available_semaphores[m_current_frame] };
-    VkPipelineStageFlags wait_stages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-    submit_info.waitSemaphoreCount = 1;
+    // Compute recorded this frame has to finish before its output is drawn from
+    VkSemaphore const compute_semaphore = m_compute != nullptr ? m_compute->Submit() : VK_NULL_HANDLE;
+
+    // Headless images aren't acquired, so there's nothing to wait for before drawing into them
+    VkSemaphore wait_semaphores[2] = {};
+    VkPipelineStageFlags wait_stages[2] = {};
+    uint32_t wait_count = 0;
+    if (m_headless == false)
+    {
+        wait_semaphores[wait_count] = m_image_available_semaphores[m_current_frame];
+        // A scaled scene is blitted into the image rather than drawn, the blit has to wait too
+        wait_stages[wait_count++] = m_scene_scaled == true ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    }
+    if (compute_semaphore != VK_NULL_HANDLE)
+    {
+        wait_semaphores[wait_count] = compute_semaphore;
+        wait_stages[wait_count++] = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    }
+    submit_info.waitSemaphoreCount = wait_count;
     submit_info.pWaitSemaphores = wait_semaphores;
     submit_info.pWaitDstStageMask = wait_stages;
 
@@ -548,7 +815,7 @@ void Renderer::VulkanRenderContext::RenderFrame()
     submit_info.pCommandBuffers = &m_command_buffers[image_index];
 
     VkSemaphore signal_semaphores[] = { m_render_finished_semaphores[m_current_frame] };
-    submit_info.signalSemaphoreCount = 1;
+    submit_info.signalSemaphoreCount = m_headless == true ? 0 : 1;
     submit_info.pSignalSemaphores = signal_semaphores;
 
     vkResetFences(m_logical_device, 1, &m_inflight_fences[m_current_frame]);
@@ -559,6 +826,13 @@ void Renderer::VulkanRenderContext::RenderFrame()
         ERROR_LOG(m_last_error);
         return;
     }
+    ++m_frame_index;
+
+    if (m_headless == true)
+    {
+        m_current_frame = (m_current_frame + 1) % MAX_FRAMES_IN_FLIGHT;
+        return;
+    }
 
     VkPresentInfoKHR present_info = {};
     present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -581,11 +855,134 @@ void Renderer::VulkanRenderContext::RenderFrame()
 
 void Renderer::VulkanRenderContext::SubmitRenderable(IRenderable const * renderable)
 {
-    // TODO: implement
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    m_submitted_renderables.emplace_back(renderable);
+    if (m_gpu_culler == nullptr)
+    {
+        m_frustum_culler.AddBounds(transform_aabb(renderable->GetMesh().GetLocalBounds(), renderable->GetTransformMatrix()));
+    }
+}
+
+void Renderer::VulkanRenderContext::SubmitParticles(CParticleEmitter const * emitter)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    if (emitter->GetSettings().simulate_on_gpu == true && m_compute != nullptr)
+    {
+        auto found = m_gpu_emitters.find(emitter);
+        if (found == m_gpu_emitters.end())
+        {
+            SGpuEmitter gpu_emitter;
+            gpu_emitter.particles = std::make_unique<VulkanGpuParticles>(*m_compute, emitter->GetSettings());
+            if (gpu_emitter.particles->Init() == false)
+            {
+                ERROR_LOG("Failed to create a GPU particle pool, simulating the emitter on the CPU");
+                gpu_emitter.particles.reset();
+            }
+            // Starts from where the emitter is rather than replaying everything it's simulated
+            gpu_emitter.simulated_time = emitter->GetSimulatedTime();
+            found = m_gpu_emitters.emplace(emitter, std::move(gpu_emitter)).first;
+        }
+
+        found->second.last_frame = m_frame_index;
+        if (found->second.particles != nullptr)
+        {
+            m_submitted_gpu_emitters.emplace_back(emitter);
+            return;
+        }
+    }
+
+    m_submitted_emitters.emplace_back(emitter);
+}
+
+void Renderer::VulkanRenderContext::SubmitText(CTextRenderer const * text)
+{
+    // Text needs a pass over the output after the upscale and a pipeline sampling the glyph
+    // atlas, neither of which exist on Vulkan yet, so only the GL backend draws it
+    (void)text;
+    if (m_text_dropped_logged == false)
+    {
+        ERROR_LOG("The Vulkan renderer doesn't draw text, submitted text is ignored");
+        m_text_dropped_logged = true;
+    }
+}
+
+void Renderer::VulkanRenderContext::RecordCompute()
+{
+    // The culled commands and particle pools are rewritten in place, and the frame before may
+    // still be drawing from them
+    VkFence const previous_frame = m_inflight_fences[(m_current_frame + MAX_FRAMES_IN_FLIGHT - 1) % MAX_FRAMES_IN_FLIGHT];
+    vkWaitForFences(m_logical_device, 1, &previous_frame, VK_TRUE, UINT64_MAX);
+
+    // Anything recorded through GetCompute since the last frame has already begun the batch
+    if (m_compute->IsRecording() == false && m_compute->Begin() == false)
+    {
+        ERROR_LOG("Failed to begin the frame's compute work");
+        return;
+    }
+
+    if (m_gpu_culler != nullptr)
+    {
+        // Begin waited for the last batch, so the last cull's count is final
+        uint32_t const last_object_count = m_gpu_culler->GetObjectCount();
+        uint32_t const last_visible = std::min(m_gpu_culler->ReadDrawCount(), last_object_count);
+        m_cull_stats.visible = last_visible;
+        m_cull_stats.culled = last_object_count - last_visible;
+
+        if (m_gpu_culler->SetObjects(m_cull_objects) == true)
+        {
+            m_gpu_culler->Record(extract_frustum(m_view_projection, EClipDepth::ZeroToOne));
+        }
+    }
+
+    for (CParticleEmitter const * emitter : m_submitted_gpu_emitters)
+    {
+        SGpuEmitter & gpu_emitter = m_gpu_emitters[emitter];
+        double const dt = emitter->GetSimulatedTime() - gpu_emitter.simulated_time;
+        gpu_emitter.simulated_time = emitter->GetSimulatedTime();
+        if (dt <= 0.0)
+        {
+            continue;
+        }
+
+        gpu_emitter.particles->SetPosition(emitter->GetSettings().position);
+        gpu_emitter.particles->Record(static_cast<float>(std::min(dt, MAX_GPU_PARTICLE_STEP)));
+    }
+}
+
+Renderer::SCullStats Renderer::VulkanRenderContext::GetCullStats() const
+{
+    return m_cull_stats;
+}
+
+bool Renderer::VulkanRenderContext::PopCapturedFrame(SCapturedFrame & out_frame, bool const wait)
+{
+    return m_readback != nullptr && m_readback->Pop(out_frame, wait);
+}
+
+Renderer::SGpuFrameTime Renderer::VulkanRenderContext::GetGpuFrameTime() const
+{
+    return m_gpu_timer != nullptr ? m_gpu_timer->GetLatest() : SGpuFrameTime();
+}
+
+void Renderer::VulkanRenderContext::SetDynamicResolution(SDynamicResolutionSettings const & settings)
+{
+    if (settings.enabled == true && m_upscale_supported == false)
+    {
+        ERROR_LOG("The swapchain images can't be blitted into, drawing at full resolution");
+    }
+    m_dynamic_resolution.SetSettings(settings);
 }
 
 void Renderer::VulkanRenderContext::CleanupSwapChain()
 {
+    // Remade at the new size the next time a frame is drawn scaled
+    if (m_scene_target != nullptr)
+    {
+        m_scene_target->Destroy();
+    }
+
     for (auto framebuffer : m_swapchain_framebuffers)
     {
         if (framebuffer != VK_NULL_HANDLE)
@@ -607,6 +1004,24 @@ void Renderer::VulkanRenderContext::CleanupSwapChain()
         m_graphics_pipeline = VK_NULL_HANDLE;
     }
 
+    if (m_particle_pipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(m_logical_device, m_particle_pipeline, nullptr);
+        m_particle_pipeline = VK_NULL_HANDLE;
+    }
+
+    if (m_gpu_particle_pipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(m_logical_device, m_gpu_particle_pipeline, nullptr);
+        m_gpu_particle_pipeline = VK_NULL_HANDLE;
+    }
+
+    if (m_particle_pipeline_layout != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineLayout(m_logical_device, m_particle_pipeline_layout, nullptr);
+        m_particle_pipeline_layout = VK_NULL_HANDLE;
+    }
+
     if (m_pipeline_layout != VK_NULL_HANDLE)
     {
         vkDestroyPipelineLayout(m_logical_device, m_pipeline_layout, nullptr);
@@ -633,15 +1048,46 @@ void Renderer::VulkanRenderContext::CleanupSwapChain()
         vkDestroySwapchainKHR(m_logical_device, m_swapchain, nullptr);
         m_swapchain = VK_NULL_HANDLE;
     }
+
+    // Swapchain images belong to the swapchain, offscreen ones were made here
+    if (m_headless == true)
+    {
+        for (auto image : m_swapchain_images)
+        {
+            if (image != VK_NULL_HANDLE)
+            {
+                vkDestroyImage(m_logical_device, image, nullptr);
+            }
+        }
+        m_swapchain_images.clear();
+
+        for (auto memory : m_offscreen_memory)
+        {
+            if (memory != VK_NULL_HANDLE)
+            {
+                vkFreeMemory(m_logical_device, memory, nullptr);
+            }
+        }
+        m_offscreen_memory.clear();
+        m_next_offscreen_image = 0;
+    }
 }
 
 bool Renderer::VulkanRenderContext::RecreateSwapChain()
 {
     vkDeviceWaitIdle(m_logical_device);
 
+    // Textures go before the device and the command pool uploads are recorded from
+    m_texture_backend.reset();
+
     CleanupSwapChain();
 
-    return CreateSwapChain()
+    // Fences are tracked per image and the new swapchain may have a different number of them,
+    // nothing is in flight after the wait above
+    bool const created = CreateSwapChain();
+    m_images_inflight.assign(m_swapchain_images.size(), VK_NULL_HANDLE);
+
+    return created
         && CreateImageViews()
         && CreateRenderPass()
         && CreateGraphicsPipeline()
@@ -654,16 +1100,48 @@ bool Renderer::VulkanRenderContext::CreateLogicalDevice()
     SQueueFamilyIndices const indices = find_queue_families(m_physical_device, m_surface);
     std::vector<VkDeviceQueueCreateInfo> queue_create_infos = create_device_queue_info_from_indices(indices);
 
+    // Everything the indirect draws can use is turned on when the device has it, the draw path
+    // falls back for whatever is missing
+    VkPhysicalDeviceProperties device_properties{};
+    VkPhysicalDeviceFeatures supported_features{};
+    vkGetPhysicalDeviceProperties(m_physical_device, &device_properties);
+    vkGetPhysicalDeviceFeatures(m_physical_device, &supported_features);
+
+    VkPhysicalDeviceVulkan12Features vulkan_12_features{};
+    vulkan_12_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    bool const vulkan_12 = device_properties.apiVersion >= VK_API_VERSION_1_2;
+    if (vulkan_12 == true)
+    {
+        VkPhysicalDeviceFeatures2 supported_features_2{};
+        supported_features_2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        supported_features_2.pNext = &vulkan_12_features;
+        vkGetPhysicalDeviceFeatures2(m_physical_device, &supported_features_2);
+    }
+
+    m_indirect_features.draw_indirect_count = vulkan_12 == true && vulkan_12_features.drawIndirectCount == VK_TRUE;
+    m_indirect_features.multi_draw_indirect = supported_features.multiDrawIndirect == VK_TRUE;
+    m_indirect_features.draw_indirect_first_instance = supported_features.drawIndirectFirstInstance == VK_TRUE;
+    m_indirect_features.max_draw_indirect_count = device_properties.limits.maxDrawIndirectCount;
+
+    // Just the one 1.2 feature the draws use
+    VkPhysicalDeviceVulkan12Features enabled_12_features{};
+    enabled_12_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    enabled_12_features.drawIndirectCount = m_indirect_features.draw_indirect_count == true ? VK_TRUE : VK_FALSE;
+
     VkPhysicalDeviceFeatures device_features{};
+    device_features.multiDrawIndirect = supported_features.multiDrawIndirect;
+    device_features.drawIndirectFirstInstance = supported_features.drawIndirectFirstInstance;
+
     VkDeviceCreateInfo device_create_info{};
     device_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     device_create_info.pQueueCreateInfos = queue_create_infos.data();
     device_create_info.queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size());
 
-    device_create_info.enabledExtensionCount = static_cast<uint32_t>(required_device_extensions.size());
+    device_create_info.enabledExtensionCount = m_headless == true ? 0 : static_cast<uint32_t>(required_device_extensions.size());
     device_create_info.ppEnabledExtensionNames = required_device_extensions.data();
 
     device_create_info.pEnabledFeatures = &device_features;
+    device_create_info.pNext = vulkan_12 == true ? &enabled_12_features : nullptr;
 
     if (vkCreateDevice(m_physical_device, &device_create_info, nullptr, &m_logical_device) != VK_SUCCESS)
     {
@@ -682,6 +1160,11 @@ bool Renderer::VulkanRenderContext::CreateLogicalDevice()
 
 bool Renderer::VulkanRenderContext::CreateSwapChain()
 {
+    if (m_headless == true)
+    {
+        return CreateOffscreenImages();
+    }
+
     SSwapChainSupportDetails swapchain_support = query_swapchain_support(m_physical_device, m_surface);
 
     VkSurfaceFormatKHR surface_format = choose_swap_surface_format(swapchain_support.formats);
@@ -715,6 +1198,19 @@ bool Renderer::VulkanRenderContext::CreateSwapChain()
     // For now just set the image usage for rendering directly to the screen. In future we could allow different
     // usages like rendering post-processing effect and then copy the result to another image
     create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    // Copying out is what frame captures need
+    m_capture_supported = (swapchain_support.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0;
+    if (m_capture_supported == true)
+    {
+        create_info.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+    // And blitting in is how a scene drawn at a lower resolution gets there
+    m_upscale_supported = (swapchain_support.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) != 0 &&
+                          VulkanSceneTarget::IsSupported(m_physical_device, m_swapchain_format);
+    if (m_upscale_supported == true)
+    {
+        create_info.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    }
 
     SQueueFamilyIndices indices = find_queue_families(m_physical_device, m_surface);
     uint32_t queue_family_indeces[] = { indices.graphicsFamily.Value(), indices.presentFamily.Value() };
@@ -757,6 +1253,63 @@ bool Renderer::VulkanRenderContext::CreateSwapChain()
     return true;
 }
 
+bool Renderer::VulkanRenderContext::CreateOffscreenImages()
+{
+    // Plain RGBA so captures need no swizzle, as many images as a swapchain would usually have
+    m_swapchain_format = VK_FORMAT_R8G8B8A8_UNORM;
+    m_capture_supported = true;
+    m_upscale_supported = VulkanSceneTarget::IsSupported(m_physical_device, m_swapchain_format);
+
+    int width = 0;
+    int height = 0;
+    glfwGetWindowSize(m_ptr_glfw_window, &width, &height);
+    m_surface_extent.width = static_cast<uint32_t>(std::max(width, 1));
+    m_surface_extent.height = static_cast<uint32_t>(std::max(height, 1));
+
+    m_swapchain_images.assign(MAX_FRAMES_IN_FLIGHT + 1, VK_NULL_HANDLE);
+    m_offscreen_memory.assign(m_swapchain_images.size(), VK_NULL_HANDLE);
+
+    for (size_t i = 0; i < m_swapchain_images.size(); ++i)
+    {
+        VkImageCreateInfo image_info = {};
+        image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        image_info.imageType = VK_IMAGE_TYPE_2D;
+        image_info.format = m_swapchain_format;
+        image_info.extent = { m_surface_extent.width, m_surface_extent.height, 1 };
+        image_info.mipLevels = 1;
+        image_info.arrayLayers = 1;
+        image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+        image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+        image_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (vkCreateImage(m_logical_device, &image_info, nullptr, &m_swapchain_images[i]) != VK_SUCCESS)
+        {
+            m_last_error = "Failed to create offscreen image";
+            ERROR_LOG(m_last_error);
+            return false;
+        }
+
+        VkMemoryRequirements requirements = {};
+        vkGetImageMemoryRequirements(m_logical_device, m_swapchain_images[i], &requirements);
+
+        VkMemoryAllocateInfo alloc_info = {};
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.allocationSize = requirements.size;
+
+        if (FindMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, alloc_info.memoryTypeIndex) == false ||
+            vkAllocateMemory(m_logical_device, &alloc_info, nullptr, &m_offscreen_memory[i]) != VK_SUCCESS ||
+            vkBindImageMemory(m_logical_device, m_swapchain_images[i], m_offscreen_memory[i], 0) != VK_SUCCESS)
+        {
+            m_last_error = "Failed to allocate offscreen image memory";
+            ERROR_LOG(m_last_error);
+            return false;
+        }
+    }
+    return true;
+}
+
 bool Renderer::VulkanRenderContext::CreateImageViews()
 {
     m_swapchain_image_views.resize(m_swapchain_images.size(), VK_NULL_HANDLE);
@@ -801,7 +1354,7 @@ bool Renderer::VulkanRenderContext::CreateRenderPass()
     color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 
     color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    color_attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    color_attachment.finalLayout = m_final_layout;
 
     VkAttachmentReference color_attachment_ref = {};
     color_attachment_ref.attachment = 0;
@@ -877,12 +1430,15 @@ bool Renderer::VulkanRenderContext::CreateGraphicsPipeline()
 
         VkPipelineShaderStageCreateInfo shader_stages[] = { vert_shader_create_info, frag_shader_create_info };
 
+        auto const binding_descriptions = VulkanIndirectDraw::GetBindingDescriptions();
+        auto const attribute_descriptions = VulkanIndirectDraw::GetAttributeDescriptions();
+
         VkPipelineVertexInputStateCreateInfo vertex_input_info = {};
         vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertex_input_info.vertexAttributeDescriptionCount = 0;
-        vertex_input_info.pVertexBindingDescriptions = nullptr;
-        vertex_input_info.vertexAttributeDescriptionCount = 0;
-        vertex_input_info.pVertexAttributeDescriptions = nullptr;
+        vertex_input_info.vertexBindingDescriptionCount = static_cast<uint32_t>(binding_descriptions.size());
+        vertex_input_info.pVertexBindingDescriptions = binding_descriptions.data();
+        vertex_input_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(attribute_descriptions.size());
+        vertex_input_info.pVertexAttributeDescriptions = attribute_descriptions.data();
 
         VkPipelineInputAssemblyStateCreateInfo input_assembly = {};
         input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -908,13 +1464,21 @@ bool Renderer::VulkanRenderContext::CreateGraphicsPipeline()
         viewport_state.scissorCount = 1;
         viewport_state.pScissors = &scissor;
 
+        // Set per frame, the scene is drawn smaller than the swapchain with dynamic resolution
+        VkDynamicState const dynamic_states[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+        VkPipelineDynamicStateCreateInfo dynamic_state = {};
+        dynamic_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamic_state.dynamicStateCount = 2;
+        dynamic_state.pDynamicStates = dynamic_states;
+
         VkPipelineRasterizationStateCreateInfo rasterizer = {};
         rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
         rasterizer.depthClampEnable = VK_FALSE;
         rasterizer.rasterizerDiscardEnable = VK_FALSE;
         rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
         rasterizer.lineWidth = 1.0f;
-        rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+        // 2D shapes come in either winding, same as the GL backend nothing is back face culled
+        rasterizer.cullMode = VK_CULL_MODE_NONE;
         rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
         rasterizer.depthBiasEnable = VK_FALSE;
         rasterizer.depthBiasConstantFactor = 0.0f; // Optional
@@ -955,8 +1519,12 @@ bool Renderer::VulkanRenderContext::CreateGraphicsPipeline()
         pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
         pipeline_layout_info.setLayoutCount = 0; // Optional
         pipeline_layout_info.pSetLayouts = nullptr; // Optional
-        pipeline_layout_info.pushConstantRangeCount = 0; // Optional
-        pipeline_layout_info.pPushConstantRanges = nullptr; // Optional
+        VkPushConstantRange view_projection_range = {};
+        view_projection_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        view_projection_range.offset = 0;
+        view_projection_range.size = sizeof(glm::mat4);
+        pipeline_layout_info.pushConstantRangeCount = 1;
+        pipeline_layout_info.pPushConstantRanges = &view_projection_range;
 
         if (vkCreatePipelineLayout(m_logical_device, &pipeline_layout_info, nullptr, &m_pipeline_layout) != VK_SUCCESS)
         {
@@ -977,7 +1545,7 @@ bool Renderer::VulkanRenderContext::CreateGraphicsPipeline()
         pipeline_info.pMultisampleState = &multisampling;
         pipeline_info.pDepthStencilState = nullptr; // Optional
         pipeline_info.pColorBlendState = &colour_blending;
-        pipeline_info.pDynamicState = nullptr; // Optional
+        pipeline_info.pDynamicState = &dynamic_state;
 
         pipeline_info.layout = m_pipeline_layout;
 
@@ -993,6 +1561,11 @@ bool Renderer::VulkanRenderContext::CreateGraphicsPipeline()
             ERROR_LOG(m_last_error);
             result = false;
         }
+
+        if (result == true)
+        {
+            CreateParticlePipeline(pipeline_info);
+        }
     }
     else
     {
@@ -1012,6 +1585,104 @@ bool Renderer::VulkanRenderContext::CreateGraphicsPipeline()
     return result;
 }
 
+void Renderer::VulkanRenderContext::CreateParticlePipeline(VkGraphicsPipelineCreateInfo pipeline_info)
+{
+    auto vert_shader_code = FileHelpers::read_file("shaders/particle_vert.spv");
+    auto frag_shader_code = FileHelpers::read_file("shaders/particle_frag.spv");
+    if (vert_shader_code.empty() == true || frag_shader_code.empty() == true)
+    {
+        ERROR_LOG("Failed to load particle shader files, particles won't be drawn");
+        return;
+    }
+
+    VkShaderModule const vert_shader_module = create_shader_module(m_logical_device, vert_shader_code);
+    VkShaderModule const frag_shader_module = create_shader_module(m_logical_device, frag_shader_code);
+
+    if (vert_shader_module != VK_NULL_HANDLE && frag_shader_module != VK_NULL_HANDLE)
+    {
+        VkPipelineShaderStageCreateInfo shader_stages[2] = {};
+        shader_stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        shader_stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+        shader_stages[0].module = vert_shader_module;
+        shader_stages[0].pName = "main";
+        shader_stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        shader_stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        shader_stages[1].module = frag_shader_module;
+        shader_stages[1].pName = "main";
+
+        auto const binding_descriptions = VulkanParticleDraw::GetBindingDescriptions();
+        auto const attribute_descriptions = VulkanParticleDraw::GetAttributeDescriptions();
+
+        VkPipelineVertexInputStateCreateInfo vertex_input_info = {};
+        vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        vertex_input_info.vertexBindingDescriptionCount = static_cast<uint32_t>(binding_descriptions.size());
+        vertex_input_info.pVertexBindingDescriptions = binding_descriptions.data();
+        vertex_input_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(attribute_descriptions.size());
+        vertex_input_info.pVertexAttributeDescriptions = attribute_descriptions.data();
+
+        // GPU pools run the same shaders over their own particle buffers
+        auto const gpu_binding_descriptions = VulkanParticleDraw::GetGpuBindingDescriptions();
+        auto const gpu_attribute_descriptions = VulkanParticleDraw::GetGpuAttributeDescriptions();
+
+        VkPipelineVertexInputStateCreateInfo gpu_vertex_input_info = vertex_input_info;
+        gpu_vertex_input_info.vertexBindingDescriptionCount = static_cast<uint32_t>(gpu_binding_descriptions.size());
+        gpu_vertex_input_info.pVertexBindingDescriptions = gpu_binding_descriptions.data();
+        gpu_vertex_input_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(gpu_attribute_descriptions.size());
+        gpu_vertex_input_info.pVertexAttributeDescriptions = gpu_attribute_descriptions.data();
+
+        // Every particle is a four corner strip
+        VkPipelineInputAssemblyStateCreateInfo input_assembly = {};
+        input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+        input_assembly.primitiveRestartEnable = VK_FALSE;
+
+        VkPushConstantRange constants_range = {};
+        constants_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        constants_range.offset = 0;
+        constants_range.size = sizeof(VulkanParticleDraw::SConstants);
+
+        VkPipelineLayoutCreateInfo pipeline_layout_info = {};
+        pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipeline_layout_info.pushConstantRangeCount = 1;
+        pipeline_layout_info.pPushConstantRanges = &constants_range;
+
+        pipeline_info.pStages = shader_stages;
+        pipeline_info.pVertexInputState = &vertex_input_info;
+        pipeline_info.pInputAssemblyState = &input_assembly;
+
+        if (vkCreatePipelineLayout(m_logical_device, &pipeline_layout_info, nullptr, &m_particle_pipeline_layout) != VK_SUCCESS)
+        {
+            ERROR_LOG("Failed to create the particle pipeline layout, particles won't be drawn");
+        }
+        else
+        {
+            pipeline_info.layout = m_particle_pipeline_layout;
+            if (vkCreateGraphicsPipelines(m_logical_device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &m_particle_pipeline) != VK_SUCCESS)
+            {
+                ERROR_LOG("Failed to create the particle pipeline, particles won't be drawn");
+                m_particle_pipeline = VK_NULL_HANDLE;
+            }
+
+            pipeline_info.pVertexInputState = &gpu_vertex_input_info;
+            if (vkCreateGraphicsPipelines(m_logical_device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &m_gpu_particle_pipeline) != VK_SUCCESS)
+            {
+                ERROR_LOG("Failed to create the GPU particle pipeline, GPU simulated emitters won't be drawn");
+                m_gpu_particle_pipeline = VK_NULL_HANDLE;
+            }
+        }
+    }
+
+    if (frag_shader_module != VK_NULL_HANDLE)
+    {
+        vkDestroyShaderModule(m_logical_device, frag_shader_module, nullptr);
+    }
+
+    if (vert_shader_module != VK_NULL_HANDLE)
+    {
+        vkDestroyShaderModule(m_logical_device, vert_shader_module, nullptr);
+    }
+}
+
 bool Renderer::VulkanRenderContext::CreateFramebuffers()
 {
     bool success = true;
@@ -1049,7 +1720,8 @@ bool Renderer::VulkanRenderContext::CreateCommandPool()
     VkCommandPoolCreateInfo pool_info = {};
     pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     pool_info.queueFamilyIndex = queue_family_indices.graphicsFamily.Value();
-    pool_info.flags = 0;
+    // Frame command buffers are re-recorded every frame
+    pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
     if (vkCreateCommandPool(m_logical_device, &pool_info, nullptr, &m_command_pool) != VK_SUCCESS)
     {
@@ -1078,46 +1750,122 @@ bool Renderer::VulkanRenderContext::CreateCommandBuffers()
         success = false;
     }
 
-    for (size_t i = 0; i < m_command_buffers.size() && success == true; i++)
+    return success;
+}
+
+bool Renderer::VulkanRenderContext::RecordCommandBuffer(uint32_t const image_index)
+{
+    VkCommandBuffer const command_buffer = m_command_buffers[image_index];
+
+    VkCommandBufferBeginInfo begin_info = {};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    begin_info.pInheritanceInfo = nullptr; // Optional
+
+    // Beginning resets whatever the buffer held from the last time the image was drawn
+    if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS)
     {
-        VkCommandBufferBeginInfo begin_info = {};
-        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        begin_info.flags = 0; // Optional
-        begin_info.pInheritanceInfo = nullptr; // Optional
+        m_last_error = "Failed to begin recording command buffer";
+        ERROR_LOG(m_last_error);
+        return false;
+    }
 
-        if (vkBeginCommandBuffer(m_command_buffers[i], &begin_info) != VK_SUCCESS)
-        {
-            m_last_error = "Failed to begin recording command buffer";
-            ERROR_LOG(m_last_error);
-            success = false;
-            break;
-        }
+    if (m_gpu_timer != nullptr)
+    {
+        m_gpu_timer->Begin(command_buffer, image_index, m_frame_index);
+    }
+
+    // The scene target's pass is compatible with the swapchain's, the same pipeline draws in both
+    VkRenderPassBeginInfo render_pass_info = {};
+    render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    render_pass_info.renderPass = m_scene_scaled == true ? m_scene_target->GetRenderPass() : m_render_pass;
+    render_pass_info.framebuffer = m_scene_scaled == true ? m_scene_target->GetFramebuffer(image_index) : m_swapchain_framebuffers[image_index];
 
-        VkRenderPassBeginInfo render_pass_info = {};
-        render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        render_pass_info.renderPass = m_render_pass;
-        render_pass_info.framebuffer = m_swapchain_framebuffers[i];
+    render_pass_info.renderArea.offset = { 0, 0 };
+    render_pass_info.renderArea.extent = m_scene_extent;
 
-        render_pass_info.renderArea.offset = { 0, 0 };
-        render_pass_info.renderArea.extent = m_surface_extent;
+    VkViewport viewport = {};
+    viewport.width = static_cast<float>(m_scene_extent.width);
+    viewport.height = static_cast<float>(m_scene_extent.height);
+    viewport.maxDepth = 1.0f;
+
+    VkRect2D scissor = {};
+    scissor.extent = m_scene_extent;
+
+    VkClearValue clear_colour = { 0.0f, 0.0f, 0.0f, 1.0f };
+    render_pass_info.clearValueCount = 1;
+    render_pass_info.pClearValues = &clear_colour;
+
+    vkCmdBeginRenderPass(command_buffer, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphics_pipeline);
+    vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+    vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+    vkCmdPushConstants(command_buffer, m_pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &m_view_projection[0][0]);
+    if (m_gpu_culler != nullptr)
+    {
+        m_indirect_draw->RecordCulled(command_buffer,
+                                      image_index,
+                                      m_gpu_culler->GetDrawBuffer(),
+                                      m_gpu_culler->GetDrawCountBuffer(),
+                                      m_gpu_culler->GetObjectCount());
+    }
+    else
+    {
+        m_indirect_draw->Record(command_buffer, image_index);
+    }
+    if (m_particle_pipeline != VK_NULL_HANDLE)
+    {
+        m_particle_draw->Record(command_buffer,
+                                image_index,
+                                m_particle_pipeline,
+                                m_gpu_particle_pipeline,
+                                m_particle_pipeline_layout,
+                                m_view_projection);
+    }
+    vkCmdEndRenderPass(command_buffer);
 
-        VkClearValue clear_colour = { 0.0f, 0.0f, 0.0f, 1.0f };
-        render_pass_info.clearValueCount = 1;
-        render_pass_info.pClearValues = &clear_colour;
+    // Ahead of the UI once there is one, that goes on top at full resolution
+    if (m_scene_scaled == true)
+    {
+        m_scene_target->RecordUpscale(command_buffer,
+                                      image_index,
+                                      m_scene_extent,
+                                      m_swapchain_images[image_index],
+                                      m_surface_extent,
+                                      m_final_layout);
+    }
 
-        vkCmdBeginRenderPass(m_command_buffers[i], &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
-        vkCmdBindPipeline(m_command_buffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphics_pipeline);
-        vkCmdDraw(m_command_buffers[i], 3, 1, 0, 0);
-        vkCmdEndRenderPass(m_command_buffers[i]);
+    if (m_gpu_timer != nullptr)
+    {
+        m_gpu_timer->End(command_buffer, image_index);
+    }
 
-        if (vkEndCommandBuffer(m_command_buffers[i]) != VK_SUCCESS)
+    if (m_capture_requested == true)
+    {
+        if (m_capture_supported == false)
         {
-            m_last_error = "failed to record command buffer!";
-            ERROR_LOG(m_last_error);
-            success = false;
+            ERROR_LOG("The swapchain images can't be copied from, ignoring the capture");
+        }
+        else
+        {
+            m_readback->Record(command_buffer,
+                               m_swapchain_images[image_index],
+                               m_final_layout,
+                               m_swapchain_format,
+                               m_surface_extent,
+                               m_inflight_fences[m_current_frame],
+                               m_frame_index);
         }
+        m_capture_requested = false;
     }
-    return success;
+
+    if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
+    {
+        m_last_error = "failed to record command buffer!";
+        ERROR_LOG(m_last_error);
+        return false;
+    }
+    return true;
 }
 
 bool Renderer::VulkanRenderContext::CreateSemaphores()
@@ -1148,3 +1896,19 @@ bool Renderer::VulkanRenderContext::CreateSemaphores()
 
     return true;
 }
+
+bool Renderer::VulkanRenderContext::FindMemoryType(uint32_t const type_bits, VkMemoryPropertyFlags const properties, uint32_t & out_type) const
+{
+    VkPhysicalDeviceMemoryProperties memory_properties = {};
+    vkGetPhysicalDeviceMemoryProperties(m_physical_device, &memory_properties);
+
+    for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i)
+    {
+        if ((type_bits & (1u << i)) != 0 && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            out_type = i;
+            return true;
+        }
+    }
+    return false;
+}
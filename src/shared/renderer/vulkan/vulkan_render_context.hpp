@@ -1,10 +1,25 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include<memory>
 #include<string>
+#include<unordered_map>
+#include<utility>
 #include<vector>
 
+#include <glm/mat4x4.hpp>
+
 #include "renderer/render_context.hpp"
+#include "renderer/draw/draw_batch.hpp"
+#include "renderer/vulkan/vulkan_compute.hpp"
+#include "renderer/vulkan/vulkan_gpu_culler.hpp"
+#include "renderer/vulkan/vulkan_gpu_particles.hpp"
+#include "renderer/vulkan/vulkan_gpu_timer.hpp"
+#include "renderer/vulkan/vulkan_indirect_draw.hpp"
+#include "renderer/vulkan/vulkan_particle_draw.hpp"
+#include "renderer/vulkan/vulkan_readback.hpp"
+#include "renderer/vulkan/vulkan_scene_target.hpp"
+#include "renderer/vulkan/vulkan_texture_backend.hpp"
 
 struct GLFWwindow;
 
@@ -13,14 +28,33 @@ namespace Renderer
     class VulkanRenderContext : public IRenderContext
     {
     public:
-        VulkanRenderContext(GLFWwindow * glfw_window);
+        // Headless makes no surface or swapchain, frames are drawn into offscreen images and never
+        // presented. The window is only asked for its size.
+        VulkanRenderContext(GLFWwindow * glfw_window, bool const headless);
         ~VulkanRenderContext();
 
         virtual bool Init() override;
         virtual void ResizeScreen(uint32_t const width, uint32_t const height) override;
         virtual void PreRender() override;
+        // Nothing is drawn outside RenderFrame yet, the upscale is recorded there with the rest
+        virtual void EndScene() override {}
         virtual void RenderFrame() override;
+        // Converted to Vulkan's clip space before it's stored
+        virtual void SetViewProjection(glm::mat4 const & view_projection) override;
         virtual void SubmitRenderable(IRenderable const * renderable) override;
+        virtual void SubmitParticles(CParticleEmitter const * emitter) override;
+        // Dropped, see the definition
+        virtual void SubmitText(CTextRenderer const * text) override;
+        virtual SCullStats GetCullStats() const override;
+        virtual ITextureBackend * GetTextureBackend() override { return m_texture_backend.get(); }
+        virtual void RequestCapture() override { m_capture_requested = true; }
+        virtual bool PopCapturedFrame(SCapturedFrame & out_frame, bool const wait) override;
+        virtual SGpuFrameTime GetGpuFrameTime() const override;
+        virtual void SetDynamicResolution(SDynamicResolutionSettings const & settings) override;
+        virtual float GetResolutionScale() const override { return m_dynamic_resolution.GetScale(); }
+        // Null if the device has no compute queue. Work recorded on it is submitted with the
+        // next frame, which waits for it before drawing.
+        VulkanCompute * GetCompute() { return m_compute.get(); }
         bool HasError() const { return m_last_error.empty() == false; }
         std::string const GetLastError() const { return m_last_error; }
 
@@ -31,15 +65,23 @@ namespace Renderer
 
         bool CreateLogicalDevice();
         bool CreateSwapChain();
+        bool CreateOffscreenImages();
         bool CreateImageViews();
         bool CreateRenderPass();
         bool CreateGraphicsPipeline();
+        // Shares the scene pipeline's fixed function state, failing only leaves particles undrawn
+        void CreateParticlePipeline(VkGraphicsPipelineCreateInfo pipeline_info);
+        // GPU culling and particle steps for the frame, submitted with it
+        void RecordCompute();
         bool CreateFramebuffers();
         bool CreateCommandPool();
         bool CreateCommandBuffers();
+        bool RecordCommandBuffer(uint32_t const image_index);
         bool CreateSemaphores();
+        bool FindMemoryType(uint32_t const type_bits, VkMemoryPropertyFlags const properties, uint32_t & out_type) const;
 
         GLFWwindow * m_ptr_glfw_window = nullptr;
+        bool m_headless = false;
 
         VkInstance m_instance = VK_NULL_HANDLE;
         VkPhysicalDevice m_physical_device = VK_NULL_HANDLE;
@@ -53,6 +95,9 @@ namespace Renderer
         VkRenderPass m_render_pass = VK_NULL_HANDLE;
         VkPipelineLayout m_pipeline_layout = VK_NULL_HANDLE;
         VkPipeline m_graphics_pipeline = VK_NULL_HANDLE;
+        VkPipelineLayout m_particle_pipeline_layout = VK_NULL_HANDLE;
+        VkPipeline m_particle_pipeline = VK_NULL_HANDLE;
+        VkPipeline m_gpu_particle_pipeline = VK_NULL_HANDLE;
         VkCommandPool m_command_pool = VK_NULL_HANDLE;
         std::vector<VkSemaphore> m_image_available_semaphores;
         std::vector<VkSemaphore> m_render_finished_semaphores;
@@ -65,6 +110,71 @@ namespace Renderer
         std::vector<VkFramebuffer> m_swapchain_framebuffers;
         std::vector<VkCommandBuffer> m_command_buffers;
 
+        // Headless only, the swapchain images' memory and which one is drawn next
+        std::vector<VkDeviceMemory> m_offscreen_memory;
+        uint32_t m_next_offscreen_image = 0;
+        // Where the render pass leaves each image, ready to present or to be read back
+        VkImageLayout m_final_layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+        uint64_t m_frame_index = 0;
+        bool m_capture_requested = false;
+        // Needs the swapchain images to allow transfers, which nearly every surface does
+        bool m_capture_supported = false;
+        std::unique_ptr<VulkanReadback> m_readback;
+        // Null if the graphics queue can't write timestamps
+        std::unique_ptr<VulkanGpuTimer> m_gpu_timer;
+
+        // With dynamic resolution the scene goes into the scene target at m_scene_extent and is
+        // blitted up to the swapchain image. Needs the swapchain images to allow blits into them.
+        CDynamicResolution m_dynamic_resolution;
+        std::unique_ptr<VulkanSceneTarget> m_scene_target;
+        bool m_upscale_supported = false;
+        bool m_scene_scaled = false;
+        VkExtent2D m_scene_extent = {};
+
+        std::unique_ptr<VulkanTextureBackend> m_texture_backend;
+        std::unique_ptr<VulkanCompute> m_compute;
+
+        // Renderables are gathered on submit, culled in RenderFrame and the visible ones drawn
+        // from one indirect buffer recorded into that frame's command buffer
+        std::vector<IRenderable const *> m_submitted_renderables;
+        CFrustumCuller m_frustum_culler;
+        SCullStats m_cull_stats;
+        CDrawBatch m_draw_batch;
+        VulkanIndirectDraw::SFeatures m_indirect_features;
+        std::unique_ptr<VulkanIndirectDraw> m_indirect_draw;
+
+        // With compute and drawIndirectCount every renderable goes into the batch and the culler
+        // writes the commands that get drawn, one object per instance. Null otherwise, and the
+        // renderables are culled on the CPU before batching.
+        std::unique_ptr<VulkanGpuCuller> m_gpu_culler;
+        std::vector<SGpuCullObject> m_cull_objects;
+
+        // Emitters are drawn after the scene's geometry, one instanced quad strip each
+        std::vector<CParticleEmitter const *> m_submitted_emitters;
+        std::unique_ptr<VulkanParticleDraw> m_particle_draw;
+
+        // Emitters with simulate_on_gpu get a pool each while there's compute, stepped up to the
+        // emitter's own simulated time every frame it's submitted. A pool that isn't submitted is
+        // retired and destroyed once no frame in flight can still be drawing it.
+        struct SGpuEmitter
+        {
+            // Null if the pool couldn't be made, the emitter is drawn from the CPU then
+            std::unique_ptr<VulkanGpuParticles> particles;
+            double simulated_time = 0.0;
+            uint64_t last_frame = 0;
+        };
+        std::unordered_map<CParticleEmitter const *, SGpuEmitter> m_gpu_emitters;
+        std::vector<std::pair<uint64_t, std::unique_ptr<VulkanGpuParticles>>> m_retired_gpu_emitters;
+        std::vector<CParticleEmitter const *> m_submitted_gpu_emitters;
+        std::vector<VulkanGpuParticles const *> m_drawn_gpu_emitters;
+
+        // Set once the first submitted text has been logged as dropped
+        bool m_text_dropped_logged = false;
+
+        // Already in Vulkan's clip space
+        glm::mat4 m_view_projection = glm::mat4(1.0f);
+
         std::string m_last_error;
     };
 }
@@ -0,0 +1,301 @@
+#include "vulkan_scene_target.hpp"
+
+#include "utility/logging.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+Renderer::VulkanSceneTarget::VulkanSceneTarget(VkPhysicalDevice physical_device, VkDevice logical_device)
+: m_physical_device(physical_device)
+, m_logical_device(logical_device)
+, m_extent()
+, m_render_pass(VK_NULL_HANDLE)
+, m_images()
+, m_memory()
+, m_image_views()
+, m_framebuffers()
+{
+}
+
+Renderer::VulkanSceneTarget::~VulkanSceneTarget()
+{
+    Destroy();
+}
+
+bool Renderer::VulkanSceneTarget::IsSupported(VkPhysicalDevice physical_device, VkFormat const format)
+{
+    VkFormatProperties properties = {};
+    vkGetPhysicalDeviceFormatProperties(physical_device, format, &properties);
+
+    VkFormatFeatureFlags const required = VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT |
+                                          VK_FORMAT_FEATURE_BLIT_SRC_BIT |
+                                          VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                          VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (properties.optimalTilingFeatures & required) == required;
+}
+
+bool Renderer::VulkanSceneTarget::Create(VkFormat const format, VkExtent2D const extent, uint32_t const image_count)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
+    Destroy();
+
+    if (CreateRenderPass(format) == false)
+    {
+        return false;
+    }
+    m_extent = extent;
+
+    m_images.assign(image_count, VK_NULL_HANDLE);
+    m_memory.assign(image_count, VK_NULL_HANDLE);
+    m_image_views.assign(image_count, VK_NULL_HANDLE);
+    m_framebuffers.assign(image_count, VK_NULL_HANDLE);
+
+    for (uint32_t i = 0; i < image_count; ++i)
+    {
+        VkImageCreateInfo image_info = {};
+        image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        image_info.imageType = VK_IMAGE_TYPE_2D;
+        image_info.format = format;
+        image_info.extent = { extent.width, extent.height, 1 };
+        image_info.mipLevels = 1;
+        image_info.arrayLayers = 1;
+        image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+        image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+        image_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (vkCreateImage(m_logical_device, &image_info, nullptr, &m_images[i]) != VK_SUCCESS)
+        {
+            ERROR_LOG("Failed to create scene image");
+            Destroy();
+            return false;
+        }
+
+        VkMemoryRequirements requirements = {};
+        vkGetImageMemoryRequirements(m_logical_device, m_images[i], &requirements);
+
+        VkMemoryAllocateInfo alloc_info = {};
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.allocationSize = requirements.size;
+
+        if (FindMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, alloc_info.memoryTypeIndex) == false ||
+            vkAllocateMemory(m_logical_device, &alloc_info, nullptr, &m_memory[i]) != VK_SUCCESS ||
+            vkBindImageMemory(m_logical_device, m_images[i], m_memory[i], 0) != VK_SUCCESS)
+        {
+            ERROR_LOG("Failed to allocate scene image memory");
+            Destroy();
+            return false;
+        }
+
+        VkImageViewCreateInfo view_info = {};
+        view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        view_info.image = m_images[i];
+        view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        view_info.format = format;
+        view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        view_info.subresourceRange.levelCount = 1;
+        view_info.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(m_logical_device, &view_info, nullptr, &m_image_views[i]) != VK_SUCCESS)
+        {
+            ERROR_LOG("Failed to create scene image view");
+            Destroy();
+            return false;
+        }
+
+        VkFramebufferCreateInfo framebuffer_info = {};
+        framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebuffer_info.renderPass = m_render_pass;
+        framebuffer_info.attachmentCount = 1;
+        framebuffer_info.pAttachments = &m_image_views[i];
+        framebuffer_info.width = extent.width;
+        framebuffer_info.height = extent.height;
+        framebuffer_info.layers = 1;
+
+        if (vkCreateFramebuffer(m_logical_device, &framebuffer_info, nullptr, &m_framebuffers[i]) != VK_SUCCESS)
+        {
+            ERROR_LOG("Failed to create scene framebuffer");
+            Destroy();
+            return false;
+        }
+    }
+    return true;
+}
+
+void Renderer::VulkanSceneTarget::Destroy()
+{
+    for (VkFramebuffer const framebuffer : m_framebuffers)
+    {
+        if (framebuffer != VK_NULL_HANDLE)
+        {
+            vkDestroyFramebuffer(m_logical_device, framebuffer, nullptr);
+        }
+    }
+    for (VkImageView const image_view : m_image_views)
+    {
+        if (image_view != VK_NULL_HANDLE)
+        {
+            vkDestroyImageView(m_logical_device, image_view, nullptr);
+        }
+    }
+    for (VkImage const image : m_images)
+    {
+        if (image != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_logical_device, image, nullptr);
+        }
+    }
+    for (VkDeviceMemory const memory : m_memory)
+    {
+        if (memory != VK_NULL_HANDLE)
+        {
+            vkFreeMemory(m_logical_device, memory, nullptr);
+        }
+    }
+    m_framebuffers.clear();
+    m_image_views.clear();
+    m_images.clear();
+    m_memory.clear();
+
+    if (m_render_pass != VK_NULL_HANDLE)
+    {
+        vkDestroyRenderPass(m_logical_device, m_render_pass, nullptr);
+        m_render_pass = VK_NULL_HANDLE;
+    }
+    m_extent = VkExtent2D();
+}
+
+void Renderer::VulkanSceneTarget::RecordUpscale(VkCommandBuffer command_buffer,
+                                                uint32_t const image_index,
+                                                VkExtent2D const scene_extent,
+                                                VkImage destination,
+                                                VkExtent2D const destination_extent,
+                                                VkImageLayout const final_layout) const
+{
+    // The scene's render pass already left its image ready to blit from
+    VkImageMemoryBarrier to_destination = {};
+    to_destination.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    to_destination.srcAccessMask = 0;
+    to_destination.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    to_destination.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    to_destination.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    to_destination.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    to_destination.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    to_destination.image = destination;
+    to_destination.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    to_destination.subresourceRange.levelCount = 1;
+    to_destination.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &to_destination);
+
+    VkImageBlit blit = {};
+    blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    blit.srcSubresource.layerCount = 1;
+    blit.srcOffsets[1] = { static_cast<int32_t>(scene_extent.width), static_cast<int32_t>(scene_extent.height), 1 };
+    blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    blit.dstSubresource.layerCount = 1;
+    blit.dstOffsets[1] = { static_cast<int32_t>(destination_extent.width), static_cast<int32_t>(destination_extent.height), 1 };
+
+    vkCmdBlitImage(command_buffer,
+                   m_images[image_index],
+                   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                   destination,
+                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                   1,
+                   &blit,
+                   VK_FILTER_LINEAR);
+
+    // Into whatever the swapchain render pass would have left it in. Anything drawn or copied
+    // next, the UI or a capture, waits on the blit; presenting waits on the frame's semaphore.
+    VkImageMemoryBarrier to_final = to_destination;
+    to_final.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    to_final.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    to_final.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    to_final.newLayout = final_layout;
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                         0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &to_final);
+}
+
+bool Renderer::VulkanSceneTarget::CreateRenderPass(VkFormat const format)
+{
+    VkAttachmentDescription colour_attachment = {};
+    colour_attachment.format = format;
+    colour_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    colour_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colour_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colour_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    colour_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    colour_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    // Left ready for the blit up to the swapchain image
+    colour_attachment.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+    VkAttachmentReference colour_attachment_ref = {};
+    colour_attachment_ref.attachment = 0;
+    colour_attachment_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkSubpassDescription subpass = {};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &colour_attachment_ref;
+
+    // In from the last blit that read the image, out to the next one
+    VkSubpassDependency dependencies[2] = {};
+    dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[0].dstSubpass = 0;
+    dependencies[0].srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    dependencies[0].srcAccessMask = 0;
+    dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+    dependencies[1].srcSubpass = 0;
+    dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependencies[1].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    dependencies[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    VkRenderPassCreateInfo render_pass_info = {};
+    render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    render_pass_info.attachmentCount = 1;
+    render_pass_info.pAttachments = &colour_attachment;
+    render_pass_info.subpassCount = 1;
+    render_pass_info.pSubpasses = &subpass;
+    render_pass_info.dependencyCount = 2;
+    render_pass_info.pDependencies = dependencies;
+
+    if (vkCreateRenderPass(m_logical_device, &render_pass_info, nullptr, &m_render_pass) != VK_SUCCESS)
+    {
+        ERROR_LOG("Failed to create scene render pass");
+        m_render_pass = VK_NULL_HANDLE;
+        return false;
+    }
+    return true;
+}
+
+bool Renderer::VulkanSceneTarget::FindMemoryType(uint32_t const type_bits, VkMemoryPropertyFlags const properties, uint32_t & out_type) const
+{
+    VkPhysicalDeviceMemoryProperties memory_properties = {};
+    vkGetPhysicalDeviceMemoryProperties(m_physical_device, &memory_properties);
+
+    for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i)
+    {
+        if ((type_bits & (1u << i)) != 0 && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            out_type = i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cinttypes>
+#include <vector>
+
+namespace Renderer
+{
+    // Where the scene is drawn when it's drawn below the output's resolution: one image per
+    // swapchain image at the swapchain's full size, with the scene drawn into its top left
+    // corner so changing scale never reallocates. Blitted up to the swapchain image afterwards.
+    class VulkanSceneTarget
+    {
+    public:
+        VulkanSceneTarget(VkPhysicalDevice physical_device, VkDevice logical_device);
+        ~VulkanSceneTarget();
+
+        VulkanSceneTarget(VulkanSceneTarget const &) = delete;
+        VulkanSceneTarget & operator=(VulkanSceneTarget const &) = delete;
+
+        // Whether images of the format can be drawn to and blitted between with filtering
+        static bool IsSupported(VkPhysicalDevice physical_device, VkFormat const format);
+
+        // Compatible with the swapchain render pass, so the same pipelines draw into either
+        bool Create(VkFormat const format, VkExtent2D const extent, uint32_t const image_count);
+        void Destroy();
+
+        bool IsCreated() const { return m_render_pass != VK_NULL_HANDLE; }
+        VkExtent2D GetExtent() const { return m_extent; }
+        VkRenderPass GetRenderPass() const { return m_render_pass; }
+        VkFramebuffer GetFramebuffer(uint32_t const image_index) const { return m_framebuffers[image_index]; }
+
+        // After the scene's render pass: scales its scene_extent corner up over the whole of
+        // the destination, which is left in final_layout. The destination needs transfer
+        // destination usage and is overwritten completely, whatever was in it is discarded.
+        void RecordUpscale(VkCommandBuffer command_buffer,
+                           uint32_t const image_index,
+                           VkExtent2D const scene_extent,
+                           VkImage destination,
+                           VkExtent2D const destination_extent,
+                           VkImageLayout const final_layout) const;
+
+    private:
+        bool CreateRenderPass(VkFormat const format);
+        bool FindMemoryType(uint32_t const type_bits, VkMemoryPropertyFlags const properties, uint32_t & out_type) const;
+
+        VkPhysicalDevice m_physical_device;
+        VkDevice m_logical_device;
+
+        VkExtent2D m_extent;
+        VkRenderPass m_render_pass;
+        std::vector<VkImage> m_images;
+        std::vector<VkDeviceMemory> m_memory;
+        std::vector<VkImageView> m_image_views;
+        std::vector<VkFramebuffer> m_framebuffers;
+    };
+}
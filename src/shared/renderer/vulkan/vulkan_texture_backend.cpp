@@ -0,0 +1,329 @@
+#include "vulkan_texture_backend.hpp"
+
+#include "utility/logging.hpp"
+
+#include <cstring>
+
+namespace
+{
+    VkFormat get_vulkan_format(Renderer::ETextureFormat const format)
+    {
+        switch (format)
+        {
+        case Renderer::ETextureFormat::RGBA8:
+            return VK_FORMAT_R8G8B8A8_UNORM;
+        case Renderer::ETextureFormat::BC1:
+            return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+        case Renderer::ETextureFormat::BC4:
+            return VK_FORMAT_BC4_UNORM_BLOCK;
+        case Renderer::ETextureFormat::BC3:
+            return VK_FORMAT_BC3_UNORM_BLOCK;
+        case Renderer::ETextureFormat::BC5:
+            return VK_FORMAT_BC5_UNORM_BLOCK;
+        case Renderer::ETextureFormat::BC7:
+            return VK_FORMAT_BC7_UNORM_BLOCK;
+        case Renderer::ETextureFormat::R8:
+            return VK_FORMAT_R8_UNORM;
+        case Renderer::ETextureFormat::Count:
+            return VK_FORMAT_UNDEFINED;
+        }
+        return VK_FORMAT_UNDEFINED;
+    }
+
+    void transition_level(VkCommandBuffer command_buffer, VkImage image, uint32_t const level,
+                          VkImageLayout const old_layout, VkImageLayout const new_layout,
+                          VkAccessFlags const src_access, VkAccessFlags const dst_access,
+                          VkPipelineStageFlags const src_stage, VkPipelineStageFlags const dst_stage)
+    {
+        VkImageMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = old_layout;
+        barrier.newLayout = new_layout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel = level;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+        barrier.srcAccessMask = src_access;
+        barrier.dstAccessMask = dst_access;
+
+        vkCmdPipelineBarrier(command_buffer, src_stage, dst_stage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+}
+
+Renderer::VulkanTextureBackend::VulkanTextureBackend(VkPhysicalDevice physical_device, VkDevice logical_device, VkQueue queue, VkCommandPool command_pool)
+: m_physical_device(physical_device)
+, m_logical_device(logical_device)
+, m_queue(queue)
+, m_command_pool(command_pool)
+, m_textures()
+, m_free_slots()
+{
+}
+
+Renderer::VulkanTextureBackend::~VulkanTextureBackend()
+{
+    for (STexture & texture : m_textures)
+    {
+        Release(texture);
+    }
+}
+
+uint32_t Renderer::VulkanTextureBackend::CreateTexture(ETextureFormat const format, uint32_t const width, uint32_t const height, uint32_t const mip_count)
+{
+    VkFormat const vulkan_format = get_vulkan_format(format);
+    if (vulkan_format == VK_FORMAT_UNDEFINED || width == 0 || height == 0 || mip_count == 0)
+    {
+        return INVALID_GPU_TEXTURE;
+    }
+
+    VkFormatProperties format_properties = {};
+    vkGetPhysicalDeviceFormatProperties(m_physical_device, vulkan_format, &format_properties);
+    if ((format_properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) == 0)
+    {
+        ERROR_LOG("Texture format " + std::to_string(static_cast<uint32_t>(format)) + " isn't supported by this device");
+        return INVALID_GPU_TEXTURE;
+    }
+
+    STexture texture;
+
+    VkImageCreateInfo image_info = {};
+    image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_info.imageType = VK_IMAGE_TYPE_2D;
+    image_info.format = vulkan_format;
+    image_info.extent.width = width;
+    image_info.extent.height = height;
+    image_info.extent.depth = 1;
+    image_info.mipLevels = mip_count;
+    image_info.arrayLayers = 1;
+    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    if (vkCreateImage(m_logical_device, &image_info, nullptr, &texture.image) != VK_SUCCESS)
+    {
+        ERROR_LOG("Failed to create texture image");
+        return INVALID_GPU_TEXTURE;
+    }
+
+    VkMemoryRequirements requirements = {};
+    vkGetImageMemoryRequirements(m_logical_device, texture.image, &requirements);
+
+    VkMemoryAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = requirements.size;
+
+    if (FindMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, alloc_info.memoryTypeIndex) == false ||
+        vkAllocateMemory(m_logical_device, &alloc_info, nullptr, &texture.memory) != VK_SUCCESS ||
+        vkBindImageMemory(m_logical_device, texture.image, texture.memory, 0) != VK_SUCCESS)
+    {
+        ERROR_LOG("Failed to allocate texture memory");
+        Release(texture);
+        return INVALID_GPU_TEXTURE;
+    }
+
+    VkImageViewCreateInfo view_info = {};
+    view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    view_info.image = texture.image;
+    view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    view_info.format = vulkan_format;
+    view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    view_info.subresourceRange.baseMipLevel = 0;
+    view_info.subresourceRange.levelCount = mip_count;
+    view_info.subresourceRange.baseArrayLayer = 0;
+    view_info.subresourceRange.layerCount = 1;
+
+    if (vkCreateImageView(m_logical_device, &view_info, nullptr, &texture.view) != VK_SUCCESS)
+    {
+        ERROR_LOG("Failed to create texture image view");
+        Release(texture);
+        return INVALID_GPU_TEXTURE;
+    }
+
+    uint32_t slot = 0;
+    if (m_free_slots.empty() == false)
+    {
+        slot = m_free_slots.back();
+        m_free_slots.pop_back();
+        m_textures[slot] = texture;
+    }
+    else
+    {
+        slot = static_cast<uint32_t>(m_textures.size());
+        m_textures.push_back(texture);
+    }
+    return slot + 1;
+}
+
+void Renderer::VulkanTextureBackend::UploadMip(uint32_t const texture, uint32_t const level, uint32_t const width, uint32_t const height, void const * data, size_t const size)
+{
+    if (texture == INVALID_GPU_TEXTURE || texture > m_textures.size() || m_textures[texture - 1].image == VK_NULL_HANDLE)
+    {
+        return;
+    }
+    VkImage const image = m_textures[texture - 1].image;
+
+    VkBuffer staging_buffer = VK_NULL_HANDLE;
+    VkDeviceMemory staging_memory = VK_NULL_HANDLE;
+
+    VkBufferCreateInfo buffer_info = {};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size = size;
+    buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(m_logical_device, &buffer_info, nullptr, &staging_buffer) != VK_SUCCESS)
+    {
+        ERROR_LOG("Failed to create texture staging buffer");
+        return;
+    }
+
+    VkMemoryRequirements requirements = {};
+    vkGetBufferMemoryRequirements(m_logical_device, staging_buffer, &requirements);
+
+    VkMemoryAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = requirements.size;
+
+    void * mapped = nullptr;
+    bool const staged = FindMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, alloc_info.memoryTypeIndex) &&
+                        vkAllocateMemory(m_logical_device, &alloc_info, nullptr, &staging_memory) == VK_SUCCESS &&
+                        vkBindBufferMemory(m_logical_device, staging_buffer, staging_memory, 0) == VK_SUCCESS &&
+                        vkMapMemory(m_logical_device, staging_memory, 0, size, 0, &mapped) == VK_SUCCESS;
+
+    VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+    if (staged == true)
+    {
+        std::memcpy(mapped, data, size);
+        vkUnmapMemory(m_logical_device, staging_memory);
+
+        VkCommandBufferAllocateInfo command_info = {};
+        command_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        command_info.commandPool = m_command_pool;
+        command_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        command_info.commandBufferCount = 1;
+
+        if (vkAllocateCommandBuffers(m_logical_device, &command_info, &command_buffer) != VK_SUCCESS)
+        {
+            command_buffer = VK_NULL_HANDLE;
+        }
+    }
+
+    if (command_buffer != VK_NULL_HANDLE)
+    {
+        VkCommandBufferBeginInfo begin_info = {};
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(command_buffer, &begin_info);
+
+        // Each level is only ever uploaded once, so it always starts out undefined
+        transition_level(command_buffer, image, level,
+                         VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+        VkBufferImageCopy region = {};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent.width = width;
+        region.imageExtent.height = height;
+        region.imageExtent.depth = 1;
+        vkCmdCopyBufferToImage(command_buffer, staging_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+        transition_level(command_buffer, image, level,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+        vkEndCommandBuffer(command_buffer);
+
+        VkSubmitInfo submit_info = {};
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &command_buffer;
+
+        if (vkQueueSubmit(m_queue, 1, &submit_info, VK_NULL_HANDLE) == VK_SUCCESS)
+        {
+            vkQueueWaitIdle(m_queue);
+        }
+        else
+        {
+            ERROR_LOG("Failed to submit texture upload");
+        }
+
+        vkFreeCommandBuffers(m_logical_device, m_command_pool, 1, &command_buffer);
+    }
+    else
+    {
+        ERROR_LOG("Failed to stage texture upload");
+    }
+
+    vkDestroyBuffer(m_logical_device, staging_buffer, nullptr);
+    if (staging_memory != VK_NULL_HANDLE)
+    {
+        vkFreeMemory(m_logical_device, staging_memory, nullptr);
+    }
+}
+
+void Renderer::VulkanTextureBackend::DestroyTexture(uint32_t const texture)
+{
+    if (texture == INVALID_GPU_TEXTURE || texture > m_textures.size() || m_textures[texture - 1].image == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    // Uploads wait for the queue but a frame drawing with the texture may still be in flight
+    vkQueueWaitIdle(m_queue);
+
+    Release(m_textures[texture - 1]);
+    m_free_slots.push_back(texture - 1);
+}
+
+VkImageView Renderer::VulkanTextureBackend::GetImageView(uint32_t const texture) const
+{
+    if (texture == INVALID_GPU_TEXTURE || texture > m_textures.size())
+    {
+        return VK_NULL_HANDLE;
+    }
+    return m_textures[texture - 1].view;
+}
+
+bool Renderer::VulkanTextureBackend::FindMemoryType(uint32_t const type_bits, VkMemoryPropertyFlags const properties, uint32_t & out_type) const
+{
+    VkPhysicalDeviceMemoryProperties memory_properties = {};
+    vkGetPhysicalDeviceMemoryProperties(m_physical_device, &memory_properties);
+
+    for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i)
+    {
+        if ((type_bits & (1u << i)) != 0 && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            out_type = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Renderer::VulkanTextureBackend::Release(STexture & texture)
+{
+    if (texture.view != VK_NULL_HANDLE)
+    {
+        vkDestroyImageView(m_logical_device, texture.view, nullptr);
+    }
+    if (texture.image != VK_NULL_HANDLE)
+    {
+        vkDestroyImage(m_logical_device, texture.image, nullptr);
+    }
+    if (texture.memory != VK_NULL_HANDLE)
+    {
+        vkFreeMemory(m_logical_device, texture.memory, nullptr);
+    }
+    texture = STexture();
+}
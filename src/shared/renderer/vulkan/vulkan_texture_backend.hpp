@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+
+#include "renderer/texture/texture_backend.hpp"
+
+namespace Renderer
+{
+    // Textures as device local images. Every level is copied in through its own staging buffer
+    // and waited on before returning, which is fine while the context idles the device each
+    // frame anyway but is the first thing to batch once it doesn't.
+    class VulkanTextureBackend : public ITextureBackend
+    {
+    public:
+        VulkanTextureBackend(VkPhysicalDevice physical_device, VkDevice logical_device, VkQueue queue, VkCommandPool command_pool);
+        ~VulkanTextureBackend();
+
+        VulkanTextureBackend(VulkanTextureBackend const &) = delete;
+        VulkanTextureBackend & operator=(VulkanTextureBackend const &) = delete;
+
+        virtual uint32_t CreateTexture(ETextureFormat const format, uint32_t const width, uint32_t const height, uint32_t const mip_count) override;
+        virtual void UploadMip(uint32_t const texture, uint32_t const level, uint32_t const width, uint32_t const height, void const * data, size_t const size) override;
+        virtual void DestroyTexture(uint32_t const texture) override;
+
+        // For binding, VK_NULL_HANDLE for an unknown texture
+        VkImageView GetImageView(uint32_t const texture) const;
+
+    private:
+        struct STexture
+        {
+            VkImage image = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkImageView view = VK_NULL_HANDLE;
+        };
+
+        bool FindMemoryType(uint32_t const type_bits, VkMemoryPropertyFlags const properties, uint32_t & out_type) const;
+        void Release(STexture & texture);
+
+        VkPhysicalDevice m_physical_device;
+        VkDevice m_logical_device;
+        VkQueue m_queue;
+        VkCommandPool m_command_pool;
+
+        // Texture ids are slot + 1 so zero stays invalid
+        std::vector<STexture> m_textures;
+        std::vector<uint32_t> m_free_slots;
+    };
+}
@@ -0,0 +1,39 @@
+#include "hierarchy_system.hpp"
+
+#include "renderer/render_system.hpp"
+
+Scene::CHierarchySystem::CHierarchySystem(CTransformHierarchy & hierarchy)
+: m_hierarchy(hierarchy)
+, m_query(ECS::CQuery::Create<SNodeComponent, Renderer::STransformComponent>())
+{
+}
+
+ECS::ComponentMask Scene::CHierarchySystem::GetReadMask() const
+{
+    return ECS::component_mask<SNodeComponent>();
+}
+
+ECS::ComponentMask Scene::CHierarchySystem::GetWriteMask() const
+{
+    return ECS::component_mask<Renderer::STransformComponent>();
+}
+
+void Scene::CHierarchySystem::Update(ECS::CWorld & world, ECS::CCommandBuffer & commands, float const delta_time)
+{
+    (void)commands;
+    (void)delta_time;
+
+    m_hierarchy.UpdateWorldTransforms();
+
+    // Copied every frame rather than only for the nodes that changed, an entity given a node
+    // after its last update still has to pick its matrix up
+    m_query.ForEach<SNodeComponent, Renderer::STransformComponent>(world, [this](ECS::SEntity const entity, SNodeComponent const & node, Renderer::STransformComponent & transform)
+    {
+        (void)entity;
+
+        if (m_hierarchy.IsValid(node.node) == true)
+        {
+            transform.transform = m_hierarchy.GetWorldMatrix(node.node);
+        }
+    });
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "ecs/query.hpp"
+#include "ecs/system_scheduler.hpp"
+#include "scene/transform_hierarchy.hpp"
+
+namespace Scene
+{
+    // Ties an entity to a node in the hierarchy, whose world matrix becomes its transform
+    struct SNodeComponent
+    {
+        NodeId node = INVALID_NODE;
+    };
+
+    // Brings the hierarchy's world matrices up to date and copies each one into the
+    // Renderer::STransformComponent of every entity with a node. Register it before anything
+    // reading transforms so the scheduler runs it first. The hierarchy has to outlive it.
+    class CHierarchySystem : public ECS::ISystem
+    {
+    public:
+        explicit CHierarchySystem(CTransformHierarchy & hierarchy);
+
+        virtual char const * GetName() const override { return "Hierarchy"; }
+        virtual ECS::ComponentMask GetReadMask() const override;
+        virtual ECS::ComponentMask GetWriteMask() const override;
+        virtual void Update(ECS::CWorld & world, ECS::CCommandBuffer & commands, float const delta_time) override;
+
+    private:
+        CTransformHierarchy & m_hierarchy;
+        ECS::CQuery m_query;
+    };
+}
@@ -0,0 +1,559 @@
+#include "scene_file.hpp"
+
+#include "utility/logging.hpp"
+#include "utility/memory/memory_tracker.hpp"
+
+#include <glm/common.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    using namespace Scene;
+
+    constexpr size_t SECTION_TYPE_COUNT = static_cast<size_t>(ESceneSection::Count);
+
+    size_t align_up(size_t const value)
+    {
+        return (value + SCENE_FILE_ALIGNMENT - 1) & ~(SCENE_FILE_ALIGNMENT - 1);
+    }
+
+    // Lays out the header, section table and aligned section data, then writes it in one go
+    class CFileBuilder
+    {
+    public:
+        explicit CFileBuilder(uint32_t const magic)
+        : m_magic(magic)
+        , m_sections()
+        , m_data()
+        {
+        }
+
+        template <typename T>
+        void AddSection(ESceneSection const type, T const * elements, size_t const count)
+        {
+            SFileSection section;
+            section.type = static_cast<uint32_t>(type);
+            section.element_size = sizeof(T);
+            section.count = count;
+            m_sections.push_back(section);
+
+            uint8_t const * bytes = reinterpret_cast<uint8_t const *>(elements);
+            m_data.emplace_back(bytes, bytes + count * sizeof(T));
+        }
+
+        bool Write(std::string const & filename)
+        {
+            size_t offset = align_up(sizeof(SFileHeader) + m_sections.size() * sizeof(SFileSection));
+            for (size_t i = 0; i < m_sections.size(); ++i)
+            {
+                m_sections[i].offset = offset;
+                offset = align_up(offset + m_data[i].size());
+            }
+
+            SFileHeader header;
+            header.magic = m_magic;
+            header.version = SCENE_FILE_VERSION;
+            header.file_size = offset;
+            header.section_count = static_cast<uint32_t>(m_sections.size());
+
+            std::vector<uint8_t> file(offset, 0);
+            std::memcpy(file.data(), &header, sizeof(header));
+            std::memcpy(file.data() + sizeof(header), m_sections.data(), m_sections.size() * sizeof(SFileSection));
+            for (size_t i = 0; i < m_sections.size(); ++i)
+            {
+                std::copy(m_data[i].begin(), m_data[i].end(), file.begin() + static_cast<std::ptrdiff_t>(m_sections[i].offset));
+            }
+
+            std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+            if (stream.is_open() == false)
+            {
+                ERROR_LOG("Failed to open file for writing: " + filename);
+                return false;
+            }
+            stream.write(reinterpret_cast<char const *>(file.data()), static_cast<std::streamsize>(file.size()));
+            return stream.good();
+        }
+
+    private:
+        uint32_t m_magic;
+        std::vector<SFileSection> m_sections;
+        std::vector<std::vector<uint8_t>> m_data;
+    };
+
+    uint32_t add_string(std::vector<char> & strings, std::string const & value)
+    {
+        uint32_t const offset = static_cast<uint32_t>(strings.size());
+        strings.insert(strings.end(), value.begin(), value.end());
+        strings.push_back('\0');
+        return offset;
+    }
+
+    // Checks the header and every section's bounds, and finds the ones this version knows about
+    bool read_sections(uint8_t const * data, size_t const size, uint32_t const magic, std::string const & filename,
+                       SFileSection const * (&out_sections)[SECTION_TYPE_COUNT])
+    {
+        std::fill(std::begin(out_sections), std::end(out_sections), nullptr);
+
+        if (size < sizeof(SFileHeader))
+        {
+            ERROR_LOG("File too small: " + filename);
+            return false;
+        }
+
+        SFileHeader const & header = *reinterpret_cast<SFileHeader const *>(data);
+        if (header.magic != magic)
+        {
+            ERROR_LOG("Not a scene or project file: " + filename);
+            return false;
+        }
+        if (header.version != SCENE_FILE_VERSION)
+        {
+            ERROR_LOG("Unsupported file version " + std::to_string(header.version) + ": " + filename);
+            return false;
+        }
+        if (header.file_size != size || sizeof(SFileHeader) + static_cast<uint64_t>(header.section_count) * sizeof(SFileSection) > size)
+        {
+            ERROR_LOG("File is truncated: " + filename);
+            return false;
+        }
+
+        SFileSection const * sections = reinterpret_cast<SFileSection const *>(data + sizeof(SFileHeader));
+        for (uint32_t i = 0; i < header.section_count; ++i)
+        {
+            SFileSection const & section = sections[i];
+            if (section.type >= SECTION_TYPE_COUNT)
+            {
+                continue;
+            }
+
+            bool const in_bounds = section.element_size != 0 &&
+                                   section.offset % SCENE_FILE_ALIGNMENT == 0 &&
+                                   section.offset <= size &&
+                                   section.count <= (size - section.offset) / section.element_size;
+            if (in_bounds == false)
+            {
+                ERROR_LOG("Section " + std::to_string(section.type) + " is out of bounds: " + filename);
+                return false;
+            }
+            out_sections[section.type] = &section;
+        }
+        return true;
+    }
+
+    // Pointer to a section's array and its length, an absent section is just empty
+    template <typename T>
+    bool get_section(uint8_t const * data, SFileSection const * section, std::string const & filename, T const *& out_elements, uint64_t & out_count)
+    {
+        out_elements = nullptr;
+        out_count = 0;
+        if (section == nullptr)
+        {
+            return true;
+        }
+
+        if (section->element_size != sizeof(T))
+        {
+            ERROR_LOG("Section " + std::to_string(section->type) + " has the wrong element size: " + filename);
+            return false;
+        }
+
+        out_elements = reinterpret_cast<T const *>(data + section->offset);
+        out_count = section->count;
+        return true;
+    }
+
+    bool valid_string(uint64_t const offset, uint64_t const string_size)
+    {
+        return offset < string_size;
+    }
+
+    void copy3(float * out, glm::vec3 const & value)
+    {
+        out[0] = value.x;
+        out[1] = value.y;
+        out[2] = value.z;
+    }
+}
+
+bool Scene::save_scene(SSceneDesc const & scene, std::string const & filename)
+{
+    std::vector<char> strings;
+    add_string(strings, "");
+
+    std::vector<SFileMesh> meshes;
+    std::vector<SFileVec3> positions;
+    std::vector<SFileVec4> colours;
+    std::vector<uint32_t> indices;
+    meshes.reserve(scene.meshes.size());
+
+    for (SSceneMeshDesc const & mesh_desc : scene.meshes)
+    {
+        SFileMesh mesh;
+        mesh.first_vertex = static_cast<uint32_t>(positions.size());
+        mesh.vertex_count = static_cast<uint32_t>(mesh_desc.positions.size());
+        mesh.first_index = static_cast<uint32_t>(indices.size());
+        mesh.index_count = static_cast<uint32_t>(mesh_desc.indices.size());
+
+        glm::vec3 bounds_min(0.0f);
+        glm::vec3 bounds_max(0.0f);
+        for (size_t i = 0; i < mesh_desc.positions.size(); ++i)
+        {
+            glm::vec3 const & position = mesh_desc.positions[i];
+            bounds_min = i == 0 ? position : glm::min(bounds_min, position);
+            bounds_max = i == 0 ? position : glm::max(bounds_max, position);
+
+            positions.push_back({ position.x, position.y, position.z });
+
+            // Missing colours default to white so the arrays always line up
+            glm::vec4 const colour = i < mesh_desc.colours.size() ? mesh_desc.colours[i] : glm::vec4(1.0f);
+            colours.push_back({ colour.x, colour.y, colour.z, colour.w });
+        }
+        copy3(mesh.bounds_min, bounds_min);
+        copy3(mesh.bounds_max, bounds_max);
+
+        for (uint32_t const index : mesh_desc.indices)
+        {
+            if (index >= mesh.vertex_count)
+            {
+                ERROR_LOG("Mesh index out of range, not saving " + filename);
+                return false;
+            }
+            indices.push_back(index);
+        }
+
+        meshes.push_back(mesh);
+    }
+
+    std::vector<SFileNode> nodes;
+    nodes.reserve(scene.nodes.size());
+    for (size_t i = 0; i < scene.nodes.size(); ++i)
+    {
+        SSceneNodeDesc const & node_desc = scene.nodes[i];
+        if ((node_desc.parent != INVALID_FILE_INDEX && node_desc.parent >= i) ||
+            (node_desc.mesh != INVALID_FILE_INDEX && node_desc.mesh >= meshes.size()))
+        {
+            ERROR_LOG("Node " + node_desc.name + " refers to a later node or missing mesh, not saving " + filename);
+            return false;
+        }
+
+        SFileNode node;
+        node.name = add_string(strings, node_desc.name);
+        node.parent = node_desc.parent;
+        node.mesh = node_desc.mesh;
+        copy3(node.position, node_desc.position);
+        node.rotation[0] = node_desc.rotation.x;
+        node.rotation[1] = node_desc.rotation.y;
+        node.rotation[2] = node_desc.rotation.z;
+        node.rotation[3] = node_desc.rotation.w;
+        copy3(node.scale, node_desc.scale);
+        nodes.push_back(node);
+    }
+
+    CFileBuilder builder(SCENE_FILE_MAGIC);
+    builder.AddSection(ESceneSection::Strings, strings.data(), strings.size());
+    builder.AddSection(ESceneSection::Nodes, nodes.data(), nodes.size());
+    builder.AddSection(ESceneSection::Meshes, meshes.data(), meshes.size());
+    builder.AddSection(ESceneSection::Positions, positions.data(), positions.size());
+    builder.AddSection(ESceneSection::Colours, colours.data(), colours.size());
+    builder.AddSection(ESceneSection::Indices, indices.data(), indices.size());
+    return builder.Write(filename);
+}
+
+Scene::CSceneFile::CSceneFile()
+: m_file()
+, m_strings(nullptr)
+, m_nodes(nullptr)
+, m_meshes(nullptr)
+, m_positions(nullptr)
+, m_colours(nullptr)
+, m_indices(nullptr)
+, m_string_size(0)
+, m_node_count(0)
+, m_mesh_count(0)
+, m_vertex_count(0)
+, m_index_count(0)
+{
+}
+
+bool Scene::CSceneFile::Open(std::string const & filename)
+{
+    Close();
+
+    if (m_file.Open(filename) == false)
+    {
+        return false;
+    }
+
+    if (Validate(filename) == false)
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void Scene::CSceneFile::Close()
+{
+    m_file.Close();
+
+    m_strings = nullptr;
+    m_nodes = nullptr;
+    m_meshes = nullptr;
+    m_positions = nullptr;
+    m_colours = nullptr;
+    m_indices = nullptr;
+    m_string_size = 0;
+    m_node_count = 0;
+    m_mesh_count = 0;
+    m_vertex_count = 0;
+    m_index_count = 0;
+}
+
+bool Scene::CSceneFile::Validate(std::string const & filename)
+{
+    uint8_t const * data = m_file.GetData();
+
+    SFileSection const * sections[SECTION_TYPE_COUNT];
+    if (read_sections(data, m_file.GetSize(), SCENE_FILE_MAGIC, filename, sections) == false)
+    {
+        return false;
+    }
+
+    auto section = [&sections](ESceneSection const type) { return sections[static_cast<size_t>(type)]; };
+
+    uint64_t node_count = 0;
+    uint64_t mesh_count = 0;
+    uint64_t colour_count = 0;
+    bool const sections_valid = get_section(data, section(ESceneSection::Strings), filename, m_strings, m_string_size) &&
+                                get_section(data, section(ESceneSection::Nodes), filename, m_nodes, node_count) &&
+                                get_section(data, section(ESceneSection::Meshes), filename, m_meshes, mesh_count) &&
+                                get_section(data, section(ESceneSection::Positions), filename, m_positions, m_vertex_count) &&
+                                get_section(data, section(ESceneSection::Colours), filename, m_colours, colour_count) &&
+                                get_section(data, section(ESceneSection::Indices), filename, m_indices, m_index_count);
+    if (sections_valid == false)
+    {
+        return false;
+    }
+
+    if (m_string_size == 0 || m_strings[m_string_size - 1] != '\0' || colour_count != m_vertex_count ||
+        node_count >= INVALID_FILE_INDEX || mesh_count >= INVALID_FILE_INDEX)
+    {
+        ERROR_LOG("Scene file is malformed: " + filename);
+        return false;
+    }
+    m_node_count = static_cast<uint32_t>(node_count);
+    m_mesh_count = static_cast<uint32_t>(mesh_count);
+
+    // The only pass over the data, everything after this trusts it
+    for (uint32_t i = 0; i < m_node_count; ++i)
+    {
+        SFileNode const & node = m_nodes[i];
+        if (valid_string(node.name, m_string_size) == false ||
+            (node.parent != INVALID_FILE_INDEX && node.parent >= i) ||
+            (node.mesh != INVALID_FILE_INDEX && node.mesh >= m_mesh_count))
+        {
+            ERROR_LOG("Scene node " + std::to_string(i) + " is malformed: " + filename);
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < m_mesh_count; ++i)
+    {
+        SFileMesh const & mesh = m_meshes[i];
+        if (static_cast<uint64_t>(mesh.first_vertex) + mesh.vertex_count > m_vertex_count ||
+            static_cast<uint64_t>(mesh.first_index) + mesh.index_count > m_index_count)
+        {
+            ERROR_LOG("Scene mesh " + std::to_string(i) + " is malformed: " + filename);
+            return false;
+        }
+
+        uint32_t const * indices = m_indices + mesh.first_index;
+        if (std::any_of(indices, indices + mesh.index_count, [&mesh](uint32_t const index) { return index >= mesh.vertex_count; }))
+        {
+            ERROR_LOG("Scene mesh " + std::to_string(i) + " has an index out of range: " + filename);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Scene::load_transform_hierarchy(CSceneFile const & scene, CTransformHierarchy & hierarchy, std::vector<NodeId> & out_nodes)
+{
+    out_nodes.clear();
+    out_nodes.reserve(scene.GetNodeCount());
+    hierarchy.Reserve(hierarchy.NodeCount() + scene.GetNodeCount());
+
+    for (uint32_t i = 0; i < scene.GetNodeCount(); ++i)
+    {
+        SFileNode const & file_node = scene.GetNodes()[i];
+        NodeId const parent = file_node.parent == INVALID_FILE_INDEX ? INVALID_NODE : out_nodes[file_node.parent];
+
+        NodeId const node = hierarchy.CreateNode(parent);
+        hierarchy.SetLocalPosition(node, glm::vec3(file_node.position[0], file_node.position[1], file_node.position[2]));
+        hierarchy.SetLocalRotation(node, glm::quat(file_node.rotation[3], file_node.rotation[0], file_node.rotation[1], file_node.rotation[2]));
+        hierarchy.SetLocalScale(node, glm::vec3(file_node.scale[0], file_node.scale[1], file_node.scale[2]));
+        out_nodes.push_back(node);
+    }
+}
+
+void Scene::load_scene_mesh(CSceneFile const & scene, uint32_t const mesh, SSceneMeshDesc & out_mesh)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Assets);
+
+    SFileMesh const & file_mesh = scene.GetMeshes()[mesh];
+
+    out_mesh.positions.clear();
+    out_mesh.colours.clear();
+    out_mesh.positions.reserve(file_mesh.vertex_count);
+    out_mesh.colours.reserve(file_mesh.vertex_count);
+    for (uint32_t v = 0; v < file_mesh.vertex_count; ++v)
+    {
+        SFileVec3 const & position = scene.GetPositions()[file_mesh.first_vertex + v];
+        SFileVec4 const & colour = scene.GetColours()[file_mesh.first_vertex + v];
+        out_mesh.positions.emplace_back(position.x, position.y, position.z);
+        out_mesh.colours.emplace_back(colour.x, colour.y, colour.z, colour.w);
+    }
+
+    uint32_t const * indices = scene.GetIndices() + file_mesh.first_index;
+    out_mesh.indices.assign(indices, indices + file_mesh.index_count);
+}
+
+bool Scene::export_scene_text(CSceneFile const & scene, std::string const & filename)
+{
+    if (scene.IsOpen() == false)
+    {
+        return false;
+    }
+
+    std::FILE * file = std::fopen(filename.c_str(), "w");
+    if (file == nullptr)
+    {
+        ERROR_LOG("Failed to open file for writing: " + filename);
+        return false;
+    }
+
+    // %.9g round trips a float exactly
+    std::fprintf(file, "goat_scene %u\n", SCENE_FILE_VERSION);
+
+    std::fprintf(file, "\nnodes %u\n", scene.GetNodeCount());
+    for (uint32_t i = 0; i < scene.GetNodeCount(); ++i)
+    {
+        SFileNode const & node = scene.GetNodes()[i];
+        std::fprintf(file, "node %u \"%s\"\n", i, scene.GetName(node));
+        std::fprintf(file, "  parent %d\n", node.parent == INVALID_FILE_INDEX ? -1 : static_cast<int>(node.parent));
+        std::fprintf(file, "  mesh %d\n", node.mesh == INVALID_FILE_INDEX ? -1 : static_cast<int>(node.mesh));
+        std::fprintf(file, "  position %.9g %.9g %.9g\n", node.position[0], node.position[1], node.position[2]);
+        std::fprintf(file, "  rotation %.9g %.9g %.9g %.9g\n", node.rotation[0], node.rotation[1], node.rotation[2], node.rotation[3]);
+        std::fprintf(file, "  scale %.9g %.9g %.9g\n", node.scale[0], node.scale[1], node.scale[2]);
+    }
+
+    std::fprintf(file, "\nmeshes %u\n", scene.GetMeshCount());
+    for (uint32_t i = 0; i < scene.GetMeshCount(); ++i)
+    {
+        SFileMesh const & mesh = scene.GetMeshes()[i];
+        std::fprintf(file, "mesh %u\n", i);
+        std::fprintf(file, "  bounds %.9g %.9g %.9g  %.9g %.9g %.9g\n",
+                     mesh.bounds_min[0], mesh.bounds_min[1], mesh.bounds_min[2],
+                     mesh.bounds_max[0], mesh.bounds_max[1], mesh.bounds_max[2]);
+
+        std::fprintf(file, "  vertices %u\n", mesh.vertex_count);
+        for (uint32_t v = 0; v < mesh.vertex_count; ++v)
+        {
+            SFileVec3 const & position = scene.GetPositions()[mesh.first_vertex + v];
+            SFileVec4 const & colour = scene.GetColours()[mesh.first_vertex + v];
+            std::fprintf(file, "    %.9g %.9g %.9g  %.9g %.9g %.9g %.9g\n",
+                         position.x, position.y, position.z, colour.x, colour.y, colour.z, colour.w);
+        }
+
+        // A triangle per line
+        std::fprintf(file, "  indices %u\n", mesh.index_count);
+        uint32_t const * indices = scene.GetIndices() + mesh.first_index;
+        for (uint32_t n = 0; n < mesh.index_count; n += 3)
+        {
+            std::fprintf(file, "   ");
+            for (uint32_t k = n; k < std::min(n + 3, mesh.index_count); ++k)
+            {
+                std::fprintf(file, " %u", indices[k]);
+            }
+            std::fprintf(file, "\n");
+        }
+    }
+
+    bool const written = std::ferror(file) == 0;
+    std::fclose(file);
+    return written;
+}
+
+bool Scene::save_project(SProjectDesc const & project, std::string const & filename)
+{
+    std::vector<char> strings;
+    add_string(strings, "");
+
+    SFileProject info;
+    info.name = add_string(strings, project.name);
+
+    std::vector<uint32_t> scenes;
+    scenes.reserve(project.scenes.size());
+    for (std::string const & scene : project.scenes)
+    {
+        scenes.push_back(add_string(strings, scene));
+    }
+
+    CFileBuilder builder(PROJECT_FILE_MAGIC);
+    builder.AddSection(ESceneSection::Strings, strings.data(), strings.size());
+    builder.AddSection(ESceneSection::Project, &info, 1);
+    builder.AddSection(ESceneSection::ProjectScenes, scenes.data(), scenes.size());
+    return builder.Write(filename);
+}
+
+bool Scene::load_project(std::string const & filename, SProjectDesc & out_project)
+{
+    Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Assets);
+
+    FileHelpers::CMappedFile file;
+    if (file.Open(filename) == false)
+    {
+        return false;
+    }
+
+    uint8_t const * data = file.GetData();
+    SFileSection const * sections[SECTION_TYPE_COUNT];
+    if (read_sections(data, file.GetSize(), PROJECT_FILE_MAGIC, filename, sections) == false)
+    {
+        return false;
+    }
+
+    char const * strings = nullptr;
+    SFileProject const * info = nullptr;
+    uint32_t const * scenes = nullptr;
+    uint64_t string_size = 0;
+    uint64_t info_count = 0;
+    uint64_t scene_count = 0;
+    bool const sections_valid = get_section(data, sections[static_cast<size_t>(ESceneSection::Strings)], filename, strings, string_size) &&
+                                get_section(data, sections[static_cast<size_t>(ESceneSection::Project)], filename, info, info_count) &&
+                                get_section(data, sections[static_cast<size_t>(ESceneSection::ProjectScenes)], filename, scenes, scene_count);
+    if (sections_valid == false || string_size == 0 || strings[string_size - 1] != '\0' || info_count != 1 || valid_string(info->name, string_size) == false)
+    {
+        ERROR_LOG("Project file is malformed: " + filename);
+        return false;
+    }
+
+    // Small enough to just copy out
+    out_project.name = strings + info->name;
+    out_project.scenes.clear();
+    for (uint64_t i = 0; i < scene_count; ++i)
+    {
+        if (valid_string(scenes[i], string_size) == false)
+        {
+            ERROR_LOG("Project file is malformed: " + filename);
+            return false;
+        }
+        out_project.scenes.push_back(strings + scenes[i]);
+    }
+    return true;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "scene/scene_format.hpp"
+#include "scene/transform_hierarchy.hpp"
+#include "utility/file/mapped_file.hpp"
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+namespace Scene
+{
+    // What gets saved, built up by whoever owns the scene
+    struct SSceneMeshDesc
+    {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec4> colours;
+        std::vector<uint32_t> indices;
+    };
+
+    struct SSceneNodeDesc
+    {
+        std::string name;
+        // Index into the node list, which has to come earlier in it
+        uint32_t parent = INVALID_FILE_INDEX;
+        uint32_t mesh = INVALID_FILE_INDEX;
+        glm::vec3 position = glm::vec3(0.0f);
+        glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        glm::vec3 scale = glm::vec3(1.0f);
+    };
+
+    struct SSceneDesc
+    {
+        std::vector<SSceneNodeDesc> nodes;
+        std::vector<SSceneMeshDesc> meshes;
+    };
+
+    bool save_scene(SSceneDesc const & scene, std::string const & filename);
+
+    // A scene file mapped and used where it lies. Opening checks every offset, size and index
+    // in the file once, after that the accessors hand out pointers straight into the mapping.
+    class CSceneFile
+    {
+    public:
+        CSceneFile();
+
+        CSceneFile(CSceneFile const &) = delete;
+        CSceneFile & operator=(CSceneFile const &) = delete;
+
+        bool Open(std::string const & filename);
+        void Close();
+        bool IsOpen() const { return m_file.IsOpen(); }
+
+        uint32_t GetNodeCount() const { return m_node_count; }
+        SFileNode const * GetNodes() const { return m_nodes; }
+        char const * GetName(SFileNode const & node) const { return m_strings + node.name; }
+
+        uint32_t GetMeshCount() const { return m_mesh_count; }
+        SFileMesh const * GetMeshes() const { return m_meshes; }
+
+        // Shared by every mesh, see SFileMesh for each one's range
+        SFileVec3 const * GetPositions() const { return m_positions; }
+        SFileVec4 const * GetColours() const { return m_colours; }
+        uint32_t const * GetIndices() const { return m_indices; }
+
+    private:
+        bool Validate(std::string const & filename);
+
+        FileHelpers::CMappedFile m_file;
+
+        char const * m_strings;
+        SFileNode const * m_nodes;
+        SFileMesh const * m_meshes;
+        SFileVec3 const * m_positions;
+        SFileVec4 const * m_colours;
+        uint32_t const * m_indices;
+
+        uint64_t m_string_size;
+        uint32_t m_node_count;
+        uint32_t m_mesh_count;
+        uint64_t m_vertex_count;
+        uint64_t m_index_count;
+    };
+
+    // Creates a node for each of the file's nodes with its parent and local position, rotation
+    // and scale. out_nodes[i] is the node made for file node i. Validation already made sure
+    // parents come first, so every parent exists by the time its children are created.
+    void load_transform_hierarchy(CSceneFile const & scene, CTransformHierarchy & hierarchy, std::vector<NodeId> & out_nodes);
+
+    // Copies one of the file's meshes out of the shared arrays
+    void load_scene_mesh(CSceneFile const & scene, uint32_t const mesh, SSceneMeshDesc & out_mesh);
+
+    // Readable dump of everything in the scene, one value per line so changes diff cleanly
+    bool export_scene_text(CSceneFile const & scene, std::string const & filename);
+
+    struct SProjectDesc
+    {
+        std::string name;
+        // Paths of the project's scene files
+        std::vector<std::string> scenes;
+    };
+
+    bool save_project(SProjectDesc const & project, std::string const & filename);
+    bool load_project(std::string const & filename, SProjectDesc & out_project);
+}
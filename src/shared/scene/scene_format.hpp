@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <type_traits>
+
+// On disk layout of scene and project files. Everything is plain data with fixed sizes so a
+// file can be mapped and read in place: a header, a table of sections, then each section's
+// array starting on a SCENE_FILE_ALIGNMENT boundary. References between arrays are indices
+// and byte offsets from the start of the section, never pointers. Little endian only.
+namespace Scene
+{
+    constexpr uint32_t SCENE_FILE_MAGIC = 0x4e435347;   // GSCN
+    constexpr uint32_t PROJECT_FILE_MAGIC = 0x4a525047; // GPRJ
+
+    // Bump whenever any of the structs below change, older files are rejected rather than guessed at
+    constexpr uint32_t SCENE_FILE_VERSION = 1;
+
+    constexpr size_t SCENE_FILE_ALIGNMENT = 16;
+
+    constexpr uint32_t INVALID_FILE_INDEX = UINT32_MAX;
+
+    enum class ESceneSection : uint32_t
+    {
+        // Zero terminated names, referenced by byte offset
+        Strings,
+        Nodes,
+        Meshes,
+        Positions,
+        Colours,
+        Indices,
+        // Project files only, a single SFileProject and the string offset of each scene's path
+        Project,
+        ProjectScenes,
+
+        Count
+    };
+
+    struct SFileHeader
+    {
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint64_t file_size = 0;
+        uint32_t section_count = 0;
+        uint32_t reserved = 0;
+    };
+
+    // The section table follows straight after the header. Unknown section types are skipped
+    // so a newer writer can add sections without breaking older readers.
+    struct SFileSection
+    {
+        uint32_t type = 0;
+        uint32_t element_size = 0;
+        uint64_t offset = 0;
+        uint64_t count = 0;
+    };
+
+    // Nodes are stored parents first, so a node's parent index is always lower than its own
+    struct SFileNode
+    {
+        uint32_t name = 0;
+        uint32_t parent = INVALID_FILE_INDEX;
+        uint32_t mesh = INVALID_FILE_INDEX;
+        uint32_t flags = 0;
+        float position[3];
+        // x, y, z, w
+        float rotation[4];
+        float scale[3];
+    };
+
+    // Ranges into the shared vertex and index arrays
+    struct SFileMesh
+    {
+        uint32_t first_vertex = 0;
+        uint32_t vertex_count = 0;
+        uint32_t first_index = 0;
+        uint32_t index_count = 0;
+        float bounds_min[3];
+        float bounds_max[3];
+    };
+
+    struct SFileVec3
+    {
+        float x, y, z;
+    };
+
+    struct SFileVec4
+    {
+        float x, y, z, w;
+    };
+
+    struct SFileProject
+    {
+        uint32_t name = 0;
+        uint32_t flags = 0;
+    };
+
+    static_assert(sizeof(SFileHeader) == 24, "Scene file header layout changed");
+    static_assert(sizeof(SFileSection) == 24, "Scene file section layout changed");
+    static_assert(sizeof(SFileNode) == 56, "Scene file node layout changed");
+    static_assert(sizeof(SFileMesh) == 40, "Scene file mesh layout changed");
+    static_assert(sizeof(SFileVec3) == 12 && sizeof(SFileVec4) == 16, "Scene file vector layout changed");
+    static_assert(sizeof(SFileProject) == 8, "Project file layout changed");
+    static_assert(std::is_standard_layout<SFileNode>::value && std::is_standard_layout<SFileMesh>::value, "Scene file structs must be plain data");
+}
@@ -0,0 +1,412 @@
+#include "transform_hierarchy.hpp"
+
+#include "utility/logging.hpp"
+#include "utility/parallel_for.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
+namespace
+{
+    constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    // Levels smaller than this are updated on the calling thread
+    constexpr size_t TRANSFORM_CHUNK_SIZE = 2048;
+
+    glm::mat4 compose_trs(glm::vec3 const & t, glm::quat const & r, glm::vec3 const & s)
+    {
+        float const xx = r.x * r.x;
+        float const yy = r.y * r.y;
+        float const zz = r.z * r.z;
+        float const xy = r.x * r.y;
+        float const xz = r.x * r.z;
+        float const yz = r.y * r.z;
+        float const wx = r.w * r.x;
+        float const wy = r.w * r.y;
+        float const wz = r.w * r.z;
+
+        glm::mat4 m(1.0f);
+        m[0] = glm::vec4((1.0f - 2.0f * (yy + zz)) * s.x, 2.0f * (xy + wz) * s.x, 2.0f * (xz - wy) * s.x, 0.0f);
+        m[1] = glm::vec4(2.0f * (xy - wz) * s.y, (1.0f - 2.0f * (xx + zz)) * s.y, 2.0f * (yz + wx) * s.y, 0.0f);
+        m[2] = glm::vec4(2.0f * (xz + wy) * s.z, 2.0f * (yz - wx) * s.z, (1.0f - 2.0f * (xx + yy)) * s.z, 0.0f);
+        m[3] = glm::vec4(t, 1.0f);
+        return m;
+    }
+
+    template <typename T>
+    void permute(std::vector<T> & values, std::vector<uint32_t> const & new_to_old)
+    {
+        std::vector<T> sorted;
+        sorted.reserve(values.size());
+        for (uint32_t const old_index : new_to_old)
+        {
+            sorted.emplace_back(values[old_index]);
+        }
+        values.swap(sorted);
+    }
+
+    template <typename T>
+    void compact(std::vector<T> & values, std::vector<uint8_t> const & remove)
+    {
+        size_t write = 0;
+        for (size_t read = 0; read < values.size(); ++read)
+        {
+            if (remove[read] == 0)
+            {
+                values[write++] = values[read];
+            }
+        }
+        values.resize(write);
+    }
+}
+
+Scene::CTransformHierarchy::CTransformHierarchy()
+: m_order_dirty(false)
+, m_any_dirty(false)
+, m_last_update_count(0)
+{
+}
+
+void Scene::CTransformHierarchy::Reserve(size_t const node_count)
+{
+    m_node_ids.reserve(node_count);
+    m_parent_index.reserve(node_count);
+    m_depth.reserve(node_count);
+    m_local_position.reserve(node_count);
+    m_local_rotation.reserve(node_count);
+    m_local_scale.reserve(node_count);
+    m_world_matrix.reserve(node_count);
+    m_dirty.reserve(node_count);
+    m_id_to_index.reserve(node_count);
+}
+
+Scene::NodeId Scene::CTransformHierarchy::CreateNode(NodeId const parent)
+{
+    uint32_t parent_index = INVALID_INDEX;
+    if (parent != INVALID_NODE)
+    {
+        if (IsValid(parent) == false)
+        {
+            ERROR_LOG("Invalid parent node");
+            return INVALID_NODE;
+        }
+        parent_index = IndexOf(parent);
+    }
+
+    NodeId id = INVALID_NODE;
+    if (m_free_ids.empty() == false)
+    {
+        id = m_free_ids.back();
+        m_free_ids.pop_back();
+    }
+    else
+    {
+        id = static_cast<NodeId>(m_id_to_index.size());
+        m_id_to_index.push_back(INVALID_INDEX);
+    }
+
+    uint32_t const index = static_cast<uint32_t>(m_node_ids.size());
+    m_id_to_index[id] = index;
+
+    m_node_ids.push_back(id);
+    m_parent_index.push_back(parent_index);
+    m_depth.push_back(parent_index == INVALID_INDEX ? 0 : m_depth[parent_index] + 1);
+    m_local_position.push_back(glm::vec3(0.0f));
+    m_local_rotation.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+    m_local_scale.push_back(glm::vec3(1.0f));
+    m_world_matrix.push_back(glm::mat4(1.0f));
+    m_dirty.push_back(1);
+
+    // Appending keeps parents before children but breaks the depth grouping
+    m_order_dirty = true;
+    m_any_dirty = true;
+
+    return id;
+}
+
+void Scene::CTransformHierarchy::DestroyNode(NodeId const node)
+{
+    if (IsValid(node) == false)
+    {
+        return;
+    }
+
+    if (m_order_dirty == true)
+    {
+        SortByDepth();
+    }
+
+    // Parents come first so one forward pass finds the whole subtree
+    uint32_t const root = IndexOf(node);
+    std::vector<uint8_t> remove(m_node_ids.size(), 0);
+    remove[root] = 1;
+    for (size_t i = root + 1; i < m_node_ids.size(); ++i)
+    {
+        uint32_t const parent = m_parent_index[i];
+        if (parent != INVALID_INDEX && remove[parent] != 0)
+        {
+            remove[i] = 1;
+        }
+    }
+
+    RemoveIndices(remove);
+}
+
+bool Scene::CTransformHierarchy::SetParent(NodeId const node, NodeId const parent)
+{
+    if (IsValid(node) == false || (parent != INVALID_NODE && IsValid(parent) == false))
+    {
+        ERROR_LOG("Invalid node");
+        return false;
+    }
+
+    uint32_t const index = IndexOf(node);
+    uint32_t const parent_index = parent == INVALID_NODE ? INVALID_INDEX : IndexOf(parent);
+
+    for (uint32_t ancestor = parent_index; ancestor != INVALID_INDEX; ancestor = m_parent_index[ancestor])
+    {
+        if (ancestor == index)
+        {
+            ERROR_LOG("Can't parent a node to one of its own descendants");
+            return false;
+        }
+    }
+
+    m_parent_index[index] = parent_index;
+    m_order_dirty = true;
+    MarkDirty(index);
+    return true;
+}
+
+Scene::NodeId Scene::CTransformHierarchy::GetParent(NodeId const node) const
+{
+    assert(IsValid(node));
+    uint32_t const parent_index = m_parent_index[IndexOf(node)];
+    return parent_index == INVALID_INDEX ? INVALID_NODE : m_node_ids[parent_index];
+}
+
+bool Scene::CTransformHierarchy::IsValid(NodeId const node) const
+{
+    return node < m_id_to_index.size() && m_id_to_index[node] != INVALID_INDEX;
+}
+
+void Scene::CTransformHierarchy::SetLocalPosition(NodeId const node, glm::vec3 const & position)
+{
+    assert(IsValid(node));
+    uint32_t const index = IndexOf(node);
+    m_local_position[index] = position;
+    MarkDirty(index);
+}
+
+void Scene::CTransformHierarchy::SetLocalRotation(NodeId const node, glm::quat const & rotation)
+{
+    assert(IsValid(node));
+    uint32_t const index = IndexOf(node);
+    m_local_rotation[index] = rotation;
+    MarkDirty(index);
+}
+
+void Scene::CTransformHierarchy::SetLocalScale(NodeId const node, glm::vec3 const & scale)
+{
+    assert(IsValid(node));
+    uint32_t const index = IndexOf(node);
+    m_local_scale[index] = scale;
+    MarkDirty(index);
+}
+
+glm::vec3 const & Scene::CTransformHierarchy::GetLocalPosition(NodeId const node) const
+{
+    assert(IsValid(node));
+    return m_local_position[IndexOf(node)];
+}
+
+glm::quat const & Scene::CTransformHierarchy::GetLocalRotation(NodeId const node) const
+{
+    assert(IsValid(node));
+    return m_local_rotation[IndexOf(node)];
+}
+
+glm::vec3 const & Scene::CTransformHierarchy::GetLocalScale(NodeId const node) const
+{
+    assert(IsValid(node));
+    return m_local_scale[IndexOf(node)];
+}
+
+glm::mat4 const & Scene::CTransformHierarchy::GetWorldMatrix(NodeId const node) const
+{
+    assert(IsValid(node));
+    return m_world_matrix[IndexOf(node)];
+}
+
+void Scene::CTransformHierarchy::UpdateWorldTransforms()
+{
+    m_last_update_count = 0;
+
+    if (m_order_dirty == true)
+    {
+        SortByDepth();
+    }
+
+    if (m_any_dirty == false)
+    {
+        return;
+    }
+
+    std::atomic<size_t> update_count(0);
+
+    // Levels run in order, a node inside a level only reads its parent's world matrix and dirty
+    // flag which were finalised by the previous level. A recomputed node leaves its flag set so
+    // its children pick the change up, the flags are all cleared once every level is done.
+    for (size_t level = 0; level + 1 < m_level_offsets.size(); ++level)
+    {
+        size_t const level_begin = m_level_offsets[level];
+        size_t const level_end = m_level_offsets[level + 1];
+
+        Utility::parallel_for(level_end - level_begin, TRANSFORM_CHUNK_SIZE, [&](size_t const begin, size_t const end)
+        {
+            size_t chunk_updates = 0;
+            for (size_t i = level_begin + begin; i < level_begin + end; ++i)
+            {
+                uint32_t const parent = m_parent_index[i];
+                bool const parent_dirty = parent != INVALID_INDEX && m_dirty[parent] != 0;
+                if (m_dirty[i] == 0 && parent_dirty == false)
+                {
+                    continue;
+                }
+
+                glm::mat4 const local = compose_trs(m_local_position[i], m_local_rotation[i], m_local_scale[i]);
+                m_world_matrix[i] = parent == INVALID_INDEX ? local : m_world_matrix[parent] * local;
+                m_dirty[i] = 1;
+                ++chunk_updates;
+            }
+            update_count.fetch_add(chunk_updates, std::memory_order_relaxed);
+        });
+    }
+
+    std::fill(m_dirty.begin(), m_dirty.end(), static_cast<uint8_t>(0));
+    m_any_dirty = false;
+    m_last_update_count = update_count.load();
+}
+
+void Scene::CTransformHierarchy::MarkDirty(uint32_t const index)
+{
+    m_dirty[index] = 1;
+    m_any_dirty = true;
+}
+
+void Scene::CTransformHierarchy::SortByDepth()
+{
+    size_t const count = m_node_ids.size();
+
+    // Reparenting can move whole subtrees so recompute every depth. Walk up until we reach a
+    // node whose depth is already known this pass, then unwind filling in the chain.
+    m_depth.assign(count, INVALID_INDEX);
+    std::vector<uint32_t> chain;
+    uint32_t max_depth = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t node = i;
+        while (node != INVALID_INDEX && m_depth[node] == INVALID_INDEX)
+        {
+            chain.push_back(node);
+            node = m_parent_index[node];
+        }
+
+        uint32_t depth = node == INVALID_INDEX ? 0 : m_depth[node] + 1;
+        while (chain.empty() == false)
+        {
+            m_depth[chain.back()] = depth++;
+            chain.pop_back();
+        }
+        max_depth = std::max(max_depth, m_depth[i]);
+    }
+
+    // Stable counting sort by depth
+    m_level_offsets.assign(count == 0 ? 1 : max_depth + 2, 0);
+    for (uint32_t const depth : m_depth)
+    {
+        ++m_level_offsets[depth + 1];
+    }
+    for (size_t level = 1; level < m_level_offsets.size(); ++level)
+    {
+        m_level_offsets[level] += m_level_offsets[level - 1];
+    }
+
+    std::vector<uint32_t> cursor(m_level_offsets.begin(), m_level_offsets.end());
+    std::vector<uint32_t> new_to_old(count);
+    std::vector<uint32_t> old_to_new(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t const new_index = cursor[m_depth[i]]++;
+        new_to_old[new_index] = i;
+        old_to_new[i] = new_index;
+    }
+
+    permute(m_node_ids, new_to_old);
+    permute(m_parent_index, new_to_old);
+    permute(m_depth, new_to_old);
+    permute(m_local_position, new_to_old);
+    permute(m_local_rotation, new_to_old);
+    permute(m_local_scale, new_to_old);
+    permute(m_world_matrix, new_to_old);
+    permute(m_dirty, new_to_old);
+
+    for (auto & parent : m_parent_index)
+    {
+        if (parent != INVALID_INDEX)
+        {
+            parent = old_to_new[parent];
+        }
+    }
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        m_id_to_index[m_node_ids[i]] = i;
+    }
+
+    m_order_dirty = false;
+}
+
+void Scene::CTransformHierarchy::RemoveIndices(std::vector<uint8_t> const & remove)
+{
+    size_t const count = m_node_ids.size();
+
+    std::vector<uint32_t> old_to_new(count, INVALID_INDEX);
+    uint32_t next = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (remove[i] == 0)
+        {
+            old_to_new[i] = next++;
+        }
+        else
+        {
+            m_id_to_index[m_node_ids[i]] = INVALID_INDEX;
+            m_free_ids.push_back(m_node_ids[i]);
+        }
+    }
+
+    compact(m_node_ids, remove);
+    compact(m_parent_index, remove);
+    compact(m_depth, remove);
+    compact(m_local_position, remove);
+    compact(m_local_rotation, remove);
+    compact(m_local_scale, remove);
+    compact(m_world_matrix, remove);
+    compact(m_dirty, remove);
+
+    for (auto & parent : m_parent_index)
+    {
+        if (parent != INVALID_INDEX)
+        {
+            parent = old_to_new[parent];
+        }
+    }
+    for (uint32_t i = 0; i < m_node_ids.size(); ++i)
+    {
+        m_id_to_index[m_node_ids[i]] = i;
+    }
+
+    // Removing whole subtrees keeps the depth order intact but the level ranges have shifted
+    m_order_dirty = true;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace Scene
+{
+    using NodeId = uint32_t;
+    constexpr NodeId INVALID_NODE = UINT32_MAX;
+
+    // Transform hierarchy stored as flat structure of arrays. Nodes are kept sorted by depth so
+    // every parent comes before its children and each depth level is a contiguous range, which
+    // lets a level be updated in parallel since nothing in it depends on anything else in it.
+    //
+    // NodeIds are stable handles, internally everything works on dense indices that change
+    // whenever the arrays are re-sorted after a structural change (create, destroy, reparent).
+    class CTransformHierarchy
+    {
+    public:
+        CTransformHierarchy();
+
+        void Reserve(size_t const node_count);
+
+        NodeId CreateNode(NodeId const parent = INVALID_NODE);
+
+        // Destroys the node along with everything parented beneath it
+        void DestroyNode(NodeId const node);
+
+        // Returns false if the node doesn't exist or the new parent is one of its descendants
+        bool SetParent(NodeId const node, NodeId const parent);
+        NodeId GetParent(NodeId const node) const;
+
+        bool IsValid(NodeId const node) const;
+        size_t NodeCount() const { return m_node_ids.size(); }
+
+        void SetLocalPosition(NodeId const node, glm::vec3 const & position);
+        void SetLocalRotation(NodeId const node, glm::quat const & rotation);
+        void SetLocalScale(NodeId const node, glm::vec3 const & scale);
+
+        glm::vec3 const & GetLocalPosition(NodeId const node) const;
+        glm::quat const & GetLocalRotation(NodeId const node) const;
+        glm::vec3 const & GetLocalScale(NodeId const node) const;
+
+        // Only valid after UpdateWorldTransforms for any node changed since the last update
+        glm::mat4 const & GetWorldMatrix(NodeId const node) const;
+
+        // Recomputes the world matrix of every dirty node and all of its descendants
+        void UpdateWorldTransforms();
+
+        // Number of world matrices recomputed by the last UpdateWorldTransforms
+        size_t GetLastUpdateCount() const { return m_last_update_count; }
+
+    private:
+        uint32_t IndexOf(NodeId const node) const { return m_id_to_index[node]; }
+        void MarkDirty(uint32_t const index);
+        void SortByDepth();
+        void RemoveIndices(std::vector<uint8_t> const & remove);
+
+        // Dense SoA arrays, all indexed the same way
+        std::vector<NodeId> m_node_ids;
+        std::vector<uint32_t> m_parent_index;
+        std::vector<uint32_t> m_depth;
+        std::vector<glm::vec3> m_local_position;
+        std::vector<glm::quat> m_local_rotation;
+        std::vector<glm::vec3> m_local_scale;
+        std::vector<glm::mat4> m_world_matrix;
+        std::vector<uint8_t> m_dirty;
+
+        // Start of each depth level within the dense arrays, plus a final end entry
+        std::vector<uint32_t> m_level_offsets;
+
+        // Sparse handle to dense index lookup
+        std::vector<uint32_t> m_id_to_index;
+        std::vector<NodeId> m_free_ids;
+
+        bool m_order_dirty;
+        bool m_any_dirty;
+        size_t m_last_update_count;
+    };
+}
@@ -0,0 +1,132 @@
+#include "cpu_features.hpp"
+
+#include <atomic>
+
+#if GOAT_ARCH_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace
+{
+    std::atomic<uint8_t> max_simd_level(static_cast<uint8_t>(Utility::ESimdLevel::AVX512));
+
+#if GOAT_ARCH_X86
+    void cpuid(uint32_t const leaf, uint32_t const sub_leaf, uint32_t regs[4])
+    {
+#if defined(_MSC_VER)
+        int info[4] = {};
+        __cpuidex(info, static_cast<int>(leaf), static_cast<int>(sub_leaf));
+        for (int i = 0; i < 4; ++i)
+        {
+            regs[i] = static_cast<uint32_t>(info[i]);
+        }
+#else
+        __cpuid_count(leaf, sub_leaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    }
+
+    uint64_t read_xcr0()
+    {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        uint32_t eax = 0;
+        uint32_t edx = 0;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+    }
+#endif
+
+    Utility::SCpuFeatures query_cpu_features()
+    {
+        Utility::SCpuFeatures features;
+
+#if GOAT_ARCH_X86
+        uint32_t regs[4] = {};
+        cpuid(0, 0, regs);
+        uint32_t const max_leaf = regs[0];
+
+        if (max_leaf >= 1)
+        {
+            cpuid(1, 0, regs);
+            features.sse41 = (regs[2] & (1u << 19)) != 0;
+            features.fma = (regs[2] & (1u << 12)) != 0;
+
+            bool const os_xsave = (regs[2] & (1u << 27)) != 0;
+            bool const cpu_avx = (regs[2] & (1u << 28)) != 0;
+
+            uint64_t const xcr0 = os_xsave ? read_xcr0() : 0;
+            // XMM and YMM state must both be saved by the OS before AVX registers are usable
+            bool const os_avx = (xcr0 & 0x6) == 0x6;
+            // as above plus opmask, ZMM_Hi256 and Hi16_ZMM state
+            bool const os_avx512 = (xcr0 & 0xE6) == 0xE6;
+
+            if (max_leaf >= 7)
+            {
+                cpuid(7, 0, regs);
+                features.avx2 = cpu_avx && os_avx && (regs[1] & (1u << 5)) != 0;
+                features.avx512f = os_avx512 && (regs[1] & (1u << 16)) != 0;
+            }
+
+            features.fma = features.fma && os_avx;
+        }
+#endif
+
+        return features;
+    }
+}
+
+Utility::SCpuFeatures const & Utility::get_cpu_features()
+{
+    static SCpuFeatures const features = query_cpu_features();
+    return features;
+}
+
+Utility::ESimdLevel Utility::get_simd_level()
+{
+    SCpuFeatures const & features = get_cpu_features();
+
+    ESimdLevel level = ESimdLevel::Scalar;
+    if (features.sse41 == true)
+    {
+        level = ESimdLevel::SSE41;
+    }
+    if (features.avx2 == true && features.fma == true)
+    {
+        level = ESimdLevel::AVX2;
+    }
+    if (features.avx512f == true && level == ESimdLevel::AVX2)
+    {
+        level = ESimdLevel::AVX512;
+    }
+
+    uint8_t const cap = max_simd_level.load(std::memory_order_relaxed);
+    if (static_cast<uint8_t>(level) > cap)
+    {
+        level = static_cast<ESimdLevel>(cap);
+    }
+    return level;
+}
+
+void Utility::set_max_simd_level(ESimdLevel const level)
+{
+    max_simd_level.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+char const * Utility::simd_level_name(ESimdLevel const level)
+{
+    switch (level)
+    {
+        case ESimdLevel::Scalar: return "Scalar";
+        case ESimdLevel::SSE41: return "SSE4.1";
+        case ESimdLevel::AVX2: return "AVX2";
+        case ESimdLevel::AVX512: return "AVX-512";
+    }
+    return "Unknown";
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cinttypes>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GOAT_ARCH_X86 1
+#else
+#define GOAT_ARCH_X86 0
+#endif
+
+namespace Utility
+{
+    // Ordered so that a higher level implies support for everything below it
+    enum class ESimdLevel : uint8_t
+    {
+        Scalar = 0,
+        SSE41,
+        AVX2,
+        AVX512
+    };
+
+    struct SCpuFeatures
+    {
+        bool sse41 = false;
+        bool avx2 = false;
+        bool fma = false;
+        bool avx512f = false;
+    };
+
+    // Queried once via CPUID (and XGETBV for OS support of the wider registers) then cached
+    SCpuFeatures const & get_cpu_features();
+
+    // The widest instruction set kernels should dispatch to, after applying any cap set below
+    ESimdLevel get_simd_level();
+
+    // Clamp dispatch to at most this level, used to compare paths or to work around a bad kernel
+    void set_max_simd_level(ESimdLevel const level);
+
+    char const * simd_level_name(ESimdLevel const level);
+}
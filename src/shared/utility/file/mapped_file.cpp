@@ -0,0 +1,135 @@
+#include "mapped_file.hpp"
+
+#include "utility/logging.hpp"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+FileHelpers::CMappedFile::CMappedFile()
+: m_data(nullptr)
+, m_size(0)
+#if defined(_WIN32)
+, m_file(INVALID_HANDLE_VALUE)
+, m_mapping(nullptr)
+#endif
+{
+}
+
+FileHelpers::CMappedFile::~CMappedFile()
+{
+    Close();
+}
+
+#if defined(_WIN32)
+
+bool FileHelpers::CMappedFile::Open(std::string const & filename)
+{
+    Close();
+
+    m_file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        ERROR_LOG("Failed to open file: " + filename);
+        return false;
+    }
+
+    LARGE_INTEGER size = {};
+    if (GetFileSizeEx(m_file, &size) == FALSE || size.QuadPart == 0)
+    {
+        ERROR_LOG("Failed to get the size of file: " + filename);
+        Close();
+        return false;
+    }
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void * const view = m_mapping != nullptr ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (view == nullptr)
+    {
+        ERROR_LOG("Failed to map file: " + filename);
+        Close();
+        return false;
+    }
+
+    m_data = static_cast<uint8_t const *>(view);
+    m_size = static_cast<size_t>(size.QuadPart);
+    return true;
+}
+
+void FileHelpers::CMappedFile::Close()
+{
+    if (m_data != nullptr)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping != nullptr)
+    {
+        CloseHandle(m_mapping);
+    }
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+    m_file = INVALID_HANDLE_VALUE;
+    m_mapping = nullptr;
+}
+
+#else
+
+bool FileHelpers::CMappedFile::Open(std::string const & filename)
+{
+    Close();
+
+    int const file = open(filename.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        ERROR_LOG("Failed to open file: " + filename);
+        return false;
+    }
+
+    struct stat info = {};
+    if (fstat(file, &info) != 0 || info.st_size <= 0)
+    {
+        ERROR_LOG("Failed to get the size of file: " + filename);
+        close(file);
+        return false;
+    }
+
+    void * const view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+    // The mapping holds its own reference to the file
+    close(file);
+
+    if (view == MAP_FAILED)
+    {
+        ERROR_LOG("Failed to map file: " + filename);
+        return false;
+    }
+
+    m_data = static_cast<uint8_t const *>(view);
+    m_size = static_cast<size_t>(info.st_size);
+    return true;
+}
+
+void FileHelpers::CMappedFile::Close()
+{
+    if (m_data != nullptr)
+    {
+        munmap(const_cast<uint8_t *>(m_data), m_size);
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <string>
+
+namespace FileHelpers
+{
+    // Read only view of a whole file mapped into memory, pages are only read from disk as
+    // they're touched. The data is page aligned so anything laid out with aligned offsets in
+    // the file is aligned in memory too.
+    class CMappedFile
+    {
+    public:
+        CMappedFile();
+        ~CMappedFile();
+
+        CMappedFile(CMappedFile const &) = delete;
+        CMappedFile & operator=(CMappedFile const &) = delete;
+
+        bool Open(std::string const & filename);
+        void Close();
+
+        bool IsOpen() const { return m_data != nullptr; }
+        uint8_t const * GetData() const { return m_data; }
+        size_t GetSize() const { return m_size; }
+
+    private:
+        uint8_t const * m_data;
+        size_t m_size;
+
+#if defined(_WIN32)
+        void * m_file;
+        void * m_mapping;
+#endif
+    };
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "utility/memory/linear_arena.hpp"
+
+namespace Memory
+{
+    // STL compatible allocator handing out memory from a CLinearArena. Deallocation does
+    // nothing, the memory comes back when the arena is reset, so containers using this must
+    // not outlive the arena's current frame. Reserve up front where possible since any
+    // regrowth leaves the old buffer behind until the reset.
+    template <typename T>
+    class arena_allocator
+    {
+    public:
+        using value_type = T;
+
+        // Moving or swapping a container takes its arena along, so a container can be pointed at
+        // the next frame's arena by assigning a fresh one over it
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        explicit arena_allocator(CLinearArena & arena) : m_arena(&arena) {}
+
+        template <typename U>
+        arena_allocator(arena_allocator<U> const & other) : m_arena(other.GetArena()) {}
+
+        T * allocate(size_t const count)
+        {
+            return m_arena->AllocateArray<T>(count);
+        }
+
+        void deallocate(T *, size_t)
+        {
+            // Reclaimed in bulk when the arena resets
+        }
+
+        CLinearArena * GetArena() const { return m_arena; }
+
+        template <typename U>
+        bool operator==(arena_allocator<U> const & rhs) const { return m_arena == rhs.GetArena(); }
+
+        template <typename U>
+        bool operator!=(arena_allocator<U> const & rhs) const { return m_arena != rhs.GetArena(); }
+
+    private:
+        CLinearArena * m_arena;
+    };
+
+    template <typename T>
+    using arena_vector = std::vector<T, arena_allocator<T>>;
+
+    using arena_string = std::basic_string<char, std::char_traits<char>, arena_allocator<char>>;
+}
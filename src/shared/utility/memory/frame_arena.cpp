@@ -0,0 +1,34 @@
+#include "frame_arena.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+    constexpr size_t DEFAULT_FRAME_ARENA_SIZE = 4 * 1024 * 1024;
+}
+
+constexpr uint32_t Memory::CFrameArena::MAX_FRAMES;
+
+Memory::CFrameArena::CFrameArena(size_t const bytes_per_frame, uint32_t const frame_count)
+: m_arenas()
+, m_frame_count(std::min(std::max(frame_count, 1u), MAX_FRAMES))
+, m_current(0)
+{
+    for (uint32_t i = 0; i < m_frame_count; ++i)
+    {
+        m_arenas[i].reset(new CLinearArena(bytes_per_frame));
+    }
+}
+
+void Memory::CFrameArena::BeginFrame()
+{
+    m_current = (m_current + 1) % m_frame_count;
+    m_arenas[m_current]->Reset();
+}
+
+Memory::CFrameArena & Memory::get_frame_arena()
+{
+    static CFrameArena arena(DEFAULT_FRAME_ARENA_SIZE);
+    return arena;
+}
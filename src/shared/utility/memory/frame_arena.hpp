@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <memory>
+
+#include "utility/memory/arena_allocator.hpp"
+#include "utility/memory/linear_arena.hpp"
+
+namespace Memory
+{
+    // A ring of linear arenas, one per frame in flight. BeginFrame moves on to the next arena
+    // and resets it, so anything allocated during a frame stays valid until the same arena
+    // comes round again, long enough for the gpu to have finished reading it.
+    class CFrameArena
+    {
+    public:
+        static constexpr uint32_t MAX_FRAMES = 3;
+
+        CFrameArena(size_t const bytes_per_frame, uint32_t const frame_count = MAX_FRAMES);
+
+        void BeginFrame();
+
+        CLinearArena & Current() { return *m_arenas[m_current]; }
+        uint32_t GetFrameCount() const { return m_frame_count; }
+
+        void * Allocate(size_t const size, size_t const alignment = alignof(std::max_align_t))
+        {
+            return Current().Allocate(size, alignment);
+        }
+
+        template <typename T>
+        arena_allocator<T> Allocator()
+        {
+            return arena_allocator<T>(Current());
+        }
+
+        template <typename T>
+        arena_vector<T> MakeVector(size_t const reserve = 0)
+        {
+            arena_vector<T> result(Allocator<T>());
+            result.reserve(reserve);
+            return result;
+        }
+
+        arena_string MakeString(char const * str)
+        {
+            return arena_string(str, Allocator<char>());
+        }
+
+    private:
+        std::unique_ptr<CLinearArena> m_arenas[MAX_FRAMES];
+        uint32_t m_frame_count;
+        uint32_t m_current;
+    };
+
+    // Shared arena for transient per-frame data, the window loop calls BeginFrame on it
+    // at the start of every frame
+    CFrameArena & get_frame_arena();
+}
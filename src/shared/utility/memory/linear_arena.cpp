@@ -0,0 +1,84 @@
+#include "linear_arena.hpp"
+
+#include "utility/logging.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+    uint8_t * align_pointer(uint8_t * ptr, size_t const alignment)
+    {
+        uintptr_t const address = reinterpret_cast<uintptr_t>(ptr);
+        return reinterpret_cast<uint8_t *>((address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1));
+    }
+}
+
+Memory::CLinearArena::CLinearArena(size_t const capacity)
+: m_block()
+, m_memory(nullptr)
+, m_capacity(0)
+, m_offset(0)
+, m_overflow_mutex()
+, m_overflow_blocks()
+, m_overflow_bytes(0)
+, m_high_water_mark(0)
+{
+    AllocateBlock(capacity);
+}
+
+void * Memory::CLinearArena::Allocate(size_t const size, size_t const alignment)
+{
+    assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+    // Reserve enough to align within our slice rather than looping on a compare exchange
+    size_t const reserve = size + alignment - 1;
+    size_t const offset = m_offset.fetch_add(reserve, std::memory_order_relaxed);
+
+    if (offset + reserve > m_capacity)
+    {
+        return AllocateOverflow(size, alignment);
+    }
+    return align_pointer(m_memory + offset, alignment);
+}
+
+void Memory::CLinearArena::Reset()
+{
+    size_t const used = GetUsed();
+    m_high_water_mark = std::max(m_high_water_mark, used + m_overflow_bytes);
+
+    if (m_overflow_blocks.empty() == false)
+    {
+        size_t const new_capacity = m_capacity + m_overflow_bytes + m_overflow_bytes / 2;
+        DEBUG_LOG("Linear arena overflowed, growing to " + std::to_string(new_capacity) + " bytes");
+
+        m_overflow_blocks.clear();
+        m_overflow_bytes = 0;
+        AllocateBlock(new_capacity);
+    }
+
+    m_offset.store(0, std::memory_order_relaxed);
+}
+
+size_t Memory::CLinearArena::GetUsed() const
+{
+    return std::min(m_offset.load(std::memory_order_relaxed), m_capacity);
+}
+
+void * Memory::CLinearArena::AllocateOverflow(size_t const size, size_t const alignment)
+{
+    std::lock_guard<std::mutex> lock(m_overflow_mutex);
+
+    size_t const block_size = size + alignment;
+    m_overflow_blocks.emplace_back(new uint8_t[block_size]);
+    m_overflow_bytes += block_size;
+
+    return align_pointer(m_overflow_blocks.back().get(), alignment);
+}
+
+void Memory::CLinearArena::AllocateBlock(size_t const capacity)
+{
+    m_block.reset(new uint8_t[capacity + CACHE_LINE_SIZE]);
+    m_memory = align_pointer(m_block.get(), CACHE_LINE_SIZE);
+    m_capacity = capacity;
+}
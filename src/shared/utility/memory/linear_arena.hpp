@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <cinttypes>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Memory
+{
+    constexpr size_t CACHE_LINE_SIZE = 64;
+
+    // Bump allocator over a single cache line aligned block. Allocation is one atomic add so it
+    // is safe from several threads at once, freeing is a no-op and Reset reclaims everything in
+    // O(1). If a frame asks for more than the block holds the extra requests fall back to
+    // separate overflow blocks, and the next Reset grows the main block to fit so that the
+    // steady state never touches the heap.
+    class CLinearArena
+    {
+    public:
+        explicit CLinearArena(size_t const capacity);
+
+        CLinearArena(CLinearArena const &) = delete;
+        CLinearArena & operator=(CLinearArena const &) = delete;
+
+        void * Allocate(size_t const size, size_t const alignment = alignof(std::max_align_t));
+
+        template <typename T>
+        T * AllocateArray(size_t const count)
+        {
+            return static_cast<T *>(Allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        // Must not be called while other threads are allocating
+        void Reset();
+
+        size_t GetCapacity() const { return m_capacity; }
+        size_t GetUsed() const;
+        size_t GetHighWaterMark() const { return m_high_water_mark; }
+
+    private:
+        void * AllocateOverflow(size_t const size, size_t const alignment);
+        void AllocateBlock(size_t const capacity);
+
+        std::unique_ptr<uint8_t[]> m_block;
+        uint8_t * m_memory;
+        size_t m_capacity;
+        std::atomic<size_t> m_offset;
+
+        std::mutex m_overflow_mutex;
+        std::vector<std::unique_ptr<uint8_t[]>> m_overflow_blocks;
+        size_t m_overflow_bytes;
+
+        size_t m_high_water_mark;
+    };
+}
@@ -0,0 +1,550 @@
+#include "memory_tracker.hpp"
+
+#include "utility/logging.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__APPLE__) || defined(__GLIBC__)
+#include <execinfo.h>
+#define GOAT_HAS_EXECINFO
+#endif
+
+namespace
+{
+    using Memory::EMemoryTag;
+
+    constexpr uint32_t HEADER_MAGIC = 0x474f4154; // GOAT
+    constexpr size_t MAX_CALLSTACK_DEPTH = 24;
+
+    struct SAllocationHeader
+    {
+        size_t size;
+        uint32_t magic;
+        EMemoryTag tag;
+        bool has_callstack;
+    };
+
+    // Keeps the user pointer aligned the same as plain malloc
+    constexpr size_t HEADER_SIZE = ((sizeof(SAllocationHeader) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t)) * alignof(std::max_align_t);
+
+    // Atomics are trivially constructible so these are zero initialised before any static
+    // constructor can allocate
+    struct STagCounters
+    {
+        std::atomic<size_t> live_bytes;
+        std::atomic<size_t> peak_bytes;
+        std::atomic<uint64_t> live_allocations;
+        std::atomic<uint64_t> total_allocations;
+        std::atomic<size_t> budget_bytes;
+        std::atomic<uint32_t> budget_warnings;
+    };
+
+    STagCounters s_counters[Memory::MEMORY_TAG_COUNT];
+
+    std::atomic<bool> s_capture_callstacks;
+
+    thread_local EMemoryTag t_current_tag = EMemoryTag::Untagged;
+
+    // Set while the tracker itself is working so that its own allocations (logging, dumping)
+    // don't recurse into budget warnings or callstack capture
+    thread_local bool t_inside_tracker = false;
+
+    class CTrackerGuard
+    {
+    public:
+        CTrackerGuard()
+        : m_previous(t_inside_tracker)
+        {
+            t_inside_tracker = true;
+        }
+
+        ~CTrackerGuard()
+        {
+            t_inside_tracker = m_previous;
+        }
+
+    private:
+        bool m_previous;
+    };
+
+    // The callstack records can't go through operator new or recording an allocation would
+    // allocate
+    template <typename T>
+    struct malloc_allocator
+    {
+        using value_type = T;
+
+        malloc_allocator() = default;
+
+        template <typename U>
+        malloc_allocator(malloc_allocator<U> const &)
+        {
+        }
+
+        T * allocate(size_t const count)
+        {
+            void * ptr = std::malloc(sizeof(T) * count);
+            if (ptr == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            return static_cast<T *>(ptr);
+        }
+
+        void deallocate(T * ptr, size_t const)
+        {
+            std::free(ptr);
+        }
+    };
+
+    template <typename T, typename U>
+    bool operator==(malloc_allocator<T> const &, malloc_allocator<U> const &)
+    {
+        return true;
+    }
+
+    template <typename T, typename U>
+    bool operator!=(malloc_allocator<T> const &, malloc_allocator<U> const &)
+    {
+        return false;
+    }
+
+    struct SCallstackRecord
+    {
+        size_t size;
+        EMemoryTag tag;
+        uint32_t frame_count;
+        void * frames[MAX_CALLSTACK_DEPTH];
+    };
+
+    struct SRecordStore
+    {
+        using RecordMap = std::unordered_map<void const *,
+                                             SCallstackRecord,
+                                             std::hash<void const *>,
+                                             std::equal_to<void const *>,
+                                             malloc_allocator<std::pair<void const * const, SCallstackRecord>>>;
+
+        std::mutex mutex;
+        RecordMap records;
+    };
+
+    // Intentionally never destroyed, frees can still arrive from other static destructors
+    SRecordStore & get_record_store()
+    {
+        static std::aligned_storage<sizeof(SRecordStore), alignof(SRecordStore)>::type storage;
+        static SRecordStore * store = new (&storage) SRecordStore();
+        return *store;
+    }
+
+    // Skips this and record_callstack so the stacks start at tracked_allocate
+    constexpr uint32_t SKIPPED_FRAMES = 2;
+
+    uint32_t capture_callstack(void ** frames, uint32_t const max_frames)
+    {
+#if defined(_WIN32)
+        return static_cast<uint32_t>(RtlCaptureStackBackTrace(SKIPPED_FRAMES, max_frames, frames, nullptr));
+#elif defined(GOAT_HAS_EXECINFO)
+        void * all_frames[MAX_CALLSTACK_DEPTH + SKIPPED_FRAMES];
+        int const count = backtrace(all_frames, static_cast<int>(max_frames + SKIPPED_FRAMES));
+        if (count <= static_cast<int>(SKIPPED_FRAMES))
+        {
+            return 0;
+        }
+        uint32_t const frame_count = static_cast<uint32_t>(count) - SKIPPED_FRAMES;
+        std::memcpy(frames, all_frames + SKIPPED_FRAMES, sizeof(void *) * frame_count);
+        return frame_count;
+#else
+        (void)frames;
+        (void)max_frames;
+        return 0;
+#endif
+    }
+
+    void record_callstack(void const * ptr, size_t const size, EMemoryTag const tag)
+    {
+        SCallstackRecord record;
+        record.size = size;
+        record.tag = tag;
+        record.frame_count = capture_callstack(record.frames, MAX_CALLSTACK_DEPTH);
+
+        SRecordStore & store = get_record_store();
+        std::lock_guard<std::mutex> lock(store.mutex);
+        store.records[ptr] = record;
+    }
+
+    void erase_callstack(void const * ptr)
+    {
+        SRecordStore & store = get_record_store();
+        std::lock_guard<std::mutex> lock(store.mutex);
+        store.records.erase(ptr);
+    }
+
+    void on_allocate(EMemoryTag const tag, size_t const size)
+    {
+        STagCounters & counters = s_counters[static_cast<size_t>(tag)];
+
+        size_t const live = counters.live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+        counters.live_allocations.fetch_add(1, std::memory_order_relaxed);
+        counters.total_allocations.fetch_add(1, std::memory_order_relaxed);
+
+        size_t peak = counters.peak_bytes.load(std::memory_order_relaxed);
+        while (live > peak && counters.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed) == false)
+        {
+        }
+
+        // Only warn on the allocation that crosses the budget, not every one after it
+        size_t const budget = counters.budget_bytes.load(std::memory_order_relaxed);
+        if (budget != 0 && live > budget && live - size <= budget)
+        {
+            counters.budget_warnings.fetch_add(1, std::memory_order_relaxed);
+
+            if (t_inside_tracker == false)
+            {
+                CTrackerGuard guard;
+                ERROR_LOG(std::string("Memory budget exceeded for ") + Memory::memory_tag_name(tag) + " : " +
+                          std::to_string(live) + " / " + std::to_string(budget) + " bytes");
+            }
+        }
+    }
+
+    void on_free(EMemoryTag const tag, size_t const size)
+    {
+        STagCounters & counters = s_counters[static_cast<size_t>(tag)];
+        counters.live_bytes.fetch_sub(size, std::memory_order_relaxed);
+        counters.live_allocations.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    std::string escape_json(std::string const & str)
+    {
+        std::string result;
+        result.reserve(str.size());
+        for (char const c : str)
+        {
+            if (c == '"' || c == '\\')
+            {
+                result += '\\';
+            }
+            result += c;
+        }
+        return result;
+    }
+
+    std::string symbolise_frame(void * frame)
+    {
+        std::string result;
+#if defined(GOAT_HAS_EXECINFO)
+        char ** symbols = backtrace_symbols(&frame, 1);
+        if (symbols != nullptr)
+        {
+            result = symbols[0];
+            std::free(symbols);
+            return result;
+        }
+#endif
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%p", frame);
+        result = buffer;
+        return result;
+    }
+}
+
+char const * Memory::memory_tag_name(EMemoryTag const tag)
+{
+    switch (tag)
+    {
+        case EMemoryTag::Untagged: return "Untagged";
+        case EMemoryTag::Renderer: return "Renderer";
+        case EMemoryTag::Assets:   return "Assets";
+        case EMemoryTag::Audio:    return "Audio";
+        case EMemoryTag::Editor:   return "Editor";
+        case EMemoryTag::Count:    break;
+    }
+    return "Unknown";
+}
+
+void * Memory::tracked_allocate(EMemoryTag const tag, size_t const size)
+{
+    uint8_t * block = static_cast<uint8_t *>(std::malloc(HEADER_SIZE + size));
+    if (block == nullptr)
+    {
+        return nullptr;
+    }
+
+    SAllocationHeader * header = reinterpret_cast<SAllocationHeader *>(block);
+    header->size = size;
+    header->magic = HEADER_MAGIC;
+    header->tag = tag;
+    header->has_callstack = false;
+
+    void * ptr = block + HEADER_SIZE;
+
+    on_allocate(tag, size);
+
+    if (s_capture_callstacks.load(std::memory_order_relaxed) == true && t_inside_tracker == false)
+    {
+        CTrackerGuard guard;
+        record_callstack(ptr, size, tag);
+        header->has_callstack = true;
+    }
+
+    return ptr;
+}
+
+void Memory::tracked_free(void * ptr)
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+
+    uint8_t * block = static_cast<uint8_t *>(ptr) - HEADER_SIZE;
+    SAllocationHeader * header = reinterpret_cast<SAllocationHeader *>(block);
+
+    if (header->magic != HEADER_MAGIC)
+    {
+        ERROR_LOG("Freeing memory that wasn't allocated by the memory tracker");
+        return;
+    }
+
+    if (header->has_callstack == true)
+    {
+        erase_callstack(ptr);
+    }
+
+    on_free(header->tag, header->size);
+
+    header->magic = 0;
+    std::free(block);
+}
+
+Memory::EMemoryTag Memory::get_thread_memory_tag()
+{
+    return t_current_tag;
+}
+
+Memory::CMemoryTagScope::CMemoryTagScope(EMemoryTag const tag)
+: m_previous_tag(t_current_tag)
+{
+    t_current_tag = tag;
+}
+
+Memory::CMemoryTagScope::~CMemoryTagScope()
+{
+    t_current_tag = m_previous_tag;
+}
+
+void Memory::set_memory_budget(EMemoryTag const tag, size_t const budget_bytes)
+{
+    s_counters[static_cast<size_t>(tag)].budget_bytes.store(budget_bytes, std::memory_order_relaxed);
+}
+
+Memory::SMemoryTagStats Memory::get_memory_stats(EMemoryTag const tag)
+{
+    STagCounters const & counters = s_counters[static_cast<size_t>(tag)];
+
+    SMemoryTagStats stats;
+    stats.live_bytes = counters.live_bytes.load(std::memory_order_relaxed);
+    stats.peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+    stats.live_allocations = counters.live_allocations.load(std::memory_order_relaxed);
+    stats.total_allocations = counters.total_allocations.load(std::memory_order_relaxed);
+    stats.budget_bytes = counters.budget_bytes.load(std::memory_order_relaxed);
+    stats.budget_warnings = counters.budget_warnings.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void Memory::set_callstack_capture(bool const enabled)
+{
+    s_capture_callstacks.store(enabled, std::memory_order_relaxed);
+}
+
+bool Memory::is_callstack_capture_enabled()
+{
+    return s_capture_callstacks.load(std::memory_order_relaxed);
+}
+
+bool Memory::dump_memory_stats_json(std::string const & filename)
+{
+    // The dump's own allocations would otherwise show up as new callstacks in the dump
+    CTrackerGuard guard;
+
+    std::vector<SCallstackRecord, malloc_allocator<SCallstackRecord>> records;
+    {
+        SRecordStore & store = get_record_store();
+        std::lock_guard<std::mutex> lock(store.mutex);
+        records.reserve(store.records.size());
+        for (auto const & record : store.records)
+        {
+            records.push_back(record.second);
+        }
+    }
+
+    // Group identical callstacks, biggest first, so dumps from two runs line up when diffed
+    auto const same_stack = [](SCallstackRecord const & lhs, SCallstackRecord const & rhs)
+    {
+        return lhs.tag == rhs.tag &&
+               lhs.frame_count == rhs.frame_count &&
+               std::equal(lhs.frames, lhs.frames + lhs.frame_count, rhs.frames);
+    };
+    std::sort(records.begin(), records.end(), [](SCallstackRecord const & lhs, SCallstackRecord const & rhs)
+    {
+        if (lhs.tag != rhs.tag)
+        {
+            return lhs.tag < rhs.tag;
+        }
+        if (lhs.frame_count != rhs.frame_count)
+        {
+            return lhs.frame_count < rhs.frame_count;
+        }
+        return std::lexicographical_compare(lhs.frames, lhs.frames + lhs.frame_count,
+                                            rhs.frames, rhs.frames + rhs.frame_count,
+                                            std::less<void *>());
+    });
+
+    struct SCallstackGroup
+    {
+        size_t first_record;
+        size_t count;
+        size_t bytes;
+    };
+    std::vector<SCallstackGroup> groups;
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        if (groups.empty() == false && same_stack(records[groups.back().first_record], records[i]) == true)
+        {
+            groups.back().count += 1;
+            groups.back().bytes += records[i].size;
+        }
+        else
+        {
+            groups.push_back({i, 1, records[i].size});
+        }
+    }
+    std::stable_sort(groups.begin(), groups.end(), [](SCallstackGroup const & lhs, SCallstackGroup const & rhs)
+    {
+        return lhs.bytes > rhs.bytes;
+    });
+
+    std::ofstream file(filename, std::ios::trunc);
+    if (file.is_open() == false)
+    {
+        ERROR_LOG("Failed to open file: " + filename);
+        return false;
+    }
+
+    file << "{\n";
+    file << "  \"tags\": [\n";
+    for (size_t i = 0; i < MEMORY_TAG_COUNT; ++i)
+    {
+        EMemoryTag const tag = static_cast<EMemoryTag>(i);
+        SMemoryTagStats const stats = get_memory_stats(tag);
+
+        file << "    {";
+        file << "\"tag\": \"" << memory_tag_name(tag) << "\", ";
+        file << "\"live_bytes\": " << stats.live_bytes << ", ";
+        file << "\"peak_bytes\": " << stats.peak_bytes << ", ";
+        file << "\"live_allocations\": " << stats.live_allocations << ", ";
+        file << "\"total_allocations\": " << stats.total_allocations << ", ";
+        file << "\"budget_bytes\": " << stats.budget_bytes << ", ";
+        file << "\"budget_warnings\": " << stats.budget_warnings;
+        file << "}" << (i + 1 < MEMORY_TAG_COUNT ? "," : "") << "\n";
+    }
+    file << "  ],\n";
+
+    file << "  \"callstacks\": [\n";
+    for (size_t i = 0; i < groups.size(); ++i)
+    {
+        SCallstackRecord const & record = records[groups[i].first_record];
+
+        file << "    {";
+        file << "\"tag\": \"" << memory_tag_name(record.tag) << "\", ";
+        file << "\"count\": " << groups[i].count << ", ";
+        file << "\"bytes\": " << groups[i].bytes << ", ";
+        file << "\"frames\": [";
+        for (uint32_t frame = 0; frame < record.frame_count; ++frame)
+        {
+            file << (frame > 0 ? ", " : "") << "\"" << escape_json(symbolise_frame(record.frames[frame])) << "\"";
+        }
+        file << "]}" << (i + 1 < groups.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n";
+    file << "}\n";
+
+    return file.good();
+}
+
+#if defined(GOAT_MEMORY_TRACKING)
+
+// Global hooks, everything that isn't explicitly tagged is attributed to the thread's current tag
+// --------------------------------------------------------------------------------
+
+void * operator new(size_t size)
+{
+    void * ptr = Memory::tracked_allocate(t_current_tag, size);
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void * operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void * operator new(size_t size, std::nothrow_t const &) noexcept
+{
+    return Memory::tracked_allocate(t_current_tag, size);
+}
+
+void * operator new[](size_t size, std::nothrow_t const &) noexcept
+{
+    return Memory::tracked_allocate(t_current_tag, size);
+}
+
+void operator delete(void * ptr) noexcept
+{
+    Memory::tracked_free(ptr);
+}
+
+void operator delete[](void * ptr) noexcept
+{
+    Memory::tracked_free(ptr);
+}
+
+void operator delete(void * ptr, std::nothrow_t const &) noexcept
+{
+    Memory::tracked_free(ptr);
+}
+
+void operator delete[](void * ptr, std::nothrow_t const &) noexcept
+{
+    Memory::tracked_free(ptr);
+}
+
+void operator delete(void * ptr, size_t) noexcept
+{
+    Memory::tracked_free(ptr);
+}
+
+void operator delete[](void * ptr, size_t) noexcept
+{
+    Memory::tracked_free(ptr);
+}
+
+#endif
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace Memory
+{
+    enum class EMemoryTag : uint8_t
+    {
+        Untagged,
+        Renderer,
+        Assets,
+        Audio,
+        Editor,
+
+        Count
+    };
+
+    constexpr size_t MEMORY_TAG_COUNT = static_cast<size_t>(EMemoryTag::Count);
+
+    struct SMemoryTagStats
+    {
+        size_t live_bytes = 0;
+        size_t peak_bytes = 0;
+        uint64_t live_allocations = 0;
+        uint64_t total_allocations = 0;
+
+        // Zero means no budget
+        size_t budget_bytes = 0;
+        uint32_t budget_warnings = 0;
+    };
+
+    char const * memory_tag_name(EMemoryTag const tag);
+
+    // Every tracked allocation carries a small header with its size and tag so that frees can
+    // be attributed without a lookup. The global new/delete go through these when the build
+    // has GOAT_MEMORY_TRACKING defined, using the calling thread's current tag.
+    void * tracked_allocate(EMemoryTag const tag, size_t const size);
+    void tracked_free(void * ptr);
+
+    EMemoryTag get_thread_memory_tag();
+
+    // Attributes every global new on this thread to the given tag until the scope ends
+    class CMemoryTagScope
+    {
+    public:
+        explicit CMemoryTagScope(EMemoryTag const tag);
+        ~CMemoryTagScope();
+
+        CMemoryTagScope(CMemoryTagScope const &) = delete;
+        CMemoryTagScope & operator=(CMemoryTagScope const &) = delete;
+
+    private:
+        EMemoryTag m_previous_tag;
+    };
+
+    // A warning is logged each time a tag's live bytes go over its budget
+    void set_memory_budget(EMemoryTag const tag, size_t const budget_bytes);
+
+    SMemoryTagStats get_memory_stats(EMemoryTag const tag);
+
+    // Callstacks are only recorded for allocations made while this is on, it is slow so it is
+    // meant for tracking down a specific leak rather than leaving enabled
+    void set_callstack_capture(bool const enabled);
+    bool is_callstack_capture_enabled();
+
+    // Writes the per tag stats and any live allocations that have callstacks recorded, grouped
+    // by callstack, so two dumps can be diffed to find leaks or regressions
+    bool dump_memory_stats_json(std::string const & filename);
+
+    template <typename T, EMemoryTag Tag>
+    class tagged_allocator
+    {
+    public:
+        using value_type = T;
+
+        template <typename U>
+        struct rebind
+        {
+            using other = tagged_allocator<U, Tag>;
+        };
+
+        tagged_allocator() = default;
+
+        template <typename U>
+        tagged_allocator(tagged_allocator<U, Tag> const &)
+        {
+        }
+
+        T * allocate(size_t const count)
+        {
+            // Allocators report failure by throwing, containers never check for null
+            void * ptr = tracked_allocate(Tag, sizeof(T) * count);
+            if (ptr == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            return static_cast<T *>(ptr);
+        }
+
+        void deallocate(T * ptr, size_t const)
+        {
+            tracked_free(ptr);
+        }
+    };
+
+    template <typename T, typename U, EMemoryTag Tag>
+    bool operator==(tagged_allocator<T, Tag> const &, tagged_allocator<U, Tag> const &)
+    {
+        return true;
+    }
+
+    template <typename T, typename U, EMemoryTag Tag>
+    bool operator!=(tagged_allocator<T, Tag> const &, tagged_allocator<U, Tag> const &)
+    {
+        return false;
+    }
+
+    template <typename T, EMemoryTag Tag>
+    using tagged_vector = std::vector<T, tagged_allocator<T, Tag>>;
+}
@@ -0,0 +1,187 @@
+#include "parallel_for.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct SBatch
+    {
+        Utility::ParallelRangeFunc const * func = nullptr;
+        size_t count = 0;
+        size_t grain_size = 1;
+        size_t chunk_count = 0;
+
+        std::atomic<size_t> next_chunk{0};
+        std::atomic<size_t> chunks_done{0};
+
+        // Runs one chunk, returns false once there are none left to claim
+        bool RunNextChunk()
+        {
+            size_t const chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= chunk_count)
+            {
+                return false;
+            }
+
+            size_t const begin = chunk * grain_size;
+            size_t const end = std::min(begin + grain_size, count);
+            (*func)(begin, end);
+
+            chunks_done.fetch_add(1, std::memory_order_acq_rel);
+            return true;
+        }
+
+        bool IsExhausted() const
+        {
+            return next_chunk.load(std::memory_order_relaxed) >= chunk_count;
+        }
+    };
+
+    class CWorkerPool
+    {
+    public:
+        CWorkerPool()
+        {
+            uint32_t const hw_threads = std::max(1u, std::thread::hardware_concurrency());
+            for (uint32_t i = 1; i < hw_threads; ++i)
+            {
+                m_workers.emplace_back([this]() { WorkerLoop(); });
+            }
+        }
+
+        ~CWorkerPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_quit = true;
+            }
+            m_wake.notify_all();
+
+            for (auto & worker : m_workers)
+            {
+                worker.join();
+            }
+        }
+
+        uint32_t ThreadCount() const
+        {
+            return static_cast<uint32_t>(m_workers.size()) + 1;
+        }
+
+        void Run(std::shared_ptr<SBatch> const & batch)
+        {
+            if (m_workers.empty() == false && batch->chunk_count > 1)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_batches.push_back(batch);
+                }
+                m_wake.notify_all();
+            }
+
+            while (batch->RunNextChunk() == true)
+            {
+            }
+
+            // Other threads may still be finishing chunks they claimed, help out with any other
+            // queued work rather than idling until they are done
+            while (batch->chunks_done.load(std::memory_order_acquire) < batch->chunk_count)
+            {
+                if (HelpWithQueuedWork() == false)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+    private:
+        std::shared_ptr<SBatch> AcquireBatch()
+        {
+            // caller must hold m_mutex
+            while (m_batches.empty() == false && m_batches.front()->IsExhausted() == true)
+            {
+                m_batches.pop_front();
+            }
+            return m_batches.empty() ? nullptr : m_batches.front();
+        }
+
+        bool HelpWithQueuedWork()
+        {
+            std::shared_ptr<SBatch> batch;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                batch = AcquireBatch();
+            }
+            return batch != nullptr && batch->RunNextChunk();
+        }
+
+        void WorkerLoop()
+        {
+            while (true)
+            {
+                std::shared_ptr<SBatch> batch;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_wake.wait(lock, [this]() { return m_quit == true || AcquireBatch() != nullptr; });
+
+                    if (m_quit == true)
+                    {
+                        return;
+                    }
+                    batch = AcquireBatch();
+                }
+
+                while (batch->RunNextChunk() == true)
+                {
+                }
+            }
+        }
+
+        std::vector<std::thread> m_workers;
+        std::deque<std::shared_ptr<SBatch>> m_batches;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        bool m_quit = false;
+    };
+
+    CWorkerPool & get_worker_pool()
+    {
+        static CWorkerPool pool;
+        return pool;
+    }
+}
+
+void Utility::parallel_for(size_t const count, size_t const grain_size, ParallelRangeFunc const & func)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    size_t const grain = std::max<size_t>(1, grain_size);
+    if (count <= grain)
+    {
+        func(0, count);
+        return;
+    }
+
+    std::shared_ptr<SBatch> batch = std::make_shared<SBatch>();
+    batch->func = &func;
+    batch->count = count;
+    batch->grain_size = grain;
+    batch->chunk_count = (count + grain - 1) / grain;
+
+    get_worker_pool().Run(batch);
+}
+
+uint32_t Utility::parallel_thread_count()
+{
+    return get_worker_pool().ThreadCount();
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <functional>
+
+namespace Utility
+{
+    using ParallelRangeFunc = std::function<void(size_t const begin, size_t const end)>;
+
+    // Splits [0, count) into chunks of at most grain_size items and runs them across a shared pool
+    // of worker threads. The calling thread works on chunks too and the call blocks until every
+    // chunk has finished, so it is safe to call from inside another parallel_for.
+    void parallel_for(size_t const count, size_t const grain_size, ParallelRangeFunc const & func);
+
+    // Number of threads that can execute chunks, including the calling thread
+    uint32_t parallel_thread_count();
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+namespace Utility
+{
+    // CPU time the whole process has used so far, user and kernel, summed over every thread.
+    // Only differences between two calls mean anything.
+    double get_process_cpu_seconds();
+}
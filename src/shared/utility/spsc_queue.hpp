@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cinttypes>
+#include <cstddef>
+#include <type_traits>
+
+namespace Utility
+{
+    // Wait-free single producer / single consumer ring buffer. Push and pop never lock or
+    // allocate so either end can be a realtime thread (e.g. the audio callback). The read and
+    // write indices are free running and kept on separate cache lines, each side also caches
+    // the other side's index so it only touches the shared line when it looks full or empty.
+    template <typename T, size_t Capacity>
+    class CSpscQueue
+    {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+        static_assert(std::is_trivially_copyable<T>::value, "Queue items are copied in and out");
+
+    public:
+        CSpscQueue()
+        : m_items()
+        , m_write()
+        , m_read()
+        {
+            m_write.index.store(0, std::memory_order_relaxed);
+            m_write.cached_other = 0;
+            m_read.index.store(0, std::memory_order_relaxed);
+            m_read.cached_other = 0;
+        }
+
+        CSpscQueue(CSpscQueue const &) = delete;
+        CSpscQueue & operator=(CSpscQueue const &) = delete;
+
+        // Producer only, returns false if the queue is full
+        bool TryPush(T const & item)
+        {
+            size_t const write = m_write.index.load(std::memory_order_relaxed);
+            if (write - m_write.cached_other == Capacity)
+            {
+                m_write.cached_other = m_read.index.load(std::memory_order_acquire);
+                if (write - m_write.cached_other == Capacity)
+                {
+                    return false;
+                }
+            }
+
+            m_items[write & (Capacity - 1)] = item;
+            m_write.index.store(write + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer only, returns false if the queue is empty
+        bool TryPop(T & item)
+        {
+            size_t const read = m_read.index.load(std::memory_order_relaxed);
+            if (read == m_read.cached_other)
+            {
+                m_read.cached_other = m_write.index.load(std::memory_order_acquire);
+                if (read == m_read.cached_other)
+                {
+                    return false;
+                }
+            }
+
+            item = m_items[read & (Capacity - 1)];
+            m_read.index.store(read + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Only exact when called from one of the two ends with the other idle
+        size_t SizeApprox() const
+        {
+            return m_write.index.load(std::memory_order_acquire) - m_read.index.load(std::memory_order_acquire);
+        }
+
+        static constexpr size_t GetCapacity() { return Capacity; }
+
+    private:
+        static constexpr size_t CACHE_LINE_SIZE = 64;
+
+        // Padded rather than alignas so the queue can be a member of heap allocated types
+        // without needing over aligned new
+        struct SIndex
+        {
+            std::atomic<size_t> index;
+            size_t cached_other;
+            uint8_t padding[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+        };
+
+        T m_items[Capacity];
+        SIndex m_write;
+        SIndex m_read;
+    };
+}
@@ -7,11 +7,19 @@
 #include <glm/vec4.hpp>
 #include <glm/mat4x4.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
 #include <iostream>
 #include <memory>
 #include <utility>
 
+#include "renderer/trace/render_trace_recorder.hpp"
 #include "utility/logging.hpp"
+#include "utility/memory/frame_arena.hpp"
+#include "utility/memory/memory_tracker.hpp"
+#include "utility/process_time.hpp"
 
 #include "imgui.h"
 #include "backends/imgui_impl_glfw.h"
@@ -32,6 +40,15 @@ Renderer::VulkanRenderContext * renderer = nullptr;
 
 #endif
 
+// The renderer itself, or a trace recorder in front of it when one is being written
+Renderer::IRenderContext * render_context = nullptr;
+
+// Set by input, window events and request_redraw, the next frame is drawn when redrawing on demand
+std::atomic<bool> redraw_requested(false);
+// Between glfwInit and glfwTerminate, when waking the loop is allowed
+std::atomic<bool> window_running(false);
+Window::SIdleStats idle_stats;
+
 #define UNUSED(expr) (void)expr
 
 Window::IWindowFunctions::~IWindowFunctions()
@@ -117,17 +134,128 @@ static void key_callback(GLFWwindow* window, int key, int scancode, int action,
     UNUSED(scancode);
     UNUSED(mods);
 
+    redraw_requested = true;
+
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
     {
         glfwSetWindowShouldClose(window, GLFW_TRUE);
     }
 }
 
+// The rest of the input only matters to ImGui, which chains on to these, they just wake the loop
+static void char_callback(GLFWwindow *, unsigned int)
+{
+    redraw_requested = true;
+}
+
+static void cursor_pos_callback(GLFWwindow *, double, double)
+{
+    redraw_requested = true;
+}
+
+static void cursor_enter_callback(GLFWwindow *, int)
+{
+    redraw_requested = true;
+}
+
+static void mouse_button_callback(GLFWwindow *, int, int, int)
+{
+    redraw_requested = true;
+}
+
+static void scroll_callback(GLFWwindow *, double, double)
+{
+    redraw_requested = true;
+}
+
+static void focus_callback(GLFWwindow *, int)
+{
+    redraw_requested = true;
+}
+
+// Part of the window was uncovered or its contents were lost
+static void refresh_callback(GLFWwindow *)
+{
+    redraw_requested = true;
+}
+
+static void save_captured_frames(Window::SHeadlessSettings const & settings, bool const wait)
+{
+    Renderer::SCapturedFrame frame;
+    while (render_context->PopCapturedFrame(frame, wait) == true)
+    {
+        char filename[64];
+        if (settings.capture_format == Renderer::ECaptureFileFormat::Png)
+        {
+            snprintf(filename, sizeof(filename), "/frame_%05" PRIu64 ".png", frame.frame_index);
+        }
+        else
+        {
+            // Raw files don't say how big they are, so the name does
+            snprintf(filename, sizeof(filename), "/frame_%05" PRIu64 "_%ux%u.rgba", frame.frame_index, frame.width, frame.height);
+        }
+        Renderer::save_captured_frame(frame, settings.capture_directory + filename, settings.capture_format);
+    }
+}
+
 static void resize_callback(GLFWwindow * _window, int _width, int _height)
 {
     UNUSED(_window);
-    renderer->ResizeScreen(static_cast<uint32_t>(_width),
-                           static_cast<uint32_t>(_height));
+    render_context->ResizeScreen(static_cast<uint32_t>(_width),
+                                 static_cast<uint32_t>(_height));
+    redraw_requested = true;
+}
+
+// Sleeps in the OS until there is a reason to draw, keeping count of how long was spent idle and
+// what that cost. Only returns with no frames pending when the window is closing or animating.
+static void wait_for_redraw(GLFWwindow * glfw_window,
+                            Window::SRedrawOnDemandSettings const & settings,
+                            Window::IWindowFunctions * window_funcs,
+                            uint32_t & pending_frames)
+{
+    // Whatever arrived while the last frame was being drawn
+    glfwPollEvents();
+
+    bool idle = false;
+    auto idle_start = std::chrono::steady_clock::now();
+    double idle_start_cpu = 0.0;
+    while (glfwWindowShouldClose(glfw_window) == false)
+    {
+        if (redraw_requested.exchange(false) == true)
+        {
+            pending_frames = settings.settle_frames + 1;
+        }
+        if (pending_frames > 0 || (window_funcs != nullptr && window_funcs->NeedsRedraw() == true))
+        {
+            break;
+        }
+
+        if (idle == false)
+        {
+            idle = true;
+            idle_start = std::chrono::steady_clock::now();
+            idle_start_cpu = Utility::get_process_cpu_seconds();
+        }
+        else
+        {
+            ++idle_stats.idle_wakeups;
+        }
+
+        glfwWaitEventsTimeout(settings.idle_wakeup_seconds);
+    }
+
+    if (idle == true)
+    {
+        idle_stats.last_idle_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - idle_start).count();
+        idle_stats.last_idle_cpu_seconds = Utility::get_process_cpu_seconds() - idle_start_cpu;
+        idle_stats.total_idle_seconds += idle_stats.last_idle_seconds;
+        idle_stats.total_idle_cpu_seconds += idle_stats.last_idle_cpu_seconds;
+    }
+}
+
+static double percent_of_one_core(double const cpu_seconds, double const seconds)
+{
+    return seconds > 0.0 ? cpu_seconds * 100.0 / seconds : 0.0;
 }
 
 
@@ -139,21 +267,47 @@ Window::WindowInstance::WindowInstance(std::string const & window_name,
 , m_width(width)
 , m_height(height)
 , m_window_funcs(window_funcs)
+, m_render_trace_filename()
+, m_dynamic_resolution()
+, m_view_projection(1.0f)
+, m_redraw_on_demand()
 {
 
 }
 
 int Window::WindowInstance::Run()
 {
+    return Run(nullptr);
+}
+
+int Window::WindowInstance::RunHeadless(SHeadlessSettings const & settings)
+{
+    return Run(&settings);
+}
+
+int Window::WindowInstance::Run(SHeadlessSettings const * headless_settings)
+{
+    bool const headless = headless_settings != nullptr;
+
     std::cout << "Init GLFW begin" << std::endl;
 
     glfwSetErrorCallback(error_callback);
 
+#if defined(GLFW_PLATFORM_NULL)
+    if (headless == true)
+    {
+        // GLFW 3.4's null platform needs no display server, older versions fall back to a
+        // hidden window on the normal one
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    }
+#endif
+
     if (glfwInit() == false)
     {
     std::cout << "Failed to init GLFW" << std::endl;
         return EXIT_FAILURE;
     }
+    window_running = true;
     std::cout << "Init GLFW finished" << std::endl;
     std::cout << "Creating GLFW window" << std::endl;
 
@@ -164,50 +318,129 @@ int Window::WindowInstance::Run()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);  // 3.2+ only
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);            // Required on Mac
+    if (headless == true)
+    {
+        // EGL can make a context with no surface behind it, the renderer draws offscreen
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+    }
 #endif
+    glfwWindowHint(GLFW_VISIBLE, headless == true ? GLFW_FALSE : GLFW_TRUE);
 
     GLFWwindow * glfw_window = nullptr;
     glfw_window = glfwCreateWindow(m_width, m_height, m_title.c_str(), nullptr, nullptr);
     if (glfw_window == nullptr)
     {
         std::cout << "Failed to create GLFW window" << std::endl;
+        window_running = false;
         glfwTerminate();
         return EXIT_FAILURE;
     }
     std::cout << "Created GLFW window" << std::endl;
 
-    
+    {
+        Memory::CMemoryTagScope memory_scope(Memory::EMemoryTag::Renderer);
+
 #ifdef GOAT_USE_VULKAN
-    uint32_t extensionCount = 0;
-    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+        uint32_t extensionCount = 0;
+        vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
 
-    std::cout << "Instantiating Vulkan Renderer" << std::endl;
-    renderer = new Renderer::VulkanRenderContext(glfw_window);
+        std::cout << "Instantiating Vulkan Renderer" << std::endl;
+        renderer = new Renderer::VulkanRenderContext(glfw_window, headless);
 #else
-    std::cout << "Instantiating OpenGL Renderer" << std::endl;
-    renderer = new Renderer::OpenGLRenderContext(glfw_window);
+        std::cout << "Instantiating OpenGL Renderer" << std::endl;
+        renderer = new Renderer::OpenGLRenderContext(glfw_window, headless);
 #endif
 
-    if (renderer->HasError() == false)
-    {
-        renderer->Init();
+        if (renderer->HasError() == false)
+        {
+            renderer->Init();
+        }
     }
 
     if (renderer->HasError())
     {
         ERROR_LOG(renderer->GetLastError());
+        window_running = false;
         glfwTerminate();
         return EXIT_FAILURE;
     }
 
-    init_imgui(glfw_window);
+    renderer->SetDynamicResolution(m_dynamic_resolution);
 
+    std::unique_ptr<Renderer::CRenderTraceRecorder> trace_recorder;
+    render_context = renderer;
+    if (m_render_trace_filename.empty() == false)
+    {
+        trace_recorder.reset(new Renderer::CRenderTraceRecorder(*renderer,
+                                                                m_render_trace_filename,
+                                                                static_cast<uint32_t>(m_width),
+                                                                static_cast<uint32_t>(m_height)));
+        if (trace_recorder->IsOpen() == true)
+        {
+            render_context = trace_recorder.get();
+        }
+    }
+    // Through the recorder so the trace starts with the camera
+    render_context->SetViewProjection(m_view_projection);
+
+    // Installed before ImGui so its callbacks chain on to these rather than replacing them
     glfwSetKeyCallback(glfw_window, key_callback);
+    glfwSetCharCallback(glfw_window, char_callback);
+    glfwSetCursorPosCallback(glfw_window, cursor_pos_callback);
+    glfwSetCursorEnterCallback(glfw_window, cursor_enter_callback);
+    glfwSetMouseButtonCallback(glfw_window, mouse_button_callback);
+    glfwSetScrollCallback(glfw_window, scroll_callback);
+    glfwSetWindowFocusCallback(glfw_window, focus_callback);
+    glfwSetWindowRefreshCallback(glfw_window, refresh_callback);
     glfwSetWindowSizeCallback(glfw_window, resize_callback);
 
+    init_imgui(glfw_window);
+
+    bool const redraw_on_demand = headless == false && m_redraw_on_demand.enabled == true;
+    // The first frame and the ones ImGui needs after it
+    uint32_t pending_frames = m_redraw_on_demand.settle_frames + 1;
+    redraw_requested = false;
+    idle_stats = SIdleStats();
+
+    uint32_t frame = 0;
+    auto const start_time = std::chrono::steady_clock::now();
+    double const start_cpu = Utility::get_process_cpu_seconds();
+
     while (glfwWindowShouldClose(glfw_window) == false && renderer->HasError() == false)
     {
-        glfwPollEvents();
+        if (headless == true)
+        {
+            if (frame == headless_settings->frame_count)
+            {
+                break;
+            }
+            if (headless_settings->capture_directory.empty() == false &&
+                headless_settings->capture_interval > 0 &&
+                frame % headless_settings->capture_interval == 0)
+            {
+                render_context->RequestCapture();
+            }
+        }
+
+        // Everything transient from the frame that used this arena last has been consumed by now
+        Memory::get_frame_arena().BeginFrame();
+
+        if (redraw_on_demand == true)
+        {
+            wait_for_redraw(glfw_window, m_redraw_on_demand, m_window_funcs, pending_frames);
+            if (glfwWindowShouldClose(glfw_window) == true)
+            {
+                break;
+            }
+            if (pending_frames > 0)
+            {
+                --pending_frames;
+            }
+        }
+        else
+        {
+            glfwPollEvents();
+        }
 
         imgui_begin_frame();
 
@@ -218,15 +451,25 @@ int Window::WindowInstance::Run()
 
         imgui_end_frame();
 
-        renderer->PreRender();
+        render_context->PreRender();
 
         if (m_window_funcs != nullptr)
         {
-            m_window_funcs->Render(renderer);
+            m_window_funcs->Render(render_context);
         }
 
+        // The scene is scaled up to the window first, so the UI is always drawn at full resolution
+        render_context->EndScene();
         imgui_draw_frame();
-        renderer->RenderFrame();
+        render_context->RenderFrame();
+        ++frame;
+        ++idle_stats.frames_drawn;
+
+        if (headless == true)
+        {
+            // Only what has already finished, the frames keep going while the rest copy
+            save_captured_frames(*headless_settings, false);
+        }
 
         if (m_window_funcs != nullptr)
         {
@@ -237,10 +480,44 @@ int Window::WindowInstance::Run()
         }
     }
 
+    idle_stats.total_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    idle_stats.total_cpu_seconds = Utility::get_process_cpu_seconds() - start_cpu;
+
+    if (headless == true)
+    {
+        save_captured_frames(*headless_settings, true);
+
+        // Includes the CPU side of every frame, there's just no presenting to wait on
+        double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        std::cout << "Rendered " << frame << " headless frames in " << seconds << "s";
+        if (frame > 0 && seconds > 0.0)
+        {
+            std::cout << ", " << (seconds * 1000.0 / frame) << "ms per frame, " << (frame / seconds) << " frames per second";
+        }
+        std::cout << std::endl;
+    }
+    else
+    {
+        // What the window cost while it was open, compare runs with and without redrawing on demand
+        std::cout << "Drew " << idle_stats.frames_drawn << " frames in " << idle_stats.total_seconds << "s using "
+                  << percent_of_one_core(idle_stats.total_cpu_seconds, idle_stats.total_seconds) << "% of one core";
+        if (redraw_on_demand == true)
+        {
+            std::cout << ", idle for " << idle_stats.total_idle_seconds << "s of it using "
+                      << percent_of_one_core(idle_stats.total_idle_cpu_seconds, idle_stats.total_idle_seconds) << "% of one core";
+        }
+        std::cout << std::endl;
+    }
+
+    // Writes out anything submitted since the last frame
+    render_context = renderer;
+    trace_recorder.reset();
+
     std::cout << "Quitting" << std::endl;
     glfwDestroyWindow(glfw_window);
     glfw_window = nullptr;
 
+    window_running = false;
     glfwTerminate();
 
     return EXIT_SUCCESS;
@@ -259,3 +536,17 @@ void Window::destroy_window(Window::WindowInstance * window)
     delete window;
     window = nullptr;
 }
+
+void Window::request_redraw()
+{
+    redraw_requested = true;
+    if (window_running == true)
+    {
+        glfwPostEmptyEvent();
+    }
+}
+
+Window::SIdleStats Window::get_idle_stats()
+{
+    return idle_stats;
+}
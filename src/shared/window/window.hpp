@@ -17,6 +17,53 @@ namespace Window
         virtual void Render(Renderer::IRenderContext * render_context) = 0;
 
         virtual bool WindowShouldClose() = 0;
+
+        // Asked before the loop goes idle when redrawing on demand, true keeps frames coming for
+        // as long as something on screen is animating
+        virtual bool NeedsRedraw() = 0;
+    };
+
+    // Rendering with nothing on screen: no visible window, no presenting and no vsync. Runs in
+    // containers without a display and measures render throughput on its own.
+    struct SHeadlessSettings
+    {
+        // Frames rendered before returning, unless the window functions ask to close first
+        uint32_t frame_count = 300;
+        // Every capture_interval'th frame is read back and saved here, nothing saved if empty
+        std::string capture_directory;
+        uint32_t capture_interval = 1;
+        Renderer::ECaptureFileFormat capture_format = Renderer::ECaptureFileFormat::Png;
+    };
+
+    // Drawing only when something changed instead of every vsync, for tools that mostly sit still.
+    // A frame is drawn for input, window events, request_redraw and whatever NeedsRedraw asks for,
+    // otherwise the loop sleeps in the OS. Ignored when headless.
+    struct SRedrawOnDemandSettings
+    {
+        bool enabled = false;
+        // Longest the loop sleeps before asking NeedsRedraw again, nothing is drawn if it says no
+        double idle_wakeup_seconds = 0.5;
+        // Drawn after the one an event arrived in, ImGui takes a frame or two to settle after
+        // input (a click that opens a menu, hover highlights moving on)
+        uint32_t settle_frames = 2;
+    };
+
+    // Where the time went, to put a number on what sitting idle costs
+    struct SIdleStats
+    {
+        uint64_t frames_drawn = 0;
+        // Times the loop woke up, found nothing to do and went back to sleep
+        uint64_t idle_wakeups = 0;
+
+        // The stretch with nothing drawn that ended most recently
+        double last_idle_seconds = 0.0;
+        double last_idle_cpu_seconds = 0.0;
+
+        // CPU is the whole process's, audio and driver threads included
+        double total_idle_seconds = 0.0;
+        double total_idle_cpu_seconds = 0.0;
+        double total_seconds = 0.0;
+        double total_cpu_seconds = 0.0;
     };
 
     class WindowInstance
@@ -28,12 +75,34 @@ namespace Window
                        IWindowFunctions * window_funcs);
 
         int Run();
+        int RunHeadless(SHeadlessSettings const & settings);
+
+        // Everything the next Run submits to the renderer is written to a render trace as well,
+        // for goat_replay to play back later
+        void RecordRenderTrace(std::string const & filename) { m_render_trace_filename = filename; }
+
+        // Applied to the renderer once it's made, off unless set
+        void SetDynamicResolution(Renderer::SDynamicResolutionSettings const & settings) { m_dynamic_resolution = settings; }
+
+        // Handed to the renderer once it's made, before the first frame. The window functions can
+        // move the camera from Render after that.
+        void SetViewProjection(glm::mat4 const & view_projection) { m_view_projection = view_projection; }
+
+        // Off unless set, every frame is drawn
+        void SetRedrawOnDemand(SRedrawOnDemandSettings const & settings) { m_redraw_on_demand = settings; }
 
     private:
+        // Headless when settings are given
+        int Run(SHeadlessSettings const * headless_settings);
+
         std::string m_title;
         int m_width;
         int m_height;
         IWindowFunctions * m_window_funcs;
+        std::string m_render_trace_filename;
+        Renderer::SDynamicResolutionSettings m_dynamic_resolution;
+        glm::mat4 m_view_projection;
+        SRedrawOnDemandSettings m_redraw_on_demand;
     };
 
     WindowInstance * create_window(std::string const & window_name,
@@ -42,4 +111,11 @@ namespace Window
                                    IWindowFunctions * window_funcs);
 
     void destroy_window(WindowInstance * window);
+
+    // Has the running window draw another frame when redrawing on demand. Safe from any thread,
+    // wakes the loop if it's asleep.
+    void request_redraw();
+
+    // For the running window, or the last one to run. Main thread only.
+    SIdleStats get_idle_stats();
 }
@@ -0,0 +1,196 @@
+// Plays a render trace recorded with the game's --trace flag back as fast as the backend this
+// was built against allows, then reports per-frame CPU and GPU times.
+// ./goat_replay <trace> [--windowed] [--csv <file>] [--capture <directory>]
+
+#include "renderer/trace/render_trace_player.hpp"
+#include "window/window.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // GPU timings trail the frame by a frame or two, a few empty frames after the end let the
+    // last of them come back
+    constexpr uint32_t GPU_DRAIN_FRAMES = 8;
+
+    class CReplayFunctions : public Window::IWindowFunctions
+    {
+    public:
+        explicit CReplayFunctions(Renderer::CRenderTracePlayer & player)
+        : m_player(player)
+        , m_cpu_milliseconds(player.GetFrameCount(), 0.0f)
+        , m_gpu_milliseconds(player.GetFrameCount(), -1.0f)
+        , m_frame_start()
+        , m_frames_started(0)
+        , m_drain_frames(0)
+        {
+        }
+
+        virtual void Input() override
+        {
+        }
+
+        virtual void Render(Renderer::IRenderContext * render_context) override
+        {
+            // Everything the CPU did for the last frame, submitting it, rendering it and the
+            // window's own work in between
+            auto const now = std::chrono::steady_clock::now();
+            if (m_frames_started > 0 && m_frames_started <= m_cpu_milliseconds.size())
+            {
+                m_cpu_milliseconds[m_frames_started - 1] = std::chrono::duration<float, std::milli>(now - m_frame_start).count();
+            }
+            m_frame_start = now;
+
+            // Every RenderFrame the window makes is one trace frame, so the renderer's frame
+            // indices line up with the trace's
+            Renderer::SGpuFrameTime const gpu_time = render_context->GetGpuFrameTime();
+            if (gpu_time.valid == true && gpu_time.frame_index < m_gpu_milliseconds.size())
+            {
+                m_gpu_milliseconds[gpu_time.frame_index] = gpu_time.milliseconds;
+            }
+
+            if (m_player.SubmitFrame(*render_context) == false)
+            {
+                ++m_drain_frames;
+            }
+            ++m_frames_started;
+        }
+
+        virtual bool WindowShouldClose() override
+        {
+            return m_drain_frames > GPU_DRAIN_FRAMES;
+        }
+
+        // Never redraws on demand, but every frame is a new one from the trace anyway
+        virtual bool NeedsRedraw() override
+        {
+            return true;
+        }
+
+        std::vector<float> const & GetCpuMilliseconds() const { return m_cpu_milliseconds; }
+        // Negative for frames the GPU didn't time
+        std::vector<float> const & GetGpuMilliseconds() const { return m_gpu_milliseconds; }
+
+    private:
+        Renderer::CRenderTracePlayer & m_player;
+        std::vector<float> m_cpu_milliseconds;
+        std::vector<float> m_gpu_milliseconds;
+        std::chrono::steady_clock::time_point m_frame_start;
+        size_t m_frames_started;
+        uint32_t m_drain_frames;
+    };
+
+    void print_summary(char const * name, std::vector<float> times)
+    {
+        times.erase(std::remove_if(times.begin(), times.end(), [](float const time) { return time < 0.0f; }), times.end());
+        if (times.empty() == true)
+        {
+            std::cout << std::setw(4) << name << "  not timed" << std::endl;
+            return;
+        }
+
+        std::sort(times.begin(), times.end());
+        double total = 0.0;
+        for (float const time : times)
+        {
+            total += time;
+        }
+        size_t const last = times.size() - 1;
+
+        std::cout << std::setw(4) << name
+                  << "  avg " << std::setw(8) << total / times.size()
+                  << "  p50 " << std::setw(8) << times[last / 2]
+                  << "  p95 " << std::setw(8) << times[last * 95 / 100]
+                  << "  max " << std::setw(8) << times[last] << " ms" << std::endl;
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "Usage: goat_replay <trace> [--windowed] [--csv <file>] [--capture <directory>]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    bool windowed = false;
+    std::string csv_filename;
+    Window::SHeadlessSettings headless_settings;
+    // The trace's own RequestCapture records decide what's captured, the window adds none
+    headless_settings.frame_count = std::numeric_limits<uint32_t>::max();
+    headless_settings.capture_interval = 0;
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string const argument = argv[i];
+        bool const has_value = i + 1 < argc;
+        if (argument == "--windowed")
+        {
+            windowed = true;
+        }
+        else if (argument == "--csv" && has_value == true)
+        {
+            csv_filename = argv[++i];
+        }
+        else if (argument == "--capture" && has_value == true)
+        {
+            headless_settings.capture_directory = argv[++i];
+        }
+    }
+
+    Renderer::CRenderTracePlayer player;
+    if (player.Open(argv[1]) == false)
+    {
+        return EXIT_FAILURE;
+    }
+    player.SetReplayCaptures(headless_settings.capture_directory.empty() == false);
+    std::cout << "Replaying " << player.GetFrameCount() << " frames at " << player.GetWidth() << "x" << player.GetHeight() << std::endl;
+
+    CReplayFunctions replay_functions(player);
+    Window::WindowInstance * window_ptr = Window::create_window("goat_replay",
+                                                                static_cast<int>(player.GetWidth()),
+                                                                static_cast<int>(player.GetHeight()),
+                                                                &replay_functions);
+    int const exit_code = windowed == true ? window_ptr->Run() : window_ptr->RunHeadless(headless_settings);
+    Window::destroy_window(window_ptr);
+    if (exit_code != EXIT_SUCCESS)
+    {
+        return exit_code;
+    }
+
+    std::vector<float> const & cpu_milliseconds = replay_functions.GetCpuMilliseconds();
+    std::vector<float> const & gpu_milliseconds = replay_functions.GetGpuMilliseconds();
+
+    if (csv_filename.empty() == false)
+    {
+        std::ofstream csv(csv_filename);
+        csv << "frame,cpu_ms,gpu_ms\n";
+        for (size_t frame = 0; frame < cpu_milliseconds.size(); ++frame)
+        {
+            csv << frame << "," << cpu_milliseconds[frame] << ",";
+            if (gpu_milliseconds[frame] >= 0.0f)
+            {
+                csv << gpu_milliseconds[frame];
+            }
+            csv << "\n";
+        }
+        if (csv.good() == false)
+        {
+            std::cout << "Failed to write " << csv_filename << std::endl;
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    print_summary("cpu", cpu_milliseconds);
+    print_summary("gpu", gpu_milliseconds);
+
+    return EXIT_SUCCESS;
+}